@@ -15,6 +15,15 @@
 #include "pw_base64/base64.h"
 
 #include <cstdint>
+#include <cstring>
+
+#include "pw_base64/config.h"
+#include "pw_base64/internal/base64.h"
+#include "pw_bytes/endian.h"
+
+#if PW_BASE64_SSSE3_SUPPORTED
+#include <tmmintrin.h>
+#endif  // PW_BASE64_SSSE3_SUPPORTED
 
 namespace pw::base64 {
 namespace {
@@ -81,15 +90,218 @@ constexpr uint8_t Byte2(uint8_t bits2, uint8_t bits3) {
   return ((bits2 & 0b000011) << 6) | bits3;
 }
 
+constexpr size_t Padding(const char* base64, size_t base64_size) {
+  if (base64[base64_size - 2] == kPadding) {
+    return 2;
+  }
+  if (base64[base64_size - 1] == kPadding) {
+    return 1;
+  }
+  return 0;
+}
+
+// Decodes groups of 4 characters into 3 bytes without handling padding.
+// Returns the end of the decoded data.
+uint8_t* DecodeGroups(const char* base64, size_t base64_size, uint8_t* binary) {
+  for (size_t ch = 0; ch < base64_size; ch += kEncodedGroupSize) {
+    const uint8_t char0 = CharToBits(base64[ch + 0]);
+    const uint8_t char1 = CharToBits(base64[ch + 1]);
+    const uint8_t char2 = CharToBits(base64[ch + 2]);
+    const uint8_t char3 = CharToBits(base64[ch + 3]);
+
+    *binary++ = Byte0(char0, char1);
+    *binary++ = Byte1(char1, char2);
+    *binary++ = Byte2(char2, char3);
+  }
+  return binary;
+}
+
+bool IsValidChars(const char* base64, size_t base64_size) {
+  for (size_t i = 0; i < base64_size; ++i) {
+    if (base64[i] < kMinValidChar || base64[i] > kMaxValidChar ||
+        CharToBits(base64[i]) == kX /* invalid char */) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Decodes base64_size characters, of which the first decoded_size were already
+// decoded into decoded_size / 4 * 3 bytes by a faster implementation.
+size_t FinishDecode(const char* base64,
+                    size_t base64_size,
+                    size_t decoded_size,
+                    uint8_t* binary) {
+  binary += decoded_size / kEncodedGroupSize * 3;
+  const uint8_t* const end = DecodeGroups(
+      &base64[decoded_size], base64_size - decoded_size, binary);
+  return size_t(end - binary) + decoded_size / kEncodedGroupSize * 3 -
+         Padding(base64, base64_size);
+}
+
+// SWAR (SIMD within a register) encoding. Each 64-bit word holds 8 characters
+// or 6-bit values, with the first one in the most significant byte.
+constexpr uint64_t kLsb = 0x0101010101010101u;
+constexpr uint64_t kMsb = 0x8080808080808080u;
+
+// Sets the most significant bit of each byte that is at least value. Bytes
+// must be less than 0x80 and value must be 1 to 0x80.
+constexpr uint64_t BytesAtLeast(uint64_t bytes, uint8_t value) {
+  return (bytes + (0x80u - value) * kLsb) & kMsb;
+}
+
+// Loads 8 bytes with the first in the most significant byte.
+inline uint64_t LoadWord(const void* data) {
+  return bytes::ReadInOrder<uint64_t>(std::endian::big, data);
+}
+
+// Stores 8 bytes with the most significant first.
+inline void StoreWord(uint64_t word, void* data) {
+  const uint64_t big_endian = bytes::ConvertOrderTo(std::endian::big, word);
+  std::memcpy(data, &big_endian, sizeof(big_endian));
+}
+
+// Encodes 6 bytes from 8 readable bytes into 8 characters.
+inline void EncodeSwarBlock(const uint8_t* bytes, char* output) {
+  // Spread the 48 input bits into eight 6-bit values, one per byte.
+  uint64_t bits = LoadWord(bytes) >> 16;
+  bits = (bits & 0x0000000000FFFFFFu) | ((bits & 0x0000FFFFFF000000u) << 8);
+  bits = (bits & 0x00000FFF00000FFFu) | ((bits & 0x00FFF00000FFF000u) << 4);
+  bits = (bits & 0x003F003F003F003Fu) | ((bits & 0x0FC00FC00FC00FC0u) << 2);
+
+  // Map each value to its character by adding the offset for its range of
+  // the alphabet. No byte overflows or underflows at any step, so the bytes
+  // never carry into each other.
+  const uint64_t chars = bits + uint64_t{'A'} * kLsb +
+                         6 * (BytesAtLeast(bits, 26) >> 7) -
+                         75 * (BytesAtLeast(bits, 52) >> 7) -
+                         15 * (BytesAtLeast(bits, 62) >> 7) +
+                         3 * (BytesAtLeast(bits, 63) >> 7);
+  StoreWord(chars, output);
+}
+
+#if PW_BASE64_SSSE3_SUPPORTED
+
+// Encodes 12 bytes from 16 readable bytes into 16 characters. This is the
+// algorithm from Wojciech Mula and Daniel Lemire, "Faster Base64 Encoding and
+// Decoding Using AVX2 Instructions" (2018).
+inline void EncodeSsse3Block(const uint8_t* bytes, char* output) {
+  // Arrange each 3-byte group as bytes 1, 0, 2, 1 of a 32-bit lane, then move
+  // its four 6-bit values into separate bytes with multiplies.
+  __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+  in = _mm_shuffle_epi8(
+      in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i bits = _mm_or_si128(
+      _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0FC0FC00)),
+                      _mm_set1_epi32(0x04000040)),
+      _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003F03F0)),
+                      _mm_set1_epi32(0x01000010)));
+
+  // Map each value to the index of its range's offset: 13 for A-Z, 0 for a-z,
+  // 1-10 for 0-9, 11 for +, and 12 for /.
+  __m128i range = _mm_subs_epu8(bits, _mm_set1_epi8(51));
+  range = _mm_or_si128(
+      range,
+      _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), bits),
+                    _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8('a' - 26,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        '0' - 52,
+                                        kChar62 - 62,
+                                        kChar63 - 63,
+                                        'A',
+                                        0,
+                                        0);
+  const __m128i chars = _mm_add_epi8(_mm_shuffle_epi8(offsets, range), bits);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(output), chars);
+}
+
+inline __m128i InRange(__m128i chars, char min, char max) {
+  return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(char(min - 1))),
+                       _mm_cmplt_epi8(chars, _mm_set1_epi8(char(max + 1))));
+}
+
+inline __m128i Equals(__m128i chars, char value) {
+  return _mm_cmpeq_epi8(chars, _mm_set1_epi8(value));
+}
+
+// Validates and, if kDecode is true, decodes blocks of 16 characters into 12
+// bytes, stopping at the first block with an invalid character. Returns the
+// number of characters processed.
+template <bool kDecode>
+size_t DecodeSsse3Blocks(const char* base64, size_t base64_size, uint8_t* out) {
+  size_t ch = 0;
+  for (; ch + 16 <= base64_size; ch += 16) {
+    const __m128i chars =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&base64[ch]));
+
+    // Classify each character by its range of the alphabet. Characters with
+    // the most significant bit set are negative, so they match no range.
+    const __m128i upper = InRange(chars, 'A', 'Z');
+    const __m128i lower = InRange(chars, 'a', 'z');
+    const __m128i digit = InRange(chars, '0', '9');
+    const __m128i char62 = _mm_or_si128(Equals(chars, '+'), Equals(chars, '-'));
+    const __m128i char63 = _mm_or_si128(Equals(chars, '/'), Equals(chars, '_'));
+    const __m128i padding = Equals(chars, kPadding);
+
+    const __m128i valid = _mm_or_si128(
+        _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(digit, padding)),
+        _mm_or_si128(char62, char63));
+    if (_mm_movemask_epi8(valid) != 0xFFFF) {
+      break;
+    }
+
+    if constexpr (kDecode) {
+      // Padding characters decode to 0, as in the scalar implementation.
+      __m128i bits =
+          _mm_and_si128(upper, _mm_sub_epi8(chars, _mm_set1_epi8('A')));
+      bits = _mm_or_si128(
+          bits,
+          _mm_and_si128(lower, _mm_sub_epi8(chars, _mm_set1_epi8('a' - 26))));
+      bits = _mm_or_si128(
+          bits,
+          _mm_and_si128(digit, _mm_sub_epi8(chars, _mm_set1_epi8('0' - 52))));
+      bits = _mm_or_si128(bits, _mm_and_si128(char62, _mm_set1_epi8(62)));
+      bits = _mm_or_si128(bits, _mm_and_si128(char63, _mm_set1_epi8(63)));
+
+      // Merge the 6-bit values into a 24-bit value per 32-bit lane, then move
+      // the three bytes of each lane to the front in big-endian order.
+      bits = _mm_maddubs_epi16(bits, _mm_set1_epi32(0x01400140));
+      bits = _mm_madd_epi16(bits, _mm_set1_epi32(0x00011000));
+      bits = _mm_shuffle_epi8(
+          bits,
+          _mm_setr_epi8(
+              2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+
+      _mm_storel_epi64(reinterpret_cast<__m128i*>(out), bits);
+      const uint32_t last =
+          uint32_t(_mm_cvtsi128_si32(_mm_srli_si128(bits, 8)));
+      std::memcpy(&out[8], &last, sizeof(last));
+      out += 12;
+    }
+  }
+  return ch;
+}
+
+#endif  // PW_BASE64_SSSE3_SUPPORTED
+
 }  // namespace
 
-extern "C" void pw_Base64Encode(const void* binary_data,
-                                const size_t binary_size_bytes,
-                                char* output) {
+namespace internal {
+
+void EncodeScalar(const void* binary_data, size_t binary_size, char* output) {
   const uint8_t* bytes = static_cast<const uint8_t*>(binary_data);
 
   // Encode groups of 3 source bytes into 4 output characters.
-  size_t remaining = binary_size_bytes;
+  size_t remaining = binary_size;
   for (; remaining >= 3u; remaining -= 3u, bytes += 3) {
     *output++ = BitGroup0Char(bytes[0]);
     *output++ = BitGroup1Char(bytes[0], bytes[1]);
@@ -112,50 +324,103 @@ extern "C" void pw_Base64Encode(const void* binary_data,
   }
 }
 
-extern "C" size_t pw_Base64Decode(const char* base64,
-                                  size_t base64_size_bytes,
-                                  void* output) {
+size_t DecodeScalar(const char* base64, size_t base64_size, void* output) {
   // If too small, can't be valid input, due to likely missing padding
-  if (base64_size_bytes < 4) {
+  if (base64_size < 4) {
     return 0;
   }
+  return FinishDecode(base64, base64_size, 0, static_cast<uint8_t*>(output));
+}
 
-  uint8_t* binary = static_cast<uint8_t*>(output);
-  for (size_t ch = 0; ch < base64_size_bytes; ch += kEncodedGroupSize) {
-    const uint8_t char0 = CharToBits(base64[ch + 0]);
-    const uint8_t char1 = CharToBits(base64[ch + 1]);
-    const uint8_t char2 = CharToBits(base64[ch + 2]);
-    const uint8_t char3 = CharToBits(base64[ch + 3]);
+bool IsValidScalar(const char* base64, size_t base64_size) {
+  if (base64_size % kEncodedGroupSize != 0) {
+    return false;
+  }
+  return IsValidChars(base64, base64_size);
+}
 
-    *binary++ = Byte0(char0, char1);
-    *binary++ = Byte1(char1, char2);
-    *binary++ = Byte2(char2, char3);
+void EncodeSwar(const void* binary_data, size_t binary_size, char* output) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(binary_data);
+
+  // Each block reads 8 bytes and encodes the first 6.
+  for (; binary_size >= 8u; binary_size -= 6u, bytes += 6, output += 8) {
+    EncodeSwarBlock(bytes, output);
+  }
+  EncodeScalar(bytes, binary_size, output);
+}
+
+#if PW_BASE64_SSSE3_SUPPORTED
+
+void EncodeSsse3(const void* binary_data, size_t binary_size, char* output) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(binary_data);
+
+  // Each block reads 16 bytes and encodes the first 12.
+  for (; binary_size >= 16u; binary_size -= 12u, bytes += 12, output += 16) {
+    EncodeSsse3Block(bytes, output);
   }
+  EncodeScalar(bytes, binary_size, output);
+}
 
-  size_t pad = 0;
-  if (base64[base64_size_bytes - 2] == kPadding) {
-    pad = 2;
-  } else if (base64[base64_size_bytes - 1] == kPadding) {
-    pad = 1;
+size_t DecodeSsse3(const char* base64, size_t base64_size, void* output) {
+  if (base64_size < 4) {
+    return 0;
   }
 
-  return binary - static_cast<uint8_t*>(output) - pad;
+  // The final group may have padding, so it is always decoded by FinishDecode.
+  uint8_t* binary = static_cast<uint8_t*>(output);
+  const size_t decoded =
+      DecodeSsse3Blocks<true>(base64, base64_size - kEncodedGroupSize, binary);
+  return FinishDecode(base64, base64_size, decoded, binary);
 }
 
-extern "C" bool pw_Base64IsValid(const char* base64_data, size_t base64_size) {
+bool IsValidSsse3(const char* base64, size_t base64_size) {
   if (base64_size % kEncodedGroupSize != 0) {
     return false;
   }
+  const size_t checked = DecodeSsse3Blocks<false>(base64, base64_size, nullptr);
+  return IsValidChars(&base64[checked], base64_size - checked);
+}
 
-  for (size_t i = 0; i < base64_size; ++i) {
-    if (base64_data[i] < kMinValidChar || base64_data[i] > kMaxValidChar ||
-        CharToBits(base64_data[i]) == kX /* invalid char */) {
-      return false;
-    }
-  }
-  return true;
+#endif  // PW_BASE64_SSSE3_SUPPORTED
+
+}  // namespace internal
+
+#if PW_BASE64_CFG_IMPLEMENTATION == PW_BASE64_SCALAR
+#define PW_BASE64_ENCODE internal::EncodeScalar
+#define PW_BASE64_DECODE internal::DecodeScalar
+#define PW_BASE64_IS_VALID internal::IsValidScalar
+#elif PW_BASE64_CFG_IMPLEMENTATION == PW_BASE64_SWAR
+#define PW_BASE64_ENCODE internal::EncodeSwar
+#define PW_BASE64_DECODE internal::DecodeScalar
+#define PW_BASE64_IS_VALID internal::IsValidScalar
+#elif PW_BASE64_CFG_IMPLEMENTATION == PW_BASE64_SSSE3
+#define PW_BASE64_ENCODE internal::EncodeSsse3
+#define PW_BASE64_DECODE internal::DecodeSsse3
+#define PW_BASE64_IS_VALID internal::IsValidSsse3
+#else
+#error "Unknown PW_BASE64_CFG_IMPLEMENTATION"
+#endif  // PW_BASE64_CFG_IMPLEMENTATION
+
+extern "C" void pw_Base64Encode(const void* binary_data,
+                                const size_t binary_size_bytes,
+                                char* output) {
+  PW_BASE64_ENCODE(binary_data, binary_size_bytes, output);
 }
 
+extern "C" size_t pw_Base64Decode(const char* base64,
+                                  size_t base64_size_bytes,
+                                  void* output) {
+  return PW_BASE64_DECODE(base64, base64_size_bytes, output);
+}
+
+extern "C" bool pw_Base64IsValid(const char* base64_data, size_t base64_size) {
+  return PW_BASE64_IS_VALID(base64_data, base64_size);
+}
+
+#undef PW_BASE64_ENCODE
+#undef PW_BASE64_DECODE
+#undef PW_BASE64_IS_VALID
+
 size_t Encode(std::span<const std::byte> binary,
               std::span<char> output_buffer) {
   const size_t required_size = EncodedSize(binary.size_bytes());
@@ -0,0 +1,143 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark comparing the speed of the base64 implementations. Random
+// binary data of several sizes is encoded, then validated and decoded as
+// pw::base64::Decode does. 24 bytes is about the size of a tokenized log
+// message. The SSSE3 implementation is included if the benchmark is compiled
+// for a CPU with SSSE3 (e.g. with -mssse3). This target should only be built
+// for the host.
+//
+// Build the pw_base64.base64_benchmark target and run the binary. Each line
+// reports the encoding and decoding throughput of one implementation in MB/s
+// of binary data.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "pw_base64/base64.h"
+#include "pw_base64/config.h"
+#include "pw_base64/internal/base64.h"
+
+namespace pw::base64 {
+namespace {
+
+constexpr size_t kBytesPerRun = 64 * 1024 * 1024;
+
+struct Implementation {
+  const char* name;
+  void (*encode)(const void*, size_t, char*);
+  size_t (*decode)(const char*, size_t, void*);
+  bool (*is_valid)(const char*, size_t);
+};
+
+constexpr Implementation kImplementations[] = {
+    {"scalar",
+     internal::EncodeScalar,
+     internal::DecodeScalar,
+     internal::IsValidScalar},
+    {"SWAR",
+     internal::EncodeSwar,
+     internal::DecodeScalar,
+     internal::IsValidScalar},
+#if PW_BASE64_SSSE3_SUPPORTED
+    {"SSSE3",
+     internal::EncodeSsse3,
+     internal::DecodeSsse3,
+     internal::IsValidSsse3},
+#endif  // PW_BASE64_SSSE3_SUPPORTED
+};
+
+std::array<uint8_t, 4096> data;
+std::array<char, EncodedSize(4096)> encoded;
+std::array<uint8_t, MaxDecodedSize(EncodedSize(4096))> decoded;
+
+// Keeps the compiler from optimizing away unused results.
+volatile size_t result;
+
+double Throughput(std::chrono::steady_clock::time_point start) {
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return double(kBytesPerRun) / 1e6 / elapsed.count();
+}
+
+double RunEncodeBenchmark(const Implementation& impl, size_t size) {
+  const size_t iterations = kBytesPerRun / size;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    impl.encode(data.data(), size, encoded.data());
+  }
+  const double throughput = Throughput(start);
+
+  result = size_t(encoded[0]);
+  return throughput;
+}
+
+// Returns the throughput in MB/s, or 0 if decoding failed.
+double RunDecodeBenchmark(const Implementation& impl, size_t size) {
+  const size_t iterations = kBytesPerRun / size;
+  const size_t encoded_size = EncodedSize(size);
+  internal::EncodeScalar(data.data(), size, encoded.data());
+
+  size_t total = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    if (impl.is_valid(encoded.data(), encoded_size)) {
+      total += impl.decode(encoded.data(), encoded_size, decoded.data());
+    }
+  }
+  const double throughput = Throughput(start);
+
+  result = total;
+  return total == iterations * size ? throughput : 0;
+}
+
+int Main() {
+  uint32_t value = 1;
+  for (uint8_t& byte : data) {
+    value = value * 1103515245u + 12345u;
+    byte = uint8_t(value >> 16);
+  }
+
+  constexpr size_t kSizes[] = {24, 256, data.size()};
+
+  std::printf("%-8s", "MB/s");
+  for (size_t size : kSizes) {
+    std::printf("  %6zu B encode  %6zu B decode", size, size);
+  }
+  std::printf("\n");
+
+  for (const Implementation& impl : kImplementations) {
+    std::printf("%-8s", impl.name);
+    for (size_t size : kSizes) {
+      const double decode = RunDecodeBenchmark(impl, size);
+      if (decode == 0) {
+        std::printf("\n%s failed to decode %zu B\n", impl.name, size);
+        return 1;
+      }
+      std::printf("  %15.1f  %15.1f", RunEncodeBenchmark(impl, size), decode);
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::base64
+
+int main() { return pw::base64::Main(); }
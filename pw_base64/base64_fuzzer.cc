@@ -0,0 +1,92 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// This fuzzer checks that every base64 implementation in the build matches the
+// scalar implementation. The fuzz data is encoded and decoded as binary data,
+// then validated and, if valid, decoded as base64 text.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "pw_assert/assert.h"
+#include "pw_base64/base64.h"
+#include "pw_base64/internal/base64.h"
+
+namespace pw::base64 {
+namespace {
+
+struct Implementation {
+  void (*encode)(const void*, size_t, char*);
+  size_t (*decode)(const char*, size_t, void*);
+  bool (*is_valid)(const char*, size_t);
+};
+
+constexpr Implementation kImplementations[] = {
+    {internal::EncodeSwar, internal::DecodeScalar, internal::IsValidScalar},
+#if PW_BASE64_SSSE3_SUPPORTED
+    {internal::EncodeSsse3, internal::DecodeSsse3, internal::IsValidSsse3},
+#endif  // PW_BASE64_SSSE3_SUPPORTED
+};
+
+void CheckBinary(const uint8_t* data, size_t size) {
+  std::vector<char> expected(EncodedSize(size));
+  internal::EncodeScalar(data, size, expected.data());
+
+  std::vector<char> encoded(expected.size());
+  std::vector<uint8_t> decoded(MaxDecodedSize(encoded.size()));
+
+  for (const Implementation& impl : kImplementations) {
+    impl.encode(data, size, encoded.data());
+    PW_ASSERT(encoded == expected);
+
+    PW_ASSERT(impl.is_valid(encoded.data(), encoded.size()));
+    PW_ASSERT(impl.decode(encoded.data(), encoded.size(), decoded.data()) ==
+              size);
+    PW_ASSERT(size == 0u || std::memcmp(decoded.data(), data, size) == 0);
+  }
+}
+
+void CheckBase64(const char* base64, size_t size) {
+  const bool valid = internal::IsValidScalar(base64, size);
+  for (const Implementation& impl : kImplementations) {
+    PW_ASSERT(impl.is_valid(base64, size) == valid);
+  }
+
+  // Decoding invalid data is not supported.
+  if (!valid) {
+    return;
+  }
+
+  std::vector<uint8_t> expected(MaxDecodedSize(size));
+  const size_t expected_size =
+      internal::DecodeScalar(base64, size, expected.data());
+
+  std::vector<uint8_t> decoded(expected.size());
+  for (const Implementation& impl : kImplementations) {
+    PW_ASSERT(impl.decode(base64, size, decoded.data()) == expected_size);
+    PW_ASSERT(expected_size == 0u ||
+              std::memcmp(decoded.data(), expected.data(), expected_size) == 0);
+  }
+}
+
+}  // namespace
+}  // namespace pw::base64
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  pw::base64::CheckBinary(data, size);
+  pw::base64::CheckBase64(reinterpret_cast<const char*>(data), size);
+  return 0;
+}
@@ -14,9 +14,13 @@
 
 #include "pw_base64/base64.h"
 
+#include <array>
+#include <cstdint>
 #include <cstring>
+#include <string>
 
 #include "gtest/gtest.h"
+#include "pw_base64/internal/base64.h"
 
 namespace pw::base64 {
 namespace {
@@ -420,5 +424,122 @@ TEST(Base64CLinkage, Decode) {
   EXPECT_STREQ("fo", output);
 }
 
+// All base64 implementations available in this build, which must match the
+// scalar implementation exactly.
+struct Implementation {
+  void (*encode)(const void*, size_t, char*);
+  size_t (*decode)(const char*, size_t, void*);
+  bool (*is_valid)(const char*, size_t);
+};
+
+constexpr Implementation kImplementations[] = {
+    {internal::EncodeScalar, internal::DecodeScalar, internal::IsValidScalar},
+    {internal::EncodeSwar, internal::DecodeScalar, internal::IsValidScalar},
+#if PW_BASE64_SSSE3_SUPPORTED
+    {internal::EncodeSsse3, internal::DecodeSsse3, internal::IsValidSsse3},
+#endif  // PW_BASE64_SSSE3_SUPPORTED
+};
+
+constexpr char kGuard = '\xA5';
+
+std::array<uint8_t, 256> RandomData() {
+  std::array<uint8_t, 256> data;
+  uint32_t value = 1;
+  for (uint8_t& byte : data) {
+    value = value * 1103515245u + 12345u;
+    byte = uint8_t(value >> 16);
+  }
+  return data;
+}
+
+TEST(Base64Implementations, AllSizesAndAlignments_MatchScalar) {
+  const std::array<uint8_t, 256> data = RandomData();
+  std::array<char, EncodedSize(256) + 1> expected;
+  std::array<char, EncodedSize(256) + 1> encoded;
+  std::array<uint8_t, MaxDecodedSize(EncodedSize(256)) + 1> decoded;
+
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t size = 0; offset + size <= data.size(); ++size) {
+      const size_t encoded_size = EncodedSize(size);
+      internal::EncodeScalar(&data[offset], size, expected.data());
+
+      for (const Implementation& impl : kImplementations) {
+        encoded.fill(kGuard);
+        impl.encode(&data[offset], size, encoded.data());
+        ASSERT_EQ(0,
+                  std::memcmp(expected.data(), encoded.data(), encoded_size));
+        ASSERT_EQ(kGuard, encoded[encoded_size]);
+
+        ASSERT_TRUE(impl.is_valid(encoded.data(), encoded_size));
+
+        const size_t max_size = MaxDecodedSize(encoded_size);
+        decoded.fill(uint8_t(kGuard));
+        ASSERT_EQ(size, impl.decode(encoded.data(), encoded_size, &decoded));
+        ASSERT_EQ(0, std::memcmp(&data[offset], decoded.data(), size));
+        ASSERT_EQ(uint8_t(kGuard), decoded[max_size]);
+      }
+    }
+  }
+}
+
+TEST(Base64Implementations, UrlSafeAndInnerPadding_MatchScalar) {
+  // Every 4th character is URL-safe or padding, which IsValid accepts and
+  // Decode treats as 0.
+  std::string base64;
+  for (size_t i = 0; i < 100; ++i) {
+    base64 += "-_=A"[i % 4];
+    base64 += "+/9z"[i % 4];
+    base64 += "Qm8a"[i % 4];
+    base64 += "x_-Z"[i % 4];
+  }
+
+  std::array<uint8_t, 300> expected;
+  const size_t expected_size =
+      internal::DecodeScalar(base64.data(), base64.size(), &expected);
+
+  for (const Implementation& impl : kImplementations) {
+    std::array<uint8_t, 300> decoded;
+    EXPECT_TRUE(impl.is_valid(base64.data(), base64.size()));
+    ASSERT_EQ(expected_size,
+              impl.decode(base64.data(), base64.size(), &decoded));
+    EXPECT_EQ(0, std::memcmp(expected.data(), decoded.data(), expected_size));
+  }
+}
+
+TEST(Base64Implementations, InvalidCharacterAtEachPosition) {
+  constexpr char kInvalid[] = {
+      '\0', ' ', '*', ',', '.', ':', '<', '>', '@', '[', '^', '`', '{', '\x7f',
+      '\x80', '\xff'};
+  constexpr std::string_view kValid =
+      "VGhpcyBpcyBhIHNlY3JldCBtZXNzYWdlVGhpcyBpcyBhIHNlY3JldCBtZXNzYWdl";
+
+  for (const Implementation& impl : kImplementations) {
+    EXPECT_TRUE(impl.is_valid(kValid.data(), kValid.size()));
+  }
+
+  for (size_t i = 0; i < kValid.size(); ++i) {
+    for (char invalid : kInvalid) {
+      std::string base64(kValid);
+      base64[i] = invalid;
+      for (const Implementation& impl : kImplementations) {
+        ASSERT_FALSE(impl.is_valid(base64.data(), base64.size()));
+      }
+    }
+  }
+}
+
+TEST(Base64Implementations, DecodeInPlace) {
+  constexpr std::string_view kExpected =
+      "This is a secret message. This is a secret message.";
+
+  for (const Implementation& impl : kImplementations) {
+    char buffer[] =
+        "VGhpcyBpcyBhIHNlY3JldCBtZXNzYWdlLiBUaGlzIGlzIGEgc2VjcmV0IG1lc3NhZ2Uu";
+    ASSERT_EQ(kExpected.size(),
+              impl.decode(buffer, sizeof(buffer) - 1, buffer));
+    EXPECT_EQ(0, std::memcmp(kExpected.data(), buffer, kExpected.size()));
+  }
+}
+
 }  // namespace
 }  // namespace pw::base64
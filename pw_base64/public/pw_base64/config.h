@@ -0,0 +1,56 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Configuration macros for the base64 module. This header is usable from C.
+#pragma once
+
+// Base64 implementations.
+//
+//   SCALAR   - Table lookups, one 3-byte / 4-character group per iteration.
+//   SWAR     - Encodes 6 bytes per iteration with arithmetic on a 64-bit
+//              integer instead of table lookups. Decodes like SCALAR, which
+//              was faster than SWAR decoding on the CPUs measured.
+//   SSSE3    - Encodes 12 bytes and decodes or validates 16 characters per
+//              iteration in an SSE register. The compiler must target a CPU
+//              with SSSE3 (e.g. -mssse3).
+//
+// All implementations produce identical output. Inputs shorter than one
+// iteration and the final group use the SCALAR code.
+#define PW_BASE64_SCALAR 0
+#define PW_BASE64_SWAR 1
+#define PW_BASE64_SSSE3 2
+
+// Whether the compiler targets a CPU with instructions for the SSSE3
+// implementation.
+#if defined(__SSSE3__)
+#define PW_BASE64_SSSE3_SUPPORTED 1
+#else
+#define PW_BASE64_SSSE3_SUPPORTED 0
+#endif  // defined(__SSSE3__)
+
+// The implementation used by pw_Base64Encode, pw_Base64Decode,
+// pw_Base64IsValid, and their C++ equivalents. Defaults to SSSE3 if available
+// and SCALAR otherwise.
+#ifndef PW_BASE64_CFG_IMPLEMENTATION
+#if PW_BASE64_SSSE3_SUPPORTED
+#define PW_BASE64_CFG_IMPLEMENTATION PW_BASE64_SSSE3
+#else
+#define PW_BASE64_CFG_IMPLEMENTATION PW_BASE64_SCALAR
+#endif  // PW_BASE64_SSSE3_SUPPORTED
+#endif  // PW_BASE64_CFG_IMPLEMENTATION
+
+#if PW_BASE64_CFG_IMPLEMENTATION == PW_BASE64_SSSE3 && \
+    !PW_BASE64_SSSE3_SUPPORTED
+#error "The SSSE3 base64 implementation requires a CPU with SSSE3"
+#endif
@@ -0,0 +1,42 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+
+#include "pw_base64/config.h"
+
+// The individual base64 implementations. pw_Base64Encode, pw_Base64Decode, and
+// pw_Base64IsValid use the ones selected by PW_BASE64_CFG_IMPLEMENTATION. The
+// others are declared for tests, fuzzers, and benchmarks; unused
+// implementations are removed by the linker. Each function has the same
+// contract as the corresponding C function.
+namespace pw::base64::internal {
+
+void EncodeScalar(const void* binary_data, size_t binary_size, char* output);
+size_t DecodeScalar(const char* base64, size_t base64_size, void* output);
+bool IsValidScalar(const char* base64, size_t base64_size);
+
+// The SWAR implementation decodes with DecodeScalar and IsValidScalar.
+void EncodeSwar(const void* binary_data, size_t binary_size, char* output);
+
+#if PW_BASE64_SSSE3_SUPPORTED
+
+void EncodeSsse3(const void* binary_data, size_t binary_size, char* output);
+size_t DecodeSsse3(const char* base64, size_t base64_size, void* output);
+bool IsValidSsse3(const char* base64, size_t base64_size);
+
+#endif  // PW_BASE64_SSSE3_SUPPORTED
+
+}  // namespace pw::base64::internal
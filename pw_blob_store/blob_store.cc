@@ -15,11 +15,14 @@
 #include "pw_blob_store/blob_store.h"
 
 #include <algorithm>
+#include <chrono>
 
 #include "pw_assert/check.h"
 #include "pw_blob_store/internal/metadata_format.h"
 #include "pw_bytes/byte_builder.h"
 #include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_kvs/alignment.h"
 #include "pw_kvs/checksum.h"
 #include "pw_kvs/flash_memory.h"
 #include "pw_kvs/key_value_store.h"
@@ -34,6 +37,17 @@ namespace pw::blob_store {
 using internal::BlobMetadataHeader;
 using internal::ChecksumValue;
 
+namespace {
+
+uint32_t MicrosecondsSince(chrono::SystemClock::time_point start) {
+  return static_cast<uint32_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(
+          chrono::SystemClock::now() - start)
+          .count());
+}
+
+}  // namespace
+
 Status BlobStore::Init() {
   if (initialized_) {
     return OkStatus();
@@ -104,6 +118,16 @@ Status BlobStore::LoadMetadata() {
 
 size_t BlobStore::MaxDataSizeBytes() const { return partition_.size_bytes(); }
 
+void BlobStore::SetReadBackVerification(ReadBackVerification verification,
+                                        size_t sample_interval) {
+  PW_CHECK(!writer_open_);
+  PW_CHECK_UINT_GT(sample_interval, 0);
+
+  read_back_verification_ = verification;
+  read_back_interval_ = sample_interval;
+  writes_since_read_back_ = 0;
+}
+
 Status BlobStore::OpenWrite() {
   if (!initialized_) {
     return Status::FailedPrecondition();
@@ -118,6 +142,7 @@ Status BlobStore::OpenWrite() {
   PW_LOG_DEBUG("Blob writer open");
 
   writer_open_ = true;
+  half_buffer_bytes_ = 0;
 
   // Clear any existing contents.
   Invalidate().IgnoreError();  // TODO(pwbug/387): Handle Status properly
@@ -340,6 +365,127 @@ Status BlobStore::Flush() {
   return OkStatus();
 }
 
+void BlobStore::StartDoubleBuffering() {
+  PW_CHECK(!write_buffer_.empty());
+  const size_t write_buffer_size_alignment =
+      write_buffer_.size_bytes() % (2 * flash_write_size_bytes_);
+  PW_CHECK_UINT_EQ(write_buffer_size_alignment, 0);
+  PW_DCHECK_UINT_EQ(write_address_, 0);
+
+  half_buffer_bytes_ = write_buffer_.size_bytes() / 2;
+}
+
+Status BlobStore::AddToDoubleBuffer(ConstByteSpan data) {
+  PW_DCHECK_UINT_GT(half_buffer_bytes_, 0);
+
+  // commit_status_ may only be read while no commit is pending.
+  if (!commit_pending_.load(std::memory_order_acquire) &&
+      !commit_status_.ok()) {
+    return Status::DataLoss();
+  }
+  if (WriteBytesRemaining() == 0) {
+    return Status::OutOfRange();
+  }
+  // Free space only grows while this runs, since only this thread sets
+  // commit_pending_.
+  if (DoubleBufferBytesFree() < data.size_bytes()) {
+    return Status::ResourceExhausted();
+  }
+
+  // Fill the current half, handing it off whenever it is full. The half being
+  // filled is always contiguous in the write buffer.
+  while (data.size_bytes() > 0) {
+    HandOffFullHalfBuffer();
+
+    const size_t bytes_in_half = write_address_ - handoff_address_;
+    const size_t add_bytes =
+        std::min(half_buffer_bytes_ - bytes_in_half, data.size_bytes());
+    PW_DCHECK_UINT_GT(add_bytes, 0);
+
+    const size_t offset = write_address_ % write_buffer_.size_bytes();
+    std::memcpy(write_buffer_.data() + offset, data.data(), add_bytes);
+    write_address_ += add_bytes;
+    data = data.subspan(add_bytes);
+  }
+
+  // Hand off a newly filled half right away so the commit can start.
+  HandOffFullHalfBuffer();
+  return OkStatus();
+}
+
+void BlobStore::HandOffFullHalfBuffer() {
+  if (write_address_ - handoff_address_ == half_buffer_bytes_ &&
+      !commit_pending_.load(std::memory_order_acquire)) {
+    handoff_address_ += half_buffer_bytes_;
+    commit_pending_.store(true, std::memory_order_release);
+  }
+}
+
+size_t BlobStore::DoubleBufferBytesFree() const {
+  size_t bytes_free = half_buffer_bytes_ - (write_address_ - handoff_address_);
+
+  // The other half is free once its data has been committed.
+  if (!commit_pending_.load(std::memory_order_acquire)) {
+    bytes_free += half_buffer_bytes_;
+  }
+  return std::min(bytes_free, WriteBytesRemaining());
+}
+
+Status BlobStore::CommitPendingBuffer() {
+  if (!commit_pending_.load(std::memory_order_acquire)) {
+    return Status::NotFound();
+  }
+
+  // Half buffers are handed off in order, so the pending half holds the data
+  // that starts at flash_address_. Once it is committed, erase the sectors for
+  // the next half while the writing thread fills it.
+  if (commit_status_.ok()) {
+    const size_t offset = flash_address_ % write_buffer_.size_bytes();
+    commit_status_ = EraseThrough(flash_address_ + half_buffer_bytes_);
+    if (commit_status_.ok()) {
+      commit_status_ = CommitToFlash(
+          write_buffer_.subspan(offset, half_buffer_bytes_));
+    }
+    if (commit_status_.ok()) {
+      commit_status_ = EraseThrough(std::min(
+          flash_address_ + half_buffer_bytes_, MaxDataSizeBytes()));
+    }
+  }
+
+  const bool ok = commit_status_.ok();
+  commit_pending_.store(false, std::memory_order_release);
+  return ok ? OkStatus() : Status::DataLoss();
+}
+
+Status BlobStore::FinishDoubleBuffering() {
+  CommitPendingBuffer().IgnoreError();  // Errors are kept in commit_status_.
+  half_buffer_bytes_ = 0;
+  if (!commit_status_.ok()) {
+    return Status::DataLoss();
+  }
+
+  const size_t offset = flash_address_ % write_buffer_.size_bytes();
+  std::memmove(write_buffer_.data(),
+               write_buffer_.data() + offset,
+               WriteBufferBytesUsed());
+
+  // The remaining bytes are written as whole flash_write_size_bytes_ chunks.
+  return EraseThrough(AlignUp(write_address_, flash_write_size_bytes_));
+}
+
+Status BlobStore::EraseThrough(size_t end_address) {
+  while (erased_address_ < end_address) {
+    PW_TRY(partition_.Erase(erased_address_, 1));
+    erased_address_ += partition_.sector_size_bytes();
+  }
+
+  // As with a full erase, blob data is valid once the flash is erased.
+  if (flash_address_ == 0 && erased_address_ != 0) {
+    valid_data_ = true;
+  }
+  return OkStatus();
+}
+
 Status BlobStore::FlushFinalPartialChunk() {
   size_t bytes_in_buffer = WriteBufferBytesUsed();
 
@@ -371,17 +517,23 @@ Status BlobStore::CommitToFlash(ConstByteSpan source, size_t data_bytes) {
   }
 
   flash_erased_ = false;
-  StatusWithSize result = partition_.Write(flash_address_, source);
+  Status status = partition_.Write(flash_address_, source).status();
+  if (status.ok() &&
+      read_back_verification_ == ReadBackVerification::kSampled &&
+      ++writes_since_read_back_ >= read_back_interval_) {
+    writes_since_read_back_ = 0;
+    status = VerifyFlashContents(flash_address_, source);
+  }
   flash_address_ += data_bytes;
   if (checksum_algo_ != nullptr) {
     checksum_algo_->Update(source.first(data_bytes));
   }
 
-  if (!result.status().ok()) {
+  if (!status.ok()) {
     valid_data_ = false;
   }
 
-  return result.status();
+  return status;
 }
 
 // Needs to be in .cc file since PW_CHECK doesn't like being in .h files.
@@ -398,8 +550,9 @@ size_t BlobStore::WriteBufferBytesFree() const {
 }
 
 Status BlobStore::EraseIfNeeded() {
-  if (flash_address_ == 0) {
-    // Always just erase. Erase is smart enough to only erase if needed.
+  // Erase is smart enough to only erase if needed. Skip it if the first
+  // sectors were already erased by a DoubleBufferedWriter.
+  if (flash_address_ == 0 && erased_address_ == 0) {
     return Erase();
   }
   return OkStatus();
@@ -458,6 +611,7 @@ Status BlobStore::Erase() {
   PW_TRY(partition_.Erase());
 
   flash_erased_ = true;
+  erased_address_ = partition_.size_bytes();
 
   // Blob data is considered valid as soon as the flash is erased. Even though
   // there are 0 bytes written, they are valid.
@@ -473,6 +627,12 @@ Status BlobStore::Invalidate() {
   write_address_ = 0;
   flash_address_ = 0;
   file_name_length_ = 0;
+  if (!flash_erased_) {
+    erased_address_ = 0;
+  }
+  handoff_address_ = 0;
+  commit_pending_.store(false, std::memory_order_relaxed);
+  commit_status_ = OkStatus();
 
   Status status = kvs_.acquire()->Delete(MetadataKey());
 
@@ -516,6 +676,7 @@ Status BlobStore::CalculateChecksumFromFlash(size_t bytes_to_check) {
 
   kvs::FlashPartition::Address address = 0;
   const kvs::FlashPartition::Address end = bytes_to_check;
+  const chrono::SystemClock::time_point start = chrono::SystemClock::now();
 
   constexpr size_t kReadBufferSizeBytes = 32;
   std::array<std::byte, kReadBufferSizeBytes> buffer;
@@ -527,12 +688,46 @@ Status BlobStore::CalculateChecksumFromFlash(size_t bytes_to_check) {
     address += read_size;
   }
 
+  read_back_bytes_.Increment(bytes_to_check);
+  read_back_us_.Increment(MicrosecondsSince(start));
+
   // Safe to ignore the return from Finish, checksum_algo_ keeps the state
   // information that it needs.
   checksum_algo_->Finish();
   return OkStatus();
 }
 
+Status BlobStore::VerifyFlashContents(kvs::FlashPartition::Address address,
+                                      ConstByteSpan expected) {
+  const chrono::SystemClock::time_point start = chrono::SystemClock::now();
+  Status status;
+
+  constexpr size_t kReadBufferSizeBytes = 32;
+  std::array<std::byte, kReadBufferSizeBytes> buffer;
+  for (size_t offset = 0; status.ok() && offset < expected.size_bytes();
+       offset += buffer.size()) {
+    const size_t read_size =
+        std::min(expected.size_bytes() - offset, buffer.size());
+    status = partition_.Read(address + offset,
+                             std::span(buffer).first(read_size))
+                 .status();
+    if (status.ok() &&
+        std::memcmp(buffer.data(), &expected[offset], read_size) != 0) {
+      status = Status::DataLoss();
+    }
+  }
+
+  read_back_bytes_.Increment(expected.size_bytes());
+  read_back_us_.Increment(MicrosecondsSince(start));
+  if (!status.ok()) {
+    PW_LOG_ERROR("Blob read back of %u bytes at 0x%x failed",
+                 static_cast<unsigned>(expected.size_bytes()),
+                 static_cast<unsigned>(address));
+    verify_failures_.Increment();
+  }
+  return status;
+}
+
 Status BlobStore::BlobWriter::SetFileName(std::string_view file_name) {
   PW_DCHECK(open_);
   PW_DCHECK_NOTNULL(file_name.data());
@@ -582,9 +777,11 @@ Status BlobStore::BlobWriter::WriteMetadata() {
   }
 
   // Check the in-memory checksum against the data that was actually committed
-  // to flash.
-  if (!store_.ValidateChecksum(store_.flash_address_, calculated_checksum)
+  // to flash, unless it was verified as it was written.
+  if (store_.read_back_verification_ == ReadBackVerification::kOnClose &&
+      !store_.ValidateChecksum(store_.flash_address_, calculated_checksum)
            .ok()) {
+    store_.verify_failures_.Increment();
     PW_CHECK_OK(store_.Invalidate());
     return Status::DataLoss();
   }
@@ -630,6 +827,10 @@ Status BlobStore::BlobWriter::Close() {
   // the BlobWriter and BlobStore such that neither are open for writes
   // anymore.
   auto do_close_write = [&]() -> Status {
+    if (store_.half_buffer_bytes_ != 0) {
+      PW_TRY(store_.FinishDoubleBuffering());
+    }
+
     // If not valid to write, there was data loss and the close will result in a
     // not valid blob. Don't need to flush any write buffered bytes.
     if (!store_.ValidToWrite()) {
@@ -0,0 +1,254 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_blob_store/blob_store.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+#include "pw_log/log.h"
+#include "pw_random/xor_shift.h"
+
+namespace pw::blob_store {
+namespace {
+
+class DoubleBufferedWriteTest : public ::testing::Test {
+ protected:
+  DoubleBufferedWriteTest() : flash_(kFlashAlignment), partition_(&flash_) {}
+
+  void InitFlashToErased() { ASSERT_EQ(OkStatus(), partition_.Erase()); }
+
+  void InitFlashToRandom(uint64_t seed) {
+    random::XorShiftStarRng64 rng(seed);
+    StatusWithSize sws = rng.Get(flash_.buffer());
+    ASSERT_EQ(OkStatus(), sws.status());
+    ASSERT_EQ(sws.size(), flash_.buffer().size());
+  }
+
+  void InitBufferToRandom(uint64_t seed) {
+    random::XorShiftStarRng64 rng(seed);
+    StatusWithSize sws = rng.Get(buffer_);
+    ASSERT_EQ(OkStatus(), sws.status());
+    ASSERT_EQ(sws.size(), buffer_.size());
+  }
+
+  // Writes the source buffer to BlobStore in the specified chunk size,
+  // committing pending half buffers every commit_interval chunks. Chunks that
+  // do not fit are retried after a commit.
+  void ChunkWriteTest(size_t chunk_size,
+                      size_t commit_interval,
+                      bool explicit_discard = false) {
+    kvs::ChecksumCrc16 checksum;
+
+    char name[16] = {};
+    snprintf(name, sizeof(name), "Blob%u", static_cast<unsigned>(chunk_size));
+
+    BlobStoreBuffer<kBufferSize> blob(
+        name, partition_, &checksum, kvs::TestKvs(), kWriteSize);
+    EXPECT_EQ(OkStatus(), blob.Init());
+
+    BlobStore::DoubleBufferedWriterWithBuffer writer(blob);
+    EXPECT_EQ(OkStatus(), writer.Open());
+
+    if (explicit_discard) {
+      EXPECT_EQ(OkStatus(), writer.Write(std::span(buffer_).first(kWriteSize)));
+      EXPECT_EQ(OkStatus(), writer.Discard());
+    }
+
+    ByteSpan source = buffer_;
+    size_t chunks = 0;
+    while (source.size_bytes() > 0) {
+      const size_t write_size = std::min(source.size_bytes(), chunk_size);
+
+      PW_LOG_DEBUG("Do write of %u bytes, %u bytes remain",
+                   static_cast<unsigned>(write_size),
+                   static_cast<unsigned>(source.size_bytes()));
+
+      Status status = writer.Write(source.first(write_size));
+      if (status.IsResourceExhausted()) {
+        ASSERT_EQ(OkStatus(), writer.CommitPending());
+        continue;
+      }
+      ASSERT_EQ(OkStatus(), status);
+      source = source.subspan(write_size);
+
+      if (++chunks % commit_interval == 0 && writer.HasPendingCommit()) {
+        ASSERT_EQ(OkStatus(), writer.CommitPending());
+      }
+    }
+
+    EXPECT_EQ(OkStatus(), writer.Close());
+
+    // Use reader to check for valid data.
+    BlobStore::BlobReader reader(blob);
+    ASSERT_EQ(OkStatus(), reader.Open());
+    Result<ConstByteSpan> result = reader.GetMemoryMappedBlob();
+    ASSERT_TRUE(result.ok());
+    ASSERT_EQ(buffer_.size(), result.value().size_bytes());
+    EXPECT_EQ(
+        0,
+        std::memcmp(buffer_.data(), result.value().data(), buffer_.size()));
+    EXPECT_EQ(OkStatus(), reader.Close());
+  }
+
+  bool SectorErased(size_t sector) {
+    return std::all_of(
+        flash_.buffer().begin() + sector * kSectorSize,
+        flash_.buffer().begin() + (sector + 1) * kSectorSize,
+        [](std::byte b) { return b == std::byte{0xff}; });
+  }
+
+  static constexpr size_t kFlashAlignment = 16;
+  static constexpr size_t kSectorSize = 1024;
+  static constexpr size_t kSectorCount = 4;
+  static constexpr size_t kWriteSize = 64;
+  static constexpr size_t kBufferSize = 512;
+  static constexpr size_t kHalfBufferSize = kBufferSize / 2;
+
+  kvs::FakeFlashMemoryBuffer<kSectorSize, kSectorCount> flash_;
+  kvs::FlashPartition partition_;
+  std::array<std::byte, kSectorCount * kSectorSize> buffer_;
+};
+
+TEST_F(DoubleBufferedWriteTest, ChunkWrite1) {
+  InitFlashToErased();
+  InitBufferToRandom(0x8675309);
+  ChunkWriteTest(1, 64);
+}
+
+TEST_F(DoubleBufferedWriteTest, ChunkWrite3) {
+  InitFlashToRandom(0x2283);
+  InitBufferToRandom(0x8675);
+  ChunkWriteTest(3, 16);
+}
+
+TEST_F(DoubleBufferedWriteTest, ChunkWrite16) {
+  InitFlashToErased();
+  InitBufferToRandom(0x86);
+  ChunkWriteTest(16, 1);
+}
+
+TEST_F(DoubleBufferedWriteTest, ChunkWrite100) {
+  InitFlashToRandom(0x9223);
+  InitBufferToRandom(0x9);
+  ChunkWriteTest(100, 3);
+}
+
+TEST_F(DoubleBufferedWriteTest, ChunkWriteHalfBuffer) {
+  InitFlashToRandom(0x9223);
+  InitBufferToRandom(0x12345678);
+  ChunkWriteTest(kHalfBufferSize, 1);
+}
+
+TEST_F(DoubleBufferedWriteTest, ChunkWriteOnlyWhenFull) {
+  InitFlashToErased();
+  InitBufferToRandom(0x1286);
+
+  // Only commit when the buffer is full.
+  ChunkWriteTest(64, kSectorCount * kSectorSize);
+}
+
+TEST_F(DoubleBufferedWriteTest, ChunkWriteDiscard) {
+  InitFlashToErased();
+  InitBufferToRandom(0x86);
+
+  // Test with a discard of an invalid blob and erased flash.
+  ChunkWriteTest(16, 4, true);
+
+  // Test with a discard of a valid blob.
+  ChunkWriteTest(16, 4, true);
+
+  // Test with a discard of an current blob with corrupted date.
+  InitFlashToRandom(0x9223);
+  ChunkWriteTest(16, 4, true);
+}
+
+TEST_F(DoubleBufferedWriteTest, Write_FullBuffer_ResourceExhausted) {
+  InitFlashToErased();
+  InitBufferToRandom(0x5);
+
+  BlobStoreBuffer<kBufferSize> blob(
+      "Blob", partition_, nullptr, kvs::TestKvs(), kWriteSize);
+  EXPECT_EQ(OkStatus(), blob.Init());
+
+  BlobStore::DoubleBufferedWriterWithBuffer writer(blob);
+  EXPECT_EQ(OkStatus(), writer.Open());
+  EXPECT_EQ(kBufferSize, writer.ConservativeWriteLimit());
+
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(buffer_).first(kBufferSize)));
+  EXPECT_TRUE(writer.HasPendingCommit());
+  EXPECT_EQ(0u, writer.ConservativeWriteLimit());
+  EXPECT_EQ(Status::ResourceExhausted(),
+            writer.Write(std::span(buffer_).subspan(kBufferSize, 1)));
+
+  // The first half is committed, and the full second half is handed off by
+  // the next write.
+  EXPECT_EQ(OkStatus(), writer.CommitPending());
+  EXPECT_EQ(kHalfBufferSize, writer.ConservativeWriteLimit());
+  EXPECT_EQ(OkStatus(),
+            writer.Write(std::span(buffer_).subspan(kBufferSize, 1)));
+  EXPECT_TRUE(writer.HasPendingCommit());
+
+  EXPECT_EQ(OkStatus(), writer.CommitPending());
+  EXPECT_EQ(Status::NotFound(), writer.CommitPending());
+  EXPECT_EQ(OkStatus(), writer.Close());
+}
+
+TEST_F(DoubleBufferedWriteTest, CommitPending_PreErasesNextSector) {
+  InitFlashToRandom(0x4321);
+  InitBufferToRandom(0x1234);
+
+  BlobStoreBuffer<kBufferSize> blob(
+      "Blob", partition_, nullptr, kvs::TestKvs(), kWriteSize);
+  EXPECT_EQ(OkStatus(), blob.Init());
+
+  BlobStore::DoubleBufferedWriterWithBuffer writer(blob);
+  EXPECT_EQ(OkStatus(), writer.Open());
+
+  // Writes only fill the buffer; nothing is erased yet.
+  ASSERT_EQ(OkStatus(), writer.Write(std::span(buffer_).first(kBufferSize)));
+  EXPECT_FALSE(SectorErased(0));
+
+  // Fill the first sector. Each Write hands off the previously filled half.
+  // After the last half of the sector is committed, the second sector is
+  // erased ahead of the data.
+  ByteSpan source = std::span(buffer_).subspan(kBufferSize);
+  ASSERT_EQ(OkStatus(), writer.CommitPending());
+  ASSERT_EQ(OkStatus(), writer.Write(source.first(kHalfBufferSize)));
+  ASSERT_EQ(OkStatus(), writer.CommitPending());
+  ASSERT_EQ(OkStatus(),
+            writer.Write(source.subspan(kHalfBufferSize, kHalfBufferSize)));
+  ASSERT_EQ(OkStatus(), writer.CommitPending());
+  EXPECT_FALSE(SectorErased(1));
+
+  ASSERT_EQ(OkStatus(), writer.Write(source.subspan(kBufferSize, 1)));
+  ASSERT_EQ(OkStatus(), writer.CommitPending());
+  EXPECT_EQ(0,
+            std::memcmp(buffer_.data(), flash_.buffer().data(), kSectorSize));
+  EXPECT_TRUE(SectorErased(1));
+  EXPECT_FALSE(SectorErased(2));
+
+  EXPECT_EQ(OkStatus(), writer.Close());
+  EXPECT_FALSE(SectorErased(2));
+}
+
+}  // namespace
+}  // namespace pw::blob_store
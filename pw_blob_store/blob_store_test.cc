@@ -26,6 +26,7 @@
 #include "pw_kvs/test_key_value_store.h"
 #include "pw_log/log.h"
 #include "pw_random/xor_shift.h"
+#include "pw_tokenizer/tokenize.h"
 
 #ifndef PW_FLASH_TEST_ALIGNMENT
 #define PW_FLASH_TEST_ALIGNMENT 1
@@ -791,5 +792,122 @@ TEST_F(BlobStoreTest, MultipleWrites) {
   WriteTestBlock();
 }
 
+// Returns the value of the blob store metric with the specified name token.
+uint32_t BlobMetric(BlobStore& blob, uint32_t token) {
+  for (const metric::Metric& metric : blob.metrics().metrics()) {
+    if (metric.name() == token) {
+      return metric.as_int();
+    }
+  }
+  ADD_FAILURE();  // The metric was not found.
+  return 0;
+}
+
+constexpr uint32_t kReadBackBytesToken =
+    PW_TOKENIZE_STRING_MASK("metrics", 0x7fffffff, "read_back_bytes");
+constexpr uint32_t kVerifyFailuresToken =
+    PW_TOKENIZE_STRING_MASK("metrics", 0x7fffffff, "verify_failures");
+
+// Writes the whole source buffer as flash write sized chunks and closes the
+// blob.
+void WriteInChunks(BlobStore& blob, ConstByteSpan data, size_t chunk_size) {
+  BlobStore::BlobWriterWithBuffer writer(blob);
+  ASSERT_EQ(OkStatus(), writer.Open());
+  for (size_t offset = 0; offset < data.size_bytes(); offset += chunk_size) {
+    ASSERT_EQ(OkStatus(), writer.Write(data.subspan(offset, chunk_size)));
+  }
+  EXPECT_EQ(OkStatus(), writer.Close());
+}
+
+TEST_F(BlobStoreTest, ReadBackOnClose_ReadsWholeBlob) {
+  InitSourceBufferToRandom(0x1357);
+  constexpr size_t kBufferSize = 256;
+  kvs::ChecksumCrc16 checksum;
+  BlobStoreBuffer<kBufferSize> blob(
+      kBlobTitle, partition_, &checksum, kvs::TestKvs(), kBufferSize);
+  EXPECT_EQ(OkStatus(), blob.Init());
+  const uint32_t init_bytes = BlobMetric(blob, kReadBackBytesToken);
+
+  WriteInChunks(blob, source_buffer_, kBufferSize);
+  EXPECT_EQ(kBlobDataSize,
+            BlobMetric(blob, kReadBackBytesToken) - init_bytes);
+}
+
+TEST_F(BlobStoreTest, ReadBackSampled_ReadsEveryNthFlashWrite) {
+  InitSourceBufferToRandom(0x2468);
+  constexpr size_t kBufferSize = 256;
+  kvs::ChecksumCrc16 checksum;
+  BlobStoreBuffer<kBufferSize> blob(
+      kBlobTitle, partition_, &checksum, kvs::TestKvs(), kBufferSize);
+  EXPECT_EQ(OkStatus(), blob.Init());
+  blob.SetReadBackVerification(BlobStore::ReadBackVerification::kSampled, 4);
+  const uint32_t init_bytes = BlobMetric(blob, kReadBackBytesToken);
+
+  WriteInChunks(blob, source_buffer_, kBufferSize);
+  EXPECT_EQ(kBlobDataSize / 4,
+            BlobMetric(blob, kReadBackBytesToken) - init_bytes);
+  EXPECT_EQ(0u, BlobMetric(blob, kVerifyFailuresToken));
+
+  BlobStore::BlobReader reader(blob);
+  ASSERT_EQ(OkStatus(), reader.Open());
+  EXPECT_EQ(kBlobDataSize, reader.ConservativeReadLimit());
+  EXPECT_EQ(OkStatus(), reader.Close());
+}
+
+TEST_F(BlobStoreTest, ReadBackNone_NoReads) {
+  InitSourceBufferToRandom(0x1111);
+  constexpr size_t kBufferSize = 256;
+  kvs::ChecksumCrc16 checksum;
+  BlobStoreBuffer<kBufferSize> blob(
+      kBlobTitle, partition_, &checksum, kvs::TestKvs(), kBufferSize);
+  EXPECT_EQ(OkStatus(), blob.Init());
+  blob.SetReadBackVerification(BlobStore::ReadBackVerification::kNone);
+  const uint32_t init_bytes = BlobMetric(blob, kReadBackBytesToken);
+
+  WriteInChunks(blob, source_buffer_, kBufferSize);
+  EXPECT_EQ(0u, BlobMetric(blob, kReadBackBytesToken) - init_bytes);
+
+  // The checksum computed while writing is checked when the blob is loaded.
+  BlobStoreBuffer<kBufferSize> reloaded_blob(
+      kBlobTitle, partition_, &checksum, kvs::TestKvs(), kBufferSize);
+  EXPECT_EQ(OkStatus(), reloaded_blob.Init());
+  BlobStore::BlobReader reader(reloaded_blob);
+  ASSERT_EQ(OkStatus(), reader.Open());
+  EXPECT_EQ(kBlobDataSize, reader.ConservativeReadLimit());
+  EXPECT_EQ(OkStatus(), reader.Close());
+}
+
+// Flash that corrupts the first byte of every write.
+class CorruptingFlash : public kvs::FakeFlashMemoryBuffer<2048, 2> {
+ public:
+  using FakeFlashMemoryBuffer::FakeFlashMemoryBuffer;
+
+  StatusWithSize Write(Address address,
+                       std::span<const std::byte> data) override {
+    StatusWithSize result = FakeFlashMemoryBuffer::Write(address, data);
+    buffer()[address] ^= std::byte{0x01};
+    return result;
+  }
+};
+
+TEST(BlobStoreReadBack, Sampled_CorruptedWrite_DataLoss) {
+  CorruptingFlash flash;
+  kvs::FlashPartition partition(&flash);
+  ASSERT_EQ(OkStatus(), partition.Erase());
+
+  constexpr size_t kBufferSize = 256;
+  BlobStoreBuffer<kBufferSize> blob(
+      "CorruptBlob", partition, nullptr, kvs::TestKvs(), kBufferSize);
+  EXPECT_EQ(OkStatus(), blob.Init());
+  blob.SetReadBackVerification(BlobStore::ReadBackVerification::kSampled);
+
+  std::array<std::byte, kBufferSize> data = {};
+  BlobStore::BlobWriterWithBuffer writer(blob);
+  ASSERT_EQ(OkStatus(), writer.Open());
+  EXPECT_EQ(Status::DataLoss(), writer.Write(data));
+  EXPECT_EQ(1u, BlobMetric(blob, kVerifyFailuresToken));
+  EXPECT_EQ(Status::DataLoss(), writer.Close());
+}
+
 }  // namespace
 }  // namespace pw::blob_store
@@ -0,0 +1,169 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark comparing blob write throughput of the BlobWriter,
+// DeferredWriter and DoubleBufferedWriter on flash with simulated erase and
+// write latency. Data arrives in chunks at a fixed rate, as from a transfer.
+// The DoubleBufferedWriter commits from a separate flush thread, so flash
+// operations overlap with receiving data.
+//
+// Build the pw_blob_store.blob_store_write_benchmark target and run the
+// binary. Each line reports the time to write and close one blob.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+
+#include "pw_blob_store/blob_store.h"
+#include "pw_chrono/system_clock.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/test_key_value_store.h"
+
+namespace pw::blob_store {
+namespace {
+
+constexpr size_t kSectorSize = 4096;
+constexpr size_t kSectors = 32;
+constexpr size_t kFlashWriteSize = 1024;
+constexpr size_t kBufferSize = 2 * kSectorSize;
+constexpr size_t kChunkSize = 1024;
+
+constexpr auto kEraseLatencyPerSector = std::chrono::microseconds(1000);
+constexpr auto kWriteLatencyPerKiB = std::chrono::microseconds(100);
+constexpr auto kChunkInterval = std::chrono::microseconds(200);
+
+// Fake flash that sleeps for the simulated duration of each erase and write.
+class SlowFlashMemory
+    : public kvs::FakeFlashMemoryBuffer<kSectorSize, kSectors> {
+ public:
+  using FakeFlashMemoryBuffer::FakeFlashMemoryBuffer;
+
+  Status Erase(Address address, size_t num_sectors) override {
+    std::this_thread::sleep_for(kEraseLatencyPerSector * num_sectors);
+    return FakeFlashMemoryBuffer::Erase(address, num_sectors);
+  }
+
+  StatusWithSize Write(Address address,
+                       std::span<const std::byte> data) override {
+    std::this_thread::sleep_for(kWriteLatencyPerKiB * data.size() / 1024);
+    return FakeFlashMemoryBuffer::Write(address, data);
+  }
+};
+
+SlowFlashMemory flash(16);
+kvs::FlashPartition partition(&flash);
+kvs::ChecksumCrc16 checksum;
+
+std::array<std::byte, kChunkSize> chunk;
+
+// Waits for the next chunk of data to arrive.
+void ReceiveChunk() { std::this_thread::sleep_for(kChunkInterval); }
+
+Status WriteBlob(BlobStore::BlobWriter& writer) {
+  PW_TRY(writer.Open());
+  for (size_t i = 0; i < partition.size_bytes() / kChunkSize; ++i) {
+    ReceiveChunk();
+    PW_TRY(writer.Write(chunk));
+  }
+  return writer.Close();
+}
+
+Status WriteBlob(BlobStore::DeferredWriter& writer) {
+  PW_TRY(writer.Open());
+  for (size_t i = 0; i < partition.size_bytes() / kChunkSize; ++i) {
+    ReceiveChunk();
+    if (writer.ConservativeWriteLimit() < kChunkSize) {
+      PW_TRY(writer.Flush());
+    }
+    PW_TRY(writer.Write(chunk));
+  }
+  return writer.Close();
+}
+
+Status WriteBlob(BlobStore::DoubleBufferedWriter& writer) {
+  PW_TRY(writer.Open());
+
+  std::atomic<bool> done = false;
+  std::thread flush_thread([&writer, &done] {
+    while (!done.load()) {
+      if (writer.CommitPending().IsNotFound()) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  Status status;
+  for (size_t i = 0; status.ok() && i < partition.size_bytes() / kChunkSize;
+       ++i) {
+    ReceiveChunk();
+    while ((status = writer.Write(chunk)).IsResourceExhausted()) {
+      std::this_thread::yield();
+    }
+  }
+
+  done.store(true);
+  flush_thread.join();
+
+  PW_TRY(status);
+  return writer.Close();
+}
+
+template <typename Writer>
+void RunWriteBenchmark(BlobStore& blob, const char* name) {
+  Writer writer(blob);
+
+  const auto start = chrono::SystemClock::now();
+  const Status status = WriteBlob(writer);
+  const auto elapsed = chrono::SystemClock::now() - start;
+
+  if (!status.ok()) {
+    std::printf("%s failed: %s\n", name, status.str());
+    return;
+  }
+
+  const int64_t us =
+      std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  std::printf("%-22s  %6" PRId64 " us  %6" PRId64 " KiB/s\n",
+              name,
+              us,
+              int64_t(partition.size_bytes()) * 1000000 / 1024 / us);
+}
+
+int Main() {
+  BlobStoreBuffer<kBufferSize> blob(
+      "Blob", partition, &checksum, kvs::TestKvs(), kFlashWriteSize);
+  if (!blob.Init().ok()) {
+    std::printf("Init failed\n");
+    return 1;
+  }
+
+  RunWriteBenchmark<BlobStore::BlobWriterWithBuffer<>>(blob, "BlobWriter");
+  RunWriteBenchmark<BlobStore::DeferredWriterWithBuffer<>>(blob,
+                                                           "DeferredWriter");
+  RunWriteBenchmark<BlobStore::DoubleBufferedWriterWithBuffer<>>(
+      blob, "DoubleBufferedWriter");
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::blob_store
+
+int main() { return pw::blob_store::Main(); }
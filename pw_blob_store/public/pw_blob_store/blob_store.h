@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <span>
 
@@ -22,6 +23,7 @@
 #include "pw_kvs/checksum.h"
 #include "pw_kvs/flash_memory.h"
 #include "pw_kvs/key_value_store.h"
+#include "pw_metric/metric.h"
 #include "pw_status/status.h"
 #include "pw_status/status_with_size.h"
 #include "pw_status/try.h"
@@ -252,6 +254,88 @@ class BlobStore {
     std::array<std::byte, RequiredMetadataBufferSize(kMaxFileNameSize)> buffer_;
   };
 
+  // Implement the stream::Writer interface with double-buffered writes for a
+  // BlobStore. The write buffer is split into two halves. Write fills one half
+  // while the other half is committed to flash by CommitPending, which is meant
+  // to be called from a flush thread or work queue. Write never accesses flash,
+  // so the writing thread is not stalled by flash writes or erases. Instead of
+  // erasing the whole partition up front, CommitPending erases one sector at a
+  // time, ahead of the data it writes.
+  //
+  // The write buffer size must be a multiple of 2 * flash_write_size_bytes.
+  //
+  // Write and CommitPending may be called concurrently from two threads. Open,
+  // Close, Discard and Erase must not be called concurrently with
+  // CommitPending. Close commits any data still buffered.
+  //
+  // Only one writter (of any type) is allowed to be open at a time.
+  // Additionally, writters are unable to open if a reader is already open.
+  class DoubleBufferedWriter : public BlobWriter {
+   public:
+    constexpr DoubleBufferedWriter(BlobStore& store, ByteSpan metadata_buffer)
+        : BlobWriter(store, metadata_buffer) {}
+    DoubleBufferedWriter(const DoubleBufferedWriter&) = delete;
+    DoubleBufferedWriter& operator=(const DoubleBufferedWriter&) = delete;
+    virtual ~DoubleBufferedWriter() {}
+
+    // Open a blob for double-buffered writing. See BlobWriter::Open().
+    Status Open() {
+      PW_TRY(BlobWriter::Open());
+      store_.StartDoubleBuffering();
+      return OkStatus();
+    }
+
+    // True if a full half of the write buffer is waiting for CommitPending.
+    bool HasPendingCommit() const {
+      return store_.commit_pending_.load(std::memory_order_acquire);
+    }
+
+    // Commit the full half of the write buffer to flash, then erase the
+    // sectors that the next half will be committed to. Returns:
+    //
+    // OK - a half buffer was committed.
+    // NOT_FOUND - no half buffer is waiting to be committed.
+    // DATA_LOSS - Error during erase or write (this commit or a previous one).
+    //     Following Write calls fail until the blob is discarded or erased.
+    Status CommitPending() {
+      PW_DASSERT(open_);
+      return store_.CommitPendingBuffer();
+    }
+
+    // Probable (not guaranteed) minimum number of bytes at this time that can
+    // be written. This is not necessarily the full number of bytes remaining in
+    // the blob. Returns zero if, in the current state, Write would return
+    // status other than OK. See stream.h for additional details.
+    size_t ConservativeLimit(LimitType limit) const final {
+      if (limit == LimitType::kWrite) {
+        PW_DASSERT(open_);
+        // Writes need to fit in the free parts of the write buffer.
+        return store_.DoubleBufferBytesFree();
+      }
+      return 0;
+    }
+
+   private:
+    // Only buffers the data. Each time a half of the write buffer fills, it is
+    // handed off to CommitPending. Returns RESOURCE_EXHAUSTED without writing
+    // anything if the data does not fit in the buffer until CommitPending is
+    // called.
+    Status DoWrite(ConstByteSpan data) final {
+      PW_DASSERT(open_);
+      return store_.AddToDoubleBuffer(data);
+    }
+  };
+
+  template <size_t kMaxFileNameSize = 0>
+  class DoubleBufferedWriterWithBuffer final : public DoubleBufferedWriter {
+   public:
+    constexpr DoubleBufferedWriterWithBuffer(BlobStore& store)
+        : DoubleBufferedWriter(store, buffer_), buffer_() {}
+
+   private:
+    std::array<std::byte, RequiredMetadataBufferSize(kMaxFileNameSize)> buffer_;
+  };
+
   // Implement stream::Reader interface for BlobStore. Multiple readers may be
   // open at the same time, but readers may not be open with a writer open.
   class BlobReader final : public stream::SeekableReader {
@@ -403,7 +487,14 @@ class BlobStore {
         readers_open_(0),
         write_address_(0),
         flash_address_(0),
-        file_name_length_(0) {}
+        erased_address_(0),
+        file_name_length_(0),
+        half_buffer_bytes_(0),
+        handoff_address_(0),
+        commit_pending_(false),
+        read_back_verification_(ReadBackVerification::kOnClose),
+        read_back_interval_(1),
+        writes_since_read_back_(0) {}
 
   BlobStore(const BlobStore&) = delete;
   BlobStore& operator=(const BlobStore&) = delete;
@@ -417,6 +508,33 @@ class BlobStore {
   // Maximum number of data bytes this BlobStore is able to store.
   size_t MaxDataSizeBytes() const;
 
+  // How data written to flash is read back to verify it. In all cases the blob
+  // checksum is computed from the data as it is committed to flash.
+  enum class ReadBackVerification {
+    // Read back the whole blob when the writer is closed and check it against
+    // the checksum. This doubles the flash traffic of a write.
+    kOnClose,
+
+    // Read back every Nth flash write right after it is committed and compare
+    // it to the written data, which is still in RAM. Nothing is read back when
+    // the writer is closed. With a DoubleBufferedWriter, the reads are done by
+    // CommitPending, one half buffer at a time.
+    kSampled,
+
+    // Do not read back written data.
+    kNone,
+  };
+
+  // Set how written data is read back to verify it. sample_interval is the N
+  // for kSampled; 1 verifies every flash write. Must not be called while a
+  // writer is open. The default is kOnClose.
+  void SetReadBackVerification(ReadBackVerification verification,
+                               size_t sample_interval = 1);
+
+  // Metrics for reading back blob data to verify it: bytes read, time spent in
+  // microseconds, and the number of verification failures.
+  metric::Group& metrics() { return metrics_; }
+
  private:
   Status LoadMetadata();
 
@@ -499,6 +617,45 @@ class BlobStore {
   // to alignment.
   Status CommitToFlash(ConstByteSpan source, size_t data_bytes = 0);
 
+  // Switch the open writer to double-buffered writes, using each half of the
+  // write buffer in turn.
+  void StartDoubleBuffering();
+
+  // Buffer data for a DoubleBufferedWriter, handing off each half of the write
+  // buffer to CommitPendingBuffer as it fills. Returns:
+  //
+  // OK - successful enqueue of data.
+  // RESOURCE_EXHAUSTED - unable to buffer all of requested data at this time.
+  //     No data written.
+  // OUT_OF_RANGE - Writer has been exhausted, similar to EOF. No data written,
+  //     no more will be written.
+  // DATA_LOSS - Error during a previous commit. No more will be written by
+  //     following Write calls for current blob (until erase/new blob started).
+  Status AddToDoubleBuffer(ConstByteSpan data);
+
+  // Hand off the half of the write buffer being filled if it is full and the
+  // other half is not waiting to be committed.
+  void HandOffFullHalfBuffer();
+
+  // Bytes that AddToDoubleBuffer is able to accept at this time.
+  size_t DoubleBufferBytesFree() const;
+
+  // Commit the half buffer handed off by AddToDoubleBuffer, if any. Returns:
+  //
+  // OK - half buffer committed.
+  // NOT_FOUND - no half buffer waiting to be committed.
+  // DATA_LOSS - Error during erase or write (this commit or a previous one).
+  Status CommitPendingBuffer();
+
+  // Commit any pending half buffer and move the remaining buffered bytes to
+  // the start of the write buffer, so that they can be written out like those
+  // of the other writers. Called when closing a DoubleBufferedWriter.
+  Status FinishDoubleBuffering();
+
+  // Erase whole sectors, starting at erased_address_, until at least the first
+  // end_address bytes of the partition are erased.
+  Status EraseThrough(size_t end_address);
+
   // Blob is valid/OK to write to. Blob is considered valid to write if no data
   // has been written due to the auto/implicit erase on write start.
   //
@@ -560,6 +717,14 @@ class BlobStore {
 
   Status CalculateChecksumFromFlash(size_t bytes_to_check);
 
+  // Read back data written at address and compare it to expected. Returns:
+  //
+  // OK - flash matches the expected data.
+  // DATA_LOSS - flash does not match the expected data.
+  // [error status] - flash read failed.
+  Status VerifyFlashContents(kvs::FlashPartition::Address address,
+                             ConstByteSpan expected);
+
   const std::string_view MetadataKey() const { return name_; }
 
   // Copies the file name of the stored data to `dest`, and returns the number
@@ -615,8 +780,46 @@ class BlobStore {
   // bytes is write_address_ - flash_address_.
   kvs::FlashPartition::Address flash_address_;
 
+  // End of the erased part of the partition, starting from address 0. Either
+  // 0 or the partition size unless a DoubleBufferedWriter erased sectors one
+  // at a time.
+  kvs::FlashPartition::Address erased_address_;
+
   // Length of the stored blob's filename.
   size_t file_name_length_;
+
+  //
+  // State for double-buffered writes. write_address_, handoff_address_ and the
+  // half being filled belong to the writing thread. While commit_pending_ is
+  // set, flash_address_, the rest of the blob state and the other half belong
+  // to CommitPendingBuffer.
+  //
+
+  // Size of each half of the write buffer while a DoubleBufferedWriter is
+  // open, otherwise 0.
+  size_t half_buffer_bytes_;
+
+  // End of the data that has been handed off to CommitPendingBuffer.
+  kvs::FlashPartition::Address handoff_address_;
+
+  // Set when a full half of the write buffer is waiting to be committed, and
+  // cleared once it has been committed.
+  std::atomic<bool> commit_pending_;
+
+  // Result of committing the previous half buffers.
+  Status commit_status_;
+
+  ReadBackVerification read_back_verification_;
+
+  // For kSampled, the number of flash writes per read back, and the number of
+  // flash writes since the last one.
+  size_t read_back_interval_;
+  size_t writes_since_read_back_;
+
+  PW_METRIC_GROUP(metrics_, "blob_store");
+  PW_METRIC(metrics_, read_back_bytes_, "read_back_bytes", 0u);
+  PW_METRIC(metrics_, read_back_us_, "read_back_us", 0u);
+  PW_METRIC(metrics_, verify_failures_, "verify_failures", 0u);
 };
 
 // Creates a BlobStore with the buffer of kBufferSizeBytes.
@@ -72,6 +72,7 @@ function(pw_auto_add_simple_module MODULE)
   list(FILTER sources EXCLUDE REGEX "_test(\\.cc|(_c)?\\.c)$")  # *_test.cc
   list(FILTER sources EXCLUDE REGEX "^test(\\.cc|(_c)?\\.c)$")  # test.cc
   list(FILTER sources EXCLUDE REGEX "_fuzzer\\.cc$")
+  list(FILTER sources EXCLUDE REGEX "_benchmark\\.cc$")
 
   file(GLOB_RECURSE headers *.h)
 
@@ -0,0 +1,138 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark comparing the speed of the CRC32 and CRC-16-CCITT
+// implementations on buffers of several sizes. The hardware CRC32
+// implementation is included if the benchmark is compiled for a CPU with CRC
+// instructions (e.g. with -mpclmul). This target should only be built for the
+// host.
+//
+// Build the pw_checksum.checksum_benchmark target and run the binary. Each line
+// reports the cost of one implementation in cycles per byte. On x86, cycles are
+// counted with the time stamp counter, which ticks at the CPU's nominal
+// frequency. Other hosts report nanoseconds per byte instead.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif  // defined(__x86_64__) || defined(__i386__)
+
+#include "pw_checksum/config.h"
+#include "pw_checksum/internal/crc16_ccitt.h"
+#include "pw_checksum/internal/crc32.h"
+
+namespace pw::checksum {
+namespace {
+
+constexpr size_t kBytesPerRun = 64 * 1024 * 1024;
+
+#if defined(__x86_64__) || defined(__i386__)
+
+constexpr const char* kUnit = "cycles/byte";
+
+uint64_t Now() { return __rdtsc(); }
+
+double Elapsed(uint64_t start) { return double(Now() - start); }
+
+#else
+
+constexpr const char* kUnit = "ns/byte";
+
+std::chrono::steady_clock::time_point Now() {
+  return std::chrono::steady_clock::now();
+}
+
+double Elapsed(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::nano>(Now() - start).count();
+}
+
+#endif  // defined(__x86_64__) || defined(__i386__)
+
+struct Implementation {
+  const char* name;
+  uint32_t (*update)(const void* data, size_t size_bytes, uint32_t value);
+};
+
+// Adapts a CRC-16-CCITT implementation to the CRC32 function signature.
+template <uint16_t (*kUpdate)(const void*, size_t, uint16_t)>
+uint32_t Crc16(const void* data, size_t size_bytes, uint32_t value) {
+  return kUpdate(data, size_bytes, uint16_t(value));
+}
+
+constexpr Implementation kImplementations[] = {
+    {"CRC32 nibble table", internal::Crc32NibbleTable},
+    {"CRC32 byte table", internal::Crc32ByteTable},
+    {"CRC32 slicing by 4", internal::Crc32SlicingBy4},
+    {"CRC32 slicing by 8", internal::Crc32SlicingBy8},
+#if PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED
+    {"CRC32 hardware", internal::Crc32Hardware},
+#endif  // PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED
+    {"CRC16 nibble table", Crc16<internal::Crc16CcittNibbleTable>},
+    {"CRC16 byte table", Crc16<internal::Crc16CcittByteTable>},
+    {"CRC16 slicing by 4", Crc16<internal::Crc16CcittSlicingBy4>},
+};
+
+std::array<uint8_t, 16384> data;
+
+// Keeps the compiler from optimizing away unused results.
+volatile uint32_t result;
+
+double RunBenchmark(const Implementation& impl, size_t size) {
+  const size_t iterations = kBytesPerRun / size;
+  uint32_t value = 0xFFFFFFFFu;
+
+  const auto start = Now();
+  for (size_t i = 0; i < iterations; ++i) {
+    value = impl.update(data.data(), size, value);
+  }
+  const double elapsed = Elapsed(start);
+
+  result = value;
+  return elapsed / double(iterations * size);
+}
+
+int Main() {
+  uint32_t value = 1;
+  for (uint8_t& byte : data) {
+    value = value * 1103515245u + 12345u;
+    byte = uint8_t(value >> 16);
+  }
+
+  constexpr size_t kSizes[] = {16, 256, 4096, data.size()};
+
+  std::printf("%-18s", kUnit);
+  for (size_t size : kSizes) {
+    std::printf("  %7zu B", size);
+  }
+  std::printf("\n");
+
+  for (const Implementation& impl : kImplementations) {
+    std::printf("%-18s", impl.name);
+    for (size_t size : kSizes) {
+      std::printf("  %9.2f", RunBenchmark(impl, size));
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::checksum
+
+int main() { return pw::checksum::Main(); }
@@ -14,6 +14,11 @@
 
 #include "pw_checksum/crc16_ccitt.h"
 
+#include <array>
+
+#include "pw_checksum/config.h"
+#include "pw_checksum/internal/crc16_ccitt.h"
+
 namespace pw::checksum {
 namespace {
 
@@ -52,18 +57,99 @@ constexpr uint16_t kCrc16CcittTable[256]{
     0x6e17, 0x7e36, 0x4e55, 0x5e74, 0x2e93, 0x3eb2, 0x0ed1, 0x1ef0,  // 256
 };
 
+// The first 16 entries of the 256-entry table: the CRC of each nibble.
+constexpr uint16_t kCrc16CcittNibbleTable[16]{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+    0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef};
+
+// Table k gives the CRC of a byte followed by k zero bytes; table 0 is the
+// 256-entry table.
+constexpr std::array<std::array<uint16_t, 256>, 4> MakeSlicingBy4Tables() {
+  std::array<std::array<uint16_t, 256>, 4> tables{};
+  for (size_t i = 0; i < 256; ++i) {
+    tables[0][i] = kCrc16CcittTable[i];
+  }
+  for (size_t k = 1; k < tables.size(); ++k) {
+    for (size_t i = 0; i < 256; ++i) {
+      const uint16_t previous = tables[k - 1][i];
+      tables[k][i] = kCrc16CcittTable[previous >> 8] ^ uint16_t(previous << 8);
+    }
+  }
+  return tables;
+}
+
+constexpr auto kCrc16CcittSlicingBy4Tables = MakeSlicingBy4Tables();
+
+template <typename Table>
+uint16_t UpdateByteWise(const Table& table,
+                        const uint8_t* array,
+                        size_t size_bytes,
+                        uint16_t value) {
+  for (size_t i = 0; i < size_bytes; ++i) {
+    value = table[((value >> 8) ^ array[i]) & 0xffu] ^ (value << 8);
+  }
+  return value;
+}
+
 }  // namespace
 
-extern "C" uint16_t pw_checksum_Crc16Ccitt(const void* data,
-                                           size_t size_bytes,
-                                           uint16_t value) {
+namespace internal {
+
+uint16_t Crc16CcittNibbleTable(const void* data,
+                               size_t size_bytes,
+                               uint16_t value) {
   const uint8_t* const array = static_cast<const uint8_t*>(data);
 
   for (size_t i = 0; i < size_bytes; ++i) {
-    value = kCrc16CcittTable[((value >> 8) ^ array[i]) & 0xffu] ^ (value << 8);
+    value = kCrc16CcittNibbleTable[((value >> 12) ^ (array[i] >> 4)) & 0xfu] ^
+            (value << 4);
+    value = kCrc16CcittNibbleTable[((value >> 12) ^ array[i]) & 0xfu] ^
+            (value << 4);
   }
 
   return value;
 }
 
+uint16_t Crc16CcittByteTable(const void* data,
+                             size_t size_bytes,
+                             uint16_t value) {
+  return UpdateByteWise(
+      kCrc16CcittTable, static_cast<const uint8_t*>(data), size_bytes, value);
+}
+
+uint16_t Crc16CcittSlicingBy4(const void* data,
+                              size_t size_bytes,
+                              uint16_t value) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+  const auto& table = kCrc16CcittSlicingBy4Tables;
+
+  // The 16-bit CRC only overlaps the first two bytes of each group of four.
+  for (; size_bytes >= 4; size_bytes -= 4, array += 4) {
+    value = table[3][(value >> 8) ^ array[0]] ^
+            table[2][(value & 0xffu) ^ array[1]] ^ table[1][array[2]] ^
+            table[0][array[3]];
+  }
+
+  return UpdateByteWise(table[0], array, size_bytes, value);
+}
+
+}  // namespace internal
+
+extern "C" uint16_t pw_checksum_Crc16Ccitt(const void* data,
+                                           size_t size_bytes,
+                                           uint16_t value) {
+#if PW_CHECKSUM_CFG_CRC16_CCITT_IMPLEMENTATION == \
+    PW_CHECKSUM_CRC16_CCITT_NIBBLE_TABLE
+  return internal::Crc16CcittNibbleTable(data, size_bytes, value);
+#elif PW_CHECKSUM_CFG_CRC16_CCITT_IMPLEMENTATION == \
+    PW_CHECKSUM_CRC16_CCITT_BYTE_TABLE
+  return internal::Crc16CcittByteTable(data, size_bytes, value);
+#elif PW_CHECKSUM_CFG_CRC16_CCITT_IMPLEMENTATION == \
+    PW_CHECKSUM_CRC16_CCITT_SLICING_BY_4
+  return internal::Crc16CcittSlicingBy4(data, size_bytes, value);
+#else
+#error "Unknown PW_CHECKSUM_CFG_CRC16_CCITT_IMPLEMENTATION"
+#endif  // PW_CHECKSUM_CFG_CRC16_CCITT_IMPLEMENTATION
+}
+
 }  // namespace pw::checksum
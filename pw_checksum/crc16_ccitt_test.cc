@@ -14,9 +14,12 @@
 
 #include "pw_checksum/crc16_ccitt.h"
 
+#include <array>
+#include <cstdint>
 #include <string_view>
 
 #include "gtest/gtest.h"
+#include "pw_checksum/internal/crc16_ccitt.h"
 
 namespace pw::checksum {
 namespace {
@@ -79,5 +82,78 @@ TEST(Crc16FromC, String) {
   EXPECT_EQ(CallChecksumCrc16Ccitt(kString.data(), kString.size()), kStringCrc);
 }
 
+// All CRC-16-CCITT implementations, which must match bit-for-bit.
+using UpdateFunction = uint16_t (*)(const void*, size_t, uint16_t);
+
+constexpr UpdateFunction kImplementations[] = {
+    internal::Crc16CcittNibbleTable,
+    internal::Crc16CcittByteTable,
+    internal::Crc16CcittSlicingBy4,
+};
+
+// Calculates the CRC one bit at a time, as a reference.
+uint16_t BitwiseCrc16Ccitt(const uint8_t* data,
+                           size_t size_bytes,
+                           uint16_t value) {
+  for (size_t i = 0; i < size_bytes; ++i) {
+    value ^= uint16_t(data[i] << 8);
+    for (int bit = 0; bit < 8; ++bit) {
+      value = (value & 0x8000u) ? uint16_t((value << 1) ^ 0x1021u)
+                                : uint16_t(value << 1);
+    }
+  }
+  return value;
+}
+
+std::array<uint8_t, 1024> RandomData() {
+  std::array<uint8_t, 1024> data;
+  uint32_t value = 1;
+  for (uint8_t& byte : data) {
+    value = value * 1103515245u + 12345u;
+    byte = uint8_t(value >> 16);
+  }
+  return data;
+}
+
+TEST(Crc16Implementations, KnownValues) {
+  for (UpdateFunction update : kImplementations) {
+    EXPECT_EQ(update(kBytes, sizeof(kBytes), Crc16Ccitt::kInitialValue),
+              kBufferCrc);
+    EXPECT_EQ(
+        update(kString.data(), kString.size(), Crc16Ccitt::kInitialValue),
+        kStringCrc);
+  }
+}
+
+TEST(Crc16Implementations, AllSizesAndAlignments_MatchBitwise) {
+  const std::array<uint8_t, 1024> data = RandomData();
+
+  for (size_t offset = 0; offset < 4; ++offset) {
+    for (size_t size = 0; offset + size <= data.size(); ++size) {
+      const uint16_t expected =
+          BitwiseCrc16Ccitt(&data[offset], size, Crc16Ccitt::kInitialValue);
+      for (UpdateFunction update : kImplementations) {
+        ASSERT_EQ(expected,
+                  update(&data[offset], size, Crc16Ccitt::kInitialValue));
+      }
+    }
+  }
+}
+
+TEST(Crc16Implementations, SplitUpdates_MatchBitwise) {
+  const std::array<uint8_t, 1024> data = RandomData();
+  constexpr size_t kSize = 300;
+  const uint16_t expected =
+      BitwiseCrc16Ccitt(data.data(), kSize, Crc16Ccitt::kInitialValue);
+
+  for (size_t split = 0; split <= kSize; ++split) {
+    for (UpdateFunction update : kImplementations) {
+      const uint16_t first =
+          update(data.data(), split, Crc16Ccitt::kInitialValue);
+      ASSERT_EQ(expected, update(&data[split], kSize - split, first));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace pw::checksum
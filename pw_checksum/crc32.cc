@@ -14,6 +14,21 @@
 
 #include "pw_checksum/crc32.h"
 
+#include <array>
+
+#include "pw_bytes/endian.h"
+#include "pw_checksum/config.h"
+#include "pw_checksum/internal/crc32.h"
+
+#if PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED
+#if defined(__PCLMUL__)
+#include <emmintrin.h>
+#include <wmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif  // defined(__PCLMUL__)
+#endif  // PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED
+
 namespace pw::checksum {
 namespace {
 
@@ -62,18 +77,212 @@ constexpr uint32_t kCrc32Table[] = {
     0x54de5729, 0x23d967bf, 0xb3667a2e, 0xc4614ab8, 0x5d681b02, 0x2a6f2b94,
     0xb40bbe37, 0xc30c8ea1, 0x5a05df1b, 0x2d02ef8d};
 
+// The first entry of every 16 in the 256-entry table: the CRC of each nibble.
+constexpr uint32_t kCrc32NibbleTable[] = {
+    0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+    0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+    0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c};
+
+// Tables for processing several bytes per iteration. Table k gives the CRC of
+// a byte followed by k zero bytes; table 0 is the 256-entry table.
+template <size_t kTables>
+constexpr std::array<std::array<uint32_t, 256>, kTables> MakeSlicingTables() {
+  std::array<std::array<uint32_t, 256>, kTables> tables{};
+  for (size_t i = 0; i < 256; ++i) {
+    tables[0][i] = kCrc32Table[i];
+  }
+  for (size_t k = 1; k < kTables; ++k) {
+    for (size_t i = 0; i < 256; ++i) {
+      const uint32_t previous = tables[k - 1][i];
+      tables[k][i] = kCrc32Table[previous & 0xFFu] ^ (previous >> 8);
+    }
+  }
+  return tables;
+}
+
+// Separate tables, so that a build using one only links that one.
+constexpr auto kCrc32SlicingBy4Tables = MakeSlicingTables<4>();
+constexpr auto kCrc32SlicingBy8Tables = MakeSlicingTables<8>();
+
+template <typename Table>
+uint32_t UpdateByteWise(const Table& table,
+                        const uint8_t* array,
+                        size_t size_bytes,
+                        uint32_t state) {
+  for (size_t i = 0; i < size_bytes; ++i) {
+    state = table[(state ^ array[i]) & 0xFFu] ^ (state >> 8);
+  }
+  return state;
+}
+
+uint32_t ReadWord(const uint8_t* array) {
+  return bytes::ReadInOrder<uint32_t>(std::endian::little, array);
+}
+
 }  // namespace
 
-extern "C" uint32_t _pw_checksum_InternalCrc32(const void* data,
-                                               size_t size_bytes,
-                                               uint32_t state) {
+namespace internal {
+
+uint32_t Crc32NibbleTable(const void* data, size_t size_bytes, uint32_t state) {
   const uint8_t* array = static_cast<const uint8_t*>(data);
 
   for (size_t i = 0; i < size_bytes; ++i) {
-    state = kCrc32Table[(state ^ array[i]) & 0xFFu] ^ (state >> 8);
+    state ^= array[i];
+    state = kCrc32NibbleTable[state & 0xFu] ^ (state >> 4);
+    state = kCrc32NibbleTable[state & 0xFu] ^ (state >> 4);
+  }
+
+  return state;
+}
+
+uint32_t Crc32ByteTable(const void* data, size_t size_bytes, uint32_t state) {
+  return UpdateByteWise(
+      kCrc32Table, static_cast<const uint8_t*>(data), size_bytes, state);
+}
+
+uint32_t Crc32SlicingBy4(const void* data, size_t size_bytes, uint32_t state) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+  const auto& table = kCrc32SlicingBy4Tables;
+
+  for (; size_bytes >= 4; size_bytes -= 4, array += 4) {
+    state ^= ReadWord(array);
+    state = table[3][state & 0xFFu] ^ table[2][(state >> 8) & 0xFFu] ^
+            table[1][(state >> 16) & 0xFFu] ^ table[0][state >> 24];
+  }
+
+  return UpdateByteWise(table[0], array, size_bytes, state);
+}
+
+uint32_t Crc32SlicingBy8(const void* data, size_t size_bytes, uint32_t state) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+  const auto& table = kCrc32SlicingBy8Tables;
+
+  for (; size_bytes >= 8; size_bytes -= 8, array += 8) {
+    const uint32_t low = state ^ ReadWord(array);
+    const uint32_t high = ReadWord(array + 4);
+    state = table[7][low & 0xFFu] ^ table[6][(low >> 8) & 0xFFu] ^
+            table[5][(low >> 16) & 0xFFu] ^ table[4][low >> 24] ^
+            table[3][high & 0xFFu] ^ table[2][(high >> 8) & 0xFFu] ^
+            table[1][(high >> 16) & 0xFFu] ^ table[0][high >> 24];
+  }
+
+  return UpdateByteWise(table[0], array, size_bytes, state);
+}
+
+#if PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED && defined(__PCLMUL__)
+
+// Folds 16-byte blocks with carry-less multiplication, then reduces the result
+// to 32 bits with a Barrett reduction, as described in Intel's "Fast CRC
+// Computation for Generic Polynomials Using PCLMULQDQ Instruction". The
+// constants are for the bit-reflected CRC32 polynomial.
+uint32_t Crc32Hardware(const void* data, size_t size_bytes, uint32_t state) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+
+  // Folding requires at least four blocks.
+  if (size_bytes < 64) {
+    return UpdateByteWise(kCrc32Table, array, size_bytes, state);
+  }
+
+  const auto load = [](const uint8_t* block) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+  };
+
+  __m128i x1 = _mm_xor_si128(load(array), _mm_cvtsi32_si128(int(state)));
+  __m128i x2 = load(array + 16);
+  __m128i x3 = load(array + 32);
+  __m128i x4 = load(array + 48);
+  array += 64;
+  size_bytes -= 64;
+
+  // Fold four blocks at a time in parallel.
+  __m128i k = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+  for (; size_bytes >= 64; size_bytes -= 64, array += 64) {
+    const __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+    const __m128i x6 = _mm_clmulepi64_si128(x2, k, 0x00);
+    const __m128i x7 = _mm_clmulepi64_si128(x3, k, 0x00);
+    const __m128i x8 = _mm_clmulepi64_si128(x4, k, 0x00);
+
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), x5);
+    x2 = _mm_xor_si128(_mm_clmulepi64_si128(x2, k, 0x11), x6);
+    x3 = _mm_xor_si128(_mm_clmulepi64_si128(x3, k, 0x11), x7);
+    x4 = _mm_xor_si128(_mm_clmulepi64_si128(x4, k, 0x11), x8);
+
+    x1 = _mm_xor_si128(x1, load(array));
+    x2 = _mm_xor_si128(x2, load(array + 16));
+    x3 = _mm_xor_si128(x3, load(array + 32));
+    x4 = _mm_xor_si128(x4, load(array + 48));
+  }
+
+  // Fold the four blocks into one, then fold in any remaining whole blocks.
+  k = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+  const auto fold = [&k](__m128i x, __m128i next) {
+    const __m128i low = _mm_clmulepi64_si128(x, k, 0x00);
+    const __m128i high = _mm_clmulepi64_si128(x, k, 0x11);
+    return _mm_xor_si128(_mm_xor_si128(high, next), low);
+  };
+  x1 = fold(x1, x2);
+  x1 = fold(x1, x3);
+  x1 = fold(x1, x4);
+  for (; size_bytes >= 16; size_bytes -= 16, array += 16) {
+    x1 = fold(x1, load(array));
+  }
+
+  // Fold 128 bits to 64 bits.
+  const __m128i mask = _mm_setr_epi32(~0, 0, ~0, 0);
+  x2 = _mm_clmulepi64_si128(x1, k, 0x10);
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+  k = _mm_set_epi64x(0, 0x0163cd6124);
+  x2 = _mm_srli_si128(x1, 4);
+  x1 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+
+  // Barrett reduction to 32 bits.
+  k = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+  x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, mask), k, 0x10);
+  x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, mask), k, 0x00);
+  x1 = _mm_xor_si128(x1, x2);
+  state = uint32_t(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+
+  return UpdateByteWise(kCrc32Table, array, size_bytes, state);
+}
+
+#elif PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED && defined(__ARM_FEATURE_CRC32)
+
+uint32_t Crc32Hardware(const void* data, size_t size_bytes, uint32_t state) {
+  const uint8_t* array = static_cast<const uint8_t*>(data);
+
+  for (; size_bytes >= 8; size_bytes -= 8, array += 8) {
+    state = __crc32d(
+        state, bytes::ReadInOrder<uint64_t>(std::endian::little, array));
+  }
+  for (; size_bytes > 0; --size_bytes, ++array) {
+    state = __crc32b(state, *array);
   }
 
   return state;
 }
 
+#endif  // PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED
+
+}  // namespace internal
+
+extern "C" uint32_t _pw_checksum_InternalCrc32(const void* data,
+                                               size_t size_bytes,
+                                               uint32_t state) {
+#if PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION == PW_CHECKSUM_CRC32_NIBBLE_TABLE
+  return internal::Crc32NibbleTable(data, size_bytes, state);
+#elif PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION == PW_CHECKSUM_CRC32_BYTE_TABLE
+  return internal::Crc32ByteTable(data, size_bytes, state);
+#elif PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION == PW_CHECKSUM_CRC32_SLICING_BY_4
+  return internal::Crc32SlicingBy4(data, size_bytes, state);
+#elif PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION == PW_CHECKSUM_CRC32_SLICING_BY_8
+  return internal::Crc32SlicingBy8(data, size_bytes, state);
+#elif PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION == PW_CHECKSUM_CRC32_HARDWARE
+  return internal::Crc32Hardware(data, size_bytes, state);
+#else
+#error "Unknown PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION"
+#endif  // PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION
+}
+
 }  // namespace pw::checksum
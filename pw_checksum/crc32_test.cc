@@ -13,11 +13,14 @@
 // the License.
 #include "pw_checksum/crc32.h"
 
+#include <array>
+#include <cstdint>
 #include <span>
 #include <string_view>
 
 #include "gtest/gtest.h"
 #include "pw_bytes/array.h"
+#include "pw_checksum/internal/crc32.h"
 
 namespace pw::checksum {
 namespace {
@@ -105,5 +108,77 @@ TEST(Crc32AppendFromC, String) {
             kStringCrc);
 }
 
+// All CRC32 implementations available in this build, which must match
+// bit-for-bit.
+using UpdateFunction = uint32_t (*)(const void*, size_t, uint32_t);
+
+constexpr UpdateFunction kImplementations[] = {
+    internal::Crc32NibbleTable,
+    internal::Crc32ByteTable,
+    internal::Crc32SlicingBy4,
+    internal::Crc32SlicingBy8,
+#if PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED
+    internal::Crc32Hardware,
+#endif  // PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED
+};
+
+constexpr uint32_t kInitialState = _PW_CHECKSUM_CRC32_INITIAL_STATE;
+
+// Calculates the CRC32 one bit at a time, as a reference.
+uint32_t BitwiseCrc32(const uint8_t* data, size_t size_bytes, uint32_t state) {
+  for (size_t i = 0; i < size_bytes; ++i) {
+    state ^= data[i];
+    for (int bit = 0; bit < 8; ++bit) {
+      state = (state >> 1) ^ (0xEDB88320u & (0u - (state & 1u)));
+    }
+  }
+  return state;
+}
+
+std::array<uint8_t, 1024> RandomData() {
+  std::array<uint8_t, 1024> data;
+  uint32_t value = 1;
+  for (uint8_t& byte : data) {
+    value = value * 1103515245u + 12345u;
+    byte = uint8_t(value >> 16);
+  }
+  return data;
+}
+
+TEST(Crc32Implementations, KnownValues) {
+  for (UpdateFunction update : kImplementations) {
+    EXPECT_EQ(~update(kBytes.data(), kBytes.size(), kInitialState), kBufferCrc);
+    EXPECT_EQ(~update(kString.data(), kString.size(), kInitialState),
+              kStringCrc);
+  }
+}
+
+TEST(Crc32Implementations, AllSizesAndAlignments_MatchBitwise) {
+  const std::array<uint8_t, 1024> data = RandomData();
+
+  for (size_t offset = 0; offset < 8; ++offset) {
+    for (size_t size = 0; offset + size <= data.size(); ++size) {
+      const uint32_t expected =
+          BitwiseCrc32(&data[offset], size, kInitialState);
+      for (UpdateFunction update : kImplementations) {
+        ASSERT_EQ(expected, update(&data[offset], size, kInitialState));
+      }
+    }
+  }
+}
+
+TEST(Crc32Implementations, SplitUpdates_MatchBitwise) {
+  const std::array<uint8_t, 1024> data = RandomData();
+  constexpr size_t kSize = 300;
+  const uint32_t expected = BitwiseCrc32(data.data(), kSize, kInitialState);
+
+  for (size_t split = 0; split <= kSize; ++split) {
+    for (UpdateFunction update : kImplementations) {
+      const uint32_t first = update(data.data(), split, kInitialState);
+      ASSERT_EQ(expected, update(&data[split], kSize - split, first));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace pw::checksum
@@ -0,0 +1,68 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Configuration macros for the checksum module. This header is usable from C.
+#pragma once
+
+// CRC32 implementations, from smallest to fastest.
+//
+//   NIBBLE_TABLE   - 16-entry (64 B) table, two lookups per byte.
+//   BYTE_TABLE     - 256-entry (1 KiB) table, one lookup per byte.
+//   SLICING_BY_4   - 4 x 256-entry (4 KiB) tables, four bytes per iteration.
+//   SLICING_BY_8   - 8 x 256-entry (8 KiB) tables, eight bytes per iteration.
+//   HARDWARE       - CRC instructions: PCLMULQDQ folding on x86, or the
+//                    ARMv8 CRC32 instructions. The compiler must target a CPU
+//                    with them (e.g. -mpclmul or -march=armv8-a+crc). Short
+//                    inputs and tails use the 256-entry table.
+//
+#define PW_CHECKSUM_CRC32_NIBBLE_TABLE 0
+#define PW_CHECKSUM_CRC32_BYTE_TABLE 1
+#define PW_CHECKSUM_CRC32_SLICING_BY_4 2
+#define PW_CHECKSUM_CRC32_SLICING_BY_8 3
+#define PW_CHECKSUM_CRC32_HARDWARE 4
+
+// The CRC32 implementation used by pw_checksum_Crc32 and the Crc32 class.
+#ifndef PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION
+#define PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION PW_CHECKSUM_CRC32_BYTE_TABLE
+#endif  // PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION
+
+// Whether the compiler targets a CPU with instructions for the HARDWARE CRC32
+// implementation.
+#if defined(__PCLMUL__) || defined(__ARM_FEATURE_CRC32)
+#define PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED 1
+#else
+#define PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED 0
+#endif  // defined(__PCLMUL__) || defined(__ARM_FEATURE_CRC32)
+
+#if PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION == PW_CHECKSUM_CRC32_HARDWARE && \
+    !PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED
+#error "The HARDWARE CRC32 implementation requires PCLMULQDQ or ARMv8 CRC32"
+#endif
+
+// CRC-16-CCITT implementations, from smallest to fastest.
+//
+//   NIBBLE_TABLE   - 16-entry (32 B) table, two lookups per byte.
+//   BYTE_TABLE     - 256-entry (512 B) table, one lookup per byte.
+//   SLICING_BY_4   - 4 x 256-entry (2 KiB) tables, four bytes per iteration.
+//
+#define PW_CHECKSUM_CRC16_CCITT_NIBBLE_TABLE 0
+#define PW_CHECKSUM_CRC16_CCITT_BYTE_TABLE 1
+#define PW_CHECKSUM_CRC16_CCITT_SLICING_BY_4 2
+
+// The CRC-16-CCITT implementation used by pw_checksum_Crc16Ccitt and the
+// Crc16Ccitt class.
+#ifndef PW_CHECKSUM_CFG_CRC16_CCITT_IMPLEMENTATION
+#define PW_CHECKSUM_CFG_CRC16_CCITT_IMPLEMENTATION \
+  PW_CHECKSUM_CRC16_CCITT_BYTE_TABLE
+#endif  // PW_CHECKSUM_CFG_CRC16_CCITT_IMPLEMENTATION
@@ -0,0 +1,37 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// The individual CRC-16-CCITT implementations. pw_checksum_Crc16Ccitt and the
+// Crc16Ccitt class use the one selected by
+// PW_CHECKSUM_CFG_CRC16_CCITT_IMPLEMENTATION. The others are declared for tests
+// and benchmarks. Each function updates and returns the CRC value.
+namespace pw::checksum::internal {
+
+uint16_t Crc16CcittNibbleTable(const void* data,
+                               size_t size_bytes,
+                               uint16_t value);
+
+uint16_t Crc16CcittByteTable(const void* data,
+                             size_t size_bytes,
+                             uint16_t value);
+
+uint16_t Crc16CcittSlicingBy4(const void* data,
+                              size_t size_bytes,
+                              uint16_t value);
+
+}  // namespace pw::checksum::internal
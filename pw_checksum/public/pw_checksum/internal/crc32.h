@@ -0,0 +1,42 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_checksum/config.h"
+
+// The individual CRC32 implementations. pw_checksum_Crc32 and the Crc32 class
+// use the one selected by PW_CHECKSUM_CFG_CRC32_IMPLEMENTATION. The others are
+// declared for tests and benchmarks; unused implementations and their tables
+// are removed by the linker. Each function updates and returns the internal,
+// non-inverted CRC state.
+namespace pw::checksum::internal {
+
+uint32_t Crc32NibbleTable(const void* data, size_t size_bytes, uint32_t state);
+
+uint32_t Crc32ByteTable(const void* data, size_t size_bytes, uint32_t state);
+
+uint32_t Crc32SlicingBy4(const void* data, size_t size_bytes, uint32_t state);
+
+uint32_t Crc32SlicingBy8(const void* data, size_t size_bytes, uint32_t state);
+
+#if PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED
+
+uint32_t Crc32Hardware(const void* data, size_t size_bytes, uint32_t state);
+
+#endif  // PW_CHECKSUM_CRC32_HARDWARE_SUPPORTED
+
+}  // namespace pw::checksum::internal
@@ -14,6 +14,8 @@
 
 #include "pw_hdlc/decoder.h"
 
+#include <cstring>
+
 #include "pw_assert/check.h"
 #include "pw_bytes/endian.h"
 #include "pw_hdlc/internal/protocol.h"
@@ -23,6 +25,40 @@
 using std::byte;
 
 namespace pw::hdlc {
+namespace {
+
+// Returns the index of the first flag or escape byte in the data, or the size
+// of the data if there are none. Eight bytes are checked at a time.
+size_t FindFlagOrEscape(ConstByteSpan data) {
+  constexpr uint64_t kLowBits = 0x0101010101010101;
+  constexpr uint64_t kHighBits = 0x8080808080808080;
+  constexpr uint64_t kFlags = kLowBits * std::to_integer<uint64_t>(kFlag);
+  constexpr uint64_t kEscapes = kLowBits * std::to_integer<uint64_t>(kEscape);
+
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= data.size(); i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, &data[i], sizeof(word));
+
+    // A byte equal to the flag or escape is zero after the XOR. The classic
+    // "has zero byte" test detects if any byte in the word is zero.
+    const uint64_t flags = word ^ kFlags;
+    const uint64_t escapes = word ^ kEscapes;
+    if ((((flags - kLowBits) & ~flags) | ((escapes - kLowBits) & ~escapes)) &
+        kHighBits) {
+      break;  // Find the matching byte below.
+    }
+  }
+
+  for (; i < data.size(); ++i) {
+    if (NeedsEscaping(data[i])) {
+      break;
+    }
+  }
+  return i;
+}
+
+}  // namespace
 
 Result<Frame> Frame::Parse(ConstByteSpan frame) {
   uint64_t address;
@@ -117,6 +153,46 @@ void Decoder::AppendByte(byte new_byte) {
   current_frame_size_ += 1;
 }
 
+size_t Decoder::AppendUnescapedData(ConstByteSpan data) {
+  if (state_ != State::kFrame) {
+    return 0;
+  }
+
+  const ConstByteSpan run = data.first(FindFlagOrEscape(data));
+
+  // Short runs are not worth the bookkeeping below.
+  if (run.size() < last_read_bytes_.size()) {
+    for (byte b : run) {
+      AppendByte(b);
+    }
+    return run.size();
+  }
+
+  if (current_frame_size_ < max_size()) {
+    std::memcpy(&buffer_[current_frame_size_],
+                run.data(),
+                std::min(run.size(), max_size() - current_frame_size_));
+  }
+
+  // The run fills the ring buffer, so every byte in it is evicted to the
+  // running checksum, oldest first.
+  const size_t held = std::min(current_frame_size_, last_read_bytes_.size());
+  size_t index = held == last_read_bytes_.size() ? last_read_bytes_index_ : 0;
+  for (size_t i = 0; i < held; ++i) {
+    fcs_.Update(last_read_bytes_[index]);
+    index = (index + 1) % last_read_bytes_.size();
+  }
+
+  fcs_.Update(run.first(run.size() - last_read_bytes_.size()));
+
+  const ConstByteSpan last_bytes = run.last(last_read_bytes_.size());
+  std::copy(last_bytes.begin(), last_bytes.end(), last_read_bytes_.begin());
+  last_read_bytes_index_ = 0;
+
+  current_frame_size_ += run.size();
+  return run.size();
+}
+
 Status Decoder::CheckFrame() const {
   // Empty frames are not an error; repeated flag characters are okay.
   if (current_frame_size_ == 0u) {
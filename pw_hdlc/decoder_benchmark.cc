@@ -0,0 +1,168 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark comparing HDLC decoding throughput of the per-byte
+// Decoder::Process and the span Decoder::Process, which appends runs of
+// unescaped data in bulk. Streams of frames are decoded with payloads that
+// never need escaping, uniformly random payloads, and payloads where every
+// fourth byte needs escaping. This target should only be built for the host.
+//
+// Build the pw_hdlc.decoder_benchmark target and run the binary. Each line
+// reports the decoding throughput in MB/s of encoded data.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_hdlc/decoder.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_hdlc/internal/protocol.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::hdlc {
+namespace {
+
+constexpr size_t kEncodedSize = 256 * 1024;
+constexpr size_t kIterations = 50;
+constexpr uint64_t kAddress = 1;
+
+enum class Payload { kNoEscapes, kRandom, kEscapeHeavy };
+
+const char* PayloadName(Payload payload) {
+  switch (payload) {
+    case Payload::kNoEscapes:
+      return "no escapes";
+    case Payload::kRandom:
+      return "random";
+    case Payload::kEscapeHeavy:
+      return "escape heavy";
+  }
+  return "";
+}
+
+std::array<std::byte, kEncodedSize> encoded;
+DecoderBuffer<1024> decoder;
+
+// Fills the encoded buffer with as many frames as fit. Returns the encoded
+// data and the number of frames.
+ConstByteSpan EncodeFrames(Payload payload,
+                           size_t payload_size,
+                           size_t& frame_count) {
+  std::minstd_rand rng(payload_size);
+  std::array<std::byte, 1024> data;
+  stream::MemoryWriter writer(encoded);
+  frame_count = 0;
+
+  while (true) {
+    for (size_t i = 0; i < payload_size; ++i) {
+      std::byte b = std::byte(rng());
+      if (payload == Payload::kNoEscapes && NeedsEscaping(b)) {
+        b = std::byte{0};
+      } else if (payload == Payload::kEscapeHeavy && i % 4 == 0) {
+        b = kFlag;
+      }
+      data[i] = b;
+    }
+
+    // Encoded frames are at most twice the payload plus framing bytes.
+    if (writer.ConservativeWriteLimit() < 2 * payload_size + 32) {
+      return writer.WrittenData();
+    }
+    if (!WriteUIFrame(kAddress, std::span(data).first(payload_size), writer)
+             .ok()) {
+      return writer.WrittenData();
+    }
+    frame_count += 1;
+  }
+}
+
+size_t DecodeBytewise(ConstByteSpan data) {
+  size_t frames = 0;
+  for (std::byte b : data) {
+    if (decoder.Process(b).ok()) {
+      frames += 1;
+    }
+  }
+  return frames;
+}
+
+size_t DecodeSpan(ConstByteSpan data) {
+  size_t frames = 0;
+  decoder.Process(data, [&frames](const Result<Frame>& result) {
+    if (result.ok()) {
+      frames += 1;
+    }
+  });
+  return frames;
+}
+
+// Returns the throughput in MB/s, or 0 if a frame failed to decode.
+double RunDecodeBenchmark(size_t (*decode)(ConstByteSpan),
+                          ConstByteSpan data,
+                          size_t frame_count) {
+  decoder.Clear();
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kIterations; ++i) {
+    if (decode(data) != frame_count) {
+      return 0;
+    }
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return double(data.size() * kIterations) / 1e6 / elapsed.count();
+}
+
+int Main() {
+  std::printf("%-12s  %7s  %12s  %12s\n",
+              "payload",
+              "size",
+              "bytewise",
+              "span");
+
+  for (Payload payload :
+       {Payload::kNoEscapes, Payload::kRandom, Payload::kEscapeHeavy}) {
+    for (size_t payload_size : {16u, 64u, 256u, 1000u}) {
+      size_t frame_count;
+      const ConstByteSpan data =
+          EncodeFrames(payload, payload_size, frame_count);
+
+      const double bytewise =
+          RunDecodeBenchmark(DecodeBytewise, data, frame_count);
+      const double span = RunDecodeBenchmark(DecodeSpan, data, frame_count);
+      if (bytewise == 0 || span == 0) {
+        std::printf("%s %zu B frames failed to decode\n",
+                    PayloadName(payload),
+                    payload_size);
+        return 1;
+      }
+
+      std::printf("%-12s  %5zu B  %7.1f MB/s  %7.1f MB/s\n",
+                  PayloadName(payload),
+                  payload_size,
+                  bytewise,
+                  span);
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::hdlc
+
+int main() { return pw::hdlc::Main(); }
@@ -14,12 +14,16 @@
 
 #include "pw_hdlc/decoder.h"
 
+#include <algorithm>
 #include <array>
 #include <cstddef>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "pw_bytes/array.h"
+#include "pw_hdlc/encoder.h"
 #include "pw_hdlc/internal/protocol.h"
+#include "pw_stream/memory_stream.h"
 
 namespace pw::hdlc {
 namespace {
@@ -152,5 +156,123 @@ TEST(Decoder, TooLargeForBuffer_DecodesNextFrame) {
   EXPECT_EQ(OkStatus(), decoder.Process(kFlag).status());
 }
 
+// Status and data of a decoded frame, for comparing decoding methods.
+struct DecodedFrame {
+  Status status;
+  std::vector<byte> data;
+
+  bool operator==(const DecodedFrame& other) const {
+    return status == other.status && data == other.data;
+  }
+};
+
+void AddDecodedFrame(std::vector<DecodedFrame>& frames,
+                     const Result<Frame>& result) {
+  DecodedFrame& frame = frames.emplace_back();
+  frame.status = result.status();
+  if (result.ok()) {
+    frame.data.assign(result.value().data().begin(),
+                      result.value().data().end());
+  }
+}
+
+class DecoderSpan : public ::testing::Test {
+ protected:
+  DecoderSpan() : writer_(encoded_) {}
+
+  void AddFrame(ConstByteSpan data) {
+    ASSERT_EQ(OkStatus(), WriteUIFrame(123, data, writer_));
+  }
+
+  void AddBytes(ConstByteSpan data) {
+    ASSERT_EQ(OkStatus(), writer_.Write(data));
+  }
+
+  ConstByteSpan encoded() const { return writer_.WrittenData(); }
+
+  // Decodes the encoded data one byte at a time.
+  std::vector<DecodedFrame> DecodeBytewise(size_t buffer_size) {
+    std::vector<DecodedFrame> frames;
+    Decoder decoder(ByteSpan(buffer_).first(buffer_size));
+    for (byte b : encoded()) {
+      Result<Frame> result = decoder.Process(b);
+      if (result.status() != Status::Unavailable()) {
+        AddDecodedFrame(frames, result);
+      }
+    }
+    return frames;
+  }
+
+  // Decodes the encoded data with the span overload, in chunks.
+  std::vector<DecodedFrame> DecodeSpans(size_t buffer_size, size_t chunk) {
+    std::vector<DecodedFrame> frames;
+    Decoder decoder(ByteSpan(buffer_).first(buffer_size));
+    for (ConstByteSpan data = encoded(); !data.empty();) {
+      const size_t size = std::min(chunk, data.size());
+      decoder.Process(data.first(size), AddDecodedFrame, frames);
+      data = data.subspan(size);
+    }
+    return frames;
+  }
+
+  void ExpectSpansMatchBytewise(size_t buffer_size) {
+    const std::vector<DecodedFrame> expected = DecodeBytewise(buffer_size);
+    for (size_t chunk : {1u, 2u, 3u, 7u, 8u, 13u, 64u, 4096u}) {
+      EXPECT_TRUE(expected == DecodeSpans(buffer_size, chunk));
+    }
+  }
+
+  std::array<byte, 512> encoded_ = {};
+  stream::MemoryWriter writer_;
+  std::array<byte, 256> buffer_;
+};
+
+TEST_F(DecoderSpan, MatchesBytewise_NoEscapes) {
+  AddFrame(bytes::String("Hello, world! This frame has no escaped bytes."));
+  AddFrame(bytes::String("1"));
+  AddFrame(bytes::String(""));
+  ExpectSpansMatchBytewise(buffer_.size());
+}
+
+TEST_F(DecoderSpan, MatchesBytewise_Escapes) {
+  AddFrame(bytes::String("~~~}}}~}~}"));
+  AddFrame(bytes::String("abcdefgh~ijklmnopqrstuvwxyz}0123456789~"));
+  AddFrame(bytes::String("~abcdefghijklmnopqrstuvwxyz}"));
+  ExpectSpansMatchBytewise(buffer_.size());
+}
+
+TEST_F(DecoderSpan, MatchesBytewise_Errors) {
+  AddFrame(bytes::String("Valid frame"));
+  AddBytes(bytes::String("~Frame with a bad FCS~"));
+  AddBytes(bytes::String("Junk between frames"));
+  AddBytes(bytes::String("~Frame with a double escape}}~"));
+  AddBytes(bytes::String("~Frame with an escaped flag}~"));
+  AddFrame(bytes::String("Another valid frame"));
+  ExpectSpansMatchBytewise(buffer_.size());
+}
+
+TEST_F(DecoderSpan, MatchesBytewise_TooLargeForBuffer) {
+  AddFrame(bytes::String("This frame is too large for a 16-byte buffer"));
+  AddFrame(bytes::String("Small frame"));
+  AddFrame(bytes::String("This ~ frame } is } also ~ too large"));
+  ExpectSpansMatchBytewise(16);
+}
+
+TEST(Decoder, Span_TooLargeForBuffer_StaysWithinBufferBoundaries) {
+  std::array<byte, 16> buffer = bytes::Initialized<16>('?');
+
+  Decoder decoder(std::span(buffer.data(), 8));
+
+  decoder.Process(
+      bytes::String("~12345678901234567890\xf2\x19\x63\x90"),
+      [](const Result<Frame>&) { FAIL(); });
+
+  for (size_t i = 8; i < buffer.size(); ++i) {
+    ASSERT_EQ(byte{'?'}, buffer[i]);
+  }
+
+  EXPECT_EQ(Status::ResourceExhausted(), decoder.Process(kFlag).status());
+}
+
 }  // namespace
 }  // namespace pw::hdlc
@@ -28,61 +28,82 @@ using std::byte;
 
 namespace pw::hdlc {
 namespace internal {
-
-Status EscapeAndWrite(const byte b, stream::Writer& writer) {
-  if (b == kFlag) {
-    return writer.Write(kEscapedFlag);
-  }
-  if (b == kEscape) {
-    return writer.Write(kEscapedEscape);
+namespace {
+
+// Escapes data into the output buffer, which must be able to hold twice the
+// size of the data. Returns the number of bytes written.
+size_t EscapeInto(ConstByteSpan data, ByteSpan output) {
+  size_t size = 0;
+  for (byte b : data) {
+    if (NeedsEscaping(b)) {
+      output[size++] = kEscape;
+      output[size++] = Escape(b);
+    } else {
+      output[size++] = b;
+    }
   }
-  return writer.Write(b);
+  return size;
 }
 
-Status Encoder::WriteData(ConstByteSpan data) {
-  auto begin = data.begin();
-  while (true) {
-    auto end = std::find_if(begin, data.end(), NeedsEscaping);
+}  // namespace
 
-    if (Status status = writer_.Write(std::span(begin, end)); !status.ok()) {
-      return status;
+Status Encoder::WriteData(ConstByteSpan data) {
+  fcs_.Update(data);
+
+  while (!data.empty()) {
+    const size_t run_size =
+        std::find_if(data.begin(), data.end(), NeedsEscaping) - data.begin();
+    if (run_size != 0u) {
+      if (Status status = writer_.Write(data.first(run_size)); !status.ok()) {
+        return status;
+      }
+      data = data.subspan(run_size);
     }
-    if (end == data.end()) {
-      fcs_.Update(data);
-      return OkStatus();
+
+    // Escape consecutive bytes that need escaping into a small buffer.
+    std::array<byte, 16> escaped;
+    size_t escaped_size = 0;
+    while (!data.empty() && NeedsEscaping(data.front()) &&
+           escaped_size < escaped.size()) {
+      escaped[escaped_size++] = kEscape;
+      escaped[escaped_size++] = Escape(data.front());
+      data = data.subspan(1);
     }
-    if (Status status = EscapeAndWrite(*end, writer_); !status.ok()) {
-      return status;
+    if (escaped_size != 0u) {
+      if (Status status =
+              writer_.Write(std::span(escaped).first(escaped_size));
+          !status.ok()) {
+        return status;
+      }
     }
-    begin = end + 1;
   }
+  return OkStatus();
 }
 
 Status Encoder::FinishFrame() {
-  if (Status status =
-          WriteData(bytes::CopyInOrder(std::endian::little, fcs_.value()));
-      !status.ok()) {
-    return status;
-  }
-  return writer_.Write(kFlag);
+  // Write the escaped frame check sequence and the terminating flag at once.
+  std::array<byte, 2 * sizeof(uint32_t) + sizeof(kFlag)> footer;
+  size_t footer_size =
+      EscapeInto(bytes::CopyInOrder(std::endian::little, fcs_.value()), footer);
+  footer[footer_size++] = kFlag;
+  return writer_.Write(std::span(footer).first(footer_size));
 }
 
 size_t Encoder::MaxEncodedSize(uint64_t address, ConstByteSpan payload) {
   constexpr size_t kFcsMaxSize = 8;  // Worst case FCS: 0x7e7e7e7e.
   size_t max_encoded_address_size = varint::EncodedSize(address) * 2;
-  size_t encoded_payload_size =
-      payload.size() +
-      std::count_if(payload.begin(), payload.end(), NeedsEscaping);
+  size_t encoded_payload_size = EscapedSize(payload);
 
   return max_encoded_address_size + sizeof(kUnusedControl) +
          encoded_payload_size + kFcsMaxSize;
 }
 
+size_t Encoder::EscapedSize(ConstByteSpan data) {
+  return data.size() + std::count_if(data.begin(), data.end(), NeedsEscaping);
+}
+
 Status Encoder::StartFrame(uint64_t address, std::byte control) {
   fcs_.clear();
-  if (Status status = writer_.Write(kFlag); !status.ok()) {
-    return status;
-  }
 
   std::array<std::byte, 16> metadata_buffer;
   size_t metadata_size =
@@ -92,7 +113,16 @@ Status Encoder::StartFrame(uint64_t address, std::byte control) {
   }
 
   metadata_buffer[metadata_size++] = control;
-  return WriteData(std::span(metadata_buffer).first(metadata_size));
+  const ConstByteSpan metadata =
+      std::span(metadata_buffer).first(metadata_size);
+  fcs_.Update(metadata);
+
+  // Write the opening flag and the escaped address and control at once.
+  std::array<std::byte, sizeof(kFlag) + 2 * metadata_buffer.size()> header;
+  header[0] = kFlag;
+  const size_t header_size =
+      sizeof(kFlag) + EscapeInto(metadata, std::span(header).subspan(1));
+  return writer_.Write(std::span(header).first(header_size));
 }
 
 }  // namespace internal
@@ -100,8 +130,18 @@ Status Encoder::StartFrame(uint64_t address, std::byte control) {
 Status WriteUIFrame(uint64_t address,
                     ConstByteSpan payload,
                     stream::Writer& writer) {
-  if (internal::Encoder::MaxEncodedSize(address, payload) >
-      writer.ConservativeWriteLimit()) {
+  return WriteUIFrame(address, std::span(&payload, 1), writer);
+}
+
+Status WriteUIFrame(uint64_t address,
+                    std::span<const ConstByteSpan> payload,
+                    stream::Writer& writer) {
+  size_t max_encoded_size =
+      internal::Encoder::MaxEncodedSize(address, ConstByteSpan());
+  for (ConstByteSpan fragment : payload) {
+    max_encoded_size += internal::Encoder::EscapedSize(fragment);
+  }
+  if (max_encoded_size > writer.ConservativeWriteLimit()) {
     return Status::ResourceExhausted();
   }
 
@@ -110,8 +150,10 @@ Status WriteUIFrame(uint64_t address,
   if (Status status = encoder.StartUnnumberedFrame(address); !status.ok()) {
     return status;
   }
-  if (Status status = encoder.WriteData(payload); !status.ok()) {
-    return status;
+  for (ConstByteSpan fragment : payload) {
+    if (Status status = encoder.WriteData(fragment); !status.ok()) {
+      return status;
+    }
   }
   return encoder.FinishFrame();
 }
@@ -0,0 +1,147 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark for HDLC frame encoding. Each frame has a payload made of an
+// 8-byte header and data stored elsewhere. The payload is encoded by copying
+// both into a contiguous buffer and calling WriteUIFrame, and by passing both
+// fragments to WriteUIFrame directly. Payloads that never need escaping and
+// uniformly random payloads are encoded. This target should only be built for
+// the host.
+//
+// Build the pw_hdlc.encoder_benchmark target and run the binary. Each line
+// reports the encoding throughput in MB/s of payload data and the number of
+// Write calls made to the writer per frame.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <span>
+
+#include "pw_bytes/span.h"
+#include "pw_hdlc/encoder.h"
+#include "pw_hdlc/internal/protocol.h"
+#include "pw_status/status.h"
+#include "pw_stream/stream.h"
+
+namespace pw::hdlc {
+namespace {
+
+constexpr size_t kHeaderSize = 8;
+constexpr size_t kMaxDataSize = 1024;
+constexpr size_t kFramesPerRun = 20000;
+constexpr uint64_t kAddress = 1;
+
+// Writer that copies data into a buffer, as a UART driver's transmit buffer
+// would, and counts the Write calls made to it.
+class SinkWriter : public stream::NonSeekableWriter {
+ public:
+  void Reset() { size_ = 0; }
+
+  size_t writes() const { return writes_; }
+
+ private:
+  Status DoWrite(ConstByteSpan data) override {
+    if (data.size() > buffer_.size() - size_) {
+      return Status::ResourceExhausted();
+    }
+    std::memcpy(&buffer_[size_], data.data(), data.size());
+    size_ += data.size();
+    writes_ += 1;
+    return OkStatus();
+  }
+
+  std::array<std::byte, 4 * kMaxDataSize> buffer_;
+  size_t size_ = 0;
+  size_t writes_ = 0;
+};
+
+std::array<std::byte, kHeaderSize> header;
+std::array<std::byte, kMaxDataSize> data;
+std::array<std::byte, kHeaderSize + kMaxDataSize> contiguous;
+
+Status EncodeCopied(ConstByteSpan frame_data, SinkWriter& writer) {
+  std::memcpy(contiguous.data(), header.data(), header.size());
+  std::memcpy(&contiguous[header.size()], frame_data.data(), frame_data.size());
+  return WriteUIFrame(
+      kAddress,
+      std::span(contiguous).first(header.size() + frame_data.size()),
+      writer);
+}
+
+Status EncodeFragments(ConstByteSpan frame_data, SinkWriter& writer) {
+  const std::array<ConstByteSpan, 2> fragments = {header, frame_data};
+  return WriteUIFrame(kAddress, fragments, writer);
+}
+
+void RunEncodeBenchmark(const char* payload,
+                        const char* name,
+                        Status (*encode)(ConstByteSpan, SinkWriter&),
+                        ConstByteSpan frame_data) {
+  SinkWriter writer;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kFramesPerRun; ++i) {
+    writer.Reset();
+    if (!encode(frame_data, writer).ok()) {
+      std::printf("%s failed\n", name);
+      return;
+    }
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  std::printf("%-10s  %-9s  %5zu B  %7.1f MB/s  %4.1f writes/frame\n",
+              payload,
+              name,
+              frame_data.size(),
+              double((kHeaderSize + frame_data.size()) * kFramesPerRun) /
+                  1e6 / elapsed.count(),
+              double(writer.writes()) / kFramesPerRun);
+}
+
+int Main() {
+  std::minstd_rand rng(1);
+  for (std::byte& b : header) {
+    b = std::byte(rng());
+    if (NeedsEscaping(b)) {
+      b = std::byte{0};
+    }
+  }
+
+  for (bool escapes : {false, true}) {
+    for (std::byte& b : data) {
+      b = std::byte(rng());
+      if (!escapes && NeedsEscaping(b)) {
+        b = std::byte{0};
+      }
+    }
+
+    for (size_t data_size : {16u, 256u, 1024u}) {
+      const ConstByteSpan frame_data = std::span(data).first(data_size);
+      const char* payload = escapes ? "random" : "no escapes";
+      RunEncodeBenchmark(payload, "copied", EncodeCopied, frame_data);
+      RunEncodeBenchmark(payload, "fragments", EncodeFragments, frame_data);
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::hdlc
+
+int main() { return pw::hdlc::Main(); }
@@ -181,6 +181,66 @@ TEST_F(WriteUnnumberedFrame, PayloadTooLarge_WritesNothing) {
   EXPECT_EQ(0u, writer_.bytes_written());
 }
 
+TEST_F(WriteUnnumberedFrame, FragmentedPayload) {
+  constexpr auto kHeader = bytes::Array<0x7E, 0x7B, 0x61>();
+  constexpr auto kData = bytes::Array<0x62, 0x63, 0x7D, 0x7E>();
+  const std::array<ConstByteSpan, 4> fragments = {
+      kHeader,
+      ConstByteSpan(),
+      ConstByteSpan(kData).first(3),
+      ConstByteSpan(kData).subspan(3)};
+
+  ASSERT_EQ(OkStatus(), WriteUIFrame(kAddress, fragments, writer_));
+  EXPECT_ENCODER_WROTE(bytes::Concat(
+      kFlag,
+      kEncodedAddress,
+      kUnnumberedControl,
+      bytes::
+          Array<0x7D, 0x5E, 0x7B, 0x61, 0x62, 0x63, 0x7D, 0x5D, 0x7D, 0x5E>(),
+      uint32_t{0x1563a4e6},
+      kFlag));
+}
+
+TEST_F(WriteUnnumberedFrame, FragmentedPayloadTooLarge_WritesNothing) {
+  constexpr auto data = bytes::Initialized<sizeof(buffer_) / 2>(0x7e);
+  const std::array<ConstByteSpan, 2> fragments = {data, data};
+  EXPECT_EQ(Status::ResourceExhausted(),
+            WriteUIFrame(kAddress, fragments, writer_));
+  EXPECT_EQ(0u, writer_.bytes_written());
+}
+
+// Counts the Write calls made to it.
+class CountingWriter : public stream::NonSeekableWriter {
+ public:
+  size_t writes() const { return writes_; }
+
+ private:
+  Status DoWrite(ConstByteSpan) override {
+    writes_ += 1;
+    return OkStatus();
+  }
+
+  size_t writes_ = 0;
+};
+
+TEST(WriteUnnumberedFrame, NoEscapes_WritesHeaderPayloadAndFooter) {
+  CountingWriter writer;
+  ASSERT_EQ(
+      OkStatus(),
+      WriteUIFrame(kAddress, bytes::String("1995 toyota corolla"), writer));
+  EXPECT_EQ(3u, writer.writes());
+}
+
+TEST(WriteUnnumberedFrame, ConsecutiveEscapes_WrittenTogether) {
+  CountingWriter writer;
+  ASSERT_EQ(OkStatus(),
+            WriteUIFrame(kAddress,
+                         bytes::Array<0x61, 0x7E, 0x7D, 0x7E, 0x62>(),
+                         writer));
+  // Header, "a", three escaped bytes, "b", and footer.
+  EXPECT_EQ(5u, writer.writes());
+}
+
 class ErrorWriter : public stream::NonSeekableWriter {
  private:
   Status DoWrite(ConstByteSpan) override { return Status::Unimplemented(); }
@@ -97,10 +97,20 @@ class Decoder {
 
   // Processes a span of data and calls the provided callback with each frame or
   // error.
+  //
+  // Runs of frame data without flag or escape bytes are found a word at a time
+  // and appended in bulk. Only flag and escape bytes, and the bytes between
+  // frames, go through the per-byte state machine.
   template <typename F, typename... Args>
   void Process(ConstByteSpan data, F&& callback, Args&&... args) {
-    for (std::byte b : data) {
-      auto result = Process(b);
+    while (!data.empty()) {
+      data = data.subspan(AppendUnescapedData(data));
+      if (data.empty()) {
+        return;
+      }
+
+      auto result = Process(data.front());
+      data = data.subspan(1);
       if (result.status() != Status::Unavailable()) {
         std::invoke(
             std::forward<F>(callback), std::forward<Args>(args)..., result);
@@ -133,6 +143,10 @@ class Decoder {
 
   void AppendByte(std::byte new_byte);
 
+  // If in the middle of a frame, appends the data up to the first flag or
+  // escape byte to the frame. Returns the number of bytes appended.
+  size_t AppendUnescapedData(ConstByteSpan data);
+
   Status CheckFrame() const;
 
   bool VerifyFrameCheckSequence() const;
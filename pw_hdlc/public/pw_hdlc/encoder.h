@@ -13,6 +13,8 @@
 // the License.
 #pragma once
 
+#include <span>
+
 #include "pw_bytes/span.h"
 #include "pw_status/status.h"
 #include "pw_stream/stream.h"
@@ -33,4 +35,12 @@ Status WriteUIFrame(uint64_t address,
                     ConstByteSpan payload,
                     stream::Writer& writer);
 
+// Writes an HDLC UI-frame with a payload made up of several fragments, such as
+// a header followed by data stored elsewhere. The fragments are encoded in
+// order directly from where they are stored, so the payload does not have to be
+// copied into a contiguous buffer first.
+Status WriteUIFrame(uint64_t address,
+                    std::span<const ConstByteSpan> payload,
+                    stream::Writer& writer);
+
 }  // namespace pw::hdlc
@@ -38,6 +38,9 @@ class Encoder {
 
   // Writes data for an ongoing frame. Must only be called after a successful
   // StartInformationFrame call, and prior to a FinishFrame() call.
+  //
+  // Runs of bytes that do not need escaping are written with a single Write
+  // call, as are runs of bytes that do.
   Status WriteData(ConstByteSpan data);
 
   // Finishes a frame. Writes the frame check sequence and a terminating flag.
@@ -47,6 +50,9 @@ class Encoder {
   // frame containing it. Does not calculate CRC to improve efficiency.
   static size_t MaxEncodedSize(uint64_t address, ConstByteSpan payload);
 
+  // Returns the size of the data once escaped.
+  static size_t EscapedSize(ConstByteSpan data);
+
  private:
   // Indicates this an information packet with sequence numbers set to 0.
   static constexpr std::byte kUnusedControl = std::byte{0};
@@ -41,12 +41,24 @@ Status Entry::Read(FlashPartition& partition,
                    Entry* entry) {
   EntryHeader header;
   PW_TRY(partition.Read(address, sizeof(header), &header));
+  return FromHeader(partition, address, formats, header, entry);
+}
 
+Status Entry::FromHeader(FlashPartition& partition,
+                         Address address,
+                         const internal::EntryFormats& formats,
+                         const EntryHeader& header,
+                         Entry* entry) {
   if (partition.AppearsErased(std::as_bytes(std::span(&header.magic, 1)))) {
     return Status::NotFound();
   }
-  if (header.key_length_bytes > kMaxKeyLength) {
-    return Status::DataLoss();
+  switch (static_cast<BatchRole>(header.key_length_bytes >> kBatchRoleShift)) {
+    case BatchRole::kNone:
+    case BatchRole::kMember:
+    case BatchRole::kCommit:
+      break;
+    default:
+      return Status::DataLoss();
   }
 
   const EntryFormat* format = formats.Find(header.magic);
@@ -79,7 +91,8 @@ Entry::Entry(FlashPartition& partition,
              Key key,
              std::span<const byte> value,
              uint16_t value_size_bytes,
-             uint32_t transaction_id)
+             uint32_t transaction_id,
+             BatchRole batch_role)
     : Entry(&partition,
             address,
             format,
@@ -87,7 +100,8 @@ Entry::Entry(FlashPartition& partition,
              .checksum = 0,
              .alignment_units =
                  alignment_bytes_to_units(partition.alignment_bytes()),
-             .key_length_bytes = static_cast<uint8_t>(key.size()),
+             .key_length_bytes = static_cast<uint8_t>(
+                 key.size() | (unsigned(batch_role) << kBatchRoleShift)),
              .value_size_bytes = value_size_bytes,
              .transaction_id = transaction_id}) {
   if (checksum_algo_ != nullptr) {
@@ -114,6 +128,7 @@ Status Entry::Update(const EntryFormat& new_format,
   header_.alignment_units =
       alignment_bytes_to_units(partition_->alignment_bytes());
   header_.transaction_id = new_transaction_id;
+  header_.key_length_bytes = static_cast<uint8_t>(key_length());
 
   // If we could write the header last, we could avoid reading the entry twice
   // when moving an entry. However, to support alignments greater than the
@@ -150,9 +165,8 @@ StatusWithSize Entry::ReadValue(std::span<byte> buffer,
   const size_t remaining_bytes = value_size() - offset_bytes;
   const size_t read_size = std::min(buffer.size(), remaining_bytes);
 
-  StatusWithSize result = partition().Read(
-      address_ + sizeof(EntryHeader) + key_length() + offset_bytes,
-      buffer.subspan(0, read_size));
+  StatusWithSize result = partition().Read(value_address() + offset_bytes,
+                                           buffer.subspan(0, read_size));
   PW_TRY_WITH_SIZE(result);
 
   if (read_size != remaining_bytes) {
@@ -166,7 +180,7 @@ Status Entry::ValueMatches(std::span<const std::byte> value) const {
     return Status::NotFound();
   }
 
-  Address address = address_ + sizeof(EntryHeader) + key_length();
+  Address address = value_address();
   Address end = address + value_size();
   const std::byte* value_ptr = value.data();
 
@@ -245,6 +259,36 @@ Status Entry::VerifyChecksumInFlash() const {
   return checksum_algo_->Verify(checksum_bytes());
 }
 
+Status Entry::VerifyChecksumInBuffer(std::span<const byte> contents) const {
+  if (contents.size() < size()) {
+    return Status::DataLoss();
+  }
+
+  EntryHeader header_to_verify;
+  std::memcpy(&header_to_verify, contents.data(), sizeof(header_to_verify));
+
+  if (header_to_verify.checksum != header_.checksum) {
+    PW_LOG_ERROR("Expected checksum 0x%08" PRIx32 ", found 0x%08" PRIx32,
+                 header_.checksum,
+                 header_to_verify.checksum);
+    return Status::DataLoss();
+  }
+
+  if (checksum_algo_ == nullptr) {
+    return header_.checksum == 0 ? OkStatus() : Status::DataLoss();
+  }
+
+  // The checksum is calculated as if the header's checksum field were 0.
+  header_to_verify.checksum = 0;
+
+  checksum_algo_->Reset();
+  checksum_algo_->Update(&header_to_verify, sizeof(header_to_verify));
+  checksum_algo_->Update(contents.subspan(sizeof(EntryHeader),
+                                          size() - sizeof(EntryHeader)));
+  checksum_algo_->Finish();
+  return checksum_algo_->Verify(checksum_bytes());
+}
+
 void Entry::DebugLog() const {
   PW_LOG_DEBUG("Entry [%s]: ", deleted() ? "tombstone" : "present");
   PW_LOG_DEBUG("   Address      = 0x%x", unsigned(address_));
@@ -252,6 +296,7 @@ void Entry::DebugLog() const {
   PW_LOG_DEBUG("   Magic        = 0x%x", unsigned(magic()));
   PW_LOG_DEBUG("   Checksum     = 0x%x", unsigned(header_.checksum));
   PW_LOG_DEBUG("   Key length   = 0x%x", unsigned(key_length()));
+  PW_LOG_DEBUG("   Batch role   = %u", unsigned(batch_role()));
   PW_LOG_DEBUG("   Value length = 0x%x", unsigned(value_size()));
   PW_LOG_DEBUG("   Entry size   = 0x%x", unsigned(size()));
   PW_LOG_DEBUG("   Alignment    = 0x%x", unsigned(alignment_bytes()));
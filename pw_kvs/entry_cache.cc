@@ -17,6 +17,7 @@
 
 #include "pw_kvs/internal/entry_cache.h"
 
+#include <algorithm>
 #include <cinttypes>
 
 #include "pw_kvs/flash_memory.h"
@@ -65,56 +66,56 @@ StatusWithSize EntryCache::Find(FlashPartition& partition,
                                 Key key,
                                 EntryMetadata* metadata) const {
   const uint32_t hash = internal::Hash(key);
+
+  // Key hashes are unique within the cache, so at most one descriptor matches.
+  const int index = FindIndex(hash);
+  if (index == -1) {
+    return StatusWithSize::NotFound();
+  }
+
   Entry::KeyBuffer key_buffer;
   bool error_detected = false;
+  bool key_found = false;
+  Key read_key;
 
-  for (size_t i = 0; i < descriptors_.size(); ++i) {
-    if (descriptors_[i].key_hash == hash) {
-      bool key_found = false;
-      Key read_key;
-
-      for (Address address : addresses(i)) {
-        Status read_result =
-            Entry::ReadKey(partition, address, key.size(), key_buffer.data());
-
-        read_key = Key(key_buffer.data(), key.size());
-
-        if (read_result.ok() && hash == internal::Hash(read_key)) {
-          key_found = true;
-          break;
-        } else {
-          // A hash mismatch can be caused by reading invalid data or a key hash
-          // collision of keys with differing size. To verify the data read from
-          // flash is good, validate the entry.
-          Entry entry;
-          read_result = Entry::Read(partition, address, formats, &entry);
-          if (read_result.ok() && entry.VerifyChecksumInFlash().ok()) {
-            key_found = true;
-            break;
-          }
-
-          PW_LOG_WARN(
-              "   Found corrupt entry, invalidating this copy of the key");
-          error_detected = true;
-          sectors.FromAddress(address).mark_corrupt();
-        }
-      }
-      size_t error_val = error_detected ? 1 : 0;
-
-      if (!key_found) {
-        PW_LOG_ERROR("No valid entries for key. Data has been lost!");
-        return StatusWithSize::DataLoss(error_val);
-      } else if (key == read_key) {
-        PW_LOG_DEBUG("Found match for key hash 0x%08" PRIx32, hash);
-        *metadata = EntryMetadata(descriptors_[i], addresses(i));
-        return StatusWithSize(error_val);
-      } else {
-        PW_LOG_WARN("Found key hash collision for 0x%08" PRIx32, hash);
-        return StatusWithSize::AlreadyExists(error_val);
+  for (Address address : addresses(index)) {
+    Status read_result =
+        Entry::ReadKey(partition, address, key.size(), key_buffer.data());
+
+    read_key = Key(key_buffer.data(), key.size());
+
+    if (read_result.ok() && hash == internal::Hash(read_key)) {
+      key_found = true;
+      break;
+    } else {
+      // A hash mismatch can be caused by reading invalid data or a key hash
+      // collision of keys with differing size. To verify the data read from
+      // flash is good, validate the entry.
+      Entry entry;
+      read_result = Entry::Read(partition, address, formats, &entry);
+      if (read_result.ok() && entry.VerifyChecksumInFlash().ok()) {
+        key_found = true;
+        break;
       }
+
+      PW_LOG_WARN("   Found corrupt entry, invalidating this copy of the key");
+      error_detected = true;
+      sectors.FromAddress(address).mark_corrupt();
     }
   }
-  return StatusWithSize::NotFound();
+  size_t error_val = error_detected ? 1 : 0;
+
+  if (!key_found) {
+    PW_LOG_ERROR("No valid entries for key. Data has been lost!");
+    return StatusWithSize::DataLoss(error_val);
+  } else if (key == read_key) {
+    PW_LOG_DEBUG("Found match for key hash 0x%08" PRIx32, hash);
+    *metadata = EntryMetadata(descriptors_[index], addresses(index));
+    return StatusWithSize(error_val);
+  } else {
+    PW_LOG_WARN("Found key hash collision for 0x%08" PRIx32, hash);
+    return StatusWithSize::AlreadyExists(error_val);
+  }
 }
 
 EntryMetadata EntryCache::AddNew(const KeyDescriptor& descriptor,
@@ -122,13 +123,13 @@ EntryMetadata EntryCache::AddNew(const KeyDescriptor& descriptor,
   // TODO(hepler): DCHECK(!full());
   Address* first_address = ResetAddresses(descriptors_.size(), address);
   descriptors_.push_back(descriptor);
+  AddToHashIndex(descriptors_.size() - 1);
   return EntryMetadata(descriptors_.back(), std::span(first_address, 1));
 }
 
-// TODO: This method is the trigger of the O(valid_entries * all_entries) time
-// complexity for reading. At some cost to memory, this could be optimized by
-// using a hash table instead of scanning, but in practice this should be fine
-// for a small number of keys
+// Without a hash index, this method is the trigger of the
+// O(valid_entries * all_entries) time complexity for reading. This is fine for
+// a small number of keys; larger caches should be given a hash index.
 Status EntryCache::AddNewOrUpdateExisting(const KeyDescriptor& descriptor,
                                           Address address,
                                           size_t sector_size_bytes) const {
@@ -192,7 +193,25 @@ size_t EntryCache::present_entries() const {
   return present_entries;
 }
 
+void EntryCache::Reset() const {
+  descriptors_.clear();
+  std::fill(hash_index_.begin(), hash_index_.end(), HashIndexSlot(0));
+}
+
 int EntryCache::FindIndex(uint32_t key_hash) const {
+  if (hash_indexed()) {
+    // The index always has at least one empty slot, so probing terminates.
+    const size_t mask = hash_index_.size() - 1;
+    for (size_t slot = key_hash & mask; hash_index_[slot] != 0u;
+         slot = (slot + 1) & mask) {
+      const size_t index = hash_index_[slot] - 1;
+      if (descriptors_[index].key_hash == key_hash) {
+        return index;
+      }
+    }
+    return -1;
+  }
+
   for (size_t i = 0; i < descriptors_.size(); ++i) {
     if (descriptors_[i].key_hash == key_hash) {
       return i;
@@ -201,6 +220,19 @@ int EntryCache::FindIndex(uint32_t key_hash) const {
   return -1;
 }
 
+void EntryCache::AddToHashIndex(size_t descriptor_index) const {
+  if (!hash_indexed()) {
+    return;
+  }
+
+  const size_t mask = hash_index_.size() - 1;
+  size_t slot = descriptors_[descriptor_index].key_hash & mask;
+  while (hash_index_[slot] != 0u) {
+    slot = (slot + 1) & mask;
+  }
+  hash_index_[slot] = HashIndexSlot(descriptor_index + 1);
+}
+
 void EntryCache::AddAddressIfRoom(size_t descriptor_index,
                                   Address address) const {
   Address* const existing = first_address(descriptor_index);
@@ -194,6 +194,97 @@ TEST_F(EmptyEntryCache, Iterator_Const_CanBeAssignedFromMutable) {
   EXPECT_EQ(99u, it->first_address());
 }
 
+class HashIndexedEntryCache : public ::testing::Test {
+ protected:
+  static constexpr size_t kMaxEntries = 32;
+  static constexpr size_t kRedundancy = 2;
+  static constexpr uint32_t kIndexSize =
+      EntryCache::HashIndexSize(kMaxEntries);
+
+  HashIndexedEntryCache()
+      : entries_(descriptors_, addresses_, kRedundancy, hash_index_) {}
+
+  Vector<KeyDescriptor, kMaxEntries> descriptors_;
+  EntryCache::AddressList<kMaxEntries, kRedundancy> addresses_;
+  EntryCache::HashIndex<kMaxEntries> hash_index_{};
+
+  EntryCache entries_;
+};
+
+TEST(EntryCacheHashIndex, HashIndexSize) {
+  EXPECT_EQ(0u, EntryCache::HashIndexSize(0));
+  EXPECT_EQ(2u, EntryCache::HashIndexSize(1));
+  EXPECT_EQ(64u, EntryCache::HashIndexSize(32));
+  EXPECT_EQ(128u, EntryCache::HashIndexSize(33));
+}
+
+TEST_F(HashIndexedEntryCache, AddNewOrUpdateExisting_CollidingSlots) {
+  ASSERT_TRUE(entries_.hash_indexed());
+
+  // Every hash maps to slot 0, so each lookup must probe past the others.
+  for (uint32_t i = 0; i < kMaxEntries; ++i) {
+    ASSERT_EQ(OkStatus(),
+              entries_.AddNewOrUpdateExisting(
+                  {i * kIndexSize, 1, EntryState::kValid}, i, 1));
+  }
+  ASSERT_TRUE(entries_.full());
+
+  // Newer transactions replace each existing descriptor rather than adding.
+  for (uint32_t i = 0; i < kMaxEntries; ++i) {
+    ASSERT_EQ(OkStatus(),
+              entries_.AddNewOrUpdateExisting(
+                  {i * kIndexSize, 2, EntryState::kValid}, 1000 + i, 1));
+  }
+  EXPECT_EQ(kMaxEntries, entries_.total_entries());
+
+  uint32_t expected_hash = 0;
+  for (const EntryMetadata& entry : entries_) {
+    EXPECT_EQ(expected_hash, entry.hash());
+    EXPECT_EQ(2u, entry.transaction_id());
+    EXPECT_EQ(1000u + expected_hash / kIndexSize, entry.first_address());
+    expected_hash += kIndexSize;
+  }
+
+  EXPECT_EQ(Status::ResourceExhausted(),
+            entries_.AddNewOrUpdateExisting(kDescriptor, 5, 1));
+}
+
+TEST_F(HashIndexedEntryCache, AddNewOrUpdateExisting_AddDuplicateEntry) {
+  ASSERT_EQ(OkStatus(),
+            entries_.AddNewOrUpdateExisting(kDescriptor, 1000, 2000));
+  ASSERT_EQ(OkStatus(),
+            entries_.AddNewOrUpdateExisting(kDescriptor, 3000, 2000));
+
+  EXPECT_EQ(1u, entries_.total_entries());
+
+  for (const EntryMetadata& entry : entries_) {
+    ASSERT_EQ(2u, entry.addresses().size());
+    EXPECT_EQ(1000u, entry.addresses()[0]);
+    EXPECT_EQ(3000u, entry.addresses()[1]);
+  }
+}
+
+TEST_F(HashIndexedEntryCache, Reset_ClearsIndex) {
+  for (uint32_t i = 0; i < kMaxEntries; ++i) {
+    ASSERT_EQ(
+        OkStatus(),
+        entries_.AddNewOrUpdateExisting({i, 1, EntryState::kValid}, i, 1));
+  }
+
+  entries_.Reset();
+  EXPECT_EQ(0u, entries_.total_entries());
+
+  // Re-adding the same hashes creates new descriptors instead of updating
+  // stale index entries.
+  for (uint32_t i = 0; i < kMaxEntries; ++i) {
+    ASSERT_EQ(
+        OkStatus(),
+        entries_.AddNewOrUpdateExisting({i, 0, EntryState::kValid}, i, 1));
+  }
+  EXPECT_EQ(kMaxEntries, entries_.total_entries());
+  EXPECT_EQ(kMaxEntries, entries_.present_entries());
+}
+
 constexpr size_t kSectorSize = 64;
 constexpr uint32_t kMagic = 0xa14ae726;
 // For KVS entry magic value always use a random 32 bit integer rather than a
@@ -18,11 +18,13 @@
 #include "pw_kvs/key_value_store.h"
 
 #include <algorithm>
+#include <array>
 #include <cinttypes>
 #include <cstring>
 #include <type_traits>
 
 #include "pw_assert/check.h"
+#include "pw_bytes/endian.h"
 #include "pw_kvs_private/config.h"
 #include "pw_log/shorter.h"
 #include "pw_status/try.h"
@@ -32,31 +34,136 @@ namespace {
 
 using std::byte;
 
+// The key of the entry that stores sector erase counts. The leading null
+// character keeps it apart from keys that applications use.
+constexpr char kEraseCountsKeyString[] = "\0pw_kvs_erase_counts";
+constexpr Key kEraseCountsKey(kEraseCountsKeyString,
+                              sizeof(kEraseCountsKeyString) - 1);
+
 constexpr bool InvalidKey(Key key) {
-  return key.empty() || (key.size() > internal::Entry::kMaxKeyLength);
+  return key.empty() || (key.size() > internal::Entry::kMaxKeyLength) ||
+         key == kEraseCountsKey;
 }
 
 }  // namespace
 
-KeyValueStore::KeyValueStore(FlashPartition* partition,
-                             std::span<const EntryFormat> formats,
-                             const Options& options,
-                             size_t redundancy,
-                             Vector<SectorDescriptor>& sector_descriptor_list,
-                             const SectorDescriptor** temp_sectors_to_skip,
-                             Vector<KeyDescriptor>& key_descriptor_list,
-                             Address* addresses)
+class KeyValueStore::ReadBurst {
+ public:
+  constexpr ReadBurst(std::span<byte> buffer)
+      : buffer_(buffer), address_(0), size_(0) {}
+
+  // Returns the bytes at [address, address + size) from the buffer. If they
+  // are not buffered, refills the buffer with one read starting at address and
+  // extending to the end of the buffer or sector, whichever comes first.
+  // Returns an empty span if the region does not fit or the read fails.
+  std::span<const byte> Get(FlashPartition& partition,
+                            Address sector_end,
+                            Address address,
+                            size_t size) {
+    if (address >= address_ && address + size <= address_ + size_) {
+      return std::span(buffer_.data() + (address - address_), size);
+    }
+
+    if (size > buffer_.size() || address + size > sector_end) {
+      return {};
+    }
+
+    const size_t read_size =
+        std::min(buffer_.size(), size_t(sector_end - address));
+    if (!partition.Read(address, buffer_.first(read_size)).ok()) {
+      size_ = 0;
+      return {};
+    }
+
+    address_ = address;
+    size_ = read_size;
+    return std::span(buffer_.data(), size);
+  }
+
+ private:
+  const std::span<byte> buffer_;
+  Address address_;  // Flash address of the first byte in buffer_.
+  size_t size_;      // Number of valid bytes in buffer_.
+};
+
+class KeyValueStore::BatchTracker {
+ public:
+  constexpr BatchTracker()
+      : newest_transaction_id_(0),
+        newest_role_(Entry::BatchRole::kNone),
+        rejected_transaction_id_(0) {}
+
+  // Records a loaded entry. Returns false if the entry belongs to a rejected
+  // batch and should be discarded.
+  bool Add(const Entry& entry) {
+    const uint32_t transaction_id = entry.transaction_id();
+    if (transaction_id == rejected_transaction_id_ &&
+        rejected_transaction_id_ != 0u) {
+      return false;
+    }
+
+    if (transaction_id > newest_transaction_id_) {
+      newest_transaction_id_ = transaction_id;
+      newest_role_ = entry.batch_role();
+    } else if (transaction_id == newest_transaction_id_ &&
+               entry.batch_role() == Entry::BatchRole::kCommit) {
+      newest_role_ = Entry::BatchRole::kCommit;
+    }
+    return true;
+  }
+
+  // Writes are not allowed until an incomplete batch is rolled back, so only
+  // the newest transaction can be an incomplete batch. Older batches may have
+  // had their commit entry garbage collected, so they are always valid.
+  bool incomplete_batch() const {
+    return newest_role_ == Entry::BatchRole::kMember;
+  }
+
+  // Discards the newest batch's entries if they are loaded again. Returns the
+  // batch's transaction ID.
+  uint32_t RejectIncompleteBatch() {
+    rejected_transaction_id_ = newest_transaction_id_;
+    newest_transaction_id_ = 0;
+    newest_role_ = Entry::BatchRole::kNone;
+    return rejected_transaction_id_;
+  }
+
+ private:
+  uint32_t newest_transaction_id_;
+  Entry::BatchRole newest_role_;  // kCommit if any entry is a commit entry.
+  uint32_t rejected_transaction_id_;
+};
+
+KeyValueStore::KeyValueStore(
+    FlashPartition* partition,
+    std::span<const EntryFormat> formats,
+    const Options& options,
+    size_t redundancy,
+    Vector<SectorDescriptor>& sector_descriptor_list,
+    const SectorDescriptor** temp_sectors_to_skip,
+    Vector<KeyDescriptor>& key_descriptor_list,
+    Address* addresses,
+    std::span<internal::EntryCache::HashIndexSlot> hash_index,
+    std::span<internal::ReadCache::Slot> read_cache_slots,
+    std::span<byte> read_cache_data)
     : partition_(*partition),
       formats_(formats),
       sectors_(sector_descriptor_list, *partition, temp_sectors_to_skip),
-      entry_cache_(key_descriptor_list, addresses, redundancy),
+      entry_cache_(key_descriptor_list, addresses, redundancy, hash_index),
       options_(options),
       initialized_(InitializationState::kNotInitialized),
       error_detected_(false),
+      read_cache_(read_cache_slots, read_cache_data),
       internal_stats_({}),
-      last_transaction_id_(0) {}
+      last_transaction_id_(0),
+      rollback_last_new_(nullptr),
+      stored_erase_counts_({}),
+      erase_counts_changed_(false),
+      gc_sector_(nullptr) {}
 
-Status KeyValueStore::Init() {
+Status KeyValueStore::Init() { return Init(std::span<byte>()); }
+
+Status KeyValueStore::Init(std::span<byte> read_buffer) {
   initialized_ = InitializationState::kNotInitialized;
   error_detected_ = false;
   last_transaction_id_ = 0;
@@ -88,7 +195,9 @@ Status KeyValueStore::Init() {
     return Status::FailedPrecondition();
   }
 
-  Status metadata_result = InitializeMetadata();
+  ReadBurst burst(read_buffer);
+  Status metadata_result =
+      InitializeMetadata(read_buffer.empty() ? nullptr : &burst);
 
   if (!error_detected_) {
     initialized_ = InitializationState::kReady;
@@ -136,11 +245,42 @@ Status KeyValueStore::Init() {
   return OkStatus();
 }
 
-Status KeyValueStore::InitializeMetadata() {
+Status KeyValueStore::InitializeMetadata(ReadBurst* burst) {
+  BatchTracker batches;
+  Status status = LoadEntries(burst, batches);
+
+  if (batches.incomplete_batch()) {
+    // A batch was interrupted before its commit entry was written. Load the
+    // entries again, treating the batch's entries as corrupt so that they are
+    // discarded when their sectors are garbage collected.
+    const uint32_t rejected_transaction_id = batches.RejectIncompleteBatch();
+    WRN("Rolling back incomplete batch with transaction ID %u",
+        unsigned(rejected_transaction_id));
+    status = LoadEntries(burst, batches);
+
+    // The rejected entries stay in flash until they are garbage collected, so
+    // new entries must not reuse their transaction ID.
+    last_transaction_id_ =
+        std::max(last_transaction_id_, rejected_transaction_id);
+  }
+
+  // If a batch failed while this KVS was running, return to the sector
+  // selection from before the batch.
+  if (rollback_last_new_ != nullptr) {
+    sectors_.set_last_new_sector(sectors_.BaseAddress(*rollback_last_new_));
+    rollback_last_new_ = nullptr;
+  }
+  return status;
+}
+
+Status KeyValueStore::LoadEntries(ReadBurst* burst, BatchTracker& batches) {
   const size_t sector_size_bytes = partition_.sector_size_bytes();
 
   sectors_.Reset();
   entry_cache_.Reset();
+  read_cache_.Clear();
+  gc_sector_ = nullptr;
+  stored_erase_counts_ = {};
 
   DBG("First pass: Read all entries from all sectors");
   Address sector_address = 0;
@@ -167,10 +307,21 @@ Status KeyValueStore::InitializeMetadata() {
       }
 
       Address next_entry_address;
-      Status status = LoadEntry(entry_address, &next_entry_address);
+      Status status;
+      if (burst != nullptr) {
+        status = LoadEntry(
+            batches, *burst, sector, entry_address, &next_entry_address);
+      } else {
+        status = LoadEntry(batches, entry_address, &next_entry_address);
+      }
       if (status.IsNotFound()) {
         DBG("Hit un-written data in sector; moving to the next sector");
         break;
+      } else if (status.IsAborted()) {
+        // The entry belongs to an incomplete batch. Count it as corrupt so the
+        // sector is garbage collected, which discards the entry.
+        corrupt_entries++;
+        sector_corrupt_bytes += next_entry_address - entry_address;
       } else if (!status.ok()) {
         // The entry could not be read, indicating likely data corruption within
         // the sector. Try to scan the remainder of the sector for other
@@ -270,6 +421,15 @@ Status KeyValueStore::InitializeMetadata() {
 
   sectors_.set_last_new_sector(newest_key);
 
+  // The erase counts entry is not in the entry cache, so account for it
+  // separately.
+  last_transaction_id_ =
+      std::max(last_transaction_id_, stored_erase_counts_.transaction_id);
+  if (stored_erase_counts_.size != 0u) {
+    sectors_.FromAddress(stored_erase_counts_.address)
+        .AddValidBytes(stored_erase_counts_.size);
+  }
+
   if (!empty_sector_found) {
     DBG("No empty sector found");
     error_detected_ = true;
@@ -305,8 +465,14 @@ KeyValueStore::StorageStats KeyValueStore::GetStorageStats() const {
   stats.corrupt_sectors_recovered = internal_stats_.corrupt_sectors_recovered;
   stats.missing_redundant_entries_recovered =
       internal_stats_.missing_redundant_entries_recovered;
+  stats.min_sector_erase_count =
+      sectors_.size() == 0u ? 0 : std::numeric_limits<size_t>::max();
 
   for (const SectorDescriptor& sector : sectors_) {
+    stats.min_sector_erase_count =
+        std::min<size_t>(stats.min_sector_erase_count, sector.erase_count());
+    stats.max_sector_erase_count =
+        std::max<size_t>(stats.max_sector_erase_count, sector.erase_count());
     stats.in_use_bytes += sector.valid_bytes();
     stats.reclaimable_bytes += sector.RecoverableBytes(sector_size);
 
@@ -350,7 +516,8 @@ bool KeyValueStore::CheckForErrors() {
   return error_detected();
 }
 
-Status KeyValueStore::LoadEntry(Address entry_address,
+Status KeyValueStore::LoadEntry(BatchTracker& batches,
+                                Address entry_address,
                                 Address* next_entry_address) {
   Entry entry;
   PW_TRY(Entry::Read(partition_, entry_address, formats_, &entry));
@@ -365,10 +532,104 @@ Status KeyValueStore::LoadEntry(Address entry_address,
   // A valid entry was found, so update the next entry address before doing any
   // of the checks that happen in AddNewOrUpdateExisting.
   *next_entry_address = entry.next_address();
+  return AddLoadedEntry(batches, entry, key);
+}
+
+// Loads an entry from the burst buffer, refilling it as needed. Entries that
+// cannot be buffered are loaded directly from flash.
+Status KeyValueStore::LoadEntry(BatchTracker& batches,
+                                ReadBurst& burst,
+                                const SectorDescriptor& sector,
+                                Address entry_address,
+                                Address* next_entry_address) {
+  const Address sector_end =
+      sectors_.BaseAddress(sector) + partition_.sector_size_bytes();
+
+  internal::EntryHeader header;
+  std::span<const byte> contents =
+      burst.Get(partition_, sector_end, entry_address, sizeof(header));
+  if (contents.empty()) {
+    return LoadEntry(batches, entry_address, next_entry_address);
+  }
+
+  std::memcpy(&header, contents.data(), sizeof(header));
+
+  Entry entry;
+  PW_TRY(
+      Entry::FromHeader(partition_, entry_address, formats_, header, &entry));
+
+  contents = burst.Get(partition_, sector_end, entry_address, entry.size());
+  if (contents.empty()) {
+    return LoadEntry(batches, entry_address, next_entry_address);
+  }
+
+  if (entry.key_length() == 0u) {
+    return Status::DataLoss();
+  }
+  const Key key(reinterpret_cast<const char*>(&contents[sizeof(header)]),
+                entry.key_length());
+
+  PW_TRY(entry.VerifyChecksumInBuffer(contents));
+
+  // A valid entry was found, so update the next entry address before doing any
+  // of the checks that happen in AddNewOrUpdateExisting.
+  *next_entry_address = entry.next_address();
+  return AddLoadedEntry(batches, entry, key);
+}
+
+// Adds a valid entry to the entry cache. Returns ABORTED if the entry belongs
+// to a batch that is being rolled back.
+Status KeyValueStore::AddLoadedEntry(BatchTracker& batches,
+                                     const Entry& entry,
+                                     Key key) {
+  if (key == kEraseCountsKey) {
+    return LoadEraseCounts(entry);
+  }
+
+  if (!batches.Add(entry)) {
+    DBG("Discarding entry at address %u from incomplete batch",
+        unsigned(entry.address()));
+    return Status::Aborted();
+  }
   return entry_cache_.AddNewOrUpdateExisting(
       entry.descriptor(key), entry.address(), partition_.sector_size_bytes());
 }
 
+// Restores the erase counts from the newest erase counts entry. Older entries
+// are stale and are discarded when their sectors are garbage collected.
+Status KeyValueStore::LoadEraseCounts(const Entry& entry) {
+  if (entry.transaction_id() <= stored_erase_counts_.transaction_id) {
+    return OkStatus();
+  }
+  stored_erase_counts_.transaction_id = entry.transaction_id();
+
+  if (!options_.persist_erase_counts) {
+    return OkStatus();
+  }
+  stored_erase_counts_.address = entry.address();
+  stored_erase_counts_.size = entry.size();
+
+  // The counts are ignored if the partition has a different number of sectors
+  // than when they were stored.
+  const size_t value_size = sectors_.size() * sizeof(uint32_t);
+  if (sectors_.size() > kMaxStoredEraseCounts ||
+      entry.value_size() != value_size) {
+    DBG("Ignoring erase counts for a different number of sectors");
+    return OkStatus();
+  }
+
+  std::array<byte, kMaxStoredEraseCounts * sizeof(uint32_t)> counts;
+  PW_TRY(entry.ReadValue(std::span(counts).first(value_size)));
+
+  const byte* count = counts.data();
+  for (SectorDescriptor& sector : sectors_) {
+    sector.RestoreEraseCount(
+        bytes::ReadInOrder<uint32_t>(std::endian::little, count));
+    count += sizeof(uint32_t);
+  }
+  return OkStatus();
+}
+
 // Scans flash memory within a sector to find a KVS entry magic.
 Status KeyValueStore::ScanForEntry(const SectorDescriptor& sector,
                                    Address start_address,
@@ -405,12 +666,49 @@ StatusWithSize KeyValueStore::Get(Key key,
                                   size_t offset_bytes) const {
   PW_TRY_WITH_SIZE(CheckReadOperation(key));
 
+  std::span<const byte> cached_value;
+  if (read_cache_.Find(key, &cached_value)) {
+    if (offset_bytes > cached_value.size()) {
+      return StatusWithSize::OutOfRange();
+    }
+    cached_value = cached_value.subspan(offset_bytes);
+    const size_t read_size = std::min(value_buffer.size(), cached_value.size());
+    std::memcpy(value_buffer.data(), cached_value.data(), read_size);
+
+    if (read_size != cached_value.size()) {
+      return StatusWithSize::ResourceExhausted(read_size);
+    }
+    return StatusWithSize(read_size);
+  }
+
   EntryMetadata metadata;
   PW_TRY_WITH_SIZE(FindExisting(key, &metadata));
 
   return Get(key, metadata, value_buffer, offset_bytes);
 }
 
+Result<ConstByteSpan> KeyValueStore::GetView(Key key) const {
+  PW_TRY(CheckReadOperation(key));
+
+  EntryMetadata metadata;
+  PW_TRY(FindExisting(key, &metadata));
+
+  Entry entry;
+  PW_TRY(ReadEntry(metadata, entry));
+
+  // Entries do not cross sector boundaries, so the value is contiguous in the
+  // MCU address space.
+  const byte* value =
+      partition_.PartitionAddressToMcuAddress(entry.value_address());
+  if (value == nullptr) {
+    return Status::Unimplemented();
+  }
+
+  const ConstByteSpan view(value, entry.value_size());
+  PW_TRY(entry.VerifyChecksum(key, view));
+  return view;
+}
+
 Status KeyValueStore::PutBytes(Key key, std::span<const byte> value) {
   PW_TRY(CheckWriteOperation(key));
   DBG("Writing key/value; key length=%u, value length=%u",
@@ -457,6 +755,216 @@ Status KeyValueStore::Delete(Key key) {
   return WriteEntryForExistingKey(metadata, EntryState::kDeleted, key, {});
 }
 
+Status KeyValueStore::Batch::Add(Key key,
+                                 std::span<const byte> value,
+                                 EntryState state) {
+  if (InvalidKey(key)) {
+    return Status::InvalidArgument();
+  }
+
+  const uint32_t hash = internal::Hash(key);
+  for (Operation& operation : operations_) {
+    if (internal::Hash(operation.key) == hash) {
+      if (operation.key != key) {
+        return Status::AlreadyExists();
+      }
+      operation.value = value;
+      operation.state = state;
+      return OkStatus();
+    }
+  }
+
+  if (operations_.full()) {
+    return Status::ResourceExhausted();
+  }
+  operations_.push_back({.key = key,
+                         .value = value,
+                         .state = state,
+                         .write = false,
+                         .prior_size = 0});
+  return OkStatus();
+}
+
+Status KeyValueStore::Commit(Batch& batch) {
+  if (!initialized()) {
+    return Status::FailedPrecondition();
+  }
+
+  size_t batch_size_bytes;
+  PW_TRY(PrepareBatch(batch, &batch_size_bytes));
+
+  if (batch_size_bytes == 0u) {
+    DBG("Batch of %u operations matches the stored entries; nothing to write",
+        unsigned(batch.size()));
+    batch.Clear();
+    return OkStatus();
+  }
+
+  // Find a sector for each redundant copy of the batch. This is the only point
+  // at which garbage collection may happen, so entries written by the batch are
+  // never relocated before they are added to the entry cache.
+  SectorDescriptor* const last_new_before_batch = sectors_.last_new();
+  Address* reserved_addresses = entry_cache_.TempReservedAddressesForWrite();
+  PW_TRY(GetAddressesForWrite(reserved_addresses, batch_size_bytes));
+
+  // All of the batch's entries share one transaction ID. As with other
+  // entries, the ID is burned even if the write fails.
+  last_transaction_id_ += 1;
+  const Status status = WriteBatch(batch, last_transaction_id_);
+
+  if (!status.ok()) {
+    // Entries that were written are not in the entry cache, so they are
+    // discarded when their sectors are garbage collected. Writes must be
+    // blocked until Repair() rolls the batch back: newer entries would make
+    // this incomplete batch look committed to the next Init().
+    ERR("Failed to write batch of %u operations", unsigned(batch.size()));
+    rollback_last_new_ = last_new_before_batch;
+    error_detected_ = true;
+    initialized_ = InitializationState::kNeedsMaintenance;
+    if (options_.recovery != ErrorRecovery::kManual) {
+      Repair().IgnoreError();  // Commit reports the original error.
+    }
+    return status;
+  }
+
+  ApplyBatch(batch);
+  batch.Clear();
+  StoreEraseCountsIfChanged();
+  return OkStatus();
+}
+
+// Checks that the batch can be committed and finds which operations change the
+// stored entries. Sets *batch_size_bytes to the size of one copy of the
+// entries that need to be written.
+Status KeyValueStore::PrepareBatch(Batch& batch, size_t* batch_size_bytes) {
+  size_t new_keys = 0;
+  *batch_size_bytes = 0;
+
+  for (Batch::Operation& operation : batch.operations_) {
+    const bool deleting = (operation.state == EntryState::kDeleted);
+
+    EntryMetadata metadata;
+    Status status = FindEntry(operation.key, &metadata);
+
+    operation.write = true;
+    operation.prior_size = 0;
+
+    if (status.ok()) {
+      if (deleting && metadata.state() == EntryState::kDeleted) {
+        return Status::NotFound();
+      }
+
+      Entry prior_entry;
+      PW_TRY(ReadEntry(metadata, prior_entry));
+      operation.prior_size = prior_entry.size();
+
+      // As in WriteEntry, skip writes that do not change the stored value.
+      if (metadata.state() == operation.state &&
+          prior_entry.value_size() == operation.value.size() &&
+          prior_entry.ValueMatches(operation.value).ok()) {
+        operation.write = false;
+      }
+    } else if (status.IsNotFound()) {
+      if (deleting) {
+        return Status::NotFound();
+      }
+      new_keys += 1;
+    } else {
+      return status;
+    }
+
+    if (operation.write) {
+      *batch_size_bytes +=
+          Entry::size(partition_, operation.key, operation.value);
+    }
+  }
+
+  if (new_keys > entry_cache_.max_entries() - entry_cache_.total_entries()) {
+    WRN("KVS full: batch adds %u entries, but only %u are available",
+        unsigned(new_keys),
+        unsigned(entry_cache_.max_entries() - entry_cache_.total_entries()));
+    return Status::ResourceExhausted();
+  }
+
+  if (*batch_size_bytes > partition_.sector_size_bytes()) {
+    DBG("%u B batch cannot fit in one sector", unsigned(*batch_size_bytes));
+    return Status::InvalidArgument();
+  }
+  return OkStatus();
+}
+
+// Writes the batch's entries back-to-back at the reserved addresses. The last
+// entry is the commit entry; it is written after all other entries, including
+// their redundant copies.
+Status KeyValueStore::WriteBatch(Batch& batch, uint32_t transaction_id) {
+  const Address* reserved_addresses =
+      entry_cache_.TempReservedAddressesForWrite();
+
+  size_t remaining_writes = 0;
+  for (const Batch::Operation& operation : batch.operations_) {
+    remaining_writes += operation.write ? 1 : 0;
+  }
+
+  size_t offset = 0;
+  for (const Batch::Operation& operation : batch.operations_) {
+    if (!operation.write) {
+      continue;
+    }
+    remaining_writes -= 1;
+    read_cache_.Invalidate(internal::Hash(operation.key));
+
+    const Entry::BatchRole role = remaining_writes == 0u
+                                      ? Entry::BatchRole::kCommit
+                                      : Entry::BatchRole::kMember;
+    Entry entry = CreateEntry(reserved_addresses[0] + offset,
+                              operation.key,
+                              operation.value,
+                              operation.state,
+                              transaction_id,
+                              role);
+
+    for (size_t i = 0; i < redundancy(); ++i) {
+      entry.set_address(reserved_addresses[i] + offset);
+      PW_TRY(AppendEntry(entry, operation.key, operation.value));
+    }
+    offset += entry.size();
+  }
+  return OkStatus();
+}
+
+// Updates the entry cache after all of the batch's entries were written.
+void KeyValueStore::ApplyBatch(Batch& batch) {
+  const Address* reserved_addresses =
+      entry_cache_.TempReservedAddressesForWrite();
+
+  size_t offset = 0;
+  for (const Batch::Operation& operation : batch.operations_) {
+    if (!operation.write) {
+      continue;
+    }
+
+    // The header is only needed for the descriptor and size, so the entry
+    // does not need to be read back from flash.
+    const Entry entry = CreateEntry(reserved_addresses[0] + offset,
+                                    operation.key,
+                                    operation.value,
+                                    operation.state,
+                                    last_transaction_id_,
+                                    Entry::BatchRole::kNone);
+
+    EntryMetadata metadata;
+    EntryMetadata* prior_metadata =
+        FindEntry(operation.key, &metadata).ok() ? &metadata : nullptr;
+    EntryMetadata new_metadata = CreateOrUpdateKeyDescriptor(
+        entry, operation.key, prior_metadata, operation.prior_size);
+
+    for (size_t i = 1; i < redundancy(); ++i) {
+      new_metadata.AddNewAddress(reserved_addresses[i] + offset);
+    }
+    offset += entry.size();
+  }
+}
+
 void KeyValueStore::Item::ReadKey() {
   key_buffer_.fill('\0');
 
@@ -552,6 +1060,8 @@ StatusWithSize KeyValueStore::Get(Key key,
       return StatusWithSize(verify_result, 0);
     }
 
+    // Only values that passed checksum verification are cached.
+    read_cache_.Put(key, value_buffer.first(result.size()));
     return StatusWithSize(verify_result, result.size());
   }
   return result;
@@ -562,6 +1072,18 @@ Status KeyValueStore::FixedSizeGet(Key key,
                                    size_t size_bytes) const {
   PW_TRY(CheckWriteOperation(key));
 
+  std::span<const byte> cached_value;
+  if (read_cache_.Find(key, &cached_value)) {
+    if (cached_value.size() != size_bytes) {
+      DBG("Requested %u B read, but value is %u B",
+          unsigned(size_bytes),
+          unsigned(cached_value.size()));
+      return Status::InvalidArgument();
+    }
+    std::memcpy(value, cached_value.data(), size_bytes);
+    return OkStatus();
+  }
+
   EntryMetadata metadata;
   PW_TRY(FindExisting(key, &metadata));
 
@@ -662,6 +1184,8 @@ Status KeyValueStore::WriteEntry(Key key,
     return OkStatus();
   }
 
+  read_cache_.Invalidate(internal::Hash(key));
+
   // List of addresses for sectors with space for this entry.
   Address* reserved_addresses = entry_cache_.TempReservedAddressesForWrite();
 
@@ -686,6 +1210,8 @@ Status KeyValueStore::WriteEntry(Key key,
     PW_TRY(AppendEntry(entry, key, value));
     new_metadata.AddNewAddress(reserved_addresses[i]);
   }
+
+  StoreEraseCountsIfChanged();
   return OkStatus();
 }
 
@@ -944,6 +1470,53 @@ Status KeyValueStore::PartialMaintenance() {
   return GarbageCollect(std::span<const Address>());
 }
 
+Status KeyValueStore::MaintenanceStep(chrono::SystemClock::duration budget) {
+  if (initialized_ == InitializationState::kNotInitialized) {
+    return Status::FailedPrecondition();
+  }
+  const chrono::SystemClock::time_point deadline =
+      chrono::SystemClock::now() + budget;
+
+  CheckForErrors();
+  // Do automatic repair, if KVS options allow for it.
+  if (error_detected_ && options_.recovery != ErrorRecovery::kManual) {
+    PW_TRY(Repair());
+  }
+
+  if (gc_sector_ == nullptr) {
+    SectorDescriptor* sector =
+        sectors_.FindSectorToGarbageCollect(std::span<const Address>());
+    if (sector == nullptr ||
+        sector->RecoverableBytes(partition_.sector_size_bytes()) == 0u) {
+      return Status::NotFound();
+    }
+    DBG("Maintenance step: begin garbage collecting sector %u",
+        sectors_.Index(sector));
+    sector->set_writable_bytes(0);
+    gc_sector_ = sector;
+  }
+
+  // Relocate entries until the sector is empty or the budget is used up.
+  // Relocated entries no longer have addresses in the sector, so each step
+  // scans the entry cache from the start.
+  for (EntryMetadata& metadata : entry_cache_) {
+    if (gc_sector_->valid_bytes() == 0u) {
+      break;
+    }
+    const size_t valid_bytes = gc_sector_->valid_bytes();
+    PW_TRY(RelocateKeyAddressesInSector(*gc_sector_, metadata, {}));
+
+    if (gc_sector_->valid_bytes() != valid_bytes &&
+        chrono::SystemClock::now() >= deadline) {
+      return OkStatus();
+    }
+  }
+
+  // GarbageCollectSector finds no entries to relocate, so only erases. It also
+  // clears gc_sector_.
+  return GarbageCollectSector(*gc_sector_, {});
+}
+
 Status KeyValueStore::GarbageCollect(
     std::span<const Address> reserved_addresses) {
   DBG("Garbage Collect a single sector");
@@ -993,6 +1566,19 @@ Status KeyValueStore::GarbageCollectSector(
     }
   }
 
+  // The erase counts entry is not in the entry cache, so move it separately.
+  // If it cannot be moved, the counts are stored again after the next write.
+  if (stored_erase_counts_.size != 0u &&
+      sectors_.AddressInSector(sector_to_gc, stored_erase_counts_.address)) {
+    if (!WriteEraseCounts(&sector_to_gc).ok()) {
+      WRN("  Failed to move the erase counts out of sector %u",
+          sectors_.Index(sector_to_gc));
+      sector_to_gc.RemoveValidBytes(stored_erase_counts_.size);
+      stored_erase_counts_.size = 0;
+      erase_counts_changed_ = true;
+    }
+  }
+
   if (sector_to_gc.valid_bytes() != 0) {
     ERR("  Failed to relocate valid entries from sector being garbage "
         "collected, %u valid bytes remain",
@@ -1004,14 +1590,78 @@ Status KeyValueStore::GarbageCollectSector(
   if (!sector_to_gc.Empty(partition_.sector_size_bytes())) {
     sector_to_gc.mark_corrupt();
     internal_stats_.sector_erase_count++;
+    sector_to_gc.IncrementEraseCount();
+    erase_counts_changed_ = true;
     PW_TRY(partition_.Erase(sectors_.BaseAddress(sector_to_gc), 1));
     sector_to_gc.set_writable_bytes(partition_.sector_size_bytes());
   }
 
+  // Collecting the sector finishes any MaintenanceStep collection of it.
+  if (&sector_to_gc == gc_sector_) {
+    gc_sector_ = nullptr;
+  }
+
   DBG("  Garbage Collect sector %u complete", sectors_.Index(sector_to_gc));
   return OkStatus();
 }
 
+Status KeyValueStore::WriteEraseCounts(const SectorDescriptor* sector_to_gc) {
+  if (sectors_.size() > kMaxStoredEraseCounts) {
+    return Status::OutOfRange();
+  }
+
+  std::array<byte, kMaxStoredEraseCounts * sizeof(uint32_t)> counts;
+  byte* count = counts.data();
+  for (const SectorDescriptor& sector : sectors_) {
+    const auto bytes =
+        bytes::CopyInOrder(std::endian::little, sector.erase_count());
+    std::memcpy(count, bytes.data(), bytes.size());
+    count += bytes.size();
+  }
+  const std::span<const byte> value(counts.data(), count - counts.data());
+  const size_t entry_size = Entry::size(partition_, kEraseCountsKey, value);
+
+  // Writing the counts never garbage collects. When moving the counts during
+  // garbage collection, any sector except the one being collected may be used.
+  SectorDescriptor* sector;
+  if (sector_to_gc == nullptr) {
+    PW_TRY(sectors_.FindSpace(&sector, entry_size, {}));
+  } else {
+    const Address skip = sectors_.BaseAddress(*sector_to_gc);
+    PW_TRY(sectors_.FindSpaceDuringGarbageCollection(
+        &sector, entry_size, std::span(&skip, 1), {}));
+  }
+
+  const Entry entry = CreateEntry(sectors_.NextWritableAddress(*sector),
+                                  kEraseCountsKey,
+                                  value,
+                                  EntryState::kValid);
+  PW_TRY(AppendEntry(entry, kEraseCountsKey, value));
+
+  // The previous entry is now stale.
+  if (stored_erase_counts_.size != 0u) {
+    sectors_.FromAddress(stored_erase_counts_.address)
+        .RemoveValidBytes(stored_erase_counts_.size);
+  }
+  stored_erase_counts_ = {.address = entry.address(),
+                          .size = entry.size(),
+                          .transaction_id = entry.transaction_id()};
+  erase_counts_changed_ = false;
+  return OkStatus();
+}
+
+void KeyValueStore::StoreEraseCountsIfChanged() {
+  if (!options_.persist_erase_counts || !erase_counts_changed_) {
+    return;
+  }
+
+  // The counts only guide wear leveling, so failing to store them does not
+  // fail the write. They are stored again after the next write.
+  if (!WriteEraseCounts(nullptr).ok()) {
+    DBG("Unable to store the erase counts");
+  }
+}
+
 StatusWithSize KeyValueStore::UpdateEntriesToPrimaryFormat() {
   size_t entries_updated = 0;
   for (EntryMetadata& prior_metadata : entry_cache_) {
@@ -1209,7 +1859,7 @@ Status KeyValueStore::Repair() {
   INF("Starting KVS repair");
 
   DBG("Reinitialize KVS metadata");
-  InitializeMetadata()
+  InitializeMetadata(nullptr)
       .IgnoreError();  // TODO(pwbug/387): Handle Status properly
 
   return FixErrors();
@@ -1233,16 +1883,35 @@ KeyValueStore::Entry KeyValueStore::CreateEntry(Address address,
   // By always burning transaction IDs, the above problem can't happen.
   last_transaction_id_ += 1;
 
+  return CreateEntry(address,
+                     key,
+                     value,
+                     state,
+                     last_transaction_id_,
+                     Entry::BatchRole::kNone);
+}
+
+KeyValueStore::Entry KeyValueStore::CreateEntry(Address address,
+                                                Key key,
+                                                std::span<const byte> value,
+                                                EntryState state,
+                                                uint32_t transaction_id,
+                                                Entry::BatchRole batch_role) {
   if (state == EntryState::kDeleted) {
-    return Entry::Tombstone(
-        partition_, address, formats_.primary(), key, last_transaction_id_);
+    return Entry::Tombstone(partition_,
+                            address,
+                            formats_.primary(),
+                            key,
+                            transaction_id,
+                            batch_role);
   }
   return Entry::Valid(partition_,
                       address,
                       formats_.primary(),
                       key,
                       value,
-                      last_transaction_id_);
+                      transaction_id,
+                      batch_role);
 }
 
 void KeyValueStore::LogDebugInfo() const {
@@ -0,0 +1,115 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark comparing KeyValueStore lookup latency when the EntryCache
+// scans every KeyDescriptor against lookups through the hash index.
+//
+// Build the pw_kvs.key_value_store_benchmark target and run the binary. Each
+// line reports the average time for Get() of an existing key and for Get() of
+// a missing key, which must examine every descriptor when scanning.
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_string/string_builder.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectorSize = 4096;
+constexpr size_t kSectors = 16;
+constexpr size_t kLookupRounds = 20;
+
+ChecksumCrc16 checksum;
+constexpr EntryFormat kFormat{.magic = 0x5b9a341e, .checksum = &checksum};
+
+FakeFlashMemoryBuffer<kSectorSize, kSectors> flash(16);
+FlashPartition partition(&flash, 0, flash.sector_count());
+
+using KeyBuffer = StringBuffer<16>;
+
+KeyBuffer MakeKey(size_t index) {
+  KeyBuffer key;
+  key.Format("sensor/%05u", unsigned(index));
+  return key;
+}
+
+// Returns the average duration of one call to lookup in nanoseconds.
+template <typename Function>
+int64_t AverageNanoseconds(size_t calls, Function&& lookup) {
+  const auto start = chrono::SystemClock::now();
+  for (size_t i = 0; i < calls; ++i) {
+    lookup(i);
+  }
+  const auto elapsed = chrono::SystemClock::now() - start;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() /
+         int64_t(calls);
+}
+
+template <size_t kKeys, bool kHashIndex>
+void RunLookupBenchmark() {
+  static KeyValueStoreBuffer<kKeys, kSectors, 1, 1, kHashIndex> kvs(&partition,
+                                                                    kFormat);
+  if (!partition.Erase().ok() || !kvs.Init().ok()) {
+    std::printf("Failed to initialize KVS\n");
+    return;
+  }
+
+  for (size_t i = 0; i < kKeys; ++i) {
+    if (!kvs.Put(MakeKey(i).view(), uint32_t(i)).ok()) {
+      std::printf("Put failed for key %u\n", unsigned(i));
+      return;
+    }
+  }
+
+  uint32_t value;
+  const int64_t hit_ns =
+      AverageNanoseconds(kKeys * kLookupRounds, [&](size_t i) {
+        kvs.Get(MakeKey(i % kKeys).view(), &value).IgnoreError();
+      });
+  const int64_t miss_ns =
+      AverageNanoseconds(kKeys * kLookupRounds, [&](size_t i) {
+        kvs.Get(MakeKey(kKeys + i % kKeys).view(), &value).IgnoreError();
+      });
+
+  std::printf("%5u keys  %-10s  hit %8" PRId64 " ns  miss %8" PRId64 " ns\n",
+              unsigned(kKeys),
+              kHashIndex ? "hash index" : "scan",
+              hit_ns,
+              miss_ns);
+}
+
+template <size_t kKeys>
+void CompareLookups() {
+  RunLookupBenchmark<kKeys, false>();
+  RunLookupBenchmark<kKeys, true>();
+}
+
+}  // namespace
+}  // namespace pw::kvs
+
+int main() {
+  pw::kvs::CompareLookups<64>();
+  pw::kvs::CompareLookups<256>();
+  pw::kvs::CompareLookups<1024>();
+  return 0;
+}
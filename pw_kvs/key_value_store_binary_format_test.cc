@@ -74,17 +74,19 @@ template <uint32_t (*kChecksum)(std::span<const byte>,
           size_t kAlignmentBytes = sizeof(internal::EntryHeader),
           size_t kKeyLengthWithNull,
           size_t kValueSize>
-constexpr auto MakeValidEntry(uint32_t magic,
-                              uint32_t id,
-                              const char (&key)[kKeyLengthWithNull],
-                              const std::array<byte, kValueSize>& value) {
+constexpr auto MakeValidEntry(
+    uint32_t magic,
+    uint32_t id,
+    const char (&key)[kKeyLengthWithNull],
+    const std::array<byte, kValueSize>& value,
+    internal::Entry::BatchRole batch_role = internal::Entry::BatchRole::kNone) {
   constexpr size_t kKeyLength = kKeyLengthWithNull - 1;
 
   auto data =
       bytes::Concat(magic,
                     uint32_t(0),
                     uint8_t(kAlignmentBytes / 16 - 1),
-                    uint8_t(kKeyLength),
+                    uint8_t(kKeyLength | (unsigned(batch_role) << 6)),
                     uint16_t(kValueSize),
                     id,
                     bytes::String(key),
@@ -602,6 +604,129 @@ TEST_F(KvsErrorRecovery, Put_WriteFailure_EntryNotAddedButBytesMarkedWritten) {
   EXPECT_EQ(stats.missing_redundant_entries_recovered, 0u);
 }
 
+// Entries from a batch with transaction ID 6 that updates key1 and k2.
+using BatchRole = internal::Entry::BatchRole;
+
+constexpr auto kBatchMember1 = MakeValidEntry(
+    kMagic, 6, "key1", bytes::String("batch1"), BatchRole::kMember);
+constexpr auto kBatchMember2 = MakeValidEntry(
+    kMagic, 6, "k2", bytes::String("batch2"), BatchRole::kMember);
+constexpr auto kBatchCommit2 = MakeValidEntry(
+    kMagic, 6, "k2", bytes::String("batch2"), BatchRole::kCommit);
+constexpr auto kEntryAfterBatch =
+    MakeValidEntry(kMagic, 7, "k3y", bytes::String("value3"));
+
+// Reads a key's value as a string; returns an empty string on failure.
+template <typename Kvs>
+std::string_view GetString(Kvs& kvs, const char* key, char (&buffer)[64]) {
+  std::memset(buffer, 0, sizeof(buffer));
+  if (!kvs.Get(key, std::as_writable_bytes(std::span(buffer))).ok()) {
+    return {};
+  }
+  return buffer;
+}
+
+TEST_F(KvsErrorHandling, Init_CommittedBatch_AllEntriesVisible) {
+  InitFlashTo(bytes::Concat(kEntry1, kEntry2, kBatchMember1, kBatchCommit2));
+
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  char buffer[64];
+  EXPECT_EQ("batch1", GetString(kvs_, "key1", buffer));
+  EXPECT_EQ("batch2", GetString(kvs_, "k2", buffer));
+  EXPECT_EQ(6u, kvs_.transaction_count());
+}
+
+TEST_F(KvsErrorHandling, Init_IncompleteBatch_RevertsToPreviousVersions) {
+  InitFlashTo(bytes::Concat(kEntry1, kEntry2, kBatchMember1, kBatchMember2));
+
+  // The batch's entries are treated as corrupt, so the sector needs repair.
+  ASSERT_EQ(Status::DataLoss(), kvs_.Init());
+  char buffer[64];
+  EXPECT_EQ("value1", GetString(kvs_, "key1", buffer));
+  EXPECT_EQ("value2", GetString(kvs_, "k2", buffer));
+
+  // The transaction ID of the rejected batch is not reused.
+  EXPECT_EQ(6u, kvs_.transaction_count());
+  EXPECT_EQ(Status::FailedPrecondition(), kvs_.Put("k3y", uint32_t(3)));
+}
+
+TEST_F(KvsErrorHandling, Init_OlderBatchWithoutCommitEntry_AllEntriesVisible) {
+  // Only the newest transaction can be an incomplete batch. An older batch's
+  // commit entry may have been garbage collected after its key was updated.
+  InitFlashTo(bytes::Concat(
+      kEntry1, kEntry2, kBatchMember1, kBatchMember2, kEntryAfterBatch));
+
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  char buffer[64];
+  EXPECT_EQ("batch1", GetString(kvs_, "key1", buffer));
+  EXPECT_EQ("batch2", GetString(kvs_, "k2", buffer));
+  EXPECT_EQ("value3", GetString(kvs_, "k3y", buffer));
+}
+
+TEST_F(KvsErrorHandling, Commit_WriteFailure_BlocksWritesUntilMaintenance) {
+  InitFlashTo(bytes::Concat(kEntry1, kEntry2));
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+
+  KeyValueStore::BatchBuffer<2> batch;
+  ASSERT_EQ(OkStatus(), batch.Put("key1", bytes::String("batch1")));
+  ASSERT_EQ(OkStatus(), batch.Put("k2", bytes::String("batch2")));
+
+  // Fail the write of the first entry, so the commit entry is never written.
+  flash_.InjectWriteError(FlashError::Unconditional(Status::Unavailable(), 1));
+  EXPECT_EQ(Status::Unavailable(), kvs_.Commit(batch));
+
+  char buffer[64];
+  EXPECT_EQ("value1", GetString(kvs_, "key1", buffer));
+  EXPECT_EQ("value2", GetString(kvs_, "k2", buffer));
+  EXPECT_EQ(Status::FailedPrecondition(), kvs_.Put("k3y", uint32_t(3)));
+
+  ASSERT_EQ(OkStatus(), kvs_.FullMaintenance());
+  EXPECT_EQ(OkStatus(), kvs_.Put("k3y", uint32_t(3)));
+
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  EXPECT_EQ("value1", GetString(kvs_, "key1", buffer));
+  EXPECT_EQ("value2", GetString(kvs_, "k2", buffer));
+}
+
+TEST_F(KvsErrorRecovery, Init_IncompleteBatch_RevertsAndRepairs) {
+  InitFlashTo(bytes::Concat(kEntry1, kEntry2, kBatchMember1, kBatchMember2));
+
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  char buffer[64];
+  EXPECT_EQ("value1", GetString(kvs_, "key1", buffer));
+  EXPECT_EQ("value2", GetString(kvs_, "k2", buffer));
+  EXPECT_EQ(1u, kvs_.GetStorageStats().corrupt_sectors_recovered);
+
+  // The sector with the batch's entries was erased, so a newer transaction
+  // cannot make the batch appear complete.
+  ASSERT_EQ(OkStatus(), kvs_.Put("k3y", bytes::String("value3")));
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  EXPECT_FALSE(kvs_.error_detected());
+  EXPECT_EQ("value1", GetString(kvs_, "key1", buffer));
+  EXPECT_EQ("value2", GetString(kvs_, "k2", buffer));
+}
+
+TEST_F(KvsErrorRecovery, Commit_WriteFailure_RollsBack) {
+  InitFlashTo(bytes::Concat(kEntry1, kEntry2));
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+
+  KeyValueStore::BatchBuffer<2> batch;
+  ASSERT_EQ(OkStatus(), batch.Put("key1", bytes::String("batch1")));
+  ASSERT_EQ(OkStatus(), batch.Put("k2", bytes::String("batch2")));
+
+  flash_.InjectWriteError(FlashError::Unconditional(Status::Unavailable(), 1));
+  EXPECT_EQ(Status::Unavailable(), kvs_.Commit(batch));
+
+  // The KVS was repaired, so writes are allowed again.
+  EXPECT_EQ(OkStatus(), kvs_.Put("k3y", bytes::String("value3")));
+
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  char buffer[64];
+  EXPECT_EQ("value1", GetString(kvs_, "key1", buffer));
+  EXPECT_EQ("value2", GetString(kvs_, "k2", buffer));
+  EXPECT_EQ("value3", GetString(kvs_, "k3y", buffer));
+}
+
 // For KVS magic value always use a random 32 bit integer rather than a
 // human readable 4 bytes. See pw_kvs/format.h for more information.
 constexpr uint32_t kAltMagic = 0x41a2db83;
@@ -0,0 +1,134 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark comparing KeyValueStore::Init(), which reads each entry with
+// several small flash reads, against Init() with a burst read buffer.
+//
+// Build the pw_kvs.key_value_store_mount_benchmark target and run the binary.
+// Each line reports the average mount time per MB of partition and the number
+// of FlashPartition::Read() calls issued by one mount.
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#include "pw_chrono/system_clock.h"
+#include "pw_kvs/crc16_checksum.h"
+#include "pw_kvs/fake_flash_memory.h"
+#include "pw_kvs/flash_memory.h"
+#include "pw_kvs/key_value_store.h"
+#include "pw_string/string_builder.h"
+
+namespace pw::kvs {
+namespace {
+
+constexpr size_t kSectorSize = 4096;
+constexpr size_t kSectors = 64;
+constexpr size_t kKeys = 256;
+constexpr size_t kValueSize = 48;
+constexpr size_t kMounts = 20;
+
+// FlashPartition that counts the Read() calls made through it.
+class CountingFlashPartition : public FlashPartition {
+ public:
+  using FlashPartition::FlashPartition;
+
+  StatusWithSize Read(Address address, std::span<std::byte> output) override {
+    reads_ += 1;
+    return FlashPartition::Read(address, output);
+  }
+
+  size_t reads() const { return reads_; }
+  void ResetReads() { reads_ = 0; }
+
+ private:
+  size_t reads_ = 0;
+};
+
+ChecksumCrc16 checksum;
+constexpr EntryFormat kFormat{.magic = 0x5b9a341e, .checksum = &checksum};
+
+FakeFlashMemoryBuffer<kSectorSize, kSectors> flash(16);
+CountingFlashPartition partition(&flash, 0, flash.sector_count());
+KeyValueStoreBuffer<kKeys, kSectors> kvs(&partition, kFormat);
+
+std::array<std::byte, kSectorSize> sector_buffer;
+std::array<std::byte, 256> small_buffer;
+
+size_t UsedBytes() {
+  const KeyValueStore::StorageStats stats = kvs.GetStorageStats();
+  return stats.in_use_bytes + stats.reclaimable_bytes;
+}
+
+// Fills about half of the partition with current and stale entries.
+bool FillPartition() {
+  if (!partition.Erase().ok() || !kvs.Init().ok()) {
+    return false;
+  }
+
+  std::array<std::byte, kValueSize> value;
+  const size_t target_bytes = partition.size_bytes() / 2;
+  for (size_t i = 0; UsedBytes() < target_bytes; ++i) {
+    StringBuffer<16> key;
+    key.Format("sensor/%05u", unsigned(i % kKeys));
+    std::memset(value.data(), int(i / kKeys), value.size());
+    if (!kvs.Put(key.view(), value).ok()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RunMountBenchmark(const char* name, std::span<std::byte> read_buffer) {
+  partition.ResetReads();
+
+  const auto start = chrono::SystemClock::now();
+  for (size_t i = 0; i < kMounts; ++i) {
+    if (!kvs.Init(read_buffer).ok()) {
+      std::printf("Init failed\n");
+      return;
+    }
+  }
+  const auto elapsed = chrono::SystemClock::now() - start;
+
+  const int64_t ns_per_mount =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() /
+      int64_t(kMounts);
+  const int64_t us_per_mb =
+      ns_per_mount * 1024 * 1024 / int64_t(partition.size_bytes()) / 1000;
+
+  std::printf("%-14s  %8" PRId64 " us/MB  %6u reads/mount\n",
+              name,
+              us_per_mb,
+              unsigned(partition.reads() / kMounts));
+}
+
+}  // namespace
+}  // namespace pw::kvs
+
+int main() {
+  if (!pw::kvs::FillPartition()) {
+    std::printf("Failed to fill the partition\n");
+    return 1;
+  }
+
+  pw::kvs::RunMountBenchmark("entry reads", {});
+  pw::kvs::RunMountBenchmark("256 B buffer", pw::kvs::small_buffer);
+  pw::kvs::RunMountBenchmark("sector buffer", pw::kvs::sector_buffer);
+  return 0;
+}
@@ -17,6 +17,7 @@
 
 #include "pw_kvs/key_value_store.h"
 
+#include <algorithm>
 #include <array>
 #include <cstdio>
 #include <cstring>
@@ -37,6 +38,7 @@
 #include "pw_log/shorter.h"
 #include "pw_status/status.h"
 #include "pw_string/string_builder.h"
+#include "pw_tokenizer/tokenize.h"
 
 namespace pw::kvs {
 namespace {
@@ -412,6 +414,494 @@ TEST_F(LargeEmptyInitializedKvs, FullMaintenance) {
   EXPECT_EQ(stats.reclaimable_bytes, 0u);
 }
 
+TEST_F(LargeEmptyInitializedKvs, MaintenanceStep_NoReclaimableBytes_NotFound) {
+  constexpr auto kBudget = chrono::SystemClock::duration::zero();
+  EXPECT_EQ(Status::NotFound(), kvs_.MaintenanceStep(kBudget));
+
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], uint8_t(0xDA)));
+  EXPECT_EQ(Status::NotFound(), kvs_.MaintenanceStep(kBudget));
+  EXPECT_EQ(kvs_.GetStorageStats().sector_erase_count, 0u);
+}
+
+TEST_F(LargeEmptyInitializedKvs, MaintenanceStep_ZeroBudget_OneEntryPerStep) {
+  constexpr auto kBudget = chrono::SystemClock::duration::zero();
+
+  // Three valid entries and one stale entry in the first sector.
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], uint8_t(1)));
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[1], uint8_t(2)));
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[2], uint8_t(3)));
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], uint8_t(4)));
+  const size_t in_use_bytes = kvs_.GetStorageStats().in_use_bytes;
+
+  // One step per relocated entry; the sector is erased by the following step.
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(OkStatus(), kvs_.MaintenanceStep(kBudget));
+    EXPECT_EQ(kvs_.GetStorageStats().sector_erase_count, 0u);
+  }
+  ASSERT_EQ(OkStatus(), kvs_.MaintenanceStep(kBudget));
+  EXPECT_EQ(Status::NotFound(), kvs_.MaintenanceStep(kBudget));
+
+  KeyValueStore::StorageStats stats = kvs_.GetStorageStats();
+  EXPECT_EQ(stats.sector_erase_count, 1u);
+  EXPECT_EQ(stats.reclaimable_bytes, 0u);
+  EXPECT_EQ(stats.in_use_bytes, in_use_bytes);
+
+  uint8_t value;
+  ASSERT_EQ(OkStatus(), kvs_.Get(keys[0], &value));
+  EXPECT_EQ(value, 4u);
+  ASSERT_EQ(OkStatus(), kvs_.Get(keys[1], &value));
+  EXPECT_EQ(value, 2u);
+  ASSERT_EQ(OkStatus(), kvs_.Get(keys[2], &value));
+  EXPECT_EQ(value, 3u);
+}
+
+TEST_F(LargeEmptyInitializedKvs, MaintenanceStep_PutBetweenSteps) {
+  constexpr auto kBudget = chrono::SystemClock::duration::zero();
+
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], uint8_t(1)));
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[1], uint8_t(2)));
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], uint8_t(3)));
+  ASSERT_EQ(OkStatus(), kvs_.MaintenanceStep(kBudget));
+
+  // Entries are not written to the sector being collected, so these Puts do
+  // not add work to the collection in progress.
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[1], uint8_t(4)));
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[2], uint8_t(5)));
+
+  Status status;
+  for (int steps = 0; (status = kvs_.MaintenanceStep(kBudget)).ok(); ++steps) {
+    ASSERT_LT(steps, 10);
+  }
+  EXPECT_EQ(Status::NotFound(), status);
+  EXPECT_EQ(kvs_.GetStorageStats().reclaimable_bytes, 0u);
+
+  uint8_t value;
+  ASSERT_EQ(OkStatus(), kvs_.Get(keys[0], &value));
+  EXPECT_EQ(value, 3u);
+  ASSERT_EQ(OkStatus(), kvs_.Get(keys[1], &value));
+  EXPECT_EQ(value, 4u);
+  ASSERT_EQ(OkStatus(), kvs_.Get(keys[2], &value));
+  EXPECT_EQ(value, 5u);
+
+  // The relocated entries are found after reinitializing.
+  ASSERT_EQ(OkStatus(), kvs_.Init());
+  ASSERT_EQ(OkStatus(), kvs_.Get(keys[0], &value));
+  EXPECT_EQ(value, 3u);
+  EXPECT_EQ(kvs_.size(), 3u);
+}
+
+TEST_F(LargeEmptyInitializedKvs, MaintenanceStep_SectorCollectedElsewhere) {
+  constexpr auto kBudget = chrono::SystemClock::duration::zero();
+
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], uint8_t(1)));
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[1], uint8_t(2)));
+  ASSERT_EQ(OkStatus(), kvs_.Put(keys[0], uint8_t(3)));
+  ASSERT_EQ(OkStatus(), kvs_.MaintenanceStep(kBudget));
+
+  // Finish collecting the sector outside of MaintenanceStep.
+  ASSERT_EQ(OkStatus(), kvs_.HeavyMaintenance());
+  const size_t erase_count = kvs_.GetStorageStats().sector_erase_count;
+  EXPECT_EQ(kvs_.GetStorageStats().reclaimable_bytes, 0u);
+
+  // The finished collection is not resumed.
+  EXPECT_EQ(Status::NotFound(), kvs_.MaintenanceStep(kBudget));
+  EXPECT_EQ(kvs_.GetStorageStats().sector_erase_count, erase_count);
+
+  uint8_t value;
+  ASSERT_EQ(OkStatus(), kvs_.Get(keys[0], &value));
+  EXPECT_EQ(value, 3u);
+  ASSERT_EQ(OkStatus(), kvs_.Get(keys[1], &value));
+  EXPECT_EQ(value, 2u);
+}
+
+TEST(InMemoryKvs, MaintenanceStep_NotInitialized_FailedPrecondition) {
+  Flash flash;
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&flash.partition,
+                                                          default_format);
+  EXPECT_EQ(Status::FailedPrecondition(),
+            kvs.MaintenanceStep(chrono::SystemClock::duration::zero()));
+}
+
+TEST(InMemoryKvs, HashIndex_PutGetDeleteManyKeys) {
+  FakeFlashMemoryBuffer<1024, 16> flash(16);
+  FlashPartition partition(&flash, 0, flash.sector_count());
+  ASSERT_EQ(OkStatus(), partition.Erase());
+
+  constexpr size_t kKeys = 200;
+  KeyValueStoreBuffer<kKeys, 16, 1, 1, /*kHashIndex=*/true> kvs(
+      &partition, default_format);
+  ASSERT_OK(kvs.Init());
+
+  for (uint32_t i = 0; i < kKeys; ++i) {
+    StringBuffer<16> key;
+    key.Format("key_%u", unsigned(i));
+    ASSERT_OK(kvs.Put(key.view(), i));
+  }
+  EXPECT_EQ(kKeys, kvs.size());
+
+  for (uint32_t i = 0; i < kKeys; i += 2) {
+    StringBuffer<16> key;
+    key.Format("key_%u", unsigned(i));
+    ASSERT_OK(kvs.Delete(key.view()));
+  }
+
+  // Remount to rebuild the index from flash.
+  ASSERT_OK(kvs.Init());
+  EXPECT_EQ(kKeys / 2, kvs.size());
+
+  for (uint32_t i = 0; i < kKeys; ++i) {
+    StringBuffer<16> key;
+    key.Format("key_%u", unsigned(i));
+    uint32_t value = 0;
+    if (i % 2 == 0) {
+      EXPECT_EQ(Status::NotFound(), kvs.Get(key.view(), &value));
+    } else {
+      ASSERT_OK(kvs.Get(key.view(), &value));
+      EXPECT_EQ(i, value);
+    }
+  }
+}
+
+void FillAndVerifyBurstInit(std::span<std::byte> read_buffer) {
+  FakeFlashMemoryBuffer<512, 8> flash(16);
+  FlashPartition partition(&flash, 0, flash.sector_count());
+  ASSERT_EQ(OkStatus(), partition.Erase());
+
+  constexpr size_t kKeys = 40;
+  KeyValueStoreBuffer<kKeys, 8> kvs(&partition, default_format);
+  ASSERT_OK(kvs.Init());
+
+  // Write each key twice so sectors hold stale entries, and vary the value
+  // size so some entries are larger than small read buffers.
+  std::array<std::byte, 100> value;
+  for (size_t pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < kKeys; ++i) {
+      StringBuffer<16> key;
+      key.Format("key_%u", unsigned(i));
+      std::memset(value.data(), int(i + pass), value.size());
+      ASSERT_OK(kvs.Put(key.view(), std::span(value).first(i * 2 + 1)));
+    }
+  }
+  const size_t transaction_count = kvs.transaction_count();
+
+  ASSERT_OK(kvs.Init(read_buffer));
+  EXPECT_EQ(kKeys, kvs.size());
+  EXPECT_EQ(transaction_count, kvs.transaction_count());
+
+  for (size_t i = 0; i < kKeys; ++i) {
+    StringBuffer<16> key;
+    key.Format("key_%u", unsigned(i));
+    std::array<std::byte, 100> read_value;
+    StatusWithSize result = kvs.Get(key.view(), read_value);
+    ASSERT_OK(result.status());
+    ASSERT_EQ(i * 2 + 1, result.size());
+    EXPECT_EQ(std::byte(i + 1), read_value[0]);
+    EXPECT_EQ(std::byte(i + 1), read_value[i * 2]);
+  }
+}
+
+TEST(InMemoryKvs, Init_ReadBufferOfOneSector) {
+  std::array<std::byte, 512> buffer;
+  FillAndVerifyBurstInit(buffer);
+}
+
+TEST(InMemoryKvs, Init_ReadBufferSmallerThanEntries) {
+  std::array<std::byte, 64> buffer;
+  FillAndVerifyBurstInit(buffer);
+}
+
+TEST(InMemoryKvs, Init_ReadBufferDetectsCorruption) {
+  FakeFlashMemoryBuffer<512, 4> flash(16);
+  FlashPartition partition(&flash, 0, flash.sector_count());
+  ASSERT_EQ(OkStatus(), partition.Erase());
+
+  KeyValueStoreBuffer<8, 4> kvs(&partition, default_format);
+  ASSERT_OK(kvs.Init());
+  ASSERT_OK(kvs.Put("key1", uint32_t(1)));
+  ASSERT_OK(kvs.Put("key2", uint32_t(2)));
+
+  // Corrupt the value of the entry for key1, which follows its key.
+  std::span<std::byte> contents = flash.buffer();
+  const auto key_bytes = std::as_bytes(std::span("key1", 4));
+  auto key1 = std::search(
+      contents.begin(), contents.end(), key_bytes.begin(), key_bytes.end());
+  ASSERT_NE(key1, contents.end());
+  key1[4] = std::byte(0xef);
+
+  std::array<std::byte, 512> buffer;
+  // The default lazy recovery repairs the corrupt sector during Init.
+  ASSERT_OK(kvs.Init(buffer));
+  EXPECT_EQ(1u, kvs.GetStorageStats().corrupt_sectors_recovered);
+
+  uint32_t value = 0;
+  EXPECT_EQ(Status::NotFound(), kvs.Get("key1", &value));
+  ASSERT_OK(kvs.Get("key2", &value));
+  EXPECT_EQ(2u, value);
+}
+
+TEST_F(LargeEmptyInitializedKvs, Batch_CommitPutsAndDeletes) {
+  ASSERT_OK(kvs_.Put("key1", uint32_t(1)));
+  ASSERT_OK(kvs_.Put("key2", uint32_t(2)));
+  const uint32_t transaction_count = kvs_.transaction_count();
+
+  KeyValueStore::BatchBuffer<4> batch;
+  ASSERT_OK(batch.Put("key1", uint32_t(10)));
+  ASSERT_OK(batch.Delete("key2"));
+  ASSERT_OK(batch.Put("key3", uint32_t(30)));
+  EXPECT_EQ(3u, batch.size());
+
+  // Nothing is visible until the batch is committed.
+  uint32_t value = 0;
+  ASSERT_OK(kvs_.Get("key1", &value));
+  EXPECT_EQ(1u, value);
+
+  ASSERT_OK(kvs_.Commit(batch));
+  EXPECT_TRUE(batch.empty());
+
+  // The whole batch is one transaction.
+  EXPECT_EQ(transaction_count + 1, kvs_.transaction_count());
+
+  for (int mount = 0; mount < 2; ++mount) {
+    EXPECT_EQ(2u, kvs_.size());
+    ASSERT_OK(kvs_.Get("key1", &value));
+    EXPECT_EQ(10u, value);
+    EXPECT_EQ(Status::NotFound(), kvs_.Get("key2", &value));
+    ASSERT_OK(kvs_.Get("key3", &value));
+    EXPECT_EQ(30u, value);
+
+    ASSERT_OK(kvs_.Init());
+    EXPECT_EQ(transaction_count + 1, kvs_.transaction_count());
+  }
+}
+
+TEST_F(LargeEmptyInitializedKvs, Batch_StagingSameKeyReplacesOperation) {
+  KeyValueStore::BatchBuffer<2> batch;
+  ASSERT_OK(batch.Put("key1", uint32_t(1)));
+  ASSERT_OK(batch.Put("key1", uint32_t(2)));
+  EXPECT_EQ(1u, batch.size());
+
+  ASSERT_OK(batch.Put("key2", uint32_t(3)));
+  EXPECT_EQ(Status::ResourceExhausted(), batch.Put("key3", uint32_t(4)));
+  EXPECT_EQ(Status::InvalidArgument(), batch.Put("", uint32_t(4)));
+
+  ASSERT_OK(kvs_.Commit(batch));
+
+  uint32_t value = 0;
+  ASSERT_OK(kvs_.Get("key1", &value));
+  EXPECT_EQ(2u, value);
+}
+
+TEST_F(LargeEmptyInitializedKvs, Batch_DeleteMissingKey_NothingWritten) {
+  ASSERT_OK(kvs_.Put("key1", uint32_t(1)));
+  const uint32_t transaction_count = kvs_.transaction_count();
+
+  KeyValueStore::BatchBuffer<2> batch;
+  ASSERT_OK(batch.Put("key1", uint32_t(2)));
+  ASSERT_OK(batch.Delete("missing"));
+  EXPECT_EQ(Status::NotFound(), kvs_.Commit(batch));
+
+  EXPECT_EQ(transaction_count, kvs_.transaction_count());
+  uint32_t value = 0;
+  ASSERT_OK(kvs_.Get("key1", &value));
+  EXPECT_EQ(1u, value);
+}
+
+TEST_F(LargeEmptyInitializedKvs, Batch_UnchangedValues_NothingWritten) {
+  ASSERT_OK(kvs_.Put("key1", uint32_t(1)));
+  const uint32_t transaction_count = kvs_.transaction_count();
+
+  KeyValueStore::BatchBuffer<1> batch;
+  ASSERT_OK(batch.Put("key1", uint32_t(1)));
+  ASSERT_OK(kvs_.Commit(batch));
+
+  EXPECT_EQ(transaction_count, kvs_.transaction_count());
+}
+
+TEST_F(LargeEmptyInitializedKvs, Batch_LargerThanSector_InvalidArgument) {
+  std::array<std::byte, 400> value{};
+  KeyValueStore::BatchBuffer<4> batch;
+  ASSERT_OK(batch.Put("key1", value));
+  ASSERT_OK(batch.Put("key2", value));
+  ASSERT_OK(batch.Put("key3", value));
+
+  EXPECT_EQ(Status::InvalidArgument(), kvs_.Commit(batch));
+  EXPECT_TRUE(kvs_.empty());
+}
+
+TEST(InMemoryKvs, Batch_RedundantCopiesInSeparateSectors) {
+  Flash flash;
+  ASSERT_EQ(OkStatus(), flash.partition.Erase());
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors, 2> kvs(&flash.partition,
+                                                             default_format);
+  ASSERT_OK(kvs.Init());
+
+  KeyValueStore::BatchBuffer<3> batch;
+  ASSERT_OK(batch.Put("key1", uint32_t(1)));
+  ASSERT_OK(batch.Put("key2", uint32_t(2)));
+  ASSERT_OK(batch.Put("key3", uint32_t(3)));
+  ASSERT_OK(kvs.Commit(batch));
+
+  ASSERT_OK(kvs.Init());
+  EXPECT_FALSE(kvs.error_detected());
+  EXPECT_EQ(3u, kvs.size());
+
+  // Erase the first sector; the second copy of every entry remains.
+  ASSERT_OK(flash.partition.Erase(0, 1));
+  ASSERT_OK(kvs.Init());
+  EXPECT_EQ(3u, kvs.size());
+  uint32_t value = 0;
+  ASSERT_OK(kvs.Get("key3", &value));
+  EXPECT_EQ(3u, value);
+}
+
+// Returns the value of the read cache metric with the specified name token.
+uint32_t ReadCacheMetric(const KeyValueStore& kvs, uint32_t token) {
+  for (const metric::Metric& metric : kvs.read_cache_metrics().metrics()) {
+    if (metric.name() == token) {
+      return metric.as_int();
+    }
+  }
+  ADD_FAILURE();  // The metric was not found.
+  return 0;
+}
+
+constexpr uint32_t kHitsToken =
+    PW_TOKENIZE_STRING_MASK("metrics", 0x7fffffff, "hits");
+constexpr uint32_t kMissesToken =
+    PW_TOKENIZE_STRING_MASK("metrics", 0x7fffffff, "misses");
+
+TEST(InMemoryKvs, ReadCache_HitsInvalidatedByPutAndDelete) {
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors, 1, 1, false, 4> kvs(
+      &flash.partition, default_format);
+  ASSERT_OK(kvs.Init());
+
+  ASSERT_OK(kvs.Put("key", uint32_t(5)));
+  uint32_t value = 0;
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_OK(kvs.Get("key", &value));
+    EXPECT_EQ(5u, value);
+  }
+  EXPECT_EQ(2u, ReadCacheMetric(kvs, kHitsToken));
+  EXPECT_EQ(1u, ReadCacheMetric(kvs, kMissesToken));
+
+  ASSERT_OK(kvs.Put("key", uint32_t(6)));
+  ASSERT_OK(kvs.Get("key", &value));
+  EXPECT_EQ(6u, value);
+  EXPECT_EQ(2u, ReadCacheMetric(kvs, kMissesToken));
+
+  ASSERT_OK(kvs.Delete("key"));
+  EXPECT_EQ(Status::NotFound(), kvs.Get("key", &value));
+  EXPECT_EQ(2u, ReadCacheMetric(kvs, kHitsToken));
+}
+
+TEST(InMemoryKvs, ReadCache_PartialReadsFromCache) {
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors, 1, 1, false, 4> kvs(
+      &flash.partition, default_format);
+  ASSERT_OK(kvs.Init());
+
+  constexpr auto kValue = bytes::Array<1, 2, 3, 4, 5, 6>();
+  ASSERT_OK(kvs.Put("key", kValue));
+  std::array<std::byte, 8> buffer{};
+  ASSERT_OK(kvs.Get("key", buffer).status());  // Populates the cache.
+
+  StatusWithSize result = kvs.Get("key", std::span(buffer).first(4));
+  EXPECT_EQ(Status::ResourceExhausted(), result.status());
+  EXPECT_EQ(4u, result.size());
+
+  result = kvs.Get("key", buffer, 4);
+  ASSERT_OK(result.status());
+  ASSERT_EQ(2u, result.size());
+  EXPECT_EQ(std::byte{5}, buffer[0]);
+  EXPECT_EQ(std::byte{6}, buffer[1]);
+
+  EXPECT_EQ(Status::OutOfRange(), kvs.Get("key", buffer, 7).status());
+
+  uint32_t wrong_size;
+  EXPECT_EQ(Status::InvalidArgument(), kvs.Get("key", &wrong_size));
+  EXPECT_EQ(4u, ReadCacheMetric(kvs, kHitsToken));
+}
+
+TEST(InMemoryKvs, ReadCache_Disabled_NoMetrics) {
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&flash.partition,
+                                                          default_format);
+  ASSERT_OK(kvs.Init());
+
+  ASSERT_OK(kvs.Put("key", uint32_t(5)));
+  uint32_t value = 0;
+  ASSERT_OK(kvs.Get("key", &value));
+  ASSERT_OK(kvs.Get("key", &value));
+  EXPECT_EQ(0u, ReadCacheMetric(kvs, kHitsToken));
+  EXPECT_EQ(0u, ReadCacheMetric(kvs, kMissesToken));
+}
+
+TEST(InMemoryKvs, GetView_PointsIntoFlash) {
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&flash.partition,
+                                                          default_format);
+  ASSERT_OK(kvs.Init());
+
+  constexpr auto kValue = bytes::Initialized<100>([](size_t i) { return i; });
+  ASSERT_OK(kvs.Put("key", kValue));
+
+  Result<ConstByteSpan> view = kvs.GetView("key");
+  ASSERT_OK(view.status());
+  ASSERT_EQ(kValue.size(), view->size());
+  EXPECT_EQ(0, std::memcmp(kValue.data(), view->data(), kValue.size()));
+
+  const std::span<std::byte> buffer = flash.memory.buffer();
+  EXPECT_GE(view->data(), buffer.data());
+  EXPECT_LE(view->data() + view->size(), buffer.data() + buffer.size());
+
+  EXPECT_EQ(Status::NotFound(), kvs.GetView("missing").status());
+}
+
+TEST(InMemoryKvs, GetView_CorruptValue_DataLoss) {
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&flash.partition,
+                                                          default_format);
+  ASSERT_OK(kvs.Init());
+
+  ASSERT_OK(kvs.Put("key", uint32_t(0x12345678)));
+  Result<ConstByteSpan> view = kvs.GetView("key");
+  ASSERT_OK(view.status());
+
+  // Flip a bit of the value in flash.
+  const std::span<std::byte> buffer = flash.memory.buffer();
+  buffer[view->data() - buffer.data()] ^= std::byte{1};
+  EXPECT_EQ(Status::DataLoss(), kvs.GetView("key").status());
+}
+
+// FakeFlashMemoryBuffer that does not support memory-mapped reads.
+class UnmappedFlash : public FakeFlashMemoryBuffer<512, 4> {
+ public:
+  using FakeFlashMemoryBuffer::FakeFlashMemoryBuffer;
+
+  std::byte* FlashAddressToMcuAddress(Address) const override {
+    return nullptr;
+  }
+};
+
+TEST(InMemoryKvs, GetView_NotMemoryMapped_Unimplemented) {
+  UnmappedFlash flash(16);
+  FlashPartition partition(&flash, 0, flash.sector_count());
+  ASSERT_OK(partition.Erase());
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(&partition,
+                                                          default_format);
+  ASSERT_OK(kvs.Init());
+
+  ASSERT_OK(kvs.Put("key", uint32_t(1)));
+  EXPECT_EQ(Status::Unimplemented(), kvs.GetView("key").status());
+}
+
 TEST(InMemoryKvs, Put_MaxValueSize) {
   // Create and erase the fake flash.
   Flash flash;
@@ -443,4 +933,54 @@ TEST(InMemoryKvs, Put_MaxValueSize) {
   EXPECT_EQ(Status::InvalidArgument(), kvs.Put("K", big_data));
 }
 
+TEST(InMemoryKvs, PersistEraseCounts_StoredInHiddenEntry) {
+  Flash flash;
+  ASSERT_OK(flash.partition.Erase());
+
+  constexpr Options kOptions{.persist_erase_counts = true};
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> kvs(
+      &flash.partition, default_format, kOptions);
+  ASSERT_OK(kvs.Init());
+
+  // Erase the sector with the stale entry, then write so the counts are stored.
+  ASSERT_OK(kvs.Put("key", uint32_t(1)));
+  ASSERT_OK(kvs.Put("key", uint32_t(2)));
+  ASSERT_OK(kvs.HeavyMaintenance());
+  ASSERT_EQ(1u, kvs.GetStorageStats().max_sector_erase_count);
+  ASSERT_OK(kvs.Put("key", uint32_t(3)));
+
+  // Moving the counts entry during garbage collection leaves nothing stale.
+  Status status;
+  for (int steps = 0; (status = kvs.MaintenanceStep(
+                           chrono::SystemClock::duration::zero()))
+                          .ok();
+       ++steps) {
+    ASSERT_LT(steps, 10);
+  }
+  EXPECT_EQ(Status::NotFound(), status);
+  ASSERT_OK(kvs.Put("key", uint32_t(4)));
+
+  KeyValueStoreBuffer<kMaxEntries, kMaxUsableSectors> reloaded(
+      &flash.partition, default_format, kOptions);
+  ASSERT_OK(reloaded.Init());
+  EXPECT_EQ(kvs.GetStorageStats().min_sector_erase_count,
+            reloaded.GetStorageStats().min_sector_erase_count);
+  EXPECT_EQ(kvs.GetStorageStats().max_sector_erase_count,
+            reloaded.GetStorageStats().max_sector_erase_count);
+
+  // The counts entry is not visible as a key.
+  EXPECT_EQ(1u, reloaded.size());
+  size_t keys = 0;
+  for (const auto& item : reloaded) {
+    EXPECT_STREQ("key", item.key());
+    keys += 1;
+  }
+  EXPECT_EQ(1u, keys);
+
+  constexpr char kReservedKey[] = "\0pw_kvs_erase_counts";
+  EXPECT_EQ(Status::InvalidArgument(),
+            reloaded.Put(Key(kReservedKey, sizeof(kReservedKey) - 1),
+                         uint32_t(5)));
+}
+
 }  // namespace pw::kvs
@@ -114,5 +114,69 @@ TEST_F(WearTest, TwoPassFillWithLargeAndLarger) {
             2u * partition_.average_erase_count());
 }
 
+// Updates a few keys far more often than the rest. The generator state is
+// passed in so that a workload can continue across KVS instances.
+void SkewedUpdates(KeyValueStore& kvs, size_t updates, uint32_t& random) {
+  constexpr size_t kKeys = 24;
+  char key[] = "key_00";
+  uint8_t value[40] = {};
+
+  // A fixed linear congruential generator keeps the workload deterministic.
+  for (size_t i = 0; i < updates; ++i) {
+    random = random * 1664525u + 1013904223u;
+    // Cubing a uniform value in [0, kKeys) favors the low-numbered keys.
+    const size_t uniform = (random >> 16) % kKeys;
+    const size_t index = uniform * uniform * uniform / (kKeys * kKeys);
+    key[4] = char('0' + index / 10);
+    key[5] = char('0' + index % 10);
+    value[0] = uint8_t(i);
+    value[1] = uint8_t(i >> 8);
+    ASSERT_EQ(OkStatus(), kvs.Put(key, value));
+  }
+}
+
+// Check that the erases from a skewed workload are spread evenly across the
+// sectors.
+TEST_F(WearTest, SkewedUpdates_EraseCountsStayClose) {
+  partition_.ResetCounters();
+
+  uint32_t random = 1;
+  SkewedUpdates(kvs_, kSectors * 2000, random);
+
+  const KeyValueStore::StorageStats stats = kvs_.GetStorageStats();
+  PW_LOG_INFO("Sector erase counts: min %u, max %u, total %u",
+              unsigned(stats.min_sector_erase_count),
+              unsigned(stats.max_sector_erase_count),
+              unsigned(stats.sector_erase_count));
+
+  EXPECT_EQ(stats.min_sector_erase_count, partition_.min_erase_count());
+  EXPECT_EQ(stats.max_sector_erase_count, partition_.max_erase_count());
+  EXPECT_GT(stats.min_sector_erase_count, 0u);
+  EXPECT_LE(stats.max_sector_erase_count, stats.min_sector_erase_count + 1u);
+}
+
+// Run the skewed workload across several KVS instances, as if the device
+// rebooted. The stored erase counts keep the wear even across reboots.
+TEST_F(WearTest, PersistEraseCounts_CountsSurviveReinit) {
+  partition_.ResetCounters();
+
+  constexpr Options kOptions{.persist_erase_counts = true};
+  uint32_t random = 1;
+  for (int boot = 0; boot < 8; ++boot) {
+    KeyValueStoreBuffer<kMaxEntries, kSectors> kvs(
+        &partition_, format, kOptions);
+    ASSERT_EQ(OkStatus(), kvs.Init());
+
+    const KeyValueStore::StorageStats stats = kvs.GetStorageStats();
+    EXPECT_EQ(stats.min_sector_erase_count, partition_.min_erase_count());
+    EXPECT_EQ(stats.max_sector_erase_count, partition_.max_erase_count());
+
+    SkewedUpdates(kvs, kSectors * 250, random);
+  }
+
+  EXPECT_GT(partition_.min_erase_count(), 0u);
+  EXPECT_LE(partition_.max_erase_count(), partition_.min_erase_count() + 1u);
+}
+
 }  // namespace
 }  // namespace pw::kvs
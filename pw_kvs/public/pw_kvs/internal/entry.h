@@ -41,6 +41,16 @@ class Entry {
 
   using Address = FlashPartition::Address;
 
+  // Role of an entry written by a KeyValueStore::Batch, stored in the top two
+  // bits of the header's key length byte. All entries in a batch share one
+  // transaction ID. The last entry is the commit entry; the other entries are
+  // only valid if the commit entry with their transaction ID was written.
+  enum class BatchRole : uint8_t {
+    kNone = 0b00,
+    kMember = 0b01,
+    kCommit = 0b11,
+  };
+
   // Buffer capable of holding any valid key (without a null terminator);
   using KeyBuffer = std::array<char, kMaxKeyLength>;
 
@@ -55,6 +65,15 @@ class Entry {
                      const internal::EntryFormats& formats,
                      Entry* entry);
 
+  // Initializes an Entry from a header that was already read from the
+  // specified address, such as from a buffered read of a whole sector. Returns
+  // the same status codes as Read.
+  static Status FromHeader(FlashPartition& partition,
+                           Address address,
+                           const internal::EntryFormats& formats,
+                           const EntryHeader& header,
+                           Entry* entry);
+
   // Reads a key into a buffer, which must be at least key_length bytes.
   static Status ReadKey(FlashPartition& partition,
                         Address address,
@@ -67,9 +86,16 @@ class Entry {
                      const EntryFormat& format,
                      Key key,
                      std::span<const std::byte> value,
-                     uint32_t transaction_id) {
-    return Entry(
-        partition, address, format, key, value, value.size(), transaction_id);
+                     uint32_t transaction_id,
+                     BatchRole batch_role = BatchRole::kNone) {
+    return Entry(partition,
+                 address,
+                 format,
+                 key,
+                 value,
+                 value.size(),
+                 transaction_id,
+                 batch_role);
   }
 
   // Creates a new Entry for a tombstone entry, which marks a deleted key.
@@ -77,14 +103,16 @@ class Entry {
                          Address address,
                          const EntryFormat& format,
                          Key key,
-                         uint32_t transaction_id) {
+                         uint32_t transaction_id,
+                         BatchRole batch_role = BatchRole::kNone) {
     return Entry(partition,
                  address,
                  format,
                  key,
                  {},
                  kDeletedValueLength,
-                 transaction_id);
+                 transaction_id,
+                 batch_role);
   }
 
   Entry() = default;
@@ -102,6 +130,7 @@ class Entry {
   // Changes the format and transcation ID for this entry. In order to calculate
   // the new checksum, the entire entry is read into a small stack-allocated
   // buffer. The updated entry may be written to flash using the Copy function.
+  // The updated entry is no longer part of a batch.
   Status Update(const EntryFormat& new_format, uint32_t new_transaction_id);
 
   // Writes this entry at a new address. The key and value are read from the
@@ -128,6 +157,10 @@ class Entry {
 
   Status VerifyChecksumInFlash() const;
 
+  // Verifies the checksum against a copy of this entry's flash contents. The
+  // contents must be size() bytes read from the entry's address.
+  Status VerifyChecksumInBuffer(std::span<const std::byte> contents) const;
+
   // Calculates the total size of an entry, including padding.
   static size_t size(const FlashPartition& partition,
                      Key key,
@@ -147,11 +180,18 @@ class Entry {
   // The address at which the next possible entry could be located.
   Address next_address() const { return address() + size(); }
 
+  // The address of the first byte of the value.
+  Address value_address() const {
+    return address() + sizeof(EntryHeader) + key_length();
+  }
+
   // Total size of this entry, including padding.
   size_t size() const { return AlignUp(content_size(), alignment_bytes()); }
 
   // The length of the key in bytes. Keys are not null terminated.
-  size_t key_length() const { return header_.key_length_bytes; }
+  size_t key_length() const {
+    return header_.key_length_bytes & kKeyLengthMask;
+  }
 
   // The size of the value, without padding. The size is 0 if this is a
   // tombstone entry.
@@ -163,6 +203,10 @@ class Entry {
 
   uint32_t transaction_id() const { return header_.transaction_id; }
 
+  BatchRole batch_role() const {
+    return static_cast<BatchRole>(header_.key_length_bytes >> kBatchRoleShift);
+  }
+
   // True if this is a tombstone entry.
   bool deleted() const {
     return header_.value_size_bytes == kDeletedValueLength;
@@ -173,13 +217,17 @@ class Entry {
  private:
   static constexpr uint16_t kDeletedValueLength = 0xFFFF;
 
+  static constexpr uint8_t kKeyLengthMask = 0b111111;
+  static constexpr int kBatchRoleShift = 6;
+
   Entry(FlashPartition& partition,
         Address address,
         const EntryFormat& format,
         Key key,
         std::span<const std::byte> value,
         uint16_t value_size_bytes,
-        uint32_t transaction_id);
+        uint32_t transaction_id,
+        BatchRole batch_role);
 
   constexpr Entry(FlashPartition* partition,
                   Address address,
@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <span>
@@ -66,7 +67,8 @@ class EntryMetadata {
   void RemoveAddress(Address address_to_remove);
 
   // Resets the KeyDescrtiptor and addresses to refer to the provided
-  // KeyDescriptor and address.
+  // KeyDescriptor and address. The new KeyDescriptor must have the same key
+  // hash as the old one if the EntryCache uses a hash index.
   void Reset(const KeyDescriptor& descriptor, Address address);
 
  private:
@@ -144,15 +146,43 @@ class EntryCache {
   template <size_t kMaxEntries, size_t kRedundancy>
   using AddressList = Address[kMaxEntries * kRedundancy + kRedundancy];
 
+  // Slot in the optional open-addressing hash index. Each slot holds a
+  // descriptor index plus one; zero marks an empty slot.
+  using HashIndexSlot = uint16_t;
+
+  // The number of hash index slots to use for the specified number of entries.
+  // The table is a power of two at least twice as large as the entry count,
+  // which keeps linear probe sequences short and guarantees an empty slot.
+  static constexpr size_t HashIndexSize(size_t max_entries) {
+    if (max_entries == 0u) {
+      return 0;
+    }
+    size_t size = 1;
+    while (size < 2 * max_entries) {
+      size *= 2;
+    }
+    return size;
+  }
+
+  // The type to use for a hash index that supports the specified number of
+  // entries.
+  template <size_t kMaxEntries>
+  using HashIndex = std::array<HashIndexSlot, HashIndexSize(kMaxEntries)>;
+
+  // Creates an EntryCache. If hash_index is empty, lookups scan every
+  // KeyDescriptor. Otherwise, hash_index must be HashIndexSize(max_entries)
+  // slots and is used to find KeyDescriptors by key hash in constant time.
   constexpr EntryCache(Vector<KeyDescriptor>& descriptors,
                        Address* addresses,
-                       size_t redundancy)
+                       size_t redundancy,
+                       std::span<HashIndexSlot> hash_index = {})
       : descriptors_(descriptors),
         addresses_(addresses),
-        redundancy_(redundancy) {}
+        redundancy_(redundancy),
+        hash_index_(hash_index) {}
 
   // Clears all KeyDescriptors.
-  void Reset() const { descriptors_.clear(); }
+  void Reset() const;
 
   // Finds the metadata for an entry matching a particular key. Searches for a
   // KeyDescriptor that matches this key and sets *metadata to point to it if
@@ -205,6 +235,10 @@ class EntryCache {
   // The maximum number of entries supported by this EntryCache.
   size_t max_entries() const { return descriptors_.max_size(); }
 
+  // True if KeyDescriptors are found through the hash index rather than by
+  // scanning the descriptor list.
+  bool hash_indexed() const { return !hash_index_.empty(); }
+
   iterator begin() const { return {this, descriptors_.begin()}; }
   const_iterator cbegin() const { return {this, descriptors_.begin()}; }
 
@@ -214,6 +248,10 @@ class EntryCache {
  private:
   int FindIndex(uint32_t key_hash) const;
 
+  // Records the descriptor at the specified index in the hash index, if there
+  // is one. The descriptor's key hash must not already be in the index.
+  void AddToHashIndex(size_t descriptor_index) const;
+
   // Adds the address to the descriptor at the specified index if there is an
   // address slot available.
   void AddAddressIfRoom(size_t descriptor_index, Address address) const;
@@ -230,6 +268,11 @@ class EntryCache {
   Vector<KeyDescriptor>& descriptors_;
   FlashPartition::Address* const addresses_;
   const size_t redundancy_;
+
+  // Optional open-addressing (linear probing) table from key hash to
+  // descriptor. Descriptors are never removed individually, so the table only
+  // needs to support insertion and clearing.
+  const std::span<HashIndexSlot> hash_index_;
 };
 
 }  // namespace internal
@@ -0,0 +1,102 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "pw_kvs/key.h"
+#include "pw_metric/metric.h"
+
+namespace pw {
+namespace kvs {
+namespace internal {
+
+// Keeps copies of recently read values in RAM so that they can be read without
+// accessing flash. The data buffer is split evenly between the slots, and each
+// slot holds one key and its value. Values whose key and value do not fit in a
+// slot are not cached. When all slots are in use, the least recently used slot
+// is replaced.
+class ReadCache {
+ public:
+  struct Slot {
+    uint32_t key_hash;
+    uint32_t last_used;  // The value of use_count_ when last read or written.
+    uint16_t key_size;   // Zero for an empty slot; keys are never empty.
+    uint16_t value_size;
+  };
+
+  // The data buffer size to use for the specified slots.
+  static constexpr size_t DataSize(size_t slots, size_t slot_size_bytes) {
+    return slots * slot_size_bytes;
+  }
+
+  // Creates a ReadCache. The cache is disabled if slots is empty. The slots
+  // must be zero-initialized or cleared with Clear() before use.
+  ReadCache(std::span<Slot> slots, std::span<std::byte> data)
+      : slots_(slots), data_(data), use_count_(0) {}
+
+  ReadCache(const ReadCache&) = delete;
+  ReadCache& operator=(const ReadCache&) = delete;
+
+  // True if the cache has any slots.
+  bool enabled() const { return !slots_.empty(); }
+
+  // Finds the cached value for the key. Returns true and sets *value if the
+  // value is cached. Counts a hit or a miss if the cache is enabled.
+  bool Find(Key key, std::span<const std::byte>* value);
+
+  // Caches a copy of the key's value, replacing any value cached for the key.
+  // Does nothing if the key and value do not fit in a slot.
+  void Put(Key key, std::span<const std::byte> value);
+
+  // Removes the value for the key with this hash, if one is cached.
+  void Invalidate(uint32_t key_hash);
+
+  // Removes all cached values.
+  void Clear();
+
+  // Metrics with the number of lookups that were and were not served from the
+  // cache.
+  metric::Group& metrics() { return metrics_; }
+
+  uint32_t hits() const { return hits_.value(); }
+  uint32_t misses() const { return misses_.value(); }
+
+ private:
+  size_t slot_size_bytes() const { return data_.size() / slots_.size(); }
+
+  std::byte* slot_data(const Slot& slot) const {
+    return &data_[size_t(&slot - slots_.data()) * slot_size_bytes()];
+  }
+
+  Key slot_key(const Slot& slot) const {
+    return Key(reinterpret_cast<const char*>(slot_data(slot)), slot.key_size);
+  }
+
+  Slot* FindSlot(uint32_t key_hash) const;
+
+  const std::span<Slot> slots_;
+  const std::span<std::byte> data_;
+  uint32_t use_count_;
+
+  PW_METRIC_GROUP(metrics_, "kvs_read_cache");
+  PW_METRIC(metrics_, hits_, "hits", 0u);
+  PW_METRIC(metrics_, misses_, "misses", 0u);
+};
+
+}  // namespace internal
+}  // namespace kvs
+}  // namespace pw
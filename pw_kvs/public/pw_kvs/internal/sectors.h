@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <algorithm>
 #include <climits>
 #include <cstddef>
 #include <cstdint>
@@ -81,6 +82,19 @@ class SectorDescriptor {
     return sector_size_bytes - valid_bytes_ - writable_bytes();
   }
 
+  // The number of times the KVS erased this sector. Erase counts are kept in
+  // RAM, so they only include erases since the KVS object was created, unless
+  // they are restored from flash.
+  uint32_t erase_count() const { return erase_count_; }
+
+  void IncrementEraseCount() { erase_count_ += 1; }
+
+  // Restores an erase count that was stored in flash. Counts only increase, so
+  // a stored count lower than the current one is ignored.
+  void RestoreEraseCount(uint32_t erase_count) {
+    erase_count_ = std::max(erase_count_, erase_count);
+  }
+
   static constexpr size_t max_sector_size() { return kMaxSectorSize; }
 
  private:
@@ -90,10 +104,11 @@ class SectorDescriptor {
   static constexpr size_t kMaxSectorSize = UINT16_MAX - 1;
 
   explicit constexpr SectorDescriptor(uint16_t sector_size_bytes)
-      : tail_free_bytes_(sector_size_bytes), valid_bytes_(0) {}
+      : tail_free_bytes_(sector_size_bytes), valid_bytes_(0), erase_count_(0) {}
 
   uint16_t tail_free_bytes_;  // writable bytes at the end of the sector
   uint16_t valid_bytes_;      // sum of sizes of valid entries
+  uint32_t erase_count_;      // erases since created, or restored count
 };
 
 // Represents a list of sectors usable by the KVS.
@@ -109,12 +124,9 @@ class Sectors {
         last_new_(nullptr),
         temp_sectors_to_skip_(temp_sectors_to_skip) {}
 
-  // Resets the Sectors list. Must be called before using the object.
-  void Reset() {
-    last_new_ = descriptors_.begin();
-    descriptors_.assign(partition_.sector_count(),
-                        SectorDescriptor(partition_.sector_size_bytes()));
-  }
+  // Resets the Sectors list. Must be called before using the object. Sector
+  // erase counts are kept if the number of sectors is unchanged.
+  void Reset();
 
   // The last sector that was selected as the "new empty sector" to write to.
   // This last new sector is used as the starting point for the next "find a new
@@ -157,8 +169,9 @@ class Sectors {
   }
 
   // Finds either an existing sector with enough space that is not the sector to
-  // skip, or an empty sector. Maintains the invariant that there is always at
-  // least 1 empty sector. Addresses in reserved_addresses are avoided.
+  // skip, or an empty sector. Of the empty sectors, the least erased one is
+  // used. Maintains the invariant that there is always at least 1 empty sector.
+  // Addresses in reserved_addresses are avoided.
   Status FindSpace(SectorDescriptor** found_sector,
                    size_t size,
                    std::span<const Address> reserved_addresses) {
@@ -180,7 +193,9 @@ class Sectors {
   }
 
   // Finds a sector that is ready to be garbage collected. Returns nullptr if no
-  // sectors can / need to be garbage collected.
+  // sectors can / need to be garbage collected. Sectors that need no
+  // relocation are preferred, then the sector that recovers the most bytes per
+  // erase it has already had.
   SectorDescriptor* FindSectorToGarbageCollect(
       std::span<const Address> reserved_addresses) const;
 
@@ -16,9 +16,12 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <span>
 #include <type_traits>
 
+#include "pw_bytes/span.h"
+#include "pw_chrono/system_clock.h"
 #include "pw_containers/vector.h"
 #include "pw_kvs/checksum.h"
 #include "pw_kvs/flash_memory.h"
@@ -26,9 +29,11 @@
 #include "pw_kvs/internal/entry.h"
 #include "pw_kvs/internal/entry_cache.h"
 #include "pw_kvs/internal/key_descriptor.h"
+#include "pw_kvs/internal/read_cache.h"
 #include "pw_kvs/internal/sectors.h"
 #include "pw_kvs/internal/span_traits.h"
 #include "pw_kvs/key.h"
+#include "pw_result/result.h"
 #include "pw_status/status.h"
 #include "pw_status/status_with_size.h"
 
@@ -77,6 +82,13 @@ struct Options {
 
   // Verify an in-flash entry's checksum after writing it.
   bool verify_on_write = true;
+
+  // Store the sector erase counts in flash so that wear leveling accounts for
+  // erases from before the KVS was last initialized. The counts are kept in an
+  // entry with a key reserved for the KVS, so the flash format is unchanged.
+  // The entry is rewritten by the first Put, Delete, or Commit after sectors
+  // are erased, and when its own sector is garbage collected.
+  bool persist_erase_counts = false;
 };
 
 class KeyValueStore {
@@ -96,6 +108,17 @@ class KeyValueStore {
   //
   Status Init();
 
+  // Initializes the key-value store, reading flash in large bursts. Each sector
+  // is read into read_buffer in as few reads as possible and entries are parsed
+  // from RAM, rather than issuing several small reads per entry. This speeds up
+  // mounting large partitions when flash reads have a high per-call cost. A
+  // buffer of at least one sector gives one read per sector; smaller buffers
+  // still work, and entries that do not fit in the buffer are read from flash
+  // individually. The buffer is only used during this call.
+  //
+  // Returns the same status codes as Init().
+  Status Init(std::span<std::byte> read_buffer);
+
   bool initialized() const {
     return initialized_ == InitializationState::kReady;
   }
@@ -132,6 +155,21 @@ class KeyValueStore {
     return FixedSizeGet(key, pointer, sizeof(T));
   }
 
+  // Returns a view of the value in memory-mapped flash, without copying it.
+  // The value's checksum is always verified, regardless of verify_on_read. The
+  // view is only valid until the next operation that writes to the KVS (Put,
+  // Delete, Commit, maintenance or Init), since that may garbage collect the
+  // sector that holds the value.
+  //
+  //                    OK: the view refers to the value in flash
+  //             NOT_FOUND: the key is not present in the KVS
+  //             DATA_LOSS: found the entry, but the data was corrupted
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //      INVALID_ARGUMENT: key is empty or too long
+  //         UNIMPLEMENTED: the partition is not memory mapped
+  //
+  Result<ConstByteSpan> GetView(Key key) const;
+
   // Adds a key-value entry to the KVS. If the key was already present, its
   // value is overwritten.
   //
@@ -183,6 +221,113 @@ class KeyValueStore {
   //
   StatusWithSize ValueSize(Key key) const;
 
+  // A group of Put and Delete operations that are written to flash together by
+  // Commit(). Batches are declared as instances of
+  // KeyValueStore::BatchBuffer<kMaxOperations>.
+  //
+  // Keys and values are not copied; they must remain valid until the batch is
+  // committed or cleared. Staging a key that is already in the batch replaces
+  // the earlier operation for that key.
+  class Batch {
+   public:
+    Batch(const Batch&) = delete;
+    Batch& operator=(const Batch&) = delete;
+
+    // Stages a Put of a key-value entry. The value may be a std::span of bytes
+    // or a trivially copyable object, as with KeyValueStore::Put.
+    //
+    //                    OK: the operation was added to the batch
+    //    RESOURCE_EXHAUSTED: the batch is full
+    //        ALREADY_EXISTS: a different key with the same hash is in the batch
+    //      INVALID_ARGUMENT: key is empty or too long
+    //
+    template <typename T,
+              typename std::enable_if_t<ConvertsToSpan<T>::value>* = nullptr>
+    Status Put(const Key& key, const T& value) {
+      return Add(key,
+                 std::as_bytes(internal::make_span(value)),
+                 internal::EntryState::kValid);
+    }
+
+    template <typename T,
+              typename std::enable_if_t<!ConvertsToSpan<T>::value>* = nullptr>
+    Status Put(const Key& key, const T& value) {
+      CheckThatObjectCanBePutOrGet<T>();
+      return Add(key,
+                 std::as_bytes(std::span<const T>(&value, 1)),
+                 internal::EntryState::kValid);
+    }
+
+    // Stages a Delete of a key. Returns the same status codes as Put.
+    Status Delete(Key key) {
+      return Add(key, {}, internal::EntryState::kDeleted);
+    }
+
+    // Removes all staged operations.
+    void Clear() { operations_.clear(); }
+
+    size_t size() const { return operations_.size(); }
+
+    bool empty() const { return operations_.empty(); }
+
+   protected:
+    struct Operation {
+      Key key;
+      std::span<const std::byte> value;
+      internal::EntryState state;
+
+      // Set by Commit(): whether this operation changes the stored entry, and
+      // the size of the entry it replaces.
+      bool write;
+      size_t prior_size;
+    };
+
+    constexpr Batch(Vector<Operation>& operations) : operations_(operations) {}
+
+   private:
+    friend class KeyValueStore;
+
+    Status Add(Key key,
+               std::span<const std::byte> value,
+               internal::EntryState state);
+
+    Vector<Operation>& operations_;
+  };
+
+  template <size_t kMaxOperations>
+  class BatchBuffer : public Batch {
+   public:
+    BatchBuffer() : Batch(operations_) {}
+
+   private:
+    Vector<Operation, kMaxOperations> operations_;
+  };
+
+  // Writes all operations in the batch to flash. Space for the whole batch is
+  // found (garbage collecting if needed) before anything is written, and the
+  // entries are written back-to-back in one sector per redundant copy. After a
+  // reset or power loss, either all of the batch's operations are visible or
+  // none are. The batch is cleared if the commit succeeds.
+  //
+  // Entries written by a batch cannot be read by versions of pw_kvs that do
+  // not support batches.
+  //
+  //                    OK: the batch was committed, or it was empty
+  //             NOT_FOUND: a Delete is for a key that is not in the KVS
+  //             DATA_LOSS: checksum validation failed after writing the data
+  //    RESOURCE_EXHAUSTED: there is not enough space for the batch
+  //        ALREADY_EXISTS: a different key with the same hash as a staged key
+  //                        is already in the KVS
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //      INVALID_ARGUMENT: the batch's entries do not fit in one sector
+  //
+  // If a write fails, none of the batch's operations are applied and the KVS
+  // needs maintenance, which is done immediately unless the KVS is configured
+  // for manual recovery. As with Put, an entry whose write reported failure may
+  // still be intact in flash; if that is the commit entry, the next Init() or
+  // maintenance applies the whole batch.
+  Status Commit(Batch& batch);
+
   // Perform all maintenance possible, including all neeeded repairing of
   // corruption and garbage collection of reclaimable space in the KVS. When
   // configured for manual recovery, this (along with FullMaintenance) is the
@@ -211,6 +356,27 @@ class KeyValueStore {
   // that makes sense for the KVS implementation.
   Status PartialMaintenance();
 
+  // Performs one time-limited step of garbage collection. Garbage collecting a
+  // sector is split across calls: each call relocates valid entries out of the
+  // sector being collected until the budget is used up, and the sector is
+  // erased by the call that finds it empty. At least one entry is relocated per
+  // call, so a call may exceed a budget that is shorter than one relocation; a
+  // budget of zero relocates at most one entry per call.
+  // No new entries are written to a sector while it is being collected.
+  //
+  // Call MaintenanceStep repeatedly (for example, from a pw::work_queue
+  // WorkQueue) until it returns NOT_FOUND to keep free space available without
+  // garbage collecting in Put. Like PartialMaintenance, this repairs the KVS if
+  // errors were detected and the KVS is not configured for manual recovery;
+  // repair is not limited by the budget.
+  //
+  //                    OK: progress was made; call again to continue
+  //             NOT_FOUND: there is no reclaimable space to garbage collect
+  //   FAILED_PRECONDITION: the KVS is not initialized
+  //
+  // Other errors are from failed reads, writes or erases.
+  Status MaintenanceStep(chrono::SystemClock::duration budget);
+
   void LogDebugInfo() const;
 
   // Classes and functions to support STL-style iteration.
@@ -315,6 +481,12 @@ class KeyValueStore {
     size_t sector_erase_count;
     size_t corrupt_sectors_recovered;
     size_t missing_redundant_entries_recovered;
+
+    // The fewest and most times any one sector was erased. These count erases
+    // since the KVS was created, or since the flash was erased if
+    // persist_erase_counts is set.
+    size_t min_sector_erase_count;
+    size_t max_sector_erase_count;
   };
 
   StorageStats GetStorageStats() const;
@@ -324,6 +496,10 @@ class KeyValueStore {
 
   bool error_detected() const { return error_detected_; }
 
+  // Hit and miss counters for the read cache. The counters stay at zero if the
+  // KVS has no read cache.
+  metric::Group& read_cache_metrics() const { return read_cache_.metrics(); }
+
   // Maximum number of bytes allowed for a key-value combination.
   size_t max_key_value_size_bytes() const {
     return max_key_value_size_bytes(partition_.sector_size_bytes());
@@ -355,7 +531,10 @@ class KeyValueStore {
                 Vector<SectorDescriptor>& sector_descriptor_list,
                 const SectorDescriptor** temp_sectors_to_skip,
                 Vector<KeyDescriptor>& key_descriptor_list,
-                Address* addresses);
+                Address* addresses,
+                std::span<internal::EntryCache::HashIndexSlot> hash_index = {},
+                std::span<internal::ReadCache::Slot> read_cache_slots = {},
+                std::span<std::byte> read_cache_data = {});
 
  private:
   using EntryMetadata = internal::EntryMetadata;
@@ -371,8 +550,24 @@ class KeyValueStore {
         "std::as_writable_bytes(std::span(&value, 1)).");
   }
 
-  Status InitializeMetadata();
-  Status LoadEntry(Address entry_address, Address* next_entry_address);
+  // RAM copy of a region of a sector, used to parse entries during Init().
+  class ReadBurst;
+
+  // Tracks batch entries during Init() to find an incomplete batch.
+  class BatchTracker;
+
+  Status InitializeMetadata(ReadBurst* burst);
+  Status LoadEntries(ReadBurst* burst, BatchTracker& batches);
+  Status LoadEntry(BatchTracker& batches,
+                   Address entry_address,
+                   Address* next_entry_address);
+  Status LoadEntry(BatchTracker& batches,
+                   ReadBurst& burst,
+                   const SectorDescriptor& sector,
+                   Address entry_address,
+                   Address* next_entry_address);
+  Status AddLoadedEntry(BatchTracker& batches, const Entry& entry, Key key);
+  Status LoadEraseCounts(const Entry& entry);
   Status ScanForEntry(const SectorDescriptor& sector,
                       Address start_address,
                       Address* next_entry_address);
@@ -490,6 +685,13 @@ class KeyValueStore {
   Status GarbageCollectSector(SectorDescriptor& sector_to_gc,
                               std::span<const Address> reserved_addresses);
 
+  // Writes the erase counts entry. If sector_to_gc is not null, the entry is
+  // moved out of that sector as part of garbage collecting it.
+  Status WriteEraseCounts(const SectorDescriptor* sector_to_gc);
+
+  // Writes the erase counts entry if sectors were erased since it was written.
+  void StoreEraseCountsIfChanged();
+
   // Ensure that all entries are on the primary (first) format. Entries that are
   // not on the primary format are rewritten.
   //
@@ -513,6 +715,19 @@ class KeyValueStore {
                               std::span<const std::byte> value,
                               EntryState state);
 
+  internal::Entry CreateEntry(Address address,
+                              Key key,
+                              std::span<const std::byte> value,
+                              EntryState state,
+                              uint32_t transaction_id,
+                              Entry::BatchRole batch_role);
+
+  Status PrepareBatch(Batch& batch, size_t* batch_size_bytes);
+
+  Status WriteBatch(Batch& batch, uint32_t transaction_id);
+
+  void ApplyBatch(Batch& batch);
+
   void LogSectors() const;
   void LogKeyDescriptor() const;
 
@@ -522,8 +737,8 @@ class KeyValueStore {
   // List of sectors used by this KVS.
   internal::Sectors sectors_;
 
-  // Unordered list of KeyDescriptors. Finding a key requires scanning and
-  // verifying a match by reading the actual entry.
+  // Unordered list of KeyDescriptors. Finding a key requires scanning (or a
+  // hash index lookup) and verifying a match by reading the actual entry.
   internal::EntryCache entry_cache_;
 
   Options options_;
@@ -552,6 +767,9 @@ class KeyValueStore {
   // make it mutable.
   mutable bool error_detected_;
 
+  // Values read by Get are cached, so the read cache is also mutable.
+  mutable internal::ReadCache read_cache_;
+
   struct InternalStats {
     size_t sector_erase_count;
     size_t corrupt_sectors_recovered;
@@ -560,12 +778,46 @@ class KeyValueStore {
   InternalStats internal_stats_;
 
   uint32_t last_transaction_id_;
+
+  // The last new sector from before a batch that failed to write, or nullptr.
+  // Rolling the batch back restores it, since the sector of the newest
+  // remaining entry may differ from the sector that was last selected.
+  SectorDescriptor* rollback_last_new_;
+
+  // The newest erase counts entry in flash. Its size is counted as valid bytes
+  // if persist_erase_counts is set, and is zero if there is no such entry.
+  struct StoredEraseCounts {
+    Address address;
+    size_t size;
+    uint32_t transaction_id;
+  };
+  StoredEraseCounts stored_erase_counts_;
+
+  // Set when a sector is erased, until the erase counts are stored again.
+  bool erase_counts_changed_;
+
+  // The sector that MaintenanceStep is garbage collecting, or nullptr. Its
+  // writable bytes are set to zero so that no entries are added to it.
+  // GarbageCollectSector clears this when it finishes collecting the sector,
+  // whether it was called by MaintenanceStep or any other garbage collection.
+  SectorDescriptor* gc_sector_;
 };
 
+// If kHashIndex is true, the KVS allocates a hash index with
+// EntryCache::HashIndexSize(kMaxEntries) 16-bit slots (about 4 bytes per entry)
+// so that finding a key takes constant time instead of scanning every entry.
+// This is worthwhile for stores with more than a few dozen keys.
+//
+// If kReadCacheSlots is non-zero, Get serves recently read values from a RAM
+// cache of kReadCacheSlots slots of kReadCacheSlotBytes bytes. Each slot holds
+// one key and its value; larger keys and values are always read from flash.
 template <size_t kMaxEntries,
           size_t kMaxUsableSectors,
           size_t kRedundancy = 1,
-          size_t kEntryFormats = 1>
+          size_t kEntryFormats = 1,
+          bool kHashIndex = false,
+          size_t kReadCacheSlots = 0,
+          size_t kReadCacheSlotBytes = 32>
 class KeyValueStoreBuffer : public KeyValueStore {
  public:
   // Constructs a KeyValueStore on the partition, with support for one
@@ -594,7 +846,10 @@ class KeyValueStoreBuffer : public KeyValueStore {
                       sectors_,
                       temp_sectors_to_skip_,
                       key_descriptors_,
-                      addresses_) {
+                      addresses_,
+                      hash_index_,
+                      read_cache_slots_,
+                      read_cache_data_) {
     std::copy(formats.begin(), formats.end(), formats_.begin());
   }
 
@@ -603,6 +858,13 @@ class KeyValueStoreBuffer : public KeyValueStore {
   static_assert(kMaxUsableSectors > 0u);
   static_assert(kRedundancy > 0u);
   static_assert(kEntryFormats > 0u);
+  static_assert(!kHashIndex ||
+                    kMaxEntries <
+                        std::numeric_limits<
+                            internal::EntryCache::HashIndexSlot>::max(),
+                "kMaxEntries is too large for the hash index");
+  static_assert(kReadCacheSlots == 0u || kReadCacheSlotBytes > 0u);
+  static_assert(kReadCacheSlotBytes <= std::numeric_limits<uint16_t>::max());
 
   Vector<SectorDescriptor, kMaxUsableSectors> sectors_;
 
@@ -623,6 +885,17 @@ class KeyValueStoreBuffer : public KeyValueStore {
   // KeyDescriptors.
   internal::EntryCache::AddressList<kRedundancy, kMaxEntries> addresses_;
 
+  // Hash index for the EntryCache. Empty if kHashIndex is false.
+  internal::EntryCache::HashIndex<kHashIndex ? kMaxEntries : 0> hash_index_{};
+
+  // Slots and key/value storage for the read cache. Empty if kReadCacheSlots
+  // is zero.
+  std::array<internal::ReadCache::Slot, kReadCacheSlots> read_cache_slots_{};
+  std::array<std::byte,
+             internal::ReadCache::DataSize(kReadCacheSlots,
+                                           kReadCacheSlotBytes)>
+      read_cache_data_;
+
   // EntryFormats that can be read by this KeyValueStore.
   std::array<EntryFormat, kEntryFormats> formats_;
 };
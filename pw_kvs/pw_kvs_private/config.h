@@ -30,8 +30,16 @@
 static_assert((PW_KVS_MAX_FLASH_ALIGNMENT >= 16UL),
               "Max flash alignment is required to be at least 16");
 
+// The maximum number of sectors for which Options::persist_erase_counts stores
+// erase counts. Writing or loading the counts uses 4 bytes of stack per sector.
+#ifndef PW_KVS_MAX_STORED_ERASE_COUNTS
+#define PW_KVS_MAX_STORED_ERASE_COUNTS 64UL
+#endif  // PW_KVS_MAX_STORED_ERASE_COUNTS
+
 namespace pw::kvs {
 
 inline constexpr size_t kMaxFlashAlignment = PW_KVS_MAX_FLASH_ALIGNMENT;
 
+inline constexpr size_t kMaxStoredEraseCounts = PW_KVS_MAX_STORED_ERASE_COUNTS;
+
 }  // namespace pw::kvs
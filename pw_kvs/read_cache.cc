@@ -0,0 +1,93 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/internal/read_cache.h"
+
+#include <cstring>
+
+#include "pw_kvs/internal/hash.h"
+
+namespace pw::kvs::internal {
+
+bool ReadCache::Find(Key key, std::span<const std::byte>* value) {
+  if (!enabled()) {
+    return false;
+  }
+
+  Slot* slot = FindSlot(Hash(key));
+  if (slot == nullptr || key != slot_key(*slot)) {
+    misses_.Increment();
+    return false;
+  }
+
+  hits_.Increment();
+  slot->last_used = ++use_count_;
+  *value = std::span(slot_data(*slot) + slot->key_size, slot->value_size);
+  return true;
+}
+
+void ReadCache::Put(Key key, std::span<const std::byte> value) {
+  if (!enabled() || key.size() + value.size() > slot_size_bytes()) {
+    return;
+  }
+
+  const uint32_t key_hash = Hash(key);
+
+  // Reuse the key's slot, an empty slot, or the least recently used slot.
+  Slot* slot = FindSlot(key_hash);
+  if (slot == nullptr) {
+    slot = &slots_[0];
+    for (Slot& candidate : slots_) {
+      if (candidate.key_size == 0u) {
+        slot = &candidate;
+        break;
+      }
+      if (candidate.last_used < slot->last_used) {
+        slot = &candidate;
+      }
+    }
+  }
+
+  std::byte* data = slot_data(*slot);
+  std::memcpy(data, key.data(), key.size());
+  std::memcpy(data + key.size(), value.data(), value.size());
+
+  slot->key_hash = key_hash;
+  slot->last_used = ++use_count_;
+  slot->key_size = static_cast<uint16_t>(key.size());
+  slot->value_size = static_cast<uint16_t>(value.size());
+}
+
+void ReadCache::Invalidate(uint32_t key_hash) {
+  if (Slot* slot = FindSlot(key_hash); slot != nullptr) {
+    slot->key_size = 0;
+  }
+}
+
+void ReadCache::Clear() {
+  for (Slot& slot : slots_) {
+    slot = {};
+  }
+}
+
+ReadCache::Slot* ReadCache::FindSlot(uint32_t key_hash) const {
+  for (Slot& slot : slots_) {
+    if (slot.key_size != 0u && slot.key_hash == key_hash) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace pw::kvs::internal
@@ -0,0 +1,120 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_kvs/internal/read_cache.h"
+
+#include <array>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/array.h"
+#include "pw_kvs/internal/hash.h"
+
+namespace pw::kvs::internal {
+namespace {
+
+constexpr size_t kSlots = 2;
+constexpr size_t kSlotSizeBytes = 16;
+
+constexpr auto kValue1 = bytes::Array<1, 2, 3, 4>();
+constexpr auto kValue2 = bytes::Array<5, 6>();
+
+class ReadCacheTest : public ::testing::Test {
+ protected:
+  ReadCacheTest() : cache_(slots_, data_) {}
+
+  bool FindValue(Key key, std::span<const std::byte> expected) {
+    std::span<const std::byte> value;
+    return cache_.Find(key, &value) && value.size() == expected.size() &&
+           std::memcmp(value.data(), expected.data(), value.size()) == 0;
+  }
+
+  std::array<ReadCache::Slot, kSlots> slots_{};
+  std::array<std::byte, ReadCache::DataSize(kSlots, kSlotSizeBytes)> data_;
+  ReadCache cache_;
+};
+
+TEST_F(ReadCacheTest, Find_Empty_Miss) {
+  std::span<const std::byte> value;
+  EXPECT_FALSE(cache_.Find("key", &value));
+  EXPECT_EQ(0u, cache_.hits());
+  EXPECT_EQ(1u, cache_.misses());
+}
+
+TEST_F(ReadCacheTest, Put_ThenFind_Hit) {
+  cache_.Put("key", kValue1);
+  EXPECT_TRUE(FindValue("key", kValue1));
+  EXPECT_EQ(1u, cache_.hits());
+  EXPECT_EQ(0u, cache_.misses());
+}
+
+TEST_F(ReadCacheTest, Put_SameKey_ReplacesValue) {
+  cache_.Put("key", kValue1);
+  cache_.Put("key", kValue2);
+  EXPECT_TRUE(FindValue("key", kValue2));
+}
+
+TEST_F(ReadCacheTest, Put_KeyAndValueLargerThanSlot_NotCached) {
+  constexpr auto kLargeValue = bytes::Initialized<kSlotSizeBytes>(0x5a);
+  cache_.Put("key", kLargeValue);
+
+  std::span<const std::byte> value;
+  EXPECT_FALSE(cache_.Find("key", &value));
+}
+
+TEST_F(ReadCacheTest, Put_Full_ReplacesLeastRecentlyUsed) {
+  cache_.Put("key1", kValue1);
+  cache_.Put("key2", kValue2);
+  EXPECT_TRUE(FindValue("key1", kValue1));
+
+  cache_.Put("key3", kValue2);
+  EXPECT_TRUE(FindValue("key1", kValue1));
+  EXPECT_TRUE(FindValue("key3", kValue2));
+
+  std::span<const std::byte> value;
+  EXPECT_FALSE(cache_.Find("key2", &value));
+}
+
+TEST_F(ReadCacheTest, Invalidate_RemovesOnlyThatKey) {
+  cache_.Put("key1", kValue1);
+  cache_.Put("key2", kValue2);
+  cache_.Invalidate(Hash("key1"));
+
+  std::span<const std::byte> value;
+  EXPECT_FALSE(cache_.Find("key1", &value));
+  EXPECT_TRUE(FindValue("key2", kValue2));
+}
+
+TEST_F(ReadCacheTest, Clear_RemovesAllKeys) {
+  cache_.Put("key1", kValue1);
+  cache_.Put("key2", kValue2);
+  cache_.Clear();
+
+  std::span<const std::byte> value;
+  EXPECT_FALSE(cache_.Find("key1", &value));
+  EXPECT_FALSE(cache_.Find("key2", &value));
+}
+
+TEST(ReadCache, NoSlots_Disabled) {
+  ReadCache cache({}, {});
+  EXPECT_FALSE(cache.enabled());
+
+  cache.Put("key", kValue1);
+  std::span<const std::byte> value;
+  EXPECT_FALSE(cache.Find("key", &value));
+  EXPECT_EQ(0u, cache.misses());
+}
+
+}  // namespace
+}  // namespace pw::kvs::internal
@@ -31,14 +31,40 @@ bool Contains(const Container& container, const T& value) {
          std::end(container);
 }
 
+// Returns true if garbage collecting sector a recovers more bytes per erase
+// than sector b. The erase counts are offset by one so that sectors that have
+// never been erased compare by recoverable bytes.
+bool MoreRecoverableBytesPerErase(const SectorDescriptor& a,
+                                  const SectorDescriptor& b,
+                                  size_t sector_size_bytes) {
+  return uint64_t(a.RecoverableBytes(sector_size_bytes)) *
+             (uint64_t(b.erase_count()) + 1) >
+         uint64_t(b.RecoverableBytes(sector_size_bytes)) *
+             (uint64_t(a.erase_count()) + 1);
+}
+
 }  // namespace
 
+void Sectors::Reset() {
+  last_new_ = descriptors_.begin();
+
+  if (descriptors_.size() == partition_.sector_count()) {
+    for (SectorDescriptor& sector : descriptors_) {
+      sector.tail_free_bytes_ = partition_.sector_size_bytes();
+      sector.valid_bytes_ = 0;
+    }
+  } else {
+    descriptors_.assign(partition_.sector_count(),
+                        SectorDescriptor(partition_.sector_size_bytes()));
+  }
+}
+
 Status Sectors::Find(FindMode find_mode,
                      SectorDescriptor** found_sector,
                      size_t size,
                      std::span<const Address> addresses_to_skip,
                      std::span<const Address> reserved_addresses) {
-  SectorDescriptor* first_empty_sector = nullptr;
+  SectorDescriptor* least_erased_empty_sector = nullptr;
   bool at_least_two_empty_sectors = (find_mode == kGarbageCollect);
 
   // Used for the GC reclaimable bytes check
@@ -88,8 +114,9 @@ Status Sectors::Find(FindMode find_mode,
   // sector that is found.
   //
   // Tier 2 is find sectors that are empty/erased. While scanning for a partial
-  // sector, keep track of the first empty sector and if a second empty sector
-  // was seen. If during GC then count the second empty sector as always seen.
+  // sector, keep track of the least erased empty sector (the first one found if
+  // several are tied) and if a second empty sector was seen. If during GC then
+  // count the second empty sector as always seen.
   //
   // Tier 3 is during garbage collection, find sectors with enough space that
   // are not empty but have recoverable bytes. Pick the sector with the least
@@ -122,23 +149,26 @@ Status Sectors::Find(FindMode find_mode,
     }
 
     if (sector->Empty(sector_size_bytes)) {
-      if (first_empty_sector == nullptr) {
-        first_empty_sector = sector;
+      if (least_erased_empty_sector == nullptr) {
+        least_erased_empty_sector = sector;
       } else {
         at_least_two_empty_sectors = true;
+        if (sector->erase_count() < least_erased_empty_sector->erase_count()) {
+          least_erased_empty_sector = sector;
+        }
       }
     }
   }
 
   // Tier 2 check: If the scan for a partial sector does not find a suitable
-  // sector, use the first empty sector that was found. Normally it is required
-  // to keep 1 empty sector after the sector found here, but that rule does not
-  // apply during GC.
-  if (first_empty_sector != nullptr && at_least_two_empty_sectors) {
-    DBG("  Found a usable empty sector; returning the first found (%u)",
-        Index(first_empty_sector));
-    last_new_ = first_empty_sector;
-    *found_sector = first_empty_sector;
+  // sector, use the least erased empty sector that was found. Normally it is
+  // required to keep 1 empty sector after the sector found here, but that rule
+  // does not apply during GC.
+  if (least_erased_empty_sector != nullptr && at_least_two_empty_sectors) {
+    DBG("  Found a usable empty sector; returning the least erased (%u)",
+        Index(least_erased_empty_sector));
+    last_new_ = least_erased_empty_sector;
+    *found_sector = least_erased_empty_sector;
     return OkStatus();
   }
 
@@ -178,29 +208,34 @@ SectorDescriptor* Sectors::FindSectorToGarbageCollect(
                                   reserved_addresses.size());
 
   // Step 1: Try to find a sectors with stale keys and no valid keys (no
-  // relocation needed). Use the first such sector found, as that will help the
-  // KVS "rotate" around the partition. Initially this would select the sector
-  // with the most reclaimable space, but that can cause GC sector selection to
-  // "ping-pong" between two sectors when updating large keys.
+  // relocation needed). Use the least erased such sector, or the first one
+  // found if several are tied, as that will help the KVS "rotate" around the
+  // partition. Initially this would select the sector with the most
+  // reclaimable space, but that can cause GC sector selection to "ping-pong"
+  // between two sectors when updating large keys.
   for (size_t i = 0; i < descriptors_.size(); ++i) {
     SectorDescriptor& sector = WearLeveledSectorFromIndex(i);
     if ((sector.valid_bytes() == 0) &&
         (sector.RecoverableBytes(sector_size_bytes) > 0) &&
-        !Contains(sectors_to_skip, &sector)) {
+        !Contains(sectors_to_skip, &sector) &&
+        (sector_candidate == nullptr ||
+         sector.erase_count() < sector_candidate->erase_count())) {
       sector_candidate = &sector;
-      break;
     }
   }
 
-  // Step 2: If step 1 yields no sectors, just find the sector with the most
-  // reclaimable bytes but no addresses to avoid.
+  // Step 2: If step 1 yields no sectors, find the sector with the most
+  // reclaimable bytes per erase it has already had, but no addresses to avoid.
+  // This reclaims space from lightly worn sectors first.
   if (sector_candidate == nullptr) {
     for (size_t i = 0; i < descriptors_.size(); ++i) {
       SectorDescriptor& sector = WearLeveledSectorFromIndex(i);
-      if ((sector.RecoverableBytes(sector_size_bytes) > candidate_bytes) &&
-          !Contains(sectors_to_skip, &sector)) {
+      if ((sector.RecoverableBytes(sector_size_bytes) > 0) &&
+          !Contains(sectors_to_skip, &sector) &&
+          (sector_candidate == nullptr ||
+           MoreRecoverableBytesPerErase(
+               sector, *sector_candidate, sector_size_bytes))) {
         sector_candidate = &sector;
-        candidate_bytes = sector.RecoverableBytes(sector_size_bytes);
       }
     }
   }
@@ -0,0 +1,334 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+#include "gtest/gtest.h"
+#include "pw_bytes/span.h"
+#include "pw_protobuf/encoder.h"
+#include "pw_stream/memory_stream.h"
+
+// Tests for the message structs and the table-driven encoder and decoder. The
+// capacities of the struct members are set in message_struct.options.
+#include "pw_protobuf_test_protos/message_struct.pwpb.h"
+
+namespace pw::protobuf {
+namespace {
+
+using namespace pw::protobuf::test;
+
+std::string_view ToString(const Vector<char>& value) {
+  return std::string_view(value.data(), value.size());
+}
+
+Scalars::Message MakeScalars() {
+  Scalars::Message message;
+  message.double_value = -2.5;
+  message.float_value = 1.25f;
+  message.int32_value = -1000;
+  message.sint32_value = -77;
+  message.sfixed32_value = -123456;
+  message.int64_value = -1'000'000'000'000;
+  message.sint64_value = 5'000'000'000;
+  message.sfixed64_value = -6;
+  message.uint32_value = 0xFFFFFFFFu;
+  message.fixed32_value = 0x12345678u;
+  message.uint64_value = 0xFFFFFFFFFFFFFFFFu;
+  message.fixed64_value = 0x123456789ABCDEFu;
+  message.bool_value = true;
+  message.color = Color::BLUE;
+  return message;
+}
+
+void ExpectScalarsEqual(const Scalars::Message& expected,
+                        const Scalars::Message& actual) {
+  EXPECT_EQ(expected.double_value, actual.double_value);
+  EXPECT_EQ(expected.float_value, actual.float_value);
+  EXPECT_EQ(expected.int32_value, actual.int32_value);
+  EXPECT_EQ(expected.sint32_value, actual.sint32_value);
+  EXPECT_EQ(expected.sfixed32_value, actual.sfixed32_value);
+  EXPECT_EQ(expected.int64_value, actual.int64_value);
+  EXPECT_EQ(expected.sint64_value, actual.sint64_value);
+  EXPECT_EQ(expected.sfixed64_value, actual.sfixed64_value);
+  EXPECT_EQ(expected.uint32_value, actual.uint32_value);
+  EXPECT_EQ(expected.fixed32_value, actual.fixed32_value);
+  EXPECT_EQ(expected.uint64_value, actual.uint64_value);
+  EXPECT_EQ(expected.fixed64_value, actual.fixed64_value);
+  EXPECT_EQ(expected.bool_value, actual.bool_value);
+  EXPECT_EQ(expected.color, actual.color);
+}
+
+TEST(CodegenStruct, Scalars_MatchesFieldMethods) {
+  const Scalars::Message message = MakeScalars();
+
+  std::byte struct_buffer[128];
+  Scalars::MemoryEncoder struct_encoder(struct_buffer);
+  ASSERT_EQ(struct_encoder.Write(message), OkStatus());
+
+  std::byte field_buffer[128];
+  Scalars::MemoryEncoder field_encoder(field_buffer);
+  field_encoder.WriteDoubleValue(message.double_value).IgnoreError();
+  field_encoder.WriteFloatValue(message.float_value).IgnoreError();
+  field_encoder.WriteInt32Value(message.int32_value).IgnoreError();
+  field_encoder.WriteSint32Value(message.sint32_value).IgnoreError();
+  field_encoder.WriteSfixed32Value(message.sfixed32_value).IgnoreError();
+  field_encoder.WriteInt64Value(message.int64_value).IgnoreError();
+  field_encoder.WriteSint64Value(message.sint64_value).IgnoreError();
+  field_encoder.WriteSfixed64Value(message.sfixed64_value).IgnoreError();
+  field_encoder.WriteUint32Value(message.uint32_value).IgnoreError();
+  field_encoder.WriteFixed32Value(message.fixed32_value).IgnoreError();
+  field_encoder.WriteUint64Value(message.uint64_value).IgnoreError();
+  field_encoder.WriteFixed64Value(message.fixed64_value).IgnoreError();
+  field_encoder.WriteBoolValue(message.bool_value).IgnoreError();
+  field_encoder.WriteColor(message.color).IgnoreError();
+  ASSERT_EQ(field_encoder.status(), OkStatus());
+
+  ASSERT_EQ(struct_encoder.size(), field_encoder.size());
+  EXPECT_EQ(std::memcmp(struct_buffer, field_buffer, field_encoder.size()), 0);
+}
+
+TEST(CodegenStruct, Scalars_RoundTrip) {
+  const Scalars::Message expected = MakeScalars();
+
+  std::byte buffer[128];
+  Scalars::MemoryEncoder encoder(buffer);
+  ASSERT_EQ(encoder.Write(expected), OkStatus());
+
+  stream::MemoryReader reader(std::span(buffer, encoder.size()));
+  Scalars::StreamDecoder decoder(reader);
+  Scalars::Message actual{};
+  ASSERT_EQ(decoder.Read(actual), OkStatus());
+
+  ExpectScalarsEqual(expected, actual);
+}
+
+TEST(CodegenStruct, Scalars_DefaultValuesNotEncoded) {
+  std::byte buffer[128];
+  Scalars::MemoryEncoder encoder(buffer);
+  ASSERT_EQ(encoder.Write(Scalars::Message{}), OkStatus());
+  EXPECT_EQ(encoder.size(), 0u);
+
+  // -0.0 is not the default value.
+  Scalars::Message message{};
+  message.double_value = -0.0;
+  ASSERT_EQ(encoder.Write(message), OkStatus());
+  EXPECT_EQ(encoder.size(), 1u + sizeof(double));
+}
+
+TEST(CodegenStruct, Lists_RoundTrip) {
+  Lists::Message expected{};
+  expected.uint32s = {1, 300, 0xFFFFFFFFu};
+  expected.sint64s = {-1, 0, 1, -5'000'000'000};
+  expected.fixed32s = {7, 8};
+  expected.doubles = {0.5, -0.25};
+  expected.bools = {true, false, true};
+  expected.colors = {static_cast<int32_t>(Color::GREEN),
+                     static_cast<int32_t>(Color::RED),
+                     static_cast<int32_t>(Color::BLUE)};
+
+  std::byte buffer[256];
+  Lists::MemoryEncoder encoder(buffer);
+  ASSERT_EQ(encoder.Write(expected), OkStatus());
+
+  stream::MemoryReader reader(std::span(buffer, encoder.size()));
+  Lists::StreamDecoder decoder(reader);
+  Lists::Message actual{};
+  ASSERT_EQ(decoder.Read(actual), OkStatus());
+
+  EXPECT_EQ(expected.uint32s, actual.uint32s);
+  EXPECT_EQ(expected.sint64s, actual.sint64s);
+  EXPECT_EQ(expected.fixed32s, actual.fixed32s);
+  EXPECT_EQ(expected.doubles, actual.doubles);
+  EXPECT_EQ(expected.bools, actual.bools);
+  EXPECT_EQ(expected.colors, actual.colors);
+}
+
+TEST(CodegenStruct, Lists_UnpackedAndPacked) {
+  std::byte buffer[64];
+  Lists::MemoryEncoder encoder(buffer);
+  encoder.WriteUint32s(1).IgnoreError();
+  const uint32_t packed[] = {2, 3};
+  encoder.WriteUint32s(packed).IgnoreError();
+  encoder.WriteUint32s(4).IgnoreError();
+  encoder.WriteBools(true).IgnoreError();
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  stream::MemoryReader reader(std::span(buffer, encoder.size()));
+  Lists::StreamDecoder decoder(reader);
+  Lists::Message message{};
+  ASSERT_EQ(decoder.Read(message), OkStatus());
+
+  constexpr uint32_t kExpected[] = {1, 2, 3, 4};
+  ASSERT_EQ(message.uint32s.size(), std::size(kExpected));
+  for (size_t i = 0; i < std::size(kExpected); ++i) {
+    EXPECT_EQ(message.uint32s[i], kExpected[i]);
+  }
+  ASSERT_EQ(message.bools.size(), 1u);
+  EXPECT_TRUE(message.bools[0]);
+}
+
+TEST(CodegenStruct, Lists_TooManyValues) {
+  std::array<uint32_t, 8> values = {};
+  std::byte buffer[64];
+  Lists::MemoryEncoder encoder(buffer);
+  ASSERT_EQ(encoder.WriteUint32s(1), OkStatus());
+  ASSERT_EQ(encoder.WriteUint32s(values), OkStatus());
+
+  stream::MemoryReader reader(std::span(buffer, encoder.size()));
+  Lists::StreamDecoder decoder(reader);
+  Lists::Message message{};
+  EXPECT_EQ(decoder.Read(message), Status::ResourceExhausted());
+
+  // None of the packed values that didn't fit are kept.
+  ASSERT_EQ(message.uint32s.size(), 1u);
+  EXPECT_EQ(message.uint32s[0], 1u);
+}
+
+TEST(CodegenStruct, Lists_UnboundedFieldSkipped) {
+  std::byte buffer[64];
+  Lists::MemoryEncoder encoder(buffer);
+  const uint32_t unbounded[] = {1, 2, 3};
+  encoder.WriteUnbounded(unbounded).IgnoreError();
+  encoder.WriteFixed32s(99).IgnoreError();
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  stream::MemoryReader reader(std::span(buffer, encoder.size()));
+  Lists::StreamDecoder decoder(reader);
+  Lists::Message message{};
+  ASSERT_EQ(decoder.Read(message), OkStatus());
+  ASSERT_EQ(message.fixed32s.size(), 1u);
+  EXPECT_EQ(message.fixed32s[0], 99u);
+}
+
+TEST(CodegenStruct, Device_RoundTrip) {
+  Device::Message expected{};
+  expected.id = 42;
+  expected.name = {'p', 'i', 'g', 'w', 'e', 'e', 'd'};
+  expected.serial = {std::byte{0xde}, std::byte{0xad}};
+  expected.scalars = MakeScalars();
+  expected.lists.uint32s = {5, 6};
+  expected.boot_time.seconds = 1634342400;
+  expected.boot_time.nanoseconds = 500;
+
+  std::byte buffer[256];
+  Device::MemoryEncoder encoder(buffer);
+  ASSERT_EQ(encoder.Write(expected), OkStatus());
+
+  stream::MemoryReader reader(std::span(buffer, encoder.size()));
+  Device::StreamDecoder decoder(reader);
+  Device::Message actual{};
+  ASSERT_EQ(decoder.Read(actual), OkStatus());
+
+  EXPECT_EQ(actual.id, 42u);
+  EXPECT_EQ(ToString(actual.name), "pigweed");
+  EXPECT_EQ(expected.serial, actual.serial);
+  ExpectScalarsEqual(expected.scalars, actual.scalars);
+  EXPECT_EQ(expected.lists.uint32s, actual.lists.uint32s);
+  EXPECT_EQ(actual.boot_time.seconds, 1634342400u);
+  EXPECT_EQ(actual.boot_time.nanoseconds, 500u);
+}
+
+TEST(CodegenStruct, Device_DefaultNestedMessagesNotEncoded) {
+  std::byte buffer[64];
+  Device::MemoryEncoder encoder(buffer);
+  ASSERT_EQ(encoder.Write(Device::Message{}), OkStatus());
+  EXPECT_EQ(encoder.size(), 0u);
+
+  // Only the nested message with a non-default field is written.
+  Device::Message message{};
+  message.scalars.bool_value = true;
+  ASSERT_EQ(encoder.Write(message), OkStatus());
+
+  Device::MemoryEncoder field_encoder(ByteSpan(buffer).subspan(32));
+  {
+    Scalars::StreamEncoder scalars = field_encoder.GetScalarsEncoder();
+    scalars.WriteBoolValue(true).IgnoreError();
+  }
+  ASSERT_EQ(field_encoder.status(), OkStatus());
+  ASSERT_EQ(encoder.size(), field_encoder.size());
+  EXPECT_EQ(std::memcmp(buffer, buffer + 32, encoder.size()), 0);
+}
+
+TEST(CodegenStruct, Device_FieldsOutOfOrderAndUnknown) {
+  std::byte buffer[256];
+  Device::MemoryEncoder encoder(buffer);
+  encoder.WriteId(7).IgnoreError();
+  encoder.WriteDescription("not in the struct").IgnoreError();
+  {
+    Device::StreamEncoder child = encoder.GetChildrenEncoder();
+    child.WriteName("child").IgnoreError();
+  }
+  {
+    Device::StreamEncoder parent = encoder.GetParentEncoder();
+    parent.WriteId(1).IgnoreError();
+  }
+  encoder.WriteName("device").IgnoreError();
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  stream::MemoryReader reader(std::span(buffer, encoder.size()));
+  Device::StreamDecoder decoder(reader);
+  Device::Message message{};
+  ASSERT_EQ(decoder.Read(message), OkStatus());
+  EXPECT_EQ(message.id, 7u);
+  EXPECT_EQ(ToString(message.name), "device");
+}
+
+TEST(CodegenStruct, Device_MergesIntoExistingValues) {
+  std::byte buffer[64];
+  Device::MemoryEncoder encoder(buffer);
+  encoder.WriteName("new").IgnoreError();
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  stream::MemoryReader reader(std::span(buffer, encoder.size()));
+  Device::StreamDecoder decoder(reader);
+  Device::Message message{};
+  message.id = 3;
+  message.name = {'o', 'l', 'd', '!'};
+  ASSERT_EQ(decoder.Read(message), OkStatus());
+  EXPECT_EQ(message.id, 3u);
+  EXPECT_EQ(ToString(message.name), "new");
+}
+
+TEST(CodegenStruct, Device_StringTooLong) {
+  std::byte buffer[64];
+  Device::MemoryEncoder encoder(buffer);
+  encoder.WriteName("this name is too long").IgnoreError();
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  stream::MemoryReader reader(std::span(buffer, encoder.size()));
+  Device::StreamDecoder decoder(reader);
+  Device::Message message{};
+  EXPECT_EQ(decoder.Read(message), Status::ResourceExhausted());
+}
+
+TEST(CodegenStruct, Device_WrongWireType) {
+  std::byte buffer[64];
+  Device::MemoryEncoder encoder(buffer);
+  encoder.WriteFixed32(static_cast<uint32_t>(Device::Fields::ID), 1)
+      .IgnoreError();
+  ASSERT_EQ(encoder.status(), OkStatus());
+
+  stream::MemoryReader reader(std::span(buffer, encoder.size()));
+  Device::StreamDecoder decoder(reader);
+  Device::Message message{};
+  EXPECT_EQ(decoder.Read(message), Status::DataLoss());
+}
+
+}  // namespace
+}  // namespace pw::protobuf
@@ -14,12 +14,14 @@
 
 #include "pw_protobuf/encoder.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 #include <span>
 
 #include "pw_assert/check.h"
 #include "pw_bytes/span.h"
+#include "pw_containers/vector.h"
 #include "pw_protobuf/serialized_size.h"
 #include "pw_protobuf/wire_format.h"
 #include "pw_status/status.h"
@@ -29,6 +31,77 @@
 #include "pw_varint/varint.h"
 
 namespace pw::protobuf {
+namespace {
+
+using internal::FieldType;
+using internal::MessageField;
+
+// Returns the member of a generated message struct that a field describes.
+template <typename T>
+const T& Member(std::span<const std::byte> message, const MessageField& field) {
+  return *reinterpret_cast<const T*>(message.data() + field.offset);
+}
+
+// Returns the contents of a string, bytes, or repeated field's
+// pw::Vector<T, kMaxSize>, which the table accesses through its size-agnostic
+// pw::Vector<T> base. The accessor takes a non-const message but the vector is
+// only read here.
+template <typename T>
+std::span<const T> RepeatedMember(std::span<const std::byte> message,
+                                  const MessageField& field) {
+  const Vector<T>& values = *static_cast<const Vector<T>*>(
+      field.vector(const_cast<std::byte*>(message.data())));
+  return std::span(values.data(), values.size());
+}
+
+// Returns the value of an enum member, which is a generated enum class with
+// int32_t as its underlying type.
+int32_t EnumMember(std::span<const std::byte> message,
+                   const MessageField& field) {
+  int32_t value;
+  std::memcpy(&value, message.data() + field.offset, sizeof(value));
+  return value;
+}
+
+// Returns the size of a scalar field's member, or 0 for other fields.
+constexpr size_t ScalarSize(FieldType type) {
+  switch (type) {
+    case FieldType::kDouble:
+    case FieldType::kInt64:
+    case FieldType::kSint64:
+    case FieldType::kSfixed64:
+    case FieldType::kUint64:
+    case FieldType::kFixed64:
+      return sizeof(uint64_t);
+    case FieldType::kFloat:
+    case FieldType::kInt32:
+    case FieldType::kSint32:
+    case FieldType::kSfixed32:
+    case FieldType::kUint32:
+    case FieldType::kFixed32:
+    case FieldType::kEnum:
+      return sizeof(uint32_t);
+    case FieldType::kBool:
+      return sizeof(bool);
+    case FieldType::kString:
+    case FieldType::kBytes:
+    case FieldType::kMessage:
+      break;
+  }
+  return 0;
+}
+
+// Checks whether a scalar holds its default value. The representation is
+// compared so that -0.0 is not treated as the default.
+bool IsDefaultScalar(std::span<const std::byte> message,
+                     const MessageField& field) {
+  const std::byte* member = message.data() + field.offset;
+  return std::all_of(member, member + ScalarSize(field.type), [](std::byte b) {
+    return b == std::byte{0};
+  });
+}
+
+}  // namespace
 
 StreamEncoder StreamEncoder::GetNestedEncoder(uint32_t field_number) {
   PW_CHECK(!nested_encoder_open());
@@ -108,6 +181,18 @@ void StreamEncoder::CloseNestedMessage(StreamEncoder& nested) {
                                       nested.memory_writer_.WrittenData());
 }
 
+void StreamEncoder::DiscardNestedMessage(StreamEncoder& nested) {
+  PW_DCHECK_PTR_EQ(nested.parent_,
+                   this,
+                   "DiscardNestedMessage() called on the wrong Encoder parent");
+
+  // As in CloseNestedMessage(), block further writes to the nested encoder,
+  // which also keeps its destructor from closing it again.
+  nested.nested_field_number_ = kFirstReservedNumber;
+  nested.parent_ = nullptr;
+  nested_field_number_ = 0;
+}
+
 Status StreamEncoder::WriteVarintField(uint32_t field_number, uint64_t value) {
   PW_TRY(UpdateStatusForWrite(
       field_number, WireType::kVarint, varint::EncodedSize(value)));
@@ -208,6 +293,136 @@ Status StreamEncoder::WritePackedFixed(uint32_t field_number,
   return status_;
 }
 
+Status StreamEncoder::Write(std::span<const std::byte> message,
+                            std::span<const MessageField> fields) {
+  for (const MessageField& field : fields) {
+    if (field.repeated) {
+      PW_TRY(WriteRepeatedStructField(message, field));
+    } else {
+      PW_TRY(WriteStructField(message, field));
+    }
+  }
+  return status_;
+}
+
+Status StreamEncoder::WriteStructField(std::span<const std::byte> message,
+                                       const MessageField& field) {
+  const uint32_t number = field.field_number;
+
+  if (ScalarSize(field.type) != 0 && IsDefaultScalar(message, field)) {
+    return status_;
+  }
+
+  switch (field.type) {
+    case FieldType::kDouble:
+      return WriteDouble(number, Member<double>(message, field));
+    case FieldType::kFloat:
+      return WriteFloat(number, Member<float>(message, field));
+    case FieldType::kInt32:
+      return WriteInt32(number, Member<int32_t>(message, field));
+    case FieldType::kEnum:
+      return WriteInt32(number, EnumMember(message, field));
+    case FieldType::kSint32:
+      return WriteSint32(number, Member<int32_t>(message, field));
+    case FieldType::kSfixed32:
+      return WriteSfixed32(number, Member<int32_t>(message, field));
+    case FieldType::kInt64:
+      return WriteInt64(number, Member<int64_t>(message, field));
+    case FieldType::kSint64:
+      return WriteSint64(number, Member<int64_t>(message, field));
+    case FieldType::kSfixed64:
+      return WriteSfixed64(number, Member<int64_t>(message, field));
+    case FieldType::kUint32:
+      return WriteUint32(number, Member<uint32_t>(message, field));
+    case FieldType::kFixed32:
+      return WriteFixed32(number, Member<uint32_t>(message, field));
+    case FieldType::kUint64:
+      return WriteUint64(number, Member<uint64_t>(message, field));
+    case FieldType::kFixed64:
+      return WriteFixed64(number, Member<uint64_t>(message, field));
+    case FieldType::kBool:
+      return WriteBool(number, Member<bool>(message, field));
+    case FieldType::kString: {
+      const std::span<const char> value = RepeatedMember<char>(message, field);
+      return value.empty() ? status_
+                           : WriteString(number, value.data(), value.size());
+    }
+    case FieldType::kBytes: {
+      const ConstByteSpan value = RepeatedMember<std::byte>(message, field);
+      return value.empty() ? status_ : WriteBytes(number, value);
+    }
+    case FieldType::kMessage: {
+      {
+        StreamEncoder nested = GetNestedEncoder(number);
+        // The nested encoder's status is propagated to this encoder when the
+        // nested encoder is destroyed. A message whose fields all hold their
+        // default values encodes to nothing, so its field is left out.
+        if (nested.Write(message.subspan(field.offset), field.nested_fields)
+                .ok() &&
+            nested.memory_writer_.bytes_written() == 0u) {
+          DiscardNestedMessage(nested);
+        }
+      }
+      return status_;
+    }
+  }
+  return status_;
+}
+
+Status StreamEncoder::WriteRepeatedStructField(
+    std::span<const std::byte> message, const MessageField& field) {
+  const uint32_t number = field.field_number;
+
+  switch (field.type) {
+    case FieldType::kDouble:
+      return WritePackedDouble(number, RepeatedMember<double>(message, field));
+    case FieldType::kFloat:
+      return WritePackedFloat(number, RepeatedMember<float>(message, field));
+    case FieldType::kInt32:
+    case FieldType::kEnum:
+      return WritePackedInt32(number, RepeatedMember<int32_t>(message, field));
+    case FieldType::kSint32:
+      return WritePackedSint32(number, RepeatedMember<int32_t>(message, field));
+    case FieldType::kSfixed32:
+      return WritePackedSfixed32(number,
+                                 RepeatedMember<int32_t>(message, field));
+    case FieldType::kInt64:
+      return WritePackedInt64(number, RepeatedMember<int64_t>(message, field));
+    case FieldType::kSint64:
+      return WritePackedSint64(number, RepeatedMember<int64_t>(message, field));
+    case FieldType::kSfixed64:
+      return WritePackedSfixed64(number,
+                                 RepeatedMember<int64_t>(message, field));
+    case FieldType::kUint32:
+      return WritePackedUint32(number,
+                               RepeatedMember<uint32_t>(message, field));
+    case FieldType::kFixed32:
+      return WritePackedFixed32(number,
+                                RepeatedMember<uint32_t>(message, field));
+    case FieldType::kUint64:
+      return WritePackedUint64(number,
+                               RepeatedMember<uint64_t>(message, field));
+    case FieldType::kFixed64:
+      return WritePackedFixed64(number,
+                                RepeatedMember<uint64_t>(message, field));
+    case FieldType::kBool: {
+      // A bool is stored as the byte 0 or 1, which is also its varint encoding,
+      // so packed bools are written as is.
+      static_assert(sizeof(bool) == 1);
+      const std::span<const bool> values = RepeatedMember<bool>(message, field);
+      return values.empty()
+                 ? status_
+                 : WriteLengthDelimitedField(number, std::as_bytes(values));
+    }
+    case FieldType::kString:
+    case FieldType::kBytes:
+    case FieldType::kMessage:
+      break;
+  }
+
+  PW_CRASH("Unsupported repeated field type in generated message table");
+}
+
 Status StreamEncoder::UpdateStatusForWrite(uint32_t field_number,
                                            WireType type,
                                            size_t data_size) {
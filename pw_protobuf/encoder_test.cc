@@ -14,6 +14,7 @@
 
 #include "pw_protobuf/encoder.h"
 
+#include <array>
 #include <span>
 
 #include "gtest/gtest.h"
@@ -307,6 +308,33 @@ TEST(StreamEncoder, PackedVarintInsufficientSpace) {
   EXPECT_EQ(encoder.status(), Status::ResourceExhausted());
 }
 
+TEST(StreamEncoder, PackedVarintLargerThanBuffer) {
+  std::byte encode_buffer[512];
+  MemoryEncoder encoder(encode_buffer);
+
+  // repeated sint64 values = 1;
+  std::array<int64_t, 40> values;
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = (i % 2 == 0 ? -1 : 1) * (int64_t(1) << (i * 3 % 63));
+  }
+  ASSERT_EQ(encoder.WritePackedSint64(1, values), OkStatus());
+
+  std::array<std::byte, 40 * varint::kMaxVarint64SizeBytes> expected;
+  size_t size = 0;
+  for (int64_t value : values) {
+    size += varint::Encode(value, std::span(expected).subspan(size));
+  }
+  ASSERT_GT(size, config::kPackedVarintBufferSize);
+
+  // The key and the payload size precede the varints.
+  const size_t header_size = 1 + varint::EncodedSize(size);
+  ConstByteSpan result(encoder);
+  ASSERT_EQ(result.size(), header_size + size);
+  EXPECT_EQ(result[0], std::byte{0x0a});
+  EXPECT_EQ(std::memcmp(result.data() + header_size, expected.data(), size),
+            0);
+}
+
 TEST(StreamEncoder, PackedFixed) {
   std::byte encode_buffer[32];
   MemoryEncoder encoder(encode_buffer);
@@ -37,8 +37,21 @@
 static_assert(PW_PROTOBUF_CFG_MAX_VARINT_SIZE > 0 &&
               PW_PROTOBUF_CFG_MAX_VARINT_SIZE <= 5);
 
+// The size of the stack buffer used for packed varint fields. Varints are
+// encoded into it before they are written to the stream, and StreamDecoder
+// reads them from the stream into it in chunks before decoding. Larger buffers
+// make fewer stream calls. Must be large enough for one 64-bit varint (10
+// bytes).
+#ifndef PW_PROTOBUF_CFG_PACKED_VARINT_BUFFER_SIZE
+#define PW_PROTOBUF_CFG_PACKED_VARINT_BUFFER_SIZE 32
+#endif  // PW_PROTOBUF_CFG_PACKED_VARINT_BUFFER_SIZE
+
+static_assert(PW_PROTOBUF_CFG_PACKED_VARINT_BUFFER_SIZE >= 10);
+
 namespace pw::protobuf::config {
 
 inline constexpr size_t kMaxVarintSize = PW_PROTOBUF_CFG_MAX_VARINT_SIZE;
+inline constexpr size_t kPackedVarintBufferSize =
+    PW_PROTOBUF_CFG_PACKED_VARINT_BUFFER_SIZE;
 
 }  // namespace pw::protobuf::config
@@ -25,6 +25,7 @@
 #include "pw_bytes/endian.h"
 #include "pw_bytes/span.h"
 #include "pw_protobuf/config.h"
+#include "pw_protobuf/internal/codegen.h"
 #include "pw_protobuf/wire_format.h"
 #include "pw_status/status.h"
 #include "pw_status/try.h"
@@ -458,6 +459,13 @@ class StreamEncoder {
   }
 
  protected:
+  // Encodes a generated message struct, using its table of fields to find the
+  // members to write. Used only by codegen.
+  //
+  // Precondition: Encoder has no active child encoder.
+  Status Write(std::span<const std::byte> message,
+               std::span<const internal::MessageField> fields);
+
   // Specialized move constructor used only for codegen.
   //
   // Postcondition: The other encoder is invalidated and cannot be used as it
@@ -498,6 +506,17 @@ class StreamEncoder {
   // encoder destructor.
   void CloseNestedMessage(StreamEncoder& nested);
 
+  // Closes a nested encoder without writing its field to this encoder.
+  void DiscardNestedMessage(StreamEncoder& nested);
+
+  // Writes one member of a generated message struct. Scalars that hold their
+  // default value and empty strings, bytes, repeated fields, and nested
+  // messages are skipped, as in proto3.
+  Status WriteStructField(std::span<const std::byte> message,
+                          const internal::MessageField& field);
+  Status WriteRepeatedStructField(std::span<const std::byte> message,
+                                  const internal::MessageField& field);
+
   // Implementation for encoding all varint field types.
   Status WriteVarintField(uint32_t field_number, uint64_t value);
 
@@ -527,16 +546,20 @@ class StreamEncoder {
   }
 
   // Writes a list of varints to the buffer in length-delimited packed encoding.
+  // Signed values are passed as the unsigned type of the same size.
   template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
   Status WritePackedVarints(uint32_t field_number,
                             std::span<T> values,
                             VarintEncodeType encode_type) {
     static_assert(std::is_same<T, const uint32_t>::value ||
-                      std::is_same<T, const int32_t>::value ||
-                      std::is_same<T, const uint64_t>::value ||
-                      std::is_same<T, const int64_t>::value,
-                  "Packed varints must be of type uint32_t, int32_t, uint64_t, "
-                  "or int64_t");
+                      std::is_same<T, const uint64_t>::value,
+                  "Packed varints must be of type uint32_t or uint64_t");
+
+    // Like WritePackedFixed, skip empty fields rather than writing a field
+    // with no payload.
+    if (values.empty()) {
+      return status_;
+    }
 
     size_t payload_size = 0;
     for (T val : values) {
@@ -559,14 +582,23 @@ class StreamEncoder {
         .IgnoreError();  // TODO(pwbug/387): Handle Status properly
     WriteVarint(payload_size)
         .IgnoreError();  // TODO(pwbug/387): Handle Status properly
-    for (T value : values) {
-      if (encode_type == VarintEncodeType::kZigZag) {
-        WriteZigzagVarint(static_cast<std::make_signed_t<T>>(value))
-            .IgnoreError();  // TODO(pwbug/387): Handle Status properly
-      } else {
-        WriteVarint(value)
-            .IgnoreError();  // TODO(pwbug/387): Handle Status properly
-      }
+
+    // Encode the varints in batches and write each batch to the stream at once.
+    std::array<std::byte, config::kPackedVarintBufferSize> buffer;
+    while (!values.empty() && status_.ok()) {
+      size_t encoded;
+      const size_t size =
+          encode_type == VarintEncodeType::kZigZag
+              ? varint::EncodeArray(
+                    std::span(
+                        reinterpret_cast<const std::make_signed_t<T>*>(
+                            values.data()),
+                        values.size()),
+                    buffer,
+                    &encoded)
+              : varint::EncodeArray(values, buffer, &encoded);
+      status_.Update(writer_.Write(std::span(buffer).first(size)));
+      values = values.subspan(encoded);
     }
 
     return status_;
@@ -0,0 +1,84 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+#include "pw_containers/vector.h"
+
+// Definitions used by the message structs generated by pw_protobuf's codegen.
+// These are not part of the public API.
+namespace pw::protobuf::internal {
+
+// The type of a field in a generated message struct. Each type determines both
+// the C++ type of the struct member and the field's wire format.
+enum class FieldType : uint8_t {
+  kDouble,    // double
+  kFloat,     // float
+  kInt32,     // int32_t
+  kSint32,    // int32_t
+  kSfixed32,  // int32_t
+  kInt64,     // int64_t
+  kSint64,    // int64_t
+  kSfixed64,  // int64_t
+  kUint32,    // uint32_t
+  kFixed32,   // uint32_t
+  kUint64,    // uint64_t
+  kFixed64,   // uint64_t
+  kBool,      // bool
+  kEnum,      // A generated enum class with int32_t as its underlying type.
+              // Repeated enum fields are stored as int32_t values.
+  kString,    // pw::Vector<char, kMaxSize>
+  kBytes,     // pw::Vector<std::byte, kMaxSize>
+  kMessage,   // A generated message struct.
+};
+
+// Describes one field of a generated message struct. The generated code emits
+// a constexpr table of MessageFields for each message, sorted by field number,
+// which StreamEncoder::Write and StreamDecoder::Read use to encode and decode
+// the struct.
+struct MessageField {
+  uint32_t field_number;
+  FieldType type;
+
+  // Repeated scalar fields are stored in a pw::Vector<T, kMaxSize>, where T is
+  // the type listed for the field's FieldType. Repeated string, bytes, and
+  // message fields are not supported.
+  bool repeated;
+
+  // Offset of the member in the message struct. Generated code asserts that
+  // message structs are small enough for this to fit.
+  uint16_t offset;
+
+  // For kMessage fields, the table of the nested message's fields.
+  std::span<const MessageField> nested_fields;
+
+  // For string, bytes, and repeated fields, returns the pw::Vector<T> base of
+  // the member in the message struct at the given address. Null otherwise.
+  void* (*vector)(void* message);
+};
+
+// Returns the size-agnostic pw::Vector<T> base of a pw::Vector<T, kMaxSize>
+// member. Generated tables use an instance of this for each vector member.
+template <typename Message, auto kMember>
+void* VectorBase(void* message) {
+  auto& member = static_cast<Message*>(message)->*kMember;
+  using Base =
+      Vector<typename std::remove_reference_t<decltype(member)>::value_type>;
+  return static_cast<Base*>(&member);
+}
+
+}  // namespace pw::protobuf::internal
@@ -16,9 +16,12 @@
 #include <array>
 #include <cstring>
 #include <limits>
+#include <span>
 
 #include "pw_assert/assert.h"
 #include "pw_bytes/endian.h"
+#include "pw_protobuf/config.h"
+#include "pw_protobuf/internal/codegen.h"
 #include "pw_protobuf/wire_format.h"
 #include "pw_status/status_with_size.h"
 #include "pw_stream/stream.h"
@@ -220,6 +223,60 @@ class StreamDecoder {
     return d;
   }
 
+  // Reads the values of a packed repeated field at the current position into
+  // out and returns the number of values read.
+  //
+  // Return values:
+  //
+  //                   OK: Read all values in the field.
+  //            NOT_FOUND: The current field is not length-delimited.
+  //   RESOURCE_EXHAUSTED: The field has more values than fit in out. The
+  //                       decoder's position remains on the field, so it can
+  //                       be read again with a larger buffer.
+  //         OUT_OF_RANGE: A value does not fit in the output type. The size is
+  //                       the number of values read before it. The field is
+  //                       consumed.
+  //            DATA_LOSS: Invalid protobuf data.
+  //
+  // Varint fields are read from the stream in chunks of
+  // PW_PROTOBUF_CFG_PACKED_VARINT_BUFFER_SIZE bytes and decoded with
+  // varint::DecodeArray. Fixed-size fields are read directly into out.
+  StatusWithSize ReadPackedInt32(std::span<int32_t> out);
+  StatusWithSize ReadPackedUint32(std::span<uint32_t> out);
+  StatusWithSize ReadPackedInt64(std::span<int64_t> out);
+  StatusWithSize ReadPackedUint64(std::span<uint64_t> out);
+  StatusWithSize ReadPackedSint32(std::span<int32_t> out);
+  StatusWithSize ReadPackedSint64(std::span<int64_t> out);
+  StatusWithSize ReadPackedBool(std::span<bool> out);
+
+  StatusWithSize ReadPackedFixed32(std::span<uint32_t> out) {
+    return ReadPackedFixedField(std::as_writable_bytes(out), sizeof(uint32_t));
+  }
+
+  StatusWithSize ReadPackedFixed64(std::span<uint64_t> out) {
+    return ReadPackedFixedField(std::as_writable_bytes(out), sizeof(uint64_t));
+  }
+
+  StatusWithSize ReadPackedSfixed32(std::span<int32_t> out) {
+    return ReadPackedFixedField(std::as_writable_bytes(out), sizeof(int32_t));
+  }
+
+  StatusWithSize ReadPackedSfixed64(std::span<int64_t> out) {
+    return ReadPackedFixedField(std::as_writable_bytes(out), sizeof(int64_t));
+  }
+
+  StatusWithSize ReadPackedFloat(std::span<float> out) {
+    static_assert(sizeof(float) == sizeof(uint32_t),
+                  "Float and uint32_t must be the same size for protobufs");
+    return ReadPackedFixedField(std::as_writable_bytes(out), sizeof(float));
+  }
+
+  StatusWithSize ReadPackedDouble(std::span<double> out) {
+    static_assert(sizeof(double) == sizeof(uint64_t),
+                  "Double and uint64_t must be the same size for protobufs");
+    return ReadPackedFixedField(std::as_writable_bytes(out), sizeof(double));
+  }
+
   // Reads a proto string value from the current position. The string is copied
   // into the provided buffer and the read size is returned. The copied string
   // will NOT be null terminated; this should be done manually if desired.
@@ -294,6 +351,23 @@ class StreamDecoder {
   // relative to the given reader.
   Result<Bounds> GetLengthDelimitedPayloadBounds();
 
+ protected:
+  // Decodes the remaining fields of the message into a generated message
+  // struct, using its table of fields to find the members to set. Fields that
+  // are not in the table are skipped. Fields that are not present keep their
+  // values, and repeated fields are appended to. Used only by codegen.
+  //
+  // Return values:
+  //
+  //                   OK: The message was decoded.
+  //   RESOURCE_EXHAUSTED: A string, bytes, or repeated field did not fit in
+  //                       its member.
+  //            DATA_LOSS: Invalid protobuf data, or a field has the wrong wire
+  //                       type.
+  //
+  Status Read(std::span<std::byte> message,
+              std::span<const internal::MessageField> fields);
+
  private:
   friend class BytesReader;
 
@@ -360,8 +434,28 @@ class StreamDecoder {
 
   StatusWithSize ReadDelimitedField(std::span<std::byte> out);
 
+  // Decodes varints from input into out, which holds elements of one type.
+  // Returns the number of bytes read and sets values_decoded, like
+  // varint::DecodeArray.
+  using PackedVarintDecoder = size_t (*)(std::span<const std::byte> input,
+                                         std::span<std::byte> out,
+                                         size_t* values_decoded);
+
+  StatusWithSize ReadPackedVarintField(std::span<std::byte> out,
+                                       size_t elem_size,
+                                       PackedVarintDecoder decode);
+
+  StatusWithSize ReadPackedFixedField(std::span<std::byte> out,
+                                      size_t elem_size);
+
   StatusWithSize ReadVarint(uint64_t* output);
 
+  // Reads the current field into a member of a generated message struct.
+  Status ReadStructField(std::span<std::byte> message,
+                         const internal::MessageField& field);
+  Status ReadRepeatedStructField(std::span<std::byte> message,
+                                 const internal::MessageField& field);
+
   Status CheckOkToRead(WireType type);
 
   stream::SeekableReader& reader_;
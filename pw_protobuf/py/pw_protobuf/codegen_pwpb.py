@@ -18,11 +18,12 @@ from datetime import datetime
 import enum
 import os
 import sys
-from typing import Dict, Iterable, List, Tuple
+from typing import Dict, Iterable, List, NamedTuple, Optional, Set, Tuple
 from typing import cast
 
 from google.protobuf import descriptor_pb2
 
+from pw_protobuf.options import FieldOptions
 from pw_protobuf.output_file import OutputFile
 from pw_protobuf.proto_tree import ProtoEnum, ProtoMessage, ProtoMessageField
 from pw_protobuf.proto_tree import ProtoNode
@@ -537,6 +538,218 @@ PROTO_FIELD_METHODS: Dict[int, List] = {
 }
 
 
+# Mapping of scalar protobuf field types to their message struct member types
+# and pw::protobuf::internal::FieldType values. Singular enums use their
+# generated enum class as the member type. Repeated enums are stored as int32_t,
+# since the decoder fills the pw::Vector through its pw::Vector<int32_t> base.
+STRUCT_FIELD_TYPES: Dict[int, Tuple[str, str]] = {
+    descriptor_pb2.FieldDescriptorProto.TYPE_DOUBLE: ('double', 'kDouble'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_FLOAT: ('float', 'kFloat'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_INT32: ('int32_t', 'kInt32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SINT32: ('int32_t', 'kSint32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SFIXED32:
+    ('int32_t', 'kSfixed32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_INT64: ('int64_t', 'kInt64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SINT64: ('int64_t', 'kSint64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_SFIXED64:
+    ('int64_t', 'kSfixed64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_UINT32: ('uint32_t', 'kUint32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_FIXED32: ('uint32_t', 'kFixed32'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_UINT64: ('uint64_t', 'kUint64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_FIXED64: ('uint64_t', 'kFixed64'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_BOOL: ('bool', 'kBool'),
+    descriptor_pb2.FieldDescriptorProto.TYPE_ENUM: ('int32_t', 'kEnum'),
+}
+
+# C++ keywords that are valid proto field names. Struct members for these
+# fields have an underscore appended.
+CPP_KEYWORDS = frozenset([
+    'alignas', 'alignof', 'and', 'asm', 'auto', 'bool', 'break', 'case',
+    'catch', 'char', 'class', 'const', 'constexpr', 'continue', 'default',
+    'delete', 'do', 'double', 'else', 'enum', 'explicit', 'export', 'extern',
+    'false', 'float', 'for', 'friend', 'goto', 'if', 'inline', 'int', 'long',
+    'mutable', 'namespace', 'new', 'noexcept', 'not', 'operator', 'or',
+    'private', 'protected', 'public', 'register', 'return', 'short', 'signed',
+    'sizeof', 'static', 'struct', 'switch', 'template', 'this', 'throw',
+    'true', 'try', 'typedef', 'typeid', 'typename', 'union', 'unsigned',
+    'using', 'virtual', 'void', 'volatile', 'while', 'xor'
+])
+
+
+class StructMember(NamedTuple):
+    """A member of a generated message struct."""
+    name: str
+    cpp_type: str
+    field_type: str
+    field_number: int
+    repeated: bool
+    nested_fields: Optional[str]
+
+    def is_vector(self) -> bool:
+        return self.repeated or self.field_type in ('kString', 'kBytes')
+
+
+class MessageStructs:
+    """Determines the members of the message structs in a package.
+
+    Message structs hold every field that can be stored in a fixed amount of
+    memory: scalars, enums, and singular submessages, plus strings, bytes, and
+    repeated scalars that have a max_size or max_count in the .options file.
+    Other fields are omitted from the struct and skipped when decoding it. As
+    submessages are stored by value, a submessage field that would make a struct
+    contain itself is omitted as well.
+    """
+    def __init__(self, package: ProtoNode, field_options: FieldOptions):
+        self._options = field_options
+        self._ordered: List[ProtoMessage] = []
+        self._recursive_fields: Set[Tuple[ProtoMessage, int]] = set()
+
+        visiting: Set[ProtoMessage] = set()
+        visited: Set[ProtoMessage] = set()
+
+        def visit(message: ProtoMessage) -> None:
+            visiting.add(message)
+            for field in message.fields():
+                dependency = field.type_node()
+                if (field.type() != descriptor_pb2.FieldDescriptorProto.
+                        TYPE_MESSAGE or field.is_repeated()
+                        or dependency is None
+                        or dependency.type() != ProtoNode.Type.MESSAGE):
+                    continue
+
+                if dependency in visiting:
+                    self._recursive_fields.add((message, field.number()))
+                elif dependency not in visited:
+                    visit(cast(ProtoMessage, dependency))
+
+            visiting.remove(message)
+            visited.add(message)
+            self._ordered.append(message)
+
+        for node in package:
+            if node.type() == ProtoNode.Type.MESSAGE and node not in visited:
+                visit(cast(ProtoMessage, node))
+
+    def messages(self) -> List[ProtoMessage]:
+        """Messages ordered so that structs are defined before their uses."""
+        return self._ordered
+
+    def members(self, message: ProtoMessage) -> List[StructMember]:
+        """Returns the struct members of a message, sorted by field number."""
+        members = []
+        for field in sorted(message.fields(), key=lambda f: f.number()):
+            member = self._member(message, field)
+            if member is not None:
+                members.append(member)
+        return members
+
+    def _member(self, message: ProtoMessage,
+                field: ProtoMessageField) -> Optional[StructMember]:
+        name = field.field_name()
+        if name in CPP_KEYWORDS:
+            name += '_'
+
+        field_path = f'{message.proto_path()}.{field.field_name()}'
+        type_node = field.type_node()
+
+        if field.type() == descriptor_pb2.FieldDescriptorProto.TYPE_MESSAGE:
+            assert type_node is not None
+            if (field.is_repeated()
+                    or (message, field.number()) in self._recursive_fields):
+                return None
+
+            namespace = f'::{type_node.cpp_namespace()}'
+            return StructMember(name, f'{namespace}::Message', 'kMessage',
+                                field.number(), False,
+                                f'{namespace}::internal::kMessageFields')
+
+        if field.type() in (descriptor_pb2.FieldDescriptorProto.TYPE_STRING,
+                            descriptor_pb2.FieldDescriptorProto.TYPE_BYTES):
+            max_size = self._options.max_size(field_path)
+            if field.is_repeated() or max_size is None:
+                return None
+
+            if field.type() == descriptor_pb2.FieldDescriptorProto.TYPE_STRING:
+                element_type, field_type = 'char', 'kString'
+            else:
+                element_type, field_type = 'std::byte', 'kBytes'
+
+            return StructMember(name,
+                                f'::pw::Vector<{element_type}, {max_size}>',
+                                field_type, field.number(), False, None)
+
+        if field.type() not in STRUCT_FIELD_TYPES:
+            return None
+
+        cpp_type, field_type = STRUCT_FIELD_TYPES[field.type()]
+        if (field.type() == descriptor_pb2.FieldDescriptorProto.TYPE_ENUM
+                and not field.is_repeated()):
+            assert type_node is not None
+            cpp_type = f'::{type_node.cpp_namespace()}'
+
+        if field.is_repeated():
+            max_count = self._options.max_count(field_path)
+            if max_count is None:
+                return None
+            cpp_type = f'::pw::Vector<{cpp_type}, {max_count}>'
+
+        return StructMember(name, cpp_type, field_type, field.number(),
+                            field.is_repeated(), None)
+
+
+def generate_struct_for_message(message: ProtoMessage, root: ProtoNode,
+                                structs: MessageStructs,
+                                output: OutputFile) -> None:
+    """Defines the struct that holds a protobuf message's fields."""
+    output.write_line()
+    output.write_line(f'struct {message.cpp_namespace(root)}::Message {{')
+    with output.indent():
+        for member in structs.members(message):
+            output.write_line(f'{member.cpp_type} {member.name}{{}};')
+    output.write_line('};')
+
+
+def generate_table_for_message(message: ProtoMessage, root: ProtoNode,
+                               structs: MessageStructs,
+                               output: OutputFile) -> None:
+    """Defines the table of fields used to encode and decode a struct."""
+    members = structs.members(message)
+    field_class = f'{PROTOBUF_NAMESPACE}::internal::MessageField'
+    field_type = f'{PROTOBUF_NAMESPACE}::internal::FieldType'
+
+    namespace = f'{message.cpp_namespace(root)}::internal'
+    output.write_line()
+    output.write_line(f'namespace {namespace} {{')
+    output.write_line()
+    output.write_line('static_assert(sizeof(Message) <= 0xffff,')
+    output.write_line('              "Message structs must fit in 64 KiB");')
+    output.write_line()
+
+    # Members of structs that contain pw::Vector are not standard layout, which
+    # GCC and Clang support in offsetof.
+    output.write_line('PW_MODIFY_DIAGNOSTICS_PUSH();')
+    output.write_line('PW_MODIFY_DIAGNOSTIC(ignored, "-Winvalid-offsetof");')
+    output.write_line(f'inline constexpr std::array<{field_class}, '
+                      f'{len(members)}> kMessageFields = {{{{')
+    with output.indent():
+        for member in members:
+            repeated = 'true' if member.repeated else 'false'
+            nested = member.nested_fields or '{}'
+            vector = (f'{PROTOBUF_NAMESPACE}::internal::VectorBase<'
+                      f'Message, &Message::{member.name}>'
+                      if member.is_vector() else 'nullptr')
+            output.write_line(f'{{{member.field_number}, '
+                              f'{field_type}::{member.field_type}, '
+                              f'{repeated}, '
+                              f'offsetof(Message, {member.name}), '
+                              f'{nested}, '
+                              f'{vector}}},')
+    output.write_line('}};')
+    output.write_line('PW_MODIFY_DIAGNOSTICS_POP();')
+    output.write_line()
+    output.write_line(f'}}  // namespace {namespace}')
+
+
 def generate_code_for_message(message: ProtoMessage, root: ProtoNode,
                               output: OutputFile,
                               encoder_type: EncoderType) -> None:
@@ -573,6 +786,16 @@ def generate_code_for_message(message: ProtoMessage, root: ProtoNode,
                 f'*static_cast<{PROTOBUF_NAMESPACE}::StreamEncoder*>(this));}}'
             )
 
+        # Encode the message from its struct.
+        output.write_line()
+        output.write_line('::pw::Status Write(const Message& message) {')
+        with output.indent():
+            output.write_line(
+                f'return {PROTOBUF_NAMESPACE}::StreamEncoder::Write(')
+            output.write_line('    std::as_bytes(std::span(&message, 1)), '
+                              'internal::kMessageFields);')
+        output.write_line('}')
+
         # Generate methods for each of the message's fields.
         for field in message.fields():
             for method_class in PROTO_FIELD_METHODS[field.type()]:
@@ -600,6 +823,32 @@ def generate_code_for_message(message: ProtoMessage, root: ProtoNode,
     output.write_line('};')
 
 
+def generate_decoder_for_message(message: ProtoMessage, root: ProtoNode,
+                                 output: OutputFile) -> None:
+    """Creates a C++ decoder class for a protobuf message."""
+    assert message.type() == ProtoNode.Type.MESSAGE
+
+    base_class = f'{PROTOBUF_NAMESPACE}::StreamDecoder'
+    output.write_line()
+    output.write_line(f'class {message.cpp_namespace(root)}::StreamDecoder '
+                      f': public {base_class} {{')
+    output.write_line(' public:')
+
+    with output.indent():
+        output.write_line(f'using {base_class}::StreamDecoder;')
+
+        # Decode the message into its struct.
+        output.write_line()
+        output.write_line('::pw::Status Read(Message& message) {')
+        with output.indent():
+            output.write_line(f'return {base_class}::Read(')
+            output.write_line('    std::as_writable_bytes(std::span(&message, '
+                              '1)), internal::kMessageFields);')
+        output.write_line('}')
+
+    output.write_line('};')
+
+
 def define_not_in_class_methods(message: ProtoMessage, root: ProtoNode,
                                 output: OutputFile,
                                 encoder_type: EncoderType) -> None:
@@ -630,7 +879,8 @@ def generate_code_for_enum(proto_enum: ProtoEnum, root: ProtoNode,
     """Creates a C++ enum for a proto enum."""
     assert proto_enum.type() == ProtoNode.Type.ENUM
 
-    output.write_line(f'enum class {proto_enum.cpp_namespace(root)} {{')
+    output.write_line(
+        f'enum class {proto_enum.cpp_namespace(root)} : int32_t {{')
     with output.indent():
         for name, number in proto_enum.values():
             output.write_line(f'{name} = {number},')
@@ -651,10 +901,13 @@ def forward_declare(node: ProtoMessage, root: ProtoNode,
             output.write_line(f'{field.enum_name()} = {field.number()},')
     output.write_line('};')
 
-    # Declare the message's encoder class and all of its enums.
+    # Declare the message's struct, encoder and decoder classes, and all of its
+    # enums.
     output.write_line()
+    output.write_line('struct Message;')
     output.write_line('class StreamEncoder;')
     output.write_line('class MemoryEncoder;')
+    output.write_line('class StreamDecoder;')
 
     for child in node.children():
         if child.type() == ProtoNode.Type.ENUM:
@@ -687,6 +940,7 @@ def _proto_filename_to_generated_header(proto_file: str) -> str:
 
 
 def generate_code_for_package(file_descriptor_proto, package: ProtoNode,
+                              field_options: FieldOptions,
                               output: OutputFile) -> None:
     """Generates code for a single .pb.h file corresponding to a .proto file."""
 
@@ -696,11 +950,16 @@ def generate_code_for_package(file_descriptor_proto, package: ProtoNode,
                       f'generated by {PLUGIN_NAME} {PLUGIN_VERSION}')
     output.write_line(f'// on {datetime.now()}')
     output.write_line('#pragma once\n')
+    output.write_line('#include <array>')
     output.write_line('#include <cstddef>')
     output.write_line('#include <cstdint>')
     output.write_line('#include <span>')
     output.write_line('#include <string_view>\n')
+    output.write_line('#include "pw_containers/vector.h"')
+    output.write_line('#include "pw_preprocessor/compiler.h"')
     output.write_line('#include "pw_protobuf/encoder.h"')
+    output.write_line('#include "pw_protobuf/internal/codegen.h"')
+    output.write_line('#include "pw_protobuf/stream_decoder.h"')
 
     for imported_file in file_descriptor_proto.dependency:
         generated_header = _proto_filename_to_generated_header(imported_file)
@@ -723,15 +982,35 @@ def generate_code_for_package(file_descriptor_proto, package: ProtoNode,
             output.write_line()
             generate_code_for_enum(cast(ProtoEnum, node), package, output)
 
+    # Define the message structs and their field tables, ordered so that each
+    # struct is defined before it is used as a member.
+    structs = MessageStructs(package, field_options)
+    for message in structs.messages():
+        generate_struct_for_message(message, package, structs, output)
+    for message in structs.messages():
+        generate_table_for_message(message, package, structs, output)
+
     generate_encoder_wrappers(package, EncoderType.STREAMING, output)
     generate_encoder_wrappers(package, EncoderType.MEMORY, output)
 
+    for node in package:
+        if node.type() == ProtoNode.Type.MESSAGE:
+            generate_decoder_for_message(cast(ProtoMessage, node), package,
+                                         output)
+
     if package.cpp_namespace():
         output.write_line(f'\n}}  // namespace {package.cpp_namespace()}')
 
 
-def process_proto_file(proto_file) -> Iterable[OutputFile]:
-    """Generates code for a single .proto file."""
+def process_proto_file(
+        proto_file,
+        field_options: Optional[FieldOptions] = None) -> Iterable[OutputFile]:
+    """Generates code for a single .proto file.
+
+    Args:
+      proto_file: The FileDescriptorProto to generate code for.
+      field_options: Capacities of the fields in the file's message structs.
+    """
 
     # Two passes are made through the file. The first builds the tree of all
     # message/enum nodes, then the second creates the fields in each. This is
@@ -741,6 +1020,7 @@ def process_proto_file(proto_file) -> Iterable[OutputFile]:
 
     output_filename = _proto_filename_to_generated_header(proto_file.name)
     output_file = OutputFile(output_filename)
-    generate_code_for_package(proto_file, package_root, output_file)
+    generate_code_for_package(proto_file, package_root, field_options
+                              or FieldOptions(), output_file)
 
     return [output_file]
@@ -0,0 +1,94 @@
+# Copyright 2021 The Pigweed Authors
+#
+# Licensed under the Apache License, Version 2.0 (the "License"); you may not
+# use this file except in compliance with the License. You may obtain a copy of
+# the License at
+#
+#     https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+# WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+# License for the specific language governing permissions and limitations under
+# the License.
+"""Loads field capacities for generated message structs from .options files.
+
+The files use the same format as Nanopb .options files, so a single file can
+configure both code generators:
+
+    // Comment.
+    pw.package.Message.field max_size:32
+    pw.package.Message.repeated_field max_count:8
+    pw.package.*.name max_size:16
+
+Each line holds a fully-qualified field name, which may contain fnmatch
+wildcards, followed by option:value pairs. pw_protobuf uses max_size for string
+and bytes fields and max_count for repeated fields; other options are ignored.
+The first line that matches a field and sets an option provides its value.
+"""
+
+import fnmatch
+from pathlib import Path
+from typing import Dict, Iterable, List, Optional, Tuple
+
+_SUPPORTED_OPTIONS = ('max_size', 'max_count')
+
+
+class FieldOptions:
+    """Field options parsed from a .options file."""
+    def __init__(self, entries: Iterable[Tuple[str, Dict[str, int]]] = ()):
+        self._entries: List[Tuple[str, Dict[str, int]]] = list(entries)
+
+    def _find(self, field_path: str, option: str) -> Optional[int]:
+        for pattern, options in self._entries:
+            if option in options and fnmatch.fnmatchcase(field_path, pattern):
+                return options[option]
+        return None
+
+    def max_size(self, field_path: str) -> Optional[int]:
+        """Returns the capacity of a string or bytes field, if set."""
+        return self._find(field_path, 'max_size')
+
+    def max_count(self, field_path: str) -> Optional[int]:
+        """Returns the capacity of a repeated field, if set."""
+        return self._find(field_path, 'max_count')
+
+
+def parse_options(contents: str) -> FieldOptions:
+    """Parses the contents of a .options file."""
+    entries: List[Tuple[str, Dict[str, int]]] = []
+
+    for line in contents.splitlines():
+        for comment in ('//', '#'):
+            line = line.split(comment, 1)[0]
+
+        parts = line.split()
+        if not parts:
+            continue
+
+        options: Dict[str, int] = {}
+        for part in parts[1:]:
+            name, _, value = part.partition(':')
+            if name in _SUPPORTED_OPTIONS:
+                options[name] = int(value)
+
+        entries.append((parts[0], options))
+
+    return FieldOptions(entries)
+
+
+def load_options(proto_file: str,
+                 include_paths: Iterable[Path]) -> FieldOptions:
+    """Loads the .options file for a .proto file, if there is one.
+
+    The .options file must have the same path as the .proto file relative to
+    one of the include paths, with the extension replaced.
+    """
+    options_file = Path(proto_file).with_suffix('.options')
+
+    for include_path in include_paths:
+        path = include_path / options_file
+        if path.is_file():
+            return parse_options(path.read_text())
+
+    return FieldOptions()
@@ -18,11 +18,24 @@ This file implements a protobuf compiler plugin which generates C++ headers for
 protobuf messages in the pw_protobuf format.
 """
 
+from pathlib import Path
 import sys
+from typing import List
 
 from google.protobuf.compiler import plugin_pb2
 
 from pw_protobuf import codegen_pwpb
+from pw_protobuf import options
+
+
+def parse_include_paths(parameter: str) -> List[Path]:
+    """Parses -I<path> include paths from the plugin's parameter string.
+
+    protoc joins all --custom_opt arguments with commas.
+    """
+    return [
+        Path(arg[2:]) for arg in parameter.split(',') if arg.startswith('-I')
+    ]
 
 
 def process_proto_request(req: plugin_pb2.CodeGeneratorRequest,
@@ -36,8 +49,12 @@ def process_proto_request(req: plugin_pb2.CodeGeneratorRequest,
       req: A CodeGeneratorRequest for a proto compilation.
       res: A CodeGeneratorResponse to populate with the plugin's output.
     """
+    include_paths = parse_include_paths(req.parameter)
+
     for proto_file in req.proto_file:
-        output_files = codegen_pwpb.process_proto_file(proto_file)
+        field_options = options.load_options(proto_file.name, include_paths)
+        output_files = codegen_pwpb.process_proto_file(proto_file,
+                                                       field_options)
         for output_file in output_files:
             fd = res.file.add()
             fd.name = output_file.name()
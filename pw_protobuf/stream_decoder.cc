@@ -14,12 +14,215 @@
 
 #include "pw_protobuf/stream_decoder.h"
 
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
 #include "pw_assert/check.h"
+#include "pw_containers/vector.h"
 #include "pw_status/status_with_size.h"
 #include "pw_status/try.h"
 #include "pw_varint/varint.h"
 
 namespace pw::protobuf {
+namespace {
+
+// Adapts a varint::DecodeArray-style function to
+// StreamDecoder::PackedVarintDecoder.
+template <typename T,
+          size_t (*kDecode)(std::span<const std::byte>, std::span<T>, size_t*)>
+size_t DecodePacked(std::span<const std::byte> input,
+                    std::span<std::byte> out,
+                    size_t* values_decoded) {
+  return kDecode(input,
+                 std::span(reinterpret_cast<T*>(out.data()),
+                           out.size() / sizeof(T)),
+                 values_decoded);
+}
+
+// Decodes varints to 64 bits in batches and converts them to T. Stops before a
+// value that kConvert rejects.
+template <typename T, bool (*kConvert)(uint64_t, T*)>
+size_t DecodeConverted(std::span<const std::byte> input,
+                       std::span<T> values,
+                       size_t* values_decoded) {
+  std::array<uint64_t, 16> batch;
+  size_t read = 0;
+  size_t count = 0;
+
+  while (count < values.size()) {
+    const std::span<uint64_t> batch_values =
+        std::span(batch).first(std::min(batch.size(), values.size() - count));
+    size_t decoded;
+    const size_t size =
+        varint::DecodeArray(input.subspan(read), batch_values, &decoded);
+
+    for (size_t i = 0; i < decoded; ++i) {
+      if (!kConvert(batch[i], &values[count + i])) {
+        // Decode the batch up to the rejected value again to find its offset.
+        read += varint::DecodeArray(
+            input.subspan(read), batch_values.first(i), &decoded);
+        *values_decoded = count + i;
+        return read;
+      }
+    }
+
+    read += size;
+    count += decoded;
+    if (decoded < batch_values.size()) {
+      break;
+    }
+  }
+
+  *values_decoded = count;
+  return read;
+}
+
+// int32 values are sign-extended to 64 bits when encoded.
+bool ToInt32(uint64_t varint, int32_t* value) {
+  const int64_t signed_value = static_cast<int64_t>(varint);
+  *value = static_cast<int32_t>(signed_value);
+  return signed_value <= std::numeric_limits<int32_t>::max() &&
+         signed_value >= std::numeric_limits<int32_t>::min();
+}
+
+bool ToBool(uint64_t varint, bool* value) {
+  *value = varint != 0u;
+  return true;
+}
+
+using internal::FieldType;
+using internal::MessageField;
+
+// Returns the wire type of a non-packed field.
+constexpr WireType WireTypeOf(FieldType type) {
+  switch (type) {
+    case FieldType::kDouble:
+    case FieldType::kSfixed64:
+    case FieldType::kFixed64:
+      return WireType::kFixed64;
+    case FieldType::kFloat:
+    case FieldType::kSfixed32:
+    case FieldType::kFixed32:
+      return WireType::kFixed32;
+    case FieldType::kInt32:
+    case FieldType::kSint32:
+    case FieldType::kInt64:
+    case FieldType::kSint64:
+    case FieldType::kUint32:
+    case FieldType::kUint64:
+    case FieldType::kBool:
+    case FieldType::kEnum:
+      return WireType::kVarint;
+    case FieldType::kString:
+    case FieldType::kBytes:
+    case FieldType::kMessage:
+      break;
+  }
+  return WireType::kDelimited;
+}
+
+// Finds the field with the given number in a table sorted by field number.
+// Fields are usually encoded in order, so the search starts at the field after
+// the one found last, which is tracked in next_index.
+const MessageField* FindField(std::span<const MessageField> fields,
+                              uint32_t field_number,
+                              size_t& next_index) {
+  for (size_t i = next_index; i < fields.size(); ++i) {
+    if (fields[i].field_number == field_number) {
+      next_index = i + 1;
+      return &fields[i];
+    }
+  }
+  for (size_t i = 0; i < next_index && i < fields.size(); ++i) {
+    if (fields[i].field_number == field_number) {
+      next_index = i + 1;
+      return &fields[i];
+    }
+  }
+  return nullptr;
+}
+
+// Returns the member of a generated message struct that a field describes.
+template <typename T>
+T& Member(std::span<std::byte> message, const MessageField& field) {
+  return *reinterpret_cast<T*>(message.data() + field.offset);
+}
+
+// Returns the size-agnostic pw::Vector<T> base of a string, bytes, or repeated
+// field's pw::Vector<T, kMaxSize> member.
+template <typename T>
+Vector<T>& VectorMember(std::span<std::byte> message,
+                        const MessageField& field) {
+  return *static_cast<Vector<T>*>(field.vector(message.data()));
+}
+
+template <typename T, Result<T> (StreamDecoder::*kRead)()>
+Status ReadScalar(StreamDecoder& decoder,
+                  std::span<std::byte> message,
+                  const MessageField& field) {
+  const Result<T> value = (decoder.*kRead)();
+  PW_TRY(value.status());
+  Member<T>(message, field) = value.value();
+  return OkStatus();
+}
+
+// Enum members are a generated enum class rather than int32_t, so the value is
+// copied into the member's bytes instead of assigned through an int32_t&.
+Status ReadEnum(StreamDecoder& decoder,
+                std::span<std::byte> message,
+                const MessageField& field) {
+  const Result<int32_t> value = decoder.ReadInt32();
+  PW_TRY(value.status());
+  std::memcpy(message.data() + field.offset, &value.value(), sizeof(int32_t));
+  return OkStatus();
+}
+
+// Reads a string or bytes field, replacing the member's contents.
+template <typename T>
+StatusWithSize ReadDelimitedMember(StreamDecoder& decoder, Vector<T>& value) {
+  value.resize(static_cast<typename Vector<T>::size_type>(value.max_size()));
+  const StatusWithSize result =
+      decoder.ReadBytes(
+          std::as_writable_bytes(std::span(value.data(), value.size())));
+  value.resize(static_cast<typename Vector<T>::size_type>(result.size()));
+  return result;
+}
+
+// Appends a packed or non-packed repeated field to the member's values.
+template <typename T,
+          Result<T> (StreamDecoder::*kRead)(),
+          StatusWithSize (StreamDecoder::*kReadPacked)(std::span<T>)>
+Status ReadRepeated(StreamDecoder& decoder,
+                    bool packed,
+                    std::span<std::byte> message,
+                    const MessageField& field) {
+  Vector<T>& values = VectorMember<T>(message, field);
+  using SizeType = typename Vector<T>::size_type;
+
+  if (!packed) {
+    if (values.full()) {
+      return Status::ResourceExhausted();
+    }
+    const Result<T> value = (decoder.*kRead)();
+    PW_TRY(value.status());
+    values.push_back(value.value());
+    return OkStatus();
+  }
+
+  // Decode directly into the vector's unused capacity. If the values don't all
+  // fit, drop the ones that were decoded so the field is not left half-read.
+  const size_t size = values.size();
+  values.resize(static_cast<SizeType>(values.max_size()));
+  const StatusWithSize result =
+      (decoder.*kReadPacked)(
+      std::span(values.data() + size, values.size() - size));
+  values.resize(
+      static_cast<SizeType>(result.ok() ? size + result.size() : size));
+  return result.status();
+}
+
+}  // namespace
 
 Status StreamDecoder::BytesReader::DoSeek(ssize_t offset, Whence origin) {
   PW_TRY(status_);
@@ -150,6 +353,51 @@ Result<bool> StreamDecoder::ReadBool() {
   return varint;
 }
 
+StatusWithSize StreamDecoder::ReadPackedInt32(std::span<int32_t> out) {
+  return ReadPackedVarintField(
+      std::as_writable_bytes(out),
+      sizeof(int32_t),
+      DecodePacked<int32_t, DecodeConverted<int32_t, ToInt32>>);
+}
+
+StatusWithSize StreamDecoder::ReadPackedUint32(std::span<uint32_t> out) {
+  return ReadPackedVarintField(std::as_writable_bytes(out),
+                               sizeof(uint32_t),
+                               DecodePacked<uint32_t, varint::DecodeArray>);
+}
+
+StatusWithSize StreamDecoder::ReadPackedInt64(std::span<int64_t> out) {
+  // int64 values are encoded as their two's complement representation.
+  return ReadPackedVarintField(std::as_writable_bytes(out),
+                               sizeof(int64_t),
+                               DecodePacked<uint64_t, varint::DecodeArray>);
+}
+
+StatusWithSize StreamDecoder::ReadPackedUint64(std::span<uint64_t> out) {
+  return ReadPackedVarintField(std::as_writable_bytes(out),
+                               sizeof(uint64_t),
+                               DecodePacked<uint64_t, varint::DecodeArray>);
+}
+
+StatusWithSize StreamDecoder::ReadPackedSint32(std::span<int32_t> out) {
+  return ReadPackedVarintField(std::as_writable_bytes(out),
+                               sizeof(int32_t),
+                               DecodePacked<int32_t, varint::DecodeArray>);
+}
+
+StatusWithSize StreamDecoder::ReadPackedSint64(std::span<int64_t> out) {
+  return ReadPackedVarintField(std::as_writable_bytes(out),
+                               sizeof(int64_t),
+                               DecodePacked<int64_t, varint::DecodeArray>);
+}
+
+StatusWithSize StreamDecoder::ReadPackedBool(std::span<bool> out) {
+  return ReadPackedVarintField(
+      std::as_writable_bytes(out),
+      sizeof(bool),
+      DecodePacked<bool, DecodeConverted<bool, ToBool>>);
+}
+
 StreamDecoder::BytesReader StreamDecoder::GetBytesReader() {
   Status status = CheckOkToRead(WireType::kDelimited);
 
@@ -349,7 +597,8 @@ StatusWithSize StreamDecoder::ReadDelimitedField(std::span<std::byte> out) {
     return StatusWithSize::ResourceExhausted();
   }
 
-  Result<ByteSpan> result = reader_.Read(out);
+  // Don't read past the end of the field if the buffer is larger than it.
+  Result<ByteSpan> result = reader_.Read(out.first(delimited_field_size_));
   if (!result.ok()) {
     return StatusWithSize(result.status(), 0);
   }
@@ -358,6 +607,117 @@ StatusWithSize StreamDecoder::ReadDelimitedField(std::span<std::byte> out) {
   return StatusWithSize(result.value().size());
 }
 
+StatusWithSize StreamDecoder::ReadPackedVarintField(
+    std::span<std::byte> out, size_t elem_size, PackedVarintDecoder decode) {
+  if (Status status = CheckOkToRead(WireType::kDelimited); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+
+  if (reader_.ConservativeReadLimit() < delimited_field_size_) {
+    status_ = Status::DataLoss();
+    return StatusWithSize(status_, 0);
+  }
+
+  // The field is read in chunks. Bytes of a varint split between chunks are
+  // moved to the front of the buffer and decoded with the next chunk.
+  std::array<std::byte, config::kPackedVarintBufferSize> buffer;
+  size_t buffered = 0;
+  size_t unread = delimited_field_size_;
+  size_t values_read = 0;
+  const size_t capacity = out.size() / elem_size;
+
+  while (unread > 0u || buffered > 0u) {
+    if (values_read == capacity) {
+      // Out of space. Return to the start of the field so that it can be read
+      // again.
+      PW_CHECK(reader_.Seek(delimited_field_offset_).ok());
+      return StatusWithSize(Status::ResourceExhausted(), values_read);
+    }
+
+    if (unread > 0u) {
+      Result<ByteSpan> result = reader_.Read(std::span(buffer).subspan(
+          buffered, std::min(unread, buffer.size() - buffered)));
+      if (!result.ok()) {
+        return StatusWithSize(result.status(), values_read);
+      }
+      if (result.value().empty()) {
+        status_ = Status::DataLoss();
+        return StatusWithSize(status_, values_read);
+      }
+      buffered += result.value().size();
+      unread -= result.value().size();
+    }
+
+    size_t decoded;
+    const size_t used = decode(std::span(buffer).first(buffered),
+                               out.subspan(values_read * elem_size),
+                               &decoded);
+    values_read += decoded;
+    buffered -= used;
+    std::memmove(buffer.data(), buffer.data() + used, buffered);
+
+    // Decoding stopped at a varint that is not split between chunks.
+    if (decoded == 0u && values_read < capacity &&
+        (unread == 0u || buffered == buffer.size())) {
+      uint64_t value;
+      if (varint::Decode(std::span(buffer).first(buffered), &value) == 0u) {
+        status_ = Status::DataLoss();
+        return StatusWithSize(status_, values_read);
+      }
+
+      // The varint is valid, but too large for the output type. Consume the
+      // field, as the single-value Read*() methods do.
+      PW_CHECK(reader_.Seek(delimited_field_offset_ + delimited_field_size_)
+                   .ok());
+      field_consumed_ = true;
+      return StatusWithSize(Status::OutOfRange(), values_read);
+    }
+  }
+
+  field_consumed_ = true;
+  return StatusWithSize(values_read);
+}
+
+StatusWithSize StreamDecoder::ReadPackedFixedField(std::span<std::byte> out,
+                                                   size_t elem_size) {
+  if (Status status = CheckOkToRead(WireType::kDelimited); !status.ok()) {
+    return StatusWithSize(status, 0);
+  }
+
+  if (reader_.ConservativeReadLimit() < delimited_field_size_ ||
+      delimited_field_size_ % elem_size != 0u) {
+    status_ = Status::DataLoss();
+    return StatusWithSize(status_, 0);
+  }
+
+  if (out.size() < delimited_field_size_) {
+    // The values can't fit into the provided buffer. Don't advance the cursor
+    // so that the field can be re-read with a larger buffer.
+    return StatusWithSize::ResourceExhausted();
+  }
+
+  Result<ByteSpan> result = reader_.Read(out.first(delimited_field_size_));
+  if (!result.ok()) {
+    return StatusWithSize(result.status(), 0);
+  }
+  if (result.value().size() != delimited_field_size_) {
+    status_ = Status::DataLoss();
+    return StatusWithSize(status_, 0);
+  }
+
+  field_consumed_ = true;
+
+  // The values are little-endian, so they can be copied directly on
+  // little-endian targets.
+  if constexpr (std::endian::native != std::endian::little) {
+    for (size_t i = 0; i < delimited_field_size_; i += elem_size) {
+      std::reverse(out.begin() + i, out.begin() + i + elem_size);
+    }
+  }
+
+  return StatusWithSize(delimited_field_size_ / elem_size);
+}
+
 StatusWithSize StreamDecoder::ReadVarint(uint64_t* output) {
   uint64_t value = 0;
   size_t count = 0;
@@ -385,6 +745,172 @@ StatusWithSize StreamDecoder::ReadVarint(uint64_t* output) {
   return StatusWithSize(count);
 }
 
+Status StreamDecoder::Read(std::span<std::byte> message,
+                           std::span<const MessageField> fields) {
+  PW_TRY(status_);
+
+  size_t next_index = 0;
+  while (true) {
+    if (Status status = Next(); !status.ok()) {
+      return status.IsOutOfRange() ? OkStatus() : status;
+    }
+
+    // Unknown fields are skipped by the next call to Next().
+    const MessageField* field =
+        FindField(fields, current_field_.field_number(), next_index);
+    if (field == nullptr) {
+      continue;
+    }
+
+    // Repeated scalars may be packed into a length-delimited field.
+    const WireType wire_type = current_field_.wire_type();
+    const bool packed = field->repeated && wire_type == WireType::kDelimited;
+    if (!packed && wire_type != WireTypeOf(field->type)) {
+      return status_ = Status::DataLoss();
+    }
+
+    PW_TRY(field->repeated ? ReadRepeatedStructField(message, *field)
+                           : ReadStructField(message, *field));
+  }
+}
+
+Status StreamDecoder::ReadStructField(std::span<std::byte> message,
+                                      const MessageField& field) {
+  switch (field.type) {
+    case FieldType::kDouble:
+      return ReadScalar<double, &StreamDecoder::ReadDouble>(
+          *this, message, field);
+    case FieldType::kFloat:
+      return ReadScalar<float, &StreamDecoder::ReadFloat>(
+          *this, message, field);
+    case FieldType::kInt32:
+      return ReadScalar<int32_t, &StreamDecoder::ReadInt32>(
+          *this, message, field);
+    case FieldType::kEnum:
+      return ReadEnum(*this, message, field);
+    case FieldType::kSint32:
+      return ReadScalar<int32_t, &StreamDecoder::ReadSint32>(
+          *this, message, field);
+    case FieldType::kSfixed32:
+      return ReadScalar<int32_t, &StreamDecoder::ReadSfixed32>(
+          *this, message, field);
+    case FieldType::kInt64:
+      return ReadScalar<int64_t, &StreamDecoder::ReadInt64>(
+          *this, message, field);
+    case FieldType::kSint64:
+      return ReadScalar<int64_t, &StreamDecoder::ReadSint64>(
+          *this, message, field);
+    case FieldType::kSfixed64:
+      return ReadScalar<int64_t, &StreamDecoder::ReadSfixed64>(
+          *this, message, field);
+    case FieldType::kUint32:
+      return ReadScalar<uint32_t, &StreamDecoder::ReadUint32>(
+          *this, message, field);
+    case FieldType::kFixed32:
+      return ReadScalar<uint32_t, &StreamDecoder::ReadFixed32>(
+          *this, message, field);
+    case FieldType::kUint64:
+      return ReadScalar<uint64_t, &StreamDecoder::ReadUint64>(
+          *this, message, field);
+    case FieldType::kFixed64:
+      return ReadScalar<uint64_t, &StreamDecoder::ReadFixed64>(
+          *this, message, field);
+    case FieldType::kBool:
+      return ReadScalar<bool, &StreamDecoder::ReadBool>(*this, message, field);
+    case FieldType::kString:
+      return ReadDelimitedMember(*this, VectorMember<char>(message, field))
+          .status();
+    case FieldType::kBytes:
+      return ReadDelimitedMember(*this, VectorMember<std::byte>(message, field))
+          .status();
+    case FieldType::kMessage: {
+      StreamDecoder nested = GetNestedDecoder();
+      return nested.Read(message.subspan(field.offset), field.nested_fields);
+    }
+  }
+  return OkStatus();
+}
+
+Status StreamDecoder::ReadRepeatedStructField(std::span<std::byte> message,
+                                              const MessageField& field) {
+  const bool packed = current_field_.wire_type() == WireType::kDelimited;
+
+  switch (field.type) {
+    case FieldType::kDouble:
+      return ReadRepeated<double,
+                          &StreamDecoder::ReadDouble,
+                          &StreamDecoder::ReadPackedDouble>(
+          *this, packed, message, field);
+    case FieldType::kFloat:
+      return ReadRepeated<float,
+                          &StreamDecoder::ReadFloat,
+                          &StreamDecoder::ReadPackedFloat>(
+          *this, packed, message, field);
+    case FieldType::kInt32:
+    case FieldType::kEnum:
+      return ReadRepeated<int32_t,
+                          &StreamDecoder::ReadInt32,
+                          &StreamDecoder::ReadPackedInt32>(
+          *this, packed, message, field);
+    case FieldType::kSint32:
+      return ReadRepeated<int32_t,
+                          &StreamDecoder::ReadSint32,
+                          &StreamDecoder::ReadPackedSint32>(
+          *this, packed, message, field);
+    case FieldType::kSfixed32:
+      return ReadRepeated<int32_t,
+                          &StreamDecoder::ReadSfixed32,
+                          &StreamDecoder::ReadPackedSfixed32>(
+          *this, packed, message, field);
+    case FieldType::kInt64:
+      return ReadRepeated<int64_t,
+                          &StreamDecoder::ReadInt64,
+                          &StreamDecoder::ReadPackedInt64>(
+          *this, packed, message, field);
+    case FieldType::kSint64:
+      return ReadRepeated<int64_t,
+                          &StreamDecoder::ReadSint64,
+                          &StreamDecoder::ReadPackedSint64>(
+          *this, packed, message, field);
+    case FieldType::kSfixed64:
+      return ReadRepeated<int64_t,
+                          &StreamDecoder::ReadSfixed64,
+                          &StreamDecoder::ReadPackedSfixed64>(
+          *this, packed, message, field);
+    case FieldType::kUint32:
+      return ReadRepeated<uint32_t,
+                          &StreamDecoder::ReadUint32,
+                          &StreamDecoder::ReadPackedUint32>(
+          *this, packed, message, field);
+    case FieldType::kFixed32:
+      return ReadRepeated<uint32_t,
+                          &StreamDecoder::ReadFixed32,
+                          &StreamDecoder::ReadPackedFixed32>(
+          *this, packed, message, field);
+    case FieldType::kUint64:
+      return ReadRepeated<uint64_t,
+                          &StreamDecoder::ReadUint64,
+                          &StreamDecoder::ReadPackedUint64>(
+          *this, packed, message, field);
+    case FieldType::kFixed64:
+      return ReadRepeated<uint64_t,
+                          &StreamDecoder::ReadFixed64,
+                          &StreamDecoder::ReadPackedFixed64>(
+          *this, packed, message, field);
+    case FieldType::kBool:
+      return ReadRepeated<bool,
+                          &StreamDecoder::ReadBool,
+                          &StreamDecoder::ReadPackedBool>(
+          *this, packed, message, field);
+    case FieldType::kString:
+    case FieldType::kBytes:
+    case FieldType::kMessage:
+      break;
+  }
+
+  PW_CRASH("Unsupported repeated field type in generated message table");
+}
+
 Status StreamDecoder::CheckOkToRead(WireType type) {
   PW_CHECK(!nested_reader_open_,
            "Cannot read from a decoder while a nested decoder is open");
@@ -0,0 +1,214 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark comparing StreamDecoder's ReadPacked*() methods with reading
+// the same samples one value at a time from a repeated field with Next() and
+// Read*(). The samples model sensor data: 12-bit ADC readings, signed deltas,
+// 32-bit fixed-point values, and floats. This target should only be built for
+// the host.
+//
+// Build the pw_protobuf.stream_decoder_benchmark target and run the binary.
+// Each line reports the decoding throughput for one field type in millions of
+// values per second.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+#include "pw_protobuf/encoder.h"
+#include "pw_protobuf/stream_decoder.h"
+#include "pw_stream/memory_stream.h"
+
+namespace pw::protobuf {
+namespace {
+
+constexpr size_t kValuesPerRun = 16 * 1024 * 1024;
+constexpr size_t kSamples = 1024;
+constexpr uint32_t kFieldNumber = 1;
+
+std::array<uint32_t, kSamples> uint32s;
+std::array<int32_t, kSamples> int32s;
+std::array<float, kSamples> floats;
+
+std::array<std::byte, kSamples * 8> encoded;
+
+// Keeps the compiler from optimizing away unused results.
+volatile uint64_t result;
+
+enum class Type { kUint32, kSint32, kFixed32, kFloat };
+
+struct Benchmark {
+  const char* name;
+  Type type;
+};
+
+constexpr Benchmark kBenchmarks[] = {
+    {"uint32", Type::kUint32},
+    {"sint32", Type::kSint32},
+    {"fixed32", Type::kFixed32},
+    {"float", Type::kFloat},
+};
+
+ConstByteSpan Encode(Type type, bool packed) {
+  MemoryEncoder encoder(encoded);
+  switch (type) {
+    case Type::kUint32:
+      if (packed) {
+        encoder.WritePackedUint32(kFieldNumber, uint32s).IgnoreError();
+      } else {
+        for (uint32_t value : uint32s) {
+          encoder.WriteUint32(kFieldNumber, value).IgnoreError();
+        }
+      }
+      break;
+    case Type::kSint32:
+      if (packed) {
+        encoder.WritePackedSint32(kFieldNumber, int32s).IgnoreError();
+      } else {
+        for (int32_t value : int32s) {
+          encoder.WriteSint32(kFieldNumber, value).IgnoreError();
+        }
+      }
+      break;
+    case Type::kFixed32:
+      if (packed) {
+        encoder.WritePackedFixed32(kFieldNumber, uint32s).IgnoreError();
+      } else {
+        for (uint32_t value : uint32s) {
+          encoder.WriteFixed32(kFieldNumber, value).IgnoreError();
+        }
+      }
+      break;
+    case Type::kFloat:
+      if (packed) {
+        encoder.WritePackedFloat(kFieldNumber, floats).IgnoreError();
+      } else {
+        for (float value : floats) {
+          encoder.WriteFloat(kFieldNumber, value).IgnoreError();
+        }
+      }
+      break;
+  }
+  return encoder.status().ok() ? ConstByteSpan(encoder) : ConstByteSpan();
+}
+
+// Reads every value in the message one at a time and returns their sum.
+uint64_t ReadEach(Type type, ConstByteSpan message) {
+  stream::MemoryReader reader(message);
+  StreamDecoder decoder(reader);
+
+  uint64_t sum = 0;
+  while (decoder.Next().ok()) {
+    switch (type) {
+      case Type::kUint32:
+        sum += decoder.ReadUint32().value_or(0);
+        break;
+      case Type::kSint32:
+        sum += decoder.ReadSint32().value_or(0);
+        break;
+      case Type::kFixed32:
+        sum += decoder.ReadFixed32().value_or(0);
+        break;
+      case Type::kFloat:
+        sum += static_cast<int64_t>(decoder.ReadFloat().value_or(0));
+        break;
+    }
+  }
+  return sum;
+}
+
+// Reads the packed field in the message and returns the sum of the values.
+uint64_t ReadPacked(Type type, ConstByteSpan message) {
+  std::array<uint32_t, kSamples> uint32_out;
+  std::array<int32_t, kSamples> int32_out;
+  std::array<float, kSamples> float_out;
+
+  stream::MemoryReader reader(message);
+  StreamDecoder decoder(reader);
+
+  uint64_t sum = 0;
+  while (decoder.Next().ok()) {
+    switch (type) {
+      case Type::kUint32:
+        decoder.ReadPackedUint32(uint32_out).IgnoreError();
+        sum += uint32_out[kSamples - 1];
+        break;
+      case Type::kSint32:
+        decoder.ReadPackedSint32(int32_out).IgnoreError();
+        sum += int32_out[kSamples - 1];
+        break;
+      case Type::kFixed32:
+        decoder.ReadPackedFixed32(uint32_out).IgnoreError();
+        sum += uint32_out[kSamples - 1];
+        break;
+      case Type::kFloat:
+        decoder.ReadPackedFloat(float_out).IgnoreError();
+        sum += static_cast<int64_t>(float_out[kSamples - 1]);
+        break;
+    }
+  }
+  return sum;
+}
+
+// Returns the throughput in millions of values per second, or 0 if the
+// message could not be encoded.
+double RunBenchmark(const Benchmark& benchmark, bool packed) {
+  const ConstByteSpan message = Encode(benchmark.type, packed);
+  if (message.empty()) {
+    return 0;
+  }
+
+  const size_t iterations = kValuesPerRun / kSamples;
+  uint64_t sum = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    sum += packed ? ReadPacked(benchmark.type, message)
+                  : ReadEach(benchmark.type, message);
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  result = sum;
+  return double(kValuesPerRun) / 1e6 / elapsed.count();
+}
+
+int Main() {
+  uint32_t value = 1;
+  for (size_t i = 0; i < kSamples; ++i) {
+    value = value * 1103515245u + 12345u;
+    uint32s[i] = (value >> 16) & 0xfff;
+    int32s[i] = int32_t(uint32s[i]) - 0x800;
+    floats[i] = float(int32s[i]) / 16.f;
+  }
+
+  std::printf("%-10s  %12s  %12s\n", "Mvalues/s", "per value", "packed");
+  for (const Benchmark& benchmark : kBenchmarks) {
+    const double each = RunBenchmark(benchmark, false);
+    const double packed = RunBenchmark(benchmark, true);
+    if (each == 0 || packed == 0) {
+      std::printf("Failed to encode %s samples\n", benchmark.name);
+      return 1;
+    }
+    std::printf("%-10s  %12.1f  %12.1f\n", benchmark.name, each, packed);
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::protobuf
+
+int main() { return pw::protobuf::Main(); }
@@ -14,7 +14,10 @@
 
 #include "pw_protobuf/stream_decoder.h"
 
+#include <array>
+
 #include "gtest/gtest.h"
+#include "pw_protobuf/encoder.h"
 #include "pw_stream/memory_stream.h"
 
 namespace pw::protobuf {
@@ -82,6 +85,36 @@ TEST(StreamDecoder, Decode) {
   EXPECT_EQ(decoder.Next(), Status::OutOfRange());
 }
 
+TEST(StreamDecoder, Decode_BytesSmallerThanBuffer) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=bytes, k=1, v={0xab, 0xcd}
+    0x0a, 0x02, 0xab, 0xcd,
+    // type=int32, k=2, v=42
+    0x10, 0x2a,
+  };
+  // clang-format on
+
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded_proto)));
+  StreamDecoder decoder(reader);
+
+  std::byte buffer[16];
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber().value(), 1u);
+  StatusWithSize sws = decoder.ReadBytes(buffer);
+  ASSERT_EQ(sws.status(), OkStatus());
+  EXPECT_EQ(sws.size(), 2u);
+
+  // The read must stop at the end of the bytes field.
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber().value(), 2u);
+  Result<int32_t> int32 = decoder.ReadInt32();
+  ASSERT_EQ(int32.status(), OkStatus());
+  EXPECT_EQ(int32.value(), 42);
+
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
 TEST(StreamDecoder, Decode_SkipsUnusedFields) {
   // clang-format off
   constexpr uint8_t encoded_proto[] = {
@@ -514,6 +547,250 @@ TEST(StreamDecoder, Decode_BytesReader_InvalidField) {
   EXPECT_EQ(decoder.Next(), Status::DataLoss());
 }
 
+TEST(StreamDecoder, Decode_PackedVarints) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=uint32[], k=1, v={0, 50, 100, 150, 200}
+    0x0a, 0x07, 0x00, 0x32, 0x64, 0x96, 0x01, 0xc8, 0x01,
+    // type=sint32[], k=2, v={-100, -25, -1, 0, 1, 25, 100}
+    0x12, 0x09, 0xc7, 0x01, 0x31, 0x01, 0x00, 0x02, 0x32, 0xc8, 0x01,
+    // type=int32[], k=3, v={-1, 300}
+    0x1a, 0x0c,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01, 0xac, 0x02,
+    // type=bool[], k=4, v={true, false, true}
+    0x22, 0x03, 0x01, 0x00, 0x01,
+    // type=int32, k=5, v=42
+    0x28, 0x2a,
+  };
+  // clang-format on
+
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded_proto)));
+  StreamDecoder decoder(reader);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber().value(), 1u);
+  std::array<uint32_t, 8> uint32s{};
+  StatusWithSize sws = decoder.ReadPackedUint32(uint32s);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), 5u);
+  EXPECT_EQ(uint32s[0], 0u);
+  EXPECT_EQ(uint32s[1], 50u);
+  EXPECT_EQ(uint32s[2], 100u);
+  EXPECT_EQ(uint32s[3], 150u);
+  EXPECT_EQ(uint32s[4], 200u);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber().value(), 2u);
+  std::array<int32_t, 8> int32s{};
+  sws = decoder.ReadPackedSint32(int32s);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), 7u);
+  EXPECT_EQ(int32s[0], -100);
+  EXPECT_EQ(int32s[1], -25);
+  EXPECT_EQ(int32s[2], -1);
+  EXPECT_EQ(int32s[3], 0);
+  EXPECT_EQ(int32s[4], 1);
+  EXPECT_EQ(int32s[5], 25);
+  EXPECT_EQ(int32s[6], 100);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber().value(), 3u);
+  sws = decoder.ReadPackedInt32(int32s);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), 2u);
+  EXPECT_EQ(int32s[0], -1);
+  EXPECT_EQ(int32s[1], 300);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber().value(), 4u);
+  std::array<bool, 3> bools{};
+  sws = decoder.ReadPackedBool(bools);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), 3u);
+  EXPECT_TRUE(bools[0]);
+  EXPECT_FALSE(bools[1]);
+  EXPECT_TRUE(bools[2]);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber().value(), 5u);
+  Result<int32_t> int32 = decoder.ReadInt32();
+  ASSERT_EQ(int32.status(), OkStatus());
+  EXPECT_EQ(int32.value(), 42);
+
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(StreamDecoder, Decode_PackedFixed) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=fixed32[], k=1, v={0, 0xdeadbeef}
+    0x0a, 0x08, 0x00, 0x00, 0x00, 0x00, 0xef, 0xbe, 0xad, 0xde,
+    // type=sfixed64[], k=2, v={-2}
+    0x12, 0x08, 0xfe, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    // type=float[], k=3, v={1.0, -2.5}
+    0x1a, 0x08, 0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0x20, 0xc0,
+    // type=double[], k=4, v={3.14159}
+    0x22, 0x08, 0x6e, 0x86, 0x1b, 0xf0, 0xf9, 0x21, 0x09, 0x40,
+  };
+  // clang-format on
+
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded_proto)));
+  StreamDecoder decoder(reader);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  std::array<uint32_t, 2> fixed32s{};
+  StatusWithSize sws = decoder.ReadPackedFixed32(fixed32s);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), 2u);
+  EXPECT_EQ(fixed32s[0], 0u);
+  EXPECT_EQ(fixed32s[1], 0xdeadbeefu);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  std::array<int64_t, 4> sfixed64s{};
+  sws = decoder.ReadPackedSfixed64(sfixed64s);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), 1u);
+  EXPECT_EQ(sfixed64s[0], -2);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  std::array<float, 2> floats{};
+  sws = decoder.ReadPackedFloat(floats);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), 2u);
+  EXPECT_EQ(floats[0], 1.0f);
+  EXPECT_EQ(floats[1], -2.5f);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  std::array<double, 1> doubles{};
+  sws = decoder.ReadPackedDouble(doubles);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), 1u);
+  EXPECT_EQ(doubles[0], 3.14159);
+
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(StreamDecoder, Decode_PackedVarints_LargerThanBuffer) {
+  std::array<uint64_t, 100> values;
+  for (size_t i = 0; i < values.size(); ++i) {
+    values[i] = uint64_t(1) << (i * 7 % 64);
+  }
+
+  std::array<std::byte, 1024> encoded;
+  MemoryEncoder encoder(encoded);
+  ASSERT_EQ(encoder.WritePackedUint64(1, values), OkStatus());
+  ASSERT_EQ(encoder.WriteUint32(2, 42), OkStatus());
+  ASSERT_GT(encoder.size(), 4 * config::kPackedVarintBufferSize);
+
+  const ConstByteSpan proto(encoder);
+  stream::MemoryReader reader(proto);
+  StreamDecoder decoder(reader);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  std::array<uint64_t, 100> decoded{};
+  StatusWithSize sws = decoder.ReadPackedUint64(decoded);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), values.size());
+  EXPECT_EQ(decoded, values);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber().value(), 2u);
+  EXPECT_EQ(decoder.ReadUint32().value(), 42u);
+}
+
+TEST(StreamDecoder, Decode_Packed_ResourceExhausted) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=uint32[], k=1, v={0, 50, 100, 150, 200}
+    0x0a, 0x07, 0x00, 0x32, 0x64, 0x96, 0x01, 0xc8, 0x01,
+    // type=fixed32[], k=2, v={0, 0xdeadbeef}
+    0x12, 0x08, 0x00, 0x00, 0x00, 0x00, 0xef, 0xbe, 0xad, 0xde,
+  };
+  // clang-format on
+
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded_proto)));
+  StreamDecoder decoder(reader);
+
+  // The position remains on the fields, so they can be read again.
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  std::array<uint32_t, 5> uint32s{};
+  StatusWithSize sws = decoder.ReadPackedUint32(std::span(uint32s).first(4));
+  EXPECT_EQ(sws.status(), Status::ResourceExhausted());
+  EXPECT_EQ(sws.size(), 4u);
+  sws = decoder.ReadPackedUint32(uint32s);
+  ASSERT_EQ(sws.status(), OkStatus());
+  ASSERT_EQ(sws.size(), 5u);
+  EXPECT_EQ(uint32s[4], 200u);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.ReadPackedFixed32(std::span(uint32s).first(1)).status(),
+            Status::ResourceExhausted());
+
+  // Skipping the field after a failed read continues to the next field.
+  EXPECT_EQ(decoder.Next(), Status::OutOfRange());
+}
+
+TEST(StreamDecoder, Decode_PackedVarints_ValueOutOfRange) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=uint64[], k=1, v={1, 0x100000000, 2}
+    0x0a, 0x07, 0x01, 0x80, 0x80, 0x80, 0x80, 0x10, 0x02,
+    // type=int32, k=2, v=42
+    0x10, 0x2a,
+  };
+  // clang-format on
+
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded_proto)));
+  StreamDecoder decoder(reader);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  std::array<uint32_t, 4> uint32s{};
+  StatusWithSize sws = decoder.ReadPackedUint32(uint32s);
+  EXPECT_EQ(sws.status(), Status::OutOfRange());
+  EXPECT_EQ(sws.size(), 1u);
+  EXPECT_EQ(uint32s[0], 1u);
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  ASSERT_EQ(decoder.FieldNumber().value(), 2u);
+  EXPECT_EQ(decoder.ReadInt32().value(), 42);
+}
+
+TEST(StreamDecoder, Decode_Packed_WrongType) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=int32, k=1, v=42
+    0x08, 0x2a,
+  };
+  // clang-format on
+
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded_proto)));
+  StreamDecoder decoder(reader);
+  std::array<uint32_t, 4> uint32s{};
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  EXPECT_EQ(decoder.ReadPackedUint32(uint32s).status(), Status::NotFound());
+}
+
+TEST(StreamDecoder, Decode_PackedVarints_BadData) {
+  // clang-format off
+  constexpr uint8_t encoded_proto[] = {
+    // type=uint32[], k=1, v={1, <truncated varint>}
+    0x0a, 0x02, 0x01, 0x80,
+  };
+  // clang-format on
+
+  stream::MemoryReader reader(std::as_bytes(std::span(encoded_proto)));
+  StreamDecoder decoder(reader);
+  std::array<uint32_t, 4> uint32s{};
+
+  EXPECT_EQ(decoder.Next(), OkStatus());
+  StatusWithSize sws = decoder.ReadPackedUint32(uint32s);
+  EXPECT_EQ(sws.status(), Status::DataLoss());
+  EXPECT_EQ(sws.size(), 1u);
+
+  EXPECT_EQ(decoder.Next(), Status::DataLoss());
+}
+
 TEST(StreamDecoder, GetLengthDelimitedPayloadBounds) {
   // clang-format off
   constexpr uint8_t encoded_proto[] = {
@@ -0,0 +1,289 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark comparing the ways to encode and decode a message with
+// generated code: pw_protobuf's per-field Write*() methods and a hand-written
+// StreamDecoder loop, pw_protobuf's table-driven message structs, and Nanopb.
+// Nanopb is only included if PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB is set,
+// which the build does when Nanopb is configured. This target should only be
+// built for the host.
+//
+// Build the pw_protobuf_compiler.codegen_benchmark target and run the binary.
+// Each line reports the encoding and decoding throughput for one code
+// generator in thousands of messages per second.
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+#include "pw_bytes/span.h"
+#include "pw_protobuf/stream_decoder.h"
+#include "pw_protobuf_compiler_comparison_protos/comparison.pwpb.h"
+#include "pw_stream/memory_stream.h"
+
+#ifndef PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB
+#define PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB 0
+#endif  // PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB
+
+#if PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB
+#include "pb_decode.h"
+#include "pb_encode.h"
+#include "pw_protobuf_compiler_comparison_protos/comparison.pb.h"
+#endif  // PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB
+
+namespace pw::protobuf_compiler {
+namespace {
+
+constexpr size_t kMessagesPerRun = 1024 * 1024;
+
+std::byte encoded[128];
+
+// Keeps the compiler from optimizing away unused results.
+volatile uint64_t result;
+
+Report::Message MakeReport() {
+  Report::Message report;
+  report.id = 1234;
+  report.timestamp = 1634342400123;
+  report.name = {'s', 'e', 'n', 's', 'o', 'r', '-', '7'};
+  report.position.latitude = 37422000;
+  report.position.longitude = -122084000;
+  for (uint32_t i = 0; i < report.samples.max_size(); ++i) {
+    report.samples.push_back(i * 37 % 4096);
+  }
+  report.battery = 0.87f;
+  report.charging = true;
+  return report;
+}
+
+// Each decoder returns this for the decoded message, or 0 if decoding failed.
+uint64_t Checksum(uint32_t id, int32_t latitude, size_t samples) {
+  return id + uint32_t(latitude) + samples;
+}
+
+// pw_protobuf with per-field Write*() methods and a hand-written decoder loop.
+size_t EncodePerField(const Report::Message& report) {
+  Report::MemoryEncoder encoder(encoded);
+  encoder.WriteId(report.id).IgnoreError();
+  encoder.WriteTimestamp(report.timestamp).IgnoreError();
+  encoder.WriteName(std::string_view(report.name.data(), report.name.size()))
+      .IgnoreError();
+  {
+    Position::StreamEncoder position = encoder.GetPositionEncoder();
+    position.WriteLatitude(report.position.latitude).IgnoreError();
+    position.WriteLongitude(report.position.longitude).IgnoreError();
+  }
+  encoder.WriteSamples(std::span(report.samples.data(), report.samples.size()))
+      .IgnoreError();
+  encoder.WriteBattery(report.battery).IgnoreError();
+  encoder.WriteCharging(report.charging).IgnoreError();
+  return encoder.status().ok() ? encoder.size() : 0;
+}
+
+uint64_t DecodePerField(ConstByteSpan message) {
+  Report::Message report{};
+  stream::MemoryReader reader(message);
+  protobuf::StreamDecoder decoder(reader);
+
+  Status status;
+  while ((status = decoder.Next()).ok()) {
+    switch (static_cast<Report::Fields>(decoder.FieldNumber().value())) {
+      case Report::Fields::ID:
+        report.id = decoder.ReadUint32().value_or(0);
+        break;
+      case Report::Fields::TIMESTAMP:
+        report.timestamp = decoder.ReadUint64().value_or(0);
+        break;
+      case Report::Fields::NAME: {
+        report.name.resize(report.name.max_size());
+        const StatusWithSize sws = decoder.ReadString(report.name);
+        report.name.resize(sws.size());
+        break;
+      }
+      case Report::Fields::POSITION: {
+        protobuf::StreamDecoder position = decoder.GetNestedDecoder();
+        while (position.Next().ok()) {
+          switch (static_cast<Position::Fields>(
+              position.FieldNumber().value())) {
+            case Position::Fields::LATITUDE:
+              report.position.latitude = position.ReadSint32().value_or(0);
+              break;
+            case Position::Fields::LONGITUDE:
+              report.position.longitude = position.ReadSint32().value_or(0);
+              break;
+          }
+        }
+        break;
+      }
+      case Report::Fields::SAMPLES: {
+        report.samples.resize(report.samples.max_size());
+        const StatusWithSize sws = decoder.ReadPackedUint32(report.samples);
+        report.samples.resize(sws.size());
+        break;
+      }
+      case Report::Fields::BATTERY:
+        report.battery = decoder.ReadFloat().value_or(0);
+        break;
+      case Report::Fields::CHARGING:
+        report.charging = decoder.ReadBool().value_or(false);
+        break;
+    }
+  }
+  if (!status.IsOutOfRange()) {
+    return 0;
+  }
+  return Checksum(report.id, report.position.latitude, report.samples.size());
+}
+
+// pw_protobuf with the table-driven message struct Write() and Read().
+size_t EncodeStruct(const Report::Message& report) {
+  Report::MemoryEncoder encoder(encoded);
+  return encoder.Write(report).ok() ? encoder.size() : 0;
+}
+
+uint64_t DecodeStruct(ConstByteSpan message) {
+  Report::Message report{};
+  stream::MemoryReader reader(message);
+  Report::StreamDecoder decoder(reader);
+  if (!decoder.Read(report).ok()) {
+    return 0;
+  }
+  return Checksum(report.id, report.position.latitude, report.samples.size());
+}
+
+#if PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB
+
+pw_protobuf_compiler_Report nanopb_report;
+
+size_t EncodeNanopb(const Report::Message&) {
+  pb_ostream_t stream = pb_ostream_from_buffer(
+      reinterpret_cast<pb_byte_t*>(encoded), sizeof(encoded));
+  if (!pb_encode(&stream, pw_protobuf_compiler_Report_fields, &nanopb_report)) {
+    return 0;
+  }
+  return stream.bytes_written;
+}
+
+uint64_t DecodeNanopb(ConstByteSpan message) {
+  pw_protobuf_compiler_Report report = pw_protobuf_compiler_Report_init_zero;
+  pb_istream_t stream = pb_istream_from_buffer(
+      reinterpret_cast<const pb_byte_t*>(message.data()), message.size());
+  if (!pb_decode(&stream, pw_protobuf_compiler_Report_fields, &report)) {
+    return 0;
+  }
+  return Checksum(report.id, report.position.latitude, report.samples_count);
+}
+
+void InitNanopbReport(const Report::Message& report) {
+  nanopb_report.id = report.id;
+  nanopb_report.timestamp = report.timestamp;
+  std::memcpy(nanopb_report.name, report.name.data(), report.name.size());
+  nanopb_report.has_position = true;
+  nanopb_report.position.latitude = report.position.latitude;
+  nanopb_report.position.longitude = report.position.longitude;
+  nanopb_report.samples_count = report.samples.size();
+  std::copy(report.samples.begin(),
+            report.samples.end(),
+            std::begin(nanopb_report.samples));
+  nanopb_report.battery = report.battery;
+  nanopb_report.charging = report.charging;
+}
+
+#endif  // PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB
+
+struct Benchmark {
+  const char* name;
+  size_t (*encode)(const Report::Message&);
+  uint64_t (*decode)(ConstByteSpan);
+};
+
+constexpr Benchmark kBenchmarks[] = {
+    {"per-field", EncodePerField, DecodePerField},
+    {"struct", EncodeStruct, DecodeStruct},
+#if PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB
+    {"nanopb", EncodeNanopb, DecodeNanopb},
+#endif  // PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB
+};
+
+// Returns the time per message in seconds, or 0 if encoding failed.
+double TimeEncode(const Benchmark& benchmark, const Report::Message& report) {
+  uint64_t sum = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kMessagesPerRun; ++i) {
+    const size_t size = benchmark.encode(report);
+    if (size == 0u) {
+      return 0;
+    }
+    sum += size;
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  result = sum;
+  return elapsed.count() / kMessagesPerRun;
+}
+
+// Returns the time per message in seconds, or 0 if decoding failed.
+double TimeDecode(const Benchmark& benchmark, ConstByteSpan message) {
+  uint64_t sum = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kMessagesPerRun; ++i) {
+    const uint64_t checksum = benchmark.decode(message);
+    if (checksum == 0u) {
+      return 0;
+    }
+    sum += checksum;
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  result = sum;
+  return elapsed.count() / kMessagesPerRun;
+}
+
+int Main() {
+  const Report::Message report = MakeReport();
+#if PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB
+  InitNanopbReport(report);
+#endif  // PW_PROTOBUF_COMPILER_BENCHMARK_NANOPB
+
+  std::printf("%-10s  %12s  %12s\n", "Kmsgs/s", "encode", "decode");
+  for (const Benchmark& benchmark : kBenchmarks) {
+    const double encode = TimeEncode(benchmark, report);
+
+    // Every implementation decodes the same message.
+    const size_t size = EncodeStruct(report);
+    const double decode = TimeDecode(benchmark, std::span(encoded, size));
+
+    if (encode == 0 || decode == 0) {
+      std::printf("Failed to encode or decode with %s\n", benchmark.name);
+      return 1;
+    }
+    std::printf(
+        "%-10s  %12.1f  %12.1f\n", benchmark.name, 1e-3 / encode, 1e-3 / decode);
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::protobuf_compiler
+
+int main() { return pw::protobuf_compiler::Main(); }
@@ -66,9 +66,12 @@ def _argument_parser() -> argparse.ArgumentParser:
 
 
 def protoc_cc_args(args: argparse.Namespace) -> Tuple[str, ...]:
+    # The pw_protobuf plugin reads *.options files from the include path to
+    # size the fields of generated message structs.
     return _COMMON_FLAGS + (
         '--plugin',
         f'protoc-gen-custom={args.plugin_path}',
+        f'--custom_opt=-I{args.compile_dir.as_posix()}',
         '--custom_out',
         args.out_dir,
     )
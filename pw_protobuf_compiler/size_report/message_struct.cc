@@ -0,0 +1,45 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Decodes and encodes a message with the generated message struct's Read() and
+// Write() methods.
+
+#include <cstddef>
+#include <span>
+
+#include "pw_bloat/bloat_this_binary.h"
+#include "pw_protobuf_compiler_comparison_protos/comparison.pwpb.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_sys_io/sys_io.h"
+
+int main() {
+  namespace Report = pw::protobuf_compiler::Report;
+
+  pw::bloat::BloatThisBinary();
+
+  std::byte buffer[128];
+  pw::sys_io::ReadBytes(buffer).IgnoreError();
+
+  Report::Message report{};
+  pw::stream::MemoryReader reader(buffer);
+  Report::StreamDecoder decoder(reader);
+  decoder.Read(report).IgnoreError();
+
+  Report::MemoryEncoder encoder(buffer);
+  encoder.Write(report).IgnoreError();
+
+  pw::sys_io::WriteBytes(std::span(buffer, encoder.size())).IgnoreError();
+
+  return static_cast<int>(buffer[92]);
+}
@@ -0,0 +1,45 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Decodes and encodes a message with Nanopb.
+
+#include <cstddef>
+#include <span>
+
+#include "pb_decode.h"
+#include "pb_encode.h"
+#include "pw_bloat/bloat_this_binary.h"
+#include "pw_protobuf_compiler_comparison_protos/comparison.pb.h"
+#include "pw_sys_io/sys_io.h"
+
+int main() {
+  pw::bloat::BloatThisBinary();
+
+  std::byte buffer[128];
+  pw::sys_io::ReadBytes(buffer).IgnoreError();
+
+  pw_protobuf_compiler_Report report = pw_protobuf_compiler_Report_init_zero;
+  pb_istream_t input = pb_istream_from_buffer(
+      reinterpret_cast<const pb_byte_t*>(buffer), sizeof(buffer));
+  pb_decode(&input, pw_protobuf_compiler_Report_fields, &report);
+
+  pb_ostream_t output = pb_ostream_from_buffer(
+      reinterpret_cast<pb_byte_t*>(buffer), sizeof(buffer));
+  pb_encode(&output, pw_protobuf_compiler_Report_fields, &report);
+
+  pw::sys_io::WriteBytes(std::span(buffer, output.bytes_written))
+      .IgnoreError();
+
+  return static_cast<int>(buffer[92]);
+}
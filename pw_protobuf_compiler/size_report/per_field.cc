@@ -0,0 +1,114 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Decodes a message with a hand-written StreamDecoder loop and encodes it with
+// the generated per-field Write*() methods.
+
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+#include "pw_bloat/bloat_this_binary.h"
+#include "pw_protobuf/stream_decoder.h"
+#include "pw_protobuf_compiler_comparison_protos/comparison.pwpb.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_sys_io/sys_io.h"
+
+namespace pw::protobuf_compiler {
+namespace {
+
+void Decode(ConstByteSpan message, Report::Message& report) {
+  stream::MemoryReader reader(message);
+  protobuf::StreamDecoder decoder(reader);
+
+  while (decoder.Next().ok()) {
+    switch (static_cast<Report::Fields>(decoder.FieldNumber().value())) {
+      case Report::Fields::ID:
+        report.id = decoder.ReadUint32().value_or(0);
+        break;
+      case Report::Fields::TIMESTAMP:
+        report.timestamp = decoder.ReadUint64().value_or(0);
+        break;
+      case Report::Fields::NAME: {
+        report.name.resize(report.name.max_size());
+        const StatusWithSize sws = decoder.ReadString(report.name);
+        report.name.resize(sws.size());
+        break;
+      }
+      case Report::Fields::POSITION: {
+        protobuf::StreamDecoder position = decoder.GetNestedDecoder();
+        while (position.Next().ok()) {
+          switch (static_cast<Position::Fields>(
+              position.FieldNumber().value())) {
+            case Position::Fields::LATITUDE:
+              report.position.latitude = position.ReadSint32().value_or(0);
+              break;
+            case Position::Fields::LONGITUDE:
+              report.position.longitude = position.ReadSint32().value_or(0);
+              break;
+          }
+        }
+        break;
+      }
+      case Report::Fields::SAMPLES: {
+        report.samples.resize(report.samples.max_size());
+        const StatusWithSize sws = decoder.ReadPackedUint32(report.samples);
+        report.samples.resize(sws.size());
+        break;
+      }
+      case Report::Fields::BATTERY:
+        report.battery = decoder.ReadFloat().value_or(0);
+        break;
+      case Report::Fields::CHARGING:
+        report.charging = decoder.ReadBool().value_or(false);
+        break;
+    }
+  }
+}
+
+size_t Encode(const Report::Message& report, ByteSpan buffer) {
+  Report::MemoryEncoder encoder(buffer);
+  encoder.WriteId(report.id).IgnoreError();
+  encoder.WriteTimestamp(report.timestamp).IgnoreError();
+  encoder.WriteName(std::string_view(report.name.data(), report.name.size()))
+      .IgnoreError();
+  {
+    Position::StreamEncoder position = encoder.GetPositionEncoder();
+    position.WriteLatitude(report.position.latitude).IgnoreError();
+    position.WriteLongitude(report.position.longitude).IgnoreError();
+  }
+  encoder.WriteSamples(std::span(report.samples.data(), report.samples.size()))
+      .IgnoreError();
+  encoder.WriteBattery(report.battery).IgnoreError();
+  encoder.WriteCharging(report.charging).IgnoreError();
+  return encoder.size();
+}
+
+}  // namespace
+}  // namespace pw::protobuf_compiler
+
+int main() {
+  pw::bloat::BloatThisBinary();
+
+  std::byte buffer[128];
+  pw::sys_io::ReadBytes(buffer).IgnoreError();
+
+  pw::protobuf_compiler::Report::Message report{};
+  pw::protobuf_compiler::Decode(buffer, report);
+  const size_t size = pw::protobuf_compiler::Encode(report, buffer);
+
+  pw::sys_io::WriteBytes(std::span(buffer, size)).IgnoreError();
+
+  return static_cast<int>(buffer[92]);
+}
@@ -0,0 +1,134 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/async_channel_output.h"
+
+#include <cstddef>
+#include <span>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "pw_containers/vector.h"
+#include "pw_sync/thread_notification.h"
+
+namespace pw::rpc {
+namespace {
+
+// Records the first byte of each packet that is sent.
+class TestAsyncOutput final : public AsyncChannelOutput<3, 16> {
+ public:
+  TestAsyncOutput() : AsyncChannelOutput("test") {}
+
+  const Vector<std::byte, 8>& sent() const { return sent_; }
+
+ private:
+  Status Send(std::span<const std::byte> packet) override {
+    sent_.push_back(packet.front());
+    return OkStatus();
+  }
+
+  Vector<std::byte, 8> sent_;
+};
+
+std::span<const std::byte> Fill(std::span<std::byte> buffer, std::byte value) {
+  buffer[0] = value;
+  return buffer.first(1);
+}
+
+TEST(AsyncChannelOutput, SendAndReleaseBuffer_QueuesForSendThread) {
+  TestAsyncOutput output;
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(OkStatus(),
+              output.SendAndReleaseBuffer(
+                  Fill(output.AcquireBuffer(), std::byte(i))));
+  }
+  EXPECT_TRUE(output.sent().empty());
+
+  std::thread send_thread([&output] { output.Start(); });
+  output.RequestStop();
+  send_thread.join();
+
+  ASSERT_EQ(output.sent().size(), 3u);
+  EXPECT_EQ(output.sent()[0], std::byte{0});
+  EXPECT_EQ(output.sent()[1], std::byte{1});
+  EXPECT_EQ(output.sent()[2], std::byte{2});
+}
+
+TEST(AsyncChannelOutput, AcquireBuffer_QueueFull_ReturnsEmptyBuffer) {
+  TestAsyncOutput output;
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(OkStatus(),
+              output.SendAndReleaseBuffer(
+                  Fill(output.AcquireBuffer(), std::byte(i))));
+  }
+
+  std::span<std::byte> empty = output.AcquireBuffer();
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(empty));
+}
+
+TEST(AsyncChannelOutput, AcquireBuffer_QueueFull_CallsOnReadyOnceSent) {
+  TestAsyncOutput output;
+  struct {
+    sync::ThreadNotification ready;
+    int calls = 0;
+  } context;
+
+  output.set_on_ready([&context] {
+    context.calls += 1;
+    context.ready.release();
+  });
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(OkStatus(),
+              output.SendAndReleaseBuffer(
+                  Fill(output.AcquireBuffer(), std::byte(i))));
+  }
+  EXPECT_TRUE(output.AcquireBuffer().empty());
+  EXPECT_TRUE(output.AcquireBuffer().empty());
+
+  std::thread send_thread([&output] { output.Start(); });
+  context.ready.acquire();
+
+  std::span<std::byte> buffer = output.AcquireBuffer();
+  EXPECT_FALSE(buffer.empty());
+  output.DiscardBuffer(buffer);
+
+  output.RequestStop();
+  send_thread.join();
+
+  EXPECT_EQ(context.calls, 1);
+  EXPECT_EQ(output.sent().size(), 3u);
+}
+
+TEST(AsyncChannelOutput, RequestStop_DiscardsLaterPackets) {
+  TestAsyncOutput output;
+
+  std::span<std::byte> buffer = output.AcquireBuffer();
+  ASSERT_FALSE(buffer.empty());
+
+  std::thread send_thread([&output] { output.Start(); });
+  output.RequestStop();
+  send_thread.join();
+
+  EXPECT_EQ(Status::Unavailable(),
+            output.SendAndReleaseBuffer(Fill(buffer, std::byte{1})));
+  EXPECT_TRUE(output.AcquireBuffer().empty());
+  EXPECT_TRUE(output.sent().empty());
+}
+
+}  // namespace
+}  // namespace pw::rpc
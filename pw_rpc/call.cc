@@ -44,7 +44,7 @@ Call::Call(Endpoint& endpoint_ref,
            MethodType type,
            CallType call_type)
     : endpoint_(&endpoint_ref),
-      channel_(endpoint().GetInternalChannel(channel_id)),
+      channel_{},
       id_(call_id),
       service_id_(service_id),
       method_id_(method_id),
@@ -55,6 +55,10 @@ Call::Call(Endpoint& endpoint_ref,
                                                  : kClientStreamInactive) {
   // TODO(pwbug/505): Defer channel lookup until it's needed to support dynamic
   // registration/removal of channels.
+  endpoint_lock().lock();
+  channel_ = endpoint().GetInternalChannel(channel_id);
+  endpoint_lock().unlock();
+
   PW_CHECK_NOTNULL(channel_,
                    "An RPC call was created for channel %u, but that channel "
                    "is not known to the server/client.",
@@ -63,7 +67,9 @@ Call::Call(Endpoint& endpoint_ref,
   endpoint().RegisterCall(*this);
 }
 
-void Call::MoveFrom(Call& other) {
+// This call takes the other call's IDs, so the other call's lock is also this
+// call's lock when this call is registered.
+void Call::MoveFrom(Call& other) PW_NO_LOCK_SAFETY_ANALYSIS {
   PW_DCHECK(!active());
 
   if (!other.active()) {
@@ -141,6 +147,12 @@ Status Call::SendPacket(PacketType type, ConstByteSpan payload, Status status) {
   if (!buffer().Contains(payload)) {
     ByteSpan buffer = PayloadBuffer();
 
+    // The ChannelOutput may have no buffers available.
+    if (response_.empty()) {
+      rpc_lock().unlock();
+      return Status::ResourceExhausted();
+    }
+
     if (payload.size() > buffer.size()) {
       ReleasePayloadBuffer();
       rpc_lock().unlock();
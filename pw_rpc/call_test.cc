@@ -157,6 +157,16 @@ TEST(ServerWriter, Open_SendsPacketWithPayload) {
           encoded, context.output().sent_data().data(), result.value().size()));
 }
 
+TEST(ServerWriter, Write_NoBufferAvailable_ReturnsResourceExhausted) {
+  ServerContextForTest<TestService, 0> context(TestService::method.method());
+  FakeServerWriter writer(context.get());
+
+  constexpr byte data[] = {byte{0xf0}, byte{0x0d}};
+  EXPECT_EQ(Status::ResourceExhausted(), writer.Write(data));
+  EXPECT_EQ(context.output().packet_count(), 0u);
+  EXPECT_TRUE(writer.active());
+}
+
 TEST(ServerWriter, Closed_IgnoresFinish) {
   ServerContextForTest<TestService> context(TestService::method.method());
   FakeServerWriter writer(context.get());
@@ -212,7 +222,7 @@ TEST(ServerReader, EndClientStream_OnlyClosesClientStream) {
 
   EXPECT_TRUE(reader.active());
   EXPECT_TRUE(reader.as_server_call().client_stream_open());
-  rpc_lock().lock();
+  reader.as_server_call().rpc_lock().lock();
   reader.as_server_call().HandleClientStreamEnd();
 
   EXPECT_TRUE(reader.active());
@@ -244,11 +254,11 @@ TEST(ServerReaderWriter, Move_MovesCallbacks) {
 #endif  // PW_RPC_CLIENT_STREAM_END_CALLBACK
 
   test::FakeServerReaderWriter destination(std::move(reader_writer));
-  rpc_lock().lock();
+  destination.as_server_call().rpc_lock().lock();
   destination.as_server_call().HandlePayload({});
-  rpc_lock().lock();
+  destination.as_server_call().rpc_lock().lock();
   destination.as_server_call().HandleClientStreamEnd();
-  rpc_lock().lock();
+  destination.as_server_call().rpc_lock().lock();
   destination.as_server_call().HandleError(Status::Unknown());
 
   EXPECT_EQ(calls, 2 + PW_RPC_CLIENT_STREAM_END_CALLBACK);
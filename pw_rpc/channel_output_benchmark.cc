@@ -0,0 +1,221 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark for server throughput with several threads calling the
+// BenchmarkService at once. Each thread sends UnaryEcho requests on its own
+// channel, and all channels share one ChannelOutput. The benchmark compares a
+// single-buffer output wrapped in a SynchronizedChannelOutput, which encodes
+// one response at a time, with a PooledChannelOutput, which encodes responses
+// in parallel and sends them in order. Multiple threads are only used if
+// PW_RPC_USE_GLOBAL_MUTEX is enabled. This target should only be built for the
+// host.
+//
+// Build the pw_rpc.channel_output_benchmark target and run the binary. Each
+// line reports the responses per second and response megabytes per second for
+// one output, thread count, and payload size.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "pw_rpc/benchmark.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/internal/config.h"
+#include "pw_rpc/internal/hash.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_rpc/pooled_channel_output.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc/synchronized_channel_output.h"
+#include "pw_sync/mutex.h"
+
+namespace pw::rpc {
+namespace {
+
+using internal::Packet;
+using internal::PacketType;
+
+constexpr size_t kRequestsPerThread = 64 * 1024;
+
+constexpr size_t kMaxThreads = 8;
+constexpr size_t kThreadCounts[] = {1, 2, 4, kMaxThreads};
+constexpr size_t kPayloadSizes[] = {32, 256};
+
+constexpr size_t kBufferSizeBytes = 512;
+
+// The server can only be called from multiple threads with the global mutex.
+constexpr bool kThreadSafe = PW_RPC_USE_GLOBAL_MUTEX;
+
+// Stands in for the transport by copying each packet out of its buffer. Only
+// one thread at a time sends packets to it.
+class Transport {
+ public:
+  Status Send(std::span<const std::byte> packet) {
+    std::memcpy(wire_.data(), packet.data(), packet.size());
+    packets_ += 1;
+    bytes_ += packet.size();
+    return OkStatus();
+  }
+
+  void Reset() {
+    packets_ = 0;
+    bytes_ = 0;
+  }
+
+  size_t packets() const { return packets_; }
+  size_t bytes() const { return bytes_; }
+
+ private:
+  std::array<std::byte, kBufferSizeBytes> wire_;
+  size_t packets_ = 0;
+  size_t bytes_ = 0;
+};
+
+class SingleBufferOutput : public ChannelOutput {
+ public:
+  SingleBufferOutput(Transport& transport)
+      : ChannelOutput("synchronized"), transport_(transport) {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override {
+    if (buffer.empty()) {
+      return OkStatus();
+    }
+    return transport_.Send(buffer);
+  }
+
+ private:
+  Transport& transport_;
+  std::array<std::byte, kBufferSizeBytes> buffer_;
+};
+
+class PooledOutput final
+    : public PooledChannelOutput<kMaxThreads, kBufferSizeBytes> {
+ public:
+  PooledOutput(Transport& transport)
+      : PooledChannelOutput("pooled"), transport_(transport) {}
+
+ private:
+  Status Send(std::span<const std::byte> packet) override {
+    return transport_.Send(packet);
+  }
+
+  Transport& transport_;
+};
+
+// Returns the time to process every request in seconds.
+double TimeRequests(ChannelOutput& output,
+                    size_t thread_count,
+                    size_t payload_size) {
+  std::array<Channel, kMaxThreads> channels;
+  for (size_t i = 0; i < channels.size(); ++i) {
+    channels[i].Configure(i + 1, output);
+  }
+
+  Server server(channels);
+  BenchmarkService service;
+  server.RegisterService(service);
+
+  // Each thread calls UnaryEcho on its own channel, so the calls do not cancel
+  // one another.
+  std::array<std::byte, kBufferSizeBytes> payload = {};
+  std::array<std::array<std::byte, kBufferSizeBytes>, kMaxThreads> buffers;
+  std::array<ConstByteSpan, kMaxThreads> requests;
+
+  for (size_t i = 0; i < thread_count; ++i) {
+    requests[i] = Packet(PacketType::REQUEST,
+                         static_cast<uint32_t>(i + 1),
+                         service.id(),
+                         internal::Hash("UnaryEcho"),
+                         1,
+                         std::span(payload).first(payload_size))
+                      .Encode(buffers[i])
+                      .value_or(ConstByteSpan());
+  }
+
+  std::vector<std::thread> threads;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < thread_count; ++i) {
+    threads.emplace_back([&server, &output, request = requests[i]] {
+      for (size_t count = 0; count < kRequestsPerThread; ++count) {
+        server.ProcessPacket(request, output).IgnoreError();
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  return elapsed.count();
+}
+
+int Main() {
+  Transport transport;
+
+  sync::Mutex mutex;
+  SynchronizedChannelOutput<SingleBufferOutput> synchronized_output(mutex,
+                                                                    transport);
+  PooledOutput pooled_output(transport);
+
+  ChannelOutput* const outputs[] = {&synchronized_output, &pooled_output};
+
+  if (!kThreadSafe) {
+    std::printf("PW_RPC_USE_GLOBAL_MUTEX is disabled; using one thread\n");
+  }
+
+  std::printf("%-14s  %7s  %7s  %12s  %8s  %8s\n",
+              "output",
+              "threads",
+              "payload",
+              "responses/s",
+              "MB/s",
+              "dropped");
+
+  for (ChannelOutput* output : outputs) {
+    for (size_t threads : kThreadCounts) {
+      if (threads > 1u && !kThreadSafe) {
+        break;
+      }
+
+      for (size_t payload_size : kPayloadSizes) {
+        transport.Reset();
+        const double time = TimeRequests(*output, threads, payload_size);
+        const size_t requests = threads * kRequestsPerThread;
+
+        std::printf("%-14s  %7zu  %7zu  %12.0f  %8.1f  %8zu\n",
+                    output->name(),
+                    threads,
+                    payload_size,
+                    transport.packets() / time,
+                    transport.bytes() / time / 1e6,
+                    requests - transport.packets());
+      }
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::rpc
+
+int main() { return pw::rpc::Main(); }
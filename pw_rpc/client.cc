@@ -33,26 +33,30 @@ using internal::PacketType;
 
 }  // namespace
 
-Status Client::ProcessPacket(ConstByteSpan data) {
+// The call's lock is the lock for the packet's IDs, which the lock analysis
+// cannot determine.
+Status Client::ProcessPacket(ConstByteSpan data) PW_NO_LOCK_SAFETY_ANALYSIS {
   PW_TRY_ASSIGN(Result<Packet> result,
                 Endpoint::ProcessPacket(data, Packet::kClient));
   Packet& packet = *result;
 
-  // Find an existing call for this RPC, if any.
-  internal::rpc_lock().lock();
-  internal::ClientCall* call =
-      static_cast<internal::ClientCall*>(FindCall(packet));
-
+  internal::endpoint_lock().lock();
   internal::Channel* channel = GetInternalChannel(packet.channel_id());
+  internal::endpoint_lock().unlock();
 
   if (channel == nullptr) {
     PW_LOG_WARN("RPC client received a packet for an unregistered channel");
-    internal::rpc_lock().unlock();
     return Status::Unavailable();
   }
 
+  // Find an existing call for this RPC, if any.
+  internal::RpcLock& call_lock = CallLock(packet);
+  call_lock.lock();
+  internal::ClientCall* call =
+      static_cast<internal::ClientCall*>(FindCall(packet));
+
   if (call == nullptr || call->id() != packet.call_id()) {
-    internal::rpc_lock().unlock();
+    call_lock.unlock();
     // The call for the packet does not exist. If the packet is a server stream
     // message, notify the server so that it can kill the stream. Otherwise,
     // silently drop the packet (as it would terminate the RPC anyway).
@@ -90,7 +94,7 @@ Status Client::ProcessPacket(ConstByteSpan data) {
       }
       break;
     default:
-      internal::rpc_lock().unlock();
+      call_lock.unlock();
       PW_LOG_WARN("pw_rpc client unable to handle packet of type %u",
                   static_cast<unsigned>(packet.type()));
   }
@@ -0,0 +1,237 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark for the time the server takes to dispatch a packet to an open
+// call. Each run registers a number of services, opens a number of
+// bidirectional streaming calls spread across them, and then processes client
+// stream packets for the open calls in round-robin order. This target should
+// only be built for the host.
+//
+// Build the pw_rpc.dispatch_benchmark target and run the binary. Each line
+// reports the average time to process one packet in nanoseconds for a number
+// of registered services and open calls.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "pw_rpc/channel.h"
+#include "pw_rpc/internal/hash.h"
+#include "pw_rpc/internal/packet.h"
+#include "pw_rpc/raw/internal/method_union.h"
+#include "pw_rpc/raw/server_reader_writer.h"
+#include "pw_rpc/server.h"
+#include "pw_rpc/service.h"
+
+namespace pw::rpc {
+namespace {
+
+using internal::Hash;
+using internal::Packet;
+using internal::PacketType;
+using internal::RawMethod;
+using internal::RawMethodUnion;
+
+constexpr size_t kPacketsPerRun = 256 * 1024;
+
+constexpr size_t kServiceCounts[] = {1, 8, 32, 128};
+constexpr size_t kOpenCallCounts[] = {1, 16, 128, 512};
+
+constexpr size_t kMethodsPerService = 4;
+
+// Only one call per method can be open on a channel, so the calls are spread
+// across enough channels to fit the largest number of open calls.
+constexpr size_t kMaxChannels = 512 / kMethodsPerService;
+
+// Calls opened by the service are kept here so they stay open.
+std::vector<RawServerReaderWriter> open_calls;
+
+// Keeps the compiler from optimizing away unused results.
+volatile size_t result;
+
+void OpenCall(RawServerReaderWriter& call) {
+  call.set_on_next([](ConstByteSpan payload) { result = payload.size(); });
+  open_calls.push_back(std::move(call));
+}
+
+class BenchmarkService final : public Service {
+ public:
+  BenchmarkService(uint32_t id) : Service(id, kMethods) {}
+
+  // The method IDs are hashes of the method names, sorted by ID.
+  static constexpr std::array<uint32_t, kMethodsPerService> kMethodIds = {
+      Hash("Notify"),
+      Hash("Stream"),
+      Hash("Control"),
+      Hash("Echo"),
+  };
+
+ private:
+  static constexpr std::array<RawMethodUnion, kMethodsPerService> kMethods = {
+      RawMethod::BidirectionalStreaming<OpenCall>(kMethodIds[0]),
+      RawMethod::BidirectionalStreaming<OpenCall>(kMethodIds[1]),
+      RawMethod::BidirectionalStreaming<OpenCall>(kMethodIds[2]),
+      RawMethod::BidirectionalStreaming<OpenCall>(kMethodIds[3]),
+  };
+};
+
+constexpr bool MethodIdsSorted() {
+  for (size_t i = 1; i < BenchmarkService::kMethodIds.size(); ++i) {
+    if (BenchmarkService::kMethodIds[i - 1] >=
+        BenchmarkService::kMethodIds[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static_assert(MethodIdsSorted(), "Methods must be sorted by ID");
+
+// The server does not send any packets for client streams, so packets are
+// simply discarded.
+class NullChannelOutput final : public ChannelOutput {
+ public:
+  NullChannelOutput() : ChannelOutput("null") {}
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte>) override {
+    return OkStatus();
+  }
+
+ private:
+  std::array<std::byte, 64> buffer_;
+};
+
+using EncodedPacket = std::array<std::byte, 32>;
+
+struct Target {
+  uint32_t channel_id;
+  uint32_t service_id;
+  uint32_t method_id;
+  uint32_t call_id;
+};
+
+ConstByteSpan Encode(const Target& target,
+                     PacketType type,
+                     EncodedPacket& buffer) {
+  static constexpr std::byte kPayload[] = {
+      std::byte{1}, std::byte{2}, std::byte{3}, std::byte{4}};
+
+  return Packet(type,
+                target.channel_id,
+                target.service_id,
+                target.method_id,
+                target.call_id,
+                kPayload)
+      .Encode(buffer)
+      .value_or(ConstByteSpan());
+}
+
+// Returns the time per packet in seconds, or 0 if processing failed.
+double TimeDispatch(size_t service_count, size_t call_count) {
+  NullChannelOutput output;
+  std::array<Channel, kMaxChannels> channels;
+  for (size_t i = 0; i < channels.size(); ++i) {
+    channels[i].Configure(i + 1, output);
+  }
+
+  Server server(channels);
+
+  std::vector<std::unique_ptr<BenchmarkService>> services;
+  for (size_t i = 0; i < service_count; ++i) {
+    char name[48];
+    const int size = std::snprintf(
+        name, sizeof(name), "pw.rpc.benchmark.Service%zu", i);
+    services.push_back(std::make_unique<BenchmarkService>(
+        Hash(std::string_view(name, static_cast<size_t>(size)))));
+    server.RegisterService(*services.back());
+  }
+
+  // Open the calls, cycling through services, then methods, then channels.
+  std::vector<EncodedPacket> packets(call_count);
+  std::vector<ConstByteSpan> encoded(call_count);
+  open_calls.clear();
+  open_calls.reserve(call_count);
+
+  for (size_t i = 0; i < call_count; ++i) {
+    const size_t service = i % service_count;
+    const size_t method = i / service_count % kMethodsPerService;
+    const size_t channel = i / service_count / kMethodsPerService;
+
+    const Target target = {static_cast<uint32_t>(channel + 1),
+                           services[service]->id(),
+                           BenchmarkService::kMethodIds[method],
+                           static_cast<uint32_t>(i + 1)};
+
+    if (!server
+             .ProcessPacket(Encode(target, PacketType::REQUEST, packets[i]),
+                            output)
+             .ok()) {
+      break;
+    }
+    encoded[i] = Encode(target, PacketType::CLIENT_STREAM, packets[i]);
+  }
+
+  // The calls must close before the server goes away.
+  if (open_calls.size() != call_count) {
+    open_calls.clear();
+    return 0;
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kPacketsPerRun; ++i) {
+    server.ProcessPacket(encoded[i % call_count], output).IgnoreError();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  open_calls.clear();
+  return elapsed.count() / kPacketsPerRun;
+}
+
+int Main() {
+  std::printf("%-10s", "ns/packet");
+  for (size_t calls : kOpenCallCounts) {
+    std::printf("  %6zu calls", calls);
+  }
+  std::printf("\n");
+
+  for (size_t services : kServiceCounts) {
+    std::printf("%3zu svcs  ", services);
+    for (size_t calls : kOpenCallCounts) {
+      const double time = TimeDispatch(services, calls);
+      if (time == 0) {
+        std::printf("\nFailed to open %zu calls on %zu services\n",
+                    calls,
+                    services);
+        return 1;
+      }
+      std::printf("  %12.1f", time * 1e9);
+    }
+    std::printf("\n");
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::rpc
+
+int main() { return pw::rpc::Main(); }
@@ -0,0 +1,555 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark for round-trip throughput and latency between a client and the
+// BenchmarkService. Each run opens a number of lanes. A lane is a channel of a
+// shared client, a server with its own BenchmarkService, and the transport
+// between them. Each lane's thread sends UnaryEcho requests or
+// BidirectionalEcho stream messages one at a time and waits for each echo
+// before sending the next. Two transports are measured:
+//
+//   loopback - Packets are passed directly between the client and server on the
+//       calling thread, so each response arrives before the request returns.
+//   socket_hdlc - The client and server are connected by a localhost
+//       SocketStream. Packets are sent in HDLC frames with an
+//       hdlc::RpcChannelOutput, and each server runs on its own thread. The
+//       HDLC encoder writes each frame in several pieces, so both sockets
+//       disable Nagle's algorithm to avoid waiting on delayed ACKs.
+//
+// Using more than one lane calls the client from multiple threads, which
+// requires PW_RPC_USE_GLOBAL_MUTEX. If it is disabled, only one lane is used.
+// This target should only be built for the host.
+//
+// Build the pw_rpc.echo_benchmark target and run the binary. Each line is a
+// JSON object with the results for one transport, mode, lane count, and payload
+// size, so the output can be collected and compared across builds:
+//
+//   transport, mode, lanes, payload - The run's configuration.
+//   requests - The number of requests sent by all lanes.
+//   dropped - The number of requests that were not echoed.
+//   packets_per_s - RPC packets sent in both directions per second.
+//   mb_per_s - Megabytes of encoded RPC packets sent per second.
+//   p50_us, p99_us - Round-trip latency percentiles in microseconds.
+//   allocs_per_request - Heap allocations per request in the measured loop.
+//
+// Diagnostics are printed to stderr so they do not mix with the results.
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "pw_hdlc/decoder.h"
+#include "pw_hdlc/rpc_channel.h"
+#include "pw_rpc/benchmark.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/internal/config.h"
+#include "pw_rpc/server.h"
+#include "pw_stream/socket_stream.h"
+
+namespace pw::rpc {
+namespace {
+
+using pw_rpc::raw::Benchmark;
+
+constexpr size_t kRequestsPerLane = 2048;
+
+constexpr size_t kMaxLanes = 8;
+constexpr size_t kLaneCounts[] = {1, 2, 4, kMaxLanes};
+constexpr size_t kPayloadSizes[] = {16, 128, 256};
+
+constexpr size_t kBufferSizeBytes = 512;
+
+// The HDLC address used for RPC frames by the socket_hdlc transport.
+constexpr uint64_t kHdlcAddress = 'R';
+
+// Each socket_hdlc lane listens on its own port, starting at this one.
+constexpr uint16_t kFirstPort = 33000;
+
+// The client can only be called from multiple threads with the global mutex.
+constexpr bool kThreadSafe = PW_RPC_USE_GLOBAL_MUTEX;
+
+enum class Transport { kLoopback, kSocketHdlc };
+enum class Mode { kUnary, kStreaming };
+
+const char* TransportName(Transport transport) {
+  return transport == Transport::kLoopback ? "loopback" : "socket_hdlc";
+}
+
+const char* ModeName(Mode mode) {
+  return mode == Mode::kUnary ? "unary" : "streaming";
+}
+
+// Counts every heap allocation made by the process. See the replacement
+// operator new at the bottom of this file.
+std::atomic<size_t> allocations;
+
+// One channel of the shared client and the server at the other end of it. Each
+// lane is only used by one client thread.
+class Lane {
+ public:
+  Lane(uint32_t channel_id)
+      : channel_id_(channel_id), server_(std::span(&server_channel_, 1)) {
+    server_.RegisterService(service_);
+  }
+
+  virtual ~Lane() = default;
+
+  uint32_t channel_id() const { return channel_id_; }
+  size_t responses() const { return responses_; }
+  const std::vector<uint32_t>& latencies() const { return latencies_; }
+
+  // Returns the number of RPC packets and encoded bytes sent in both
+  // directions. Only call these after the lane is closed.
+  virtual size_t packets() const = 0;
+  virtual size_t bytes() const = 0;
+
+  // The client's output for this lane's channel.
+  virtual ChannelOutput& client_output() = 0;
+
+  // Stops any threads used by the transport.
+  virtual void Close() {}
+
+  // Sends the requests one at a time and records the round-trip time of each.
+  // Waits until start is set before sending the first request.
+  void Run(Client& client,
+           Mode mode,
+           ConstByteSpan payload,
+           size_t requests,
+           const std::atomic<bool>& start) {
+    latencies_.clear();
+    latencies_.reserve(requests);
+    responses_ = 0;
+
+    RawClientReaderWriter stream;
+    if (mode == Mode::kStreaming) {
+      stream = Benchmark::BidirectionalEcho(
+          client, channel_id_, [this](ConstByteSpan) { responses_ += 1; });
+    }
+
+    while (!start.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+
+    for (size_t count = 0; count < requests; ++count) {
+      const auto sent = std::chrono::steady_clock::now();
+
+      // The unary call must stay open until its response is received.
+      RawUnaryReceiver unary;
+      if (mode == Mode::kStreaming) {
+        stream.Write(payload).IgnoreError();
+      } else {
+        unary = Benchmark::UnaryEcho(
+            client, channel_id_, payload, [this](ConstByteSpan, Status status) {
+              if (status.ok()) {
+                responses_ += 1;
+              }
+            });
+      }
+
+      if (!ReceiveResponse().ok()) {
+        break;
+      }
+
+      latencies_.push_back(static_cast<uint32_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - sent)
+              .count()));
+    }
+
+    stream.Cancel().IgnoreError();
+  }
+
+ protected:
+  Server& server() { return server_; }
+  Channel& server_channel() { return server_channel_; }
+
+ private:
+  // Blocks until the response to the most recent request is processed.
+  virtual Status ReceiveResponse() = 0;
+
+  const uint32_t channel_id_;
+  Channel server_channel_;
+  BenchmarkService service_;
+  Server server_;
+
+  size_t responses_ = 0;
+  std::vector<uint32_t> latencies_;
+};
+
+// Passes each packet to the client or server on the same thread.
+class LoopbackOutput final : public ChannelOutput {
+ public:
+  LoopbackOutput() : ChannelOutput("loopback") {}
+
+  void set_destination(Server& server) { server_ = &server; }
+  void set_destination(Client& client) { client_ = &client; }
+
+  size_t packets() const { return packets_; }
+  size_t bytes() const { return bytes_; }
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override {
+    if (buffer.empty()) {
+      return OkStatus();
+    }
+    packets_ += 1;
+    bytes_ += buffer.size();
+
+    if (server_ != nullptr) {
+      return server_->ProcessPacket(buffer, *this);
+    }
+    return client_->ProcessPacket(buffer);
+  }
+
+ private:
+  Server* server_ = nullptr;
+  Client* client_ = nullptr;
+  size_t packets_ = 0;
+  size_t bytes_ = 0;
+  std::array<std::byte, kBufferSizeBytes> buffer_;
+};
+
+class LoopbackLane final : public Lane {
+ public:
+  LoopbackLane(uint32_t channel_id, Client& client, uint16_t)
+      : Lane(channel_id) {
+    server_channel().Configure(channel_id, to_client_);
+    to_server_.set_destination(server());
+    to_client_.set_destination(client);
+  }
+
+  size_t packets() const override {
+    return to_server_.packets() + to_client_.packets();
+  }
+  size_t bytes() const override {
+    return to_server_.bytes() + to_client_.bytes();
+  }
+
+  ChannelOutput& client_output() override { return to_server_; }
+
+ private:
+  // The response was processed before the request returned.
+  Status ReceiveResponse() override { return OkStatus(); }
+
+  LoopbackOutput to_server_;
+  LoopbackOutput to_client_;
+};
+
+// Sends packets in HDLC frames and counts them.
+class HdlcOutput final
+    : public hdlc::RpcChannelOutputBuffer<kBufferSizeBytes> {
+ public:
+  HdlcOutput(stream::Writer& writer)
+      : RpcChannelOutputBuffer(writer, kHdlcAddress, "hdlc") {}
+
+  size_t packets() const { return packets_; }
+  size_t bytes() const { return bytes_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override {
+    if (!buffer.empty()) {
+      packets_ += 1;
+      bytes_ += buffer.size();
+    }
+    return RpcChannelOutputBuffer::SendAndReleaseBuffer(buffer);
+  }
+
+ private:
+  size_t packets_ = 0;
+  size_t bytes_ = 0;
+};
+
+// Runs the server on its own thread, which reads frames from a socket until the
+// client disconnects. The client thread reads the responses itself.
+class SocketHdlcLane final : public Lane {
+ public:
+  SocketHdlcLane(uint32_t channel_id, Client& client, uint16_t port)
+      : Lane(channel_id),
+        client_(client),
+        port_(port),
+        to_server_(client_socket_),
+        to_client_(server_socket_) {
+    server_channel().Configure(channel_id, to_client_);
+  }
+
+  ~SocketHdlcLane() { Close(); }
+
+  // Starts the server thread and connects to it.
+  Status Connect() {
+    server_thread_ = std::thread([this] { Serve(); });
+
+    // The server may not be listening yet, so retry for up to a second.
+    for (int attempt = 0; attempt < 100; ++attempt) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      if (client_socket_.Connect(nullptr, port_).ok()) {
+        return client_socket_.DisableNagle();
+      }
+      client_socket_.Close();
+    }
+    return Status::Unavailable();
+  }
+
+  size_t packets() const override {
+    return to_server_.packets() + to_client_.packets();
+  }
+  size_t bytes() const override {
+    return to_server_.bytes() + to_client_.bytes();
+  }
+
+  ChannelOutput& client_output() override { return to_server_; }
+
+  // Disconnecting the client makes the server thread return.
+  void Close() override {
+    client_socket_.Close();
+    if (server_thread_.joinable()) {
+      server_thread_.join();
+    }
+  }
+
+ private:
+  void Serve() {
+    if (!server_socket_.Serve(port_).ok() ||
+        !server_socket_.DisableNagle().ok()) {
+      return;
+    }
+
+    hdlc::DecoderBuffer<kBufferSizeBytes> decoder;
+    std::array<std::byte, kBufferSizeBytes> data;
+
+    while (true) {
+      Result<ByteSpan> read = server_socket_.Read(data);
+      if (!read.ok() || read.value().empty()) {
+        break;
+      }
+      decoder.Process(read.value(), [this](const Result<hdlc::Frame>& frame) {
+        if (frame.ok()) {
+          server()
+              .ProcessPacket(frame.value().data(), to_client_)
+              .IgnoreError();
+        }
+      });
+    }
+    server_socket_.Close();
+  }
+
+  // Only one request is outstanding, so the response is the next frame.
+  Status ReceiveResponse() override {
+    bool received = false;
+
+    while (!received) {
+      Result<ByteSpan> read = client_socket_.Read(read_buffer_);
+      if (!read.ok() || read.value().empty()) {
+        return Status::Unavailable();
+      }
+      decoder_.Process(read.value(), [&](const Result<hdlc::Frame>& frame) {
+        if (frame.ok()) {
+          client_.ProcessPacket(frame.value().data()).IgnoreError();
+          received = true;
+        }
+      });
+    }
+    return OkStatus();
+  }
+
+  Client& client_;
+  const uint16_t port_;
+
+  stream::SocketStream client_socket_;
+  stream::SocketStream server_socket_;
+  HdlcOutput to_server_;
+  HdlcOutput to_client_;
+  std::thread server_thread_;
+
+  hdlc::DecoderBuffer<kBufferSizeBytes> decoder_;
+  std::array<std::byte, kBufferSizeBytes> read_buffer_;
+};
+
+struct Results {
+  size_t requests;
+  size_t dropped;
+  double packets_per_s;
+  double mb_per_s;
+  double p50_us;
+  double p99_us;
+  double allocs_per_request;
+};
+
+// Returns the latency at the given percentile, in microseconds.
+double Percentile(const std::vector<uint32_t>& sorted, size_t percentile) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  const size_t index =
+      std::min(sorted.size() - 1, sorted.size() * percentile / 100);
+  return sorted[index] / 1e3;
+}
+
+template <typename LaneType>
+Status RunLanes(size_t lane_count,
+                Mode mode,
+                size_t payload_size,
+                Results& out) {
+  std::array<Channel, kMaxLanes> channels;
+  Client client(std::span<Channel>(channels.data(), lane_count));
+
+  std::vector<std::unique_ptr<LaneType>> lanes;
+  for (size_t i = 0; i < lane_count; ++i) {
+    const uint32_t channel_id = static_cast<uint32_t>(i + 1);
+    lanes.push_back(std::make_unique<LaneType>(
+        channel_id, client, static_cast<uint16_t>(kFirstPort + i)));
+    channels[i].Configure(channel_id, lanes.back()->client_output());
+  }
+
+  if constexpr (std::is_same_v<LaneType, SocketHdlcLane>) {
+    for (auto& lane : lanes) {
+      if (Status status = lane->Connect(); !status.ok()) {
+        return status;
+      }
+    }
+  }
+
+  std::array<std::byte, kBufferSizeBytes> payload = {};
+  const ConstByteSpan request = std::span(payload).first(payload_size);
+
+  std::atomic<bool> start = false;
+  std::vector<std::thread> threads;
+  for (auto& lane : lanes) {
+    threads.emplace_back([&client, &lane, &start, mode, request] {
+      lane->Run(client, mode, request, kRequestsPerLane, start);
+    });
+  }
+
+  // Let the threads open their streams before starting the clock.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  const size_t allocations_before = allocations.load();
+  const auto started = std::chrono::steady_clock::now();
+  start.store(true, std::memory_order_release);
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - started;
+  const size_t allocations_during = allocations.load() - allocations_before;
+
+  std::vector<uint32_t> latencies;
+  size_t packets = 0;
+  size_t bytes = 0;
+  size_t responses = 0;
+
+  for (auto& lane : lanes) {
+    lane->Close();
+    latencies.insert(
+        latencies.end(), lane->latencies().begin(), lane->latencies().end());
+    packets += lane->packets();
+    bytes += lane->bytes();
+    responses += lane->responses();
+  }
+  std::sort(latencies.begin(), latencies.end());
+
+  out.requests = lane_count * kRequestsPerLane;
+  out.dropped = out.requests - std::min(out.requests, responses);
+  out.packets_per_s = packets / elapsed.count();
+  out.mb_per_s = bytes / elapsed.count() / 1e6;
+  out.p50_us = Percentile(latencies, 50);
+  out.p99_us = Percentile(latencies, 99);
+  out.allocs_per_request =
+      static_cast<double>(allocations_during) / out.requests;
+  return OkStatus();
+}
+
+int Main() {
+  if (!kThreadSafe) {
+    std::fprintf(stderr,
+                 "PW_RPC_USE_GLOBAL_MUTEX is disabled; using one lane\n");
+  }
+
+  for (Transport transport : {Transport::kLoopback, Transport::kSocketHdlc}) {
+    for (Mode mode : {Mode::kUnary, Mode::kStreaming}) {
+      for (size_t lanes : kLaneCounts) {
+        if (lanes > 1u && !kThreadSafe) {
+          break;
+        }
+
+        for (size_t payload_size : kPayloadSizes) {
+          Results results;
+          const Status status =
+              transport == Transport::kLoopback
+                  ? RunLanes<LoopbackLane>(lanes, mode, payload_size, results)
+                  : RunLanes<SocketHdlcLane>(
+                        lanes, mode, payload_size, results);
+          if (!status.ok()) {
+            std::fprintf(stderr,
+                         "Failed to connect %s lanes: %s\n",
+                         TransportName(transport),
+                         status.str());
+            return 1;
+          }
+
+          std::printf(
+              "{\"transport\": \"%s\", \"mode\": \"%s\", \"lanes\": %zu, "
+              "\"payload\": %zu, \"requests\": %zu, \"dropped\": %zu, "
+              "\"packets_per_s\": %.0f, \"mb_per_s\": %.3f, "
+              "\"p50_us\": %.2f, \"p99_us\": %.2f, "
+              "\"allocs_per_request\": %.3f}\n",
+              TransportName(transport),
+              ModeName(mode),
+              lanes,
+              payload_size,
+              results.requests,
+              results.dropped,
+              results.packets_per_s,
+              results.mb_per_s,
+              results.p50_us,
+              results.p99_us,
+              results.allocs_per_request);
+          std::fflush(stdout);
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::rpc
+
+int main() { return pw::rpc::Main(); }
+
+// Count allocations by replacing the global operator new. The array forms call
+// these by default.
+void* operator new(size_t size) {
+  pw::rpc::allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* memory = std::malloc(size > 0u ? size : 1u); memory != nullptr) {
+    return memory;
+  }
+  std::abort();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, size_t) noexcept { std::free(memory); }
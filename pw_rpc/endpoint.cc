@@ -18,6 +18,7 @@
 #include "pw_rpc/internal/endpoint.h"
 // clang-format on
 
+#include <array>
 #include <mutex>
 
 #include "pw_log/log.h"
@@ -25,7 +26,12 @@
 
 namespace pw::rpc::internal {
 
-RpcLock& rpc_lock() {
+RpcLock& rpc_lock(size_t bucket) {
+  static std::array<RpcLock, cfg::kCallHashBuckets> locks;
+  return locks[bucket];
+}
+
+RpcLock& endpoint_lock() {
   static RpcLock lock;
   return lock;
 }
@@ -33,8 +39,10 @@ RpcLock& rpc_lock() {
 Endpoint::~Endpoint() {
   // Since the calls remove themselves from the Endpoint in
   // CloseAndSendResponse(), close responders until no responders remain.
-  while (!calls_.empty()) {
-    calls_.front().CloseAndSendResponse(OkStatus()).IgnoreError();
+  for (IntrusiveList<Call>& calls : calls_) {
+    while (!calls.empty()) {
+      calls.front().CloseAndSendResponse(OkStatus()).IgnoreError();
+    }
   }
 }
 
@@ -62,15 +70,17 @@ Result<Packet> Endpoint::ProcessPacket(std::span<const std::byte> data,
   return result;
 }
 
-void Endpoint::RegisterCall(Call& call) {
-  std::lock_guard lock(rpc_lock());
+// The existing call has the same IDs as the new call, so it has the same lock,
+// which the lock analysis cannot determine.
+void Endpoint::RegisterCall(Call& call) PW_NO_LOCK_SAFETY_ANALYSIS {
+  std::lock_guard lock(call.rpc_lock());
 
   Call* const existing_call =
       FindCallById(call.channel_id(), call.service_id(), call.method_id());
 
   if (existing_call != nullptr) {
     existing_call->HandleError(Status::Cancelled());
-    rpc_lock().lock();  // Reacquire after releasing to call the user callback
+    call.rpc_lock().lock();  // Reacquire after releasing to call the callback
   }
 
   RegisterUniqueCall(call);
@@ -99,7 +109,7 @@ Channel* Endpoint::AssignChannel(uint32_t id, ChannelOutput& interface) {
 Call* Endpoint::FindCallById(uint32_t channel_id,
                              uint32_t service_id,
                              uint32_t method_id) {
-  for (Call& call : calls_) {
+  for (Call& call : CallsFor(channel_id, service_id, method_id)) {
     if (channel_id == call.channel_id() && service_id == call.service_id() &&
         method_id == call.method_id()) {
       return &call;
@@ -101,7 +101,7 @@ void NanopbSendInitialRequest(ClientCall& call,
   PW_DCHECK(call.active());
 
   Result<ByteSpan> result = EncodeToPayloadBuffer(call, payload, serde);
-  rpc_lock().lock();
+  call.rpc_lock().lock();
 
   if (result.ok()) {
     call.SendInitialRequestLocked(*result);
@@ -69,8 +69,10 @@ class NanopbUnaryResponseClientCall : public UnaryResponseClientCall {
   }
 
   NanopbUnaryResponseClientCall& operator=(
-      NanopbUnaryResponseClientCall&& other) PW_LOCKS_EXCLUDED(rpc_lock()) {
-    std::lock_guard lock(rpc_lock());
+      NanopbUnaryResponseClientCall&& other)
+      PW_LOCKS_EXCLUDED(rpc_lock(), other.rpc_lock()) {
+    CloseClientCall();
+    std::lock_guard lock(other.rpc_lock());
     MoveUnaryResponseClientCallFrom(other);
     serde_ = other.serde_;
     set_on_completed(std::move(other.nanopb_on_completed_));
@@ -144,9 +146,14 @@ class NanopbStreamResponseClientCall : public StreamResponseClientCall {
     *this = std::move(other);
   }
 
+  // If the other call is active, its lock is this call's lock after the move.
+  // Otherwise, this call is closed and no other thread can access it.
   NanopbStreamResponseClientCall& operator=(
-      NanopbStreamResponseClientCall&& other) PW_LOCKS_EXCLUDED(rpc_lock()) {
-    std::lock_guard lock(rpc_lock());
+      NanopbStreamResponseClientCall&& other)
+      PW_LOCKS_EXCLUDED(rpc_lock(), other.rpc_lock())
+          PW_NO_LOCK_SAFETY_ANALYSIS {
+    CloseClientCall();
+    std::lock_guard lock(other.rpc_lock());
     MoveStreamResponseClientCallFrom(other);
     serde_ = other.serde_;
     set_on_next_locked(std::move(other.nanopb_on_next_));
@@ -15,7 +15,6 @@
 
 #include "pb_common.h"
 #include "pw_bytes/span.h"
-#include "pw_rpc/internal/lock.h"
 #include "pw_status/status_with_size.h"
 
 namespace pw::rpc::internal {
@@ -88,8 +87,7 @@ class NanopbServerCall;
 // active() must be true.
 void NanopbSendInitialRequest(ClientCall& call,
                               NanopbSerde serde,
-                              const void* payload)
-    PW_LOCKS_EXCLUDED(rpc_lock());
+                              const void* payload);
 
 // [Client/Server] Encodes and sends a client or server stream message.
 // active() must be true.
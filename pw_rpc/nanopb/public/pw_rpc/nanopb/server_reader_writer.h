@@ -57,14 +57,16 @@ class NanopbServerCall : public internal::ServerCall {
   }
 
   NanopbServerCall& operator=(NanopbServerCall&& other)
-      PW_LOCKS_EXCLUDED(rpc_lock()) {
-    std::lock_guard lock(rpc_lock());
+      PW_LOCKS_EXCLUDED(rpc_lock(), other.rpc_lock()) {
+    CloseAndSendResponse(OkStatus()).IgnoreError();
+    std::lock_guard lock(other.rpc_lock());
     MoveNanopbServerCallFrom(other);
     return *this;
   }
 
+  // This call must be closed before another call is moved into it.
   void MoveNanopbServerCallFrom(NanopbServerCall& other)
-      PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock()) {
+      PW_EXCLUSIVE_LOCKS_REQUIRED(other.rpc_lock()) {
     MoveServerCallFrom(other);
     serde_ = other.serde_;
   }
@@ -96,9 +98,13 @@ class BaseNanopbServerReader : public NanopbServerCall {
     *this = std::move(other);
   }
 
+  // If the other call is active, its lock is this call's lock after the move.
+  // Otherwise, this call is closed and no other thread can access it.
   BaseNanopbServerReader& operator=(BaseNanopbServerReader&& other)
-      PW_LOCKS_EXCLUDED(rpc_lock()) {
-    std::lock_guard lock(rpc_lock());
+      PW_LOCKS_EXCLUDED(rpc_lock(), other.rpc_lock())
+          PW_NO_LOCK_SAFETY_ANALYSIS {
+    CloseAndSendResponse(OkStatus()).IgnoreError();
+    std::lock_guard lock(other.rpc_lock());
     MoveNanopbServerCallFrom(other);
     set_on_next_locked(std::move(other.nanopb_on_next_));
     return *this;
@@ -0,0 +1,179 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+#include "pw_rpc/pooled_channel_output.h"
+
+#include <cstddef>
+#include <span>
+
+#include "gtest/gtest.h"
+#include "pw_containers/vector.h"
+
+namespace pw::rpc {
+namespace {
+
+// Records the first byte and size of each packet that is sent.
+class TestPooledOutput final : public PooledChannelOutput<3, 16> {
+ public:
+  TestPooledOutput() : PooledChannelOutput("test") {}
+
+  void set_send_status(Status status) { send_status_ = status; }
+
+  const Vector<std::byte, 8>& sent() const { return sent_; }
+  const Vector<size_t, 8>& sizes() const { return sizes_; }
+
+ private:
+  Status Send(std::span<const std::byte> packet) override {
+    sent_.push_back(packet.front());
+    sizes_.push_back(packet.size());
+    return send_status_;
+  }
+
+  Vector<std::byte, 8> sent_;
+  Vector<size_t, 8> sizes_;
+  Status send_status_;
+};
+
+std::span<const std::byte> Fill(std::span<std::byte> buffer,
+                                std::byte value,
+                                size_t size) {
+  buffer[0] = value;
+  return buffer.first(size);
+}
+
+TEST(PooledChannelOutput, AcquireBuffer_ReturnsDistinctBuffers) {
+  TestPooledOutput output;
+
+  std::span<std::byte> one = output.AcquireBuffer();
+  std::span<std::byte> two = output.AcquireBuffer();
+  std::span<std::byte> three = output.AcquireBuffer();
+
+  EXPECT_EQ(one.size(), 16u);
+  EXPECT_EQ(two.size(), 16u);
+  EXPECT_EQ(three.size(), 16u);
+  EXPECT_NE(one.data(), two.data());
+  EXPECT_NE(two.data(), three.data());
+  EXPECT_NE(one.data(), three.data());
+
+  output.DiscardBuffer(one);
+  output.DiscardBuffer(two);
+  output.DiscardBuffer(three);
+}
+
+TEST(PooledChannelOutput, AcquireBuffer_AllInUse_ReturnsEmptyBuffer) {
+  TestPooledOutput output;
+
+  std::span<std::byte> one = output.AcquireBuffer();
+  std::span<std::byte> two = output.AcquireBuffer();
+  std::span<std::byte> three = output.AcquireBuffer();
+
+  std::span<std::byte> empty = output.AcquireBuffer();
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(empty));
+
+  output.DiscardBuffer(one);
+  EXPECT_FALSE(output.AcquireBuffer().empty());
+
+  output.DiscardBuffer(two);
+  output.DiscardBuffer(three);
+}
+
+TEST(PooledChannelOutput, SendAndReleaseBuffer_InOrder_SendsEachPacket) {
+  TestPooledOutput output;
+
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(OkStatus(),
+              output.SendAndReleaseBuffer(
+                  Fill(output.AcquireBuffer(), std::byte(i), 1 + i)));
+  }
+
+  ASSERT_EQ(output.sent().size(), 5u);
+  for (size_t i = 0; i < 5u; ++i) {
+    EXPECT_EQ(output.sent()[i], std::byte(i));
+    EXPECT_EQ(output.sizes()[i], 1 + i);
+  }
+}
+
+TEST(PooledChannelOutput, SendAndReleaseBuffer_SendsInReleaseOrder) {
+  TestPooledOutput output;
+
+  std::span<std::byte> one = output.AcquireBuffer();
+  std::span<std::byte> two = output.AcquireBuffer();
+  std::span<std::byte> three = output.AcquireBuffer();
+
+  EXPECT_EQ(OkStatus(),
+            output.SendAndReleaseBuffer(Fill(three, std::byte{3}, 3)));
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(Fill(one, std::byte{1}, 1)));
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(Fill(two, std::byte{2}, 2)));
+
+  ASSERT_EQ(output.sent().size(), 3u);
+  EXPECT_EQ(output.sent()[0], std::byte{3});
+  EXPECT_EQ(output.sent()[1], std::byte{1});
+  EXPECT_EQ(output.sent()[2], std::byte{2});
+  EXPECT_EQ(output.sizes()[0], 3u);
+  EXPECT_EQ(output.sizes()[1], 1u);
+  EXPECT_EQ(output.sizes()[2], 2u);
+
+  // All of the buffers were released.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(output.AcquireBuffer().empty());
+  }
+  EXPECT_TRUE(output.AcquireBuffer().empty());
+}
+
+TEST(PooledChannelOutput, SendAndReleaseBuffer_HeldBuffer_DoesNotBlockOthers) {
+  TestPooledOutput output;
+
+  std::span<std::byte> held = output.AcquireBuffer();
+
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(OkStatus(),
+              output.SendAndReleaseBuffer(
+                  Fill(output.AcquireBuffer(), std::byte(i), 1)));
+  }
+  EXPECT_EQ(output.sent().size(), 5u);
+
+  output.DiscardBuffer(held);
+  EXPECT_EQ(output.sent().size(), 5u);
+}
+
+TEST(PooledChannelOutput, DiscardBuffer_SkipsPacket) {
+  TestPooledOutput output;
+
+  std::span<std::byte> one = output.AcquireBuffer();
+  std::span<std::byte> two = output.AcquireBuffer();
+
+  output.DiscardBuffer(one);
+  EXPECT_EQ(OkStatus(), output.SendAndReleaseBuffer(Fill(two, std::byte{2}, 2)));
+
+  ASSERT_EQ(output.sent().size(), 1u);
+  EXPECT_EQ(output.sent()[0], std::byte{2});
+
+  // The discarded buffer was released.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(output.AcquireBuffer().empty());
+  }
+}
+
+TEST(PooledChannelOutput, SendAndReleaseBuffer_ReturnsSendStatus) {
+  TestPooledOutput output;
+  output.set_send_status(Status::Unavailable());
+
+  EXPECT_EQ(Status::Unavailable(),
+            output.SendAndReleaseBuffer(
+                Fill(output.AcquireBuffer(), std::byte{1}, 1)));
+}
+
+}  // namespace
+}  // namespace pw::rpc
@@ -0,0 +1,195 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <mutex>
+#include <span>
+#include <utility>
+
+#include "pw_assert/assert.h"
+#include "pw_function/function.h"
+#include "pw_rpc/channel.h"
+#include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+#include "pw_sync/thread_notification.h"
+#include "pw_thread/thread_core.h"
+
+namespace pw::rpc {
+
+// A ChannelOutput that sends packets from its own thread. Writers encode
+// packets into a bounded queue of kQueueDepth buffers and return without
+// waiting for the transport, so a slow transport does not stall RPC handlers.
+// Run the output on a dedicated thread with pw::thread::Thread. That thread
+// sends the queued packets with Send() in the order they were released.
+//
+// If every buffer is queued or being encoded, AcquireBuffer() returns an empty
+// buffer and the RPC write fails with RESOURCE_EXHAUSTED. The output then calls
+// the ready callback from the send thread once a buffer is free again, so
+// producers such as log drains can stop writing and resume when called back
+// instead of blocking or dropping data.
+template <size_t kQueueDepth, size_t kBufferSizeBytes>
+class AsyncChannelOutput : public ChannelOutput, public thread::ThreadCore {
+ public:
+  static_assert(kQueueDepth > 0u, "The queue must have at least one buffer");
+
+  // Note: the ThreadNotification prevents this from being constexpr.
+  AsyncChannelOutput(const char* name) : ChannelOutput(name) {
+    for (size_t i = 0; i < kQueueDepth; ++i) {
+      free_[i] = i;
+    }
+  }
+
+  // Sets the function to call when a buffer becomes free after AcquireBuffer()
+  // failed. It is called once for any number of failures since the last call,
+  // from the send thread, with no locks held. Set it before starting the send
+  // thread.
+  void set_on_ready(Function<void()>&& on_ready) {
+    on_ready_ = std::move(on_ready);
+  }
+
+  std::span<std::byte> AcquireBuffer() final PW_LOCKS_EXCLUDED(mutex_) {
+    std::lock_guard lock(mutex_);
+    if (free_count_ == 0u || stop_requested_) {
+      ready_pending_ = true;
+      return {};
+    }
+
+    free_count_ -= 1;
+    return buffers_[free_[free_count_]];
+  }
+
+  // Queues the packet for the send thread and returns immediately. Errors from
+  // Send() are not reported to the writer. Returns UNAVAILABLE and discards the
+  // packet if RequestStop() was called.
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) final
+      PW_LOCKS_EXCLUDED(mutex_) {
+    // Releasing the empty buffer returned when the queue was full.
+    if (buffer.data() == nullptr) {
+      return OkStatus();
+    }
+
+    const size_t index = IndexOf(buffer);
+
+    std::lock_guard lock(mutex_);
+    if (buffer.empty() || stop_requested_) {
+      free_[free_count_++] = index;
+
+      // Wake the send thread to call on_ready_ for the freed buffer.
+      if (ready_pending_) {
+        notification_.release();
+      }
+      return buffer.empty() ? OkStatus() : Status::Unavailable();
+    }
+
+    sizes_[index] = buffer.size();
+    queue_[(queue_head_ + queued_count_) % kQueueDepth] = index;
+    queued_count_ += 1;
+    notification_.release();
+    return OkStatus();
+  }
+
+  // Sends the packets that are already queued, then returns from the send
+  // thread. Further writes fail with RESOURCE_EXHAUSTED. The output cannot be
+  // restarted.
+  void RequestStop() PW_LOCKS_EXCLUDED(mutex_) {
+    std::lock_guard lock(mutex_);
+    stop_requested_ = true;
+    notification_.release();
+  }
+
+ protected:
+  // Sends an encoded packet. Called on the send thread only, in queue order.
+  virtual Status Send(std::span<const std::byte> packet) = 0;
+
+ private:
+  size_t IndexOf(std::span<const std::byte> buffer) const {
+    const size_t offset = buffer.data() - buffers_.front().data();
+    PW_DASSERT(offset < sizeof(buffers_) && offset % kBufferSizeBytes == 0u);
+    return offset / kBufferSizeBytes;
+  }
+
+  void Run() override PW_LOCKS_EXCLUDED(mutex_) {
+    while (true) {
+      notification_.acquire();
+
+      if (!SendQueued()) {
+        return;
+      }
+    }
+  }
+
+  // Sends packets until the queue is empty, calling on_ready_ as soon as a
+  // buffer is free for a writer that failed to acquire one. Returns false if a
+  // stop was requested.
+  bool SendQueued() PW_LOCKS_EXCLUDED(mutex_) {
+    mutex_.lock();
+    while (true) {
+      if (ready_pending_ && free_count_ > 0u && !stop_requested_) {
+        ready_pending_ = false;
+        mutex_.unlock();
+
+        if (on_ready_ != nullptr) {
+          on_ready_();
+        }
+        mutex_.lock();
+        continue;
+      }
+
+      if (queued_count_ == 0u) {
+        break;
+      }
+
+      const size_t index = queue_[queue_head_];
+      const size_t size = sizes_[index];
+      queue_head_ = (queue_head_ + 1) % kQueueDepth;
+      queued_count_ -= 1;
+      mutex_.unlock();
+
+      Send(std::span(buffers_[index]).first(size)).IgnoreError();
+
+      mutex_.lock();
+      free_[free_count_++] = index;
+    }
+    const bool keep_running = !stop_requested_;
+    mutex_.unlock();
+    return keep_running;
+  }
+
+  sync::Mutex mutex_;
+  sync::ThreadNotification notification_;
+  Function<void()> on_ready_;
+
+  bool stop_requested_ PW_GUARDED_BY(mutex_) = false;
+
+  // Set when AcquireBuffer() fails, so the next freed buffer calls on_ready_.
+  bool ready_pending_ PW_GUARDED_BY(mutex_) = false;
+
+  // Stack of buffers that are available to acquire.
+  std::array<size_t, kQueueDepth> free_ PW_GUARDED_BY(mutex_);
+  size_t free_count_ PW_GUARDED_BY(mutex_) = kQueueDepth;
+
+  // Ring of buffers with encoded packets, in the order to send them.
+  std::array<size_t, kQueueDepth> queue_ PW_GUARDED_BY(mutex_) = {};
+  size_t queue_head_ PW_GUARDED_BY(mutex_) = 0;
+  size_t queued_count_ PW_GUARDED_BY(mutex_) = 0;
+
+  std::array<size_t, kQueueDepth> sizes_ PW_GUARDED_BY(mutex_) = {};
+
+  std::array<std::array<std::byte, kBufferSizeBytes>, kQueueDepth> buffers_;
+};
+
+}  // namespace pw::rpc
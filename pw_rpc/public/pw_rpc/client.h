@@ -44,7 +44,7 @@ class Client : public internal::Endpoint {
   //   UNAVAILABLE - No RPC channel with the requested ID was found.
   //
   Status ProcessPacket(ConstByteSpan data)
-      PW_LOCKS_EXCLUDED(internal::rpc_lock());
+      PW_LOCKS_EXCLUDED(internal::endpoint_lock());
 };
 
 }  // namespace pw::rpc
@@ -76,6 +76,14 @@ class Call : public IntrusiveList<Call>::Item {
   uint32_t service_id() const { return service_id_; }
   uint32_t method_id() const { return method_id_; }
 
+  // Returns the lock that guards this call. Calls with different IDs usually
+  // have different locks, so operations on them do not contend. The lock
+  // changes only when another call is moved into this one.
+  RpcLock& rpc_lock() const PW_LOCK_RETURNED(
+      internal::rpc_lock(channel_id(), service_id_, method_id_)) {
+    return internal::rpc_lock(channel_id(), service_id_, method_id_);
+  }
+
   // Closes the Call and sends a RESPONSE packet, if it is active. Returns the
   // status from sending the packet, or FAILED_PRECONDITION if the Call is not
   // active.
@@ -104,7 +112,7 @@ class Call : public IntrusiveList<Call>::Item {
 
   // Whenever a payload arrives (in a server/client stream or in a response),
   // call the on_next_ callback.
-  // Precondition: rpc_lock() must be held.
+  // Precondition: this call's rpc_lock() must be held.
   void HandlePayload(ConstByteSpan message) const
       PW_UNLOCK_FUNCTION(rpc_lock()) {
     const bool invoke = on_next_ != nullptr;
@@ -115,7 +123,7 @@ class Call : public IntrusiveList<Call>::Item {
     }
   }
 
-  // Precondition: rpc_lock() must be held.
+  // Precondition: this call's rpc_lock() must be held.
   void HandleError(Status status) PW_UNLOCK_FUNCTION(rpc_lock()) {
     Close();
     on_error(status);
@@ -173,8 +181,10 @@ class Call : public IntrusiveList<Call>::Item {
        uint32_t method_id,
        MethodType type);
 
-  // This call must be in a closed state when this is called.
-  void MoveFrom(Call& other) PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock());
+  // This call must be in a closed state when this is called. Only the other
+  // call's lock is held, since no other thread can access a closed call. If the
+  // other call is active, this call takes its IDs, and with them its lock.
+  void MoveFrom(Call& other) PW_EXCLUSIVE_LOCKS_REQUIRED(other.rpc_lock());
 
   Endpoint& endpoint() const { return *endpoint_; }
   Channel& channel() const { return *channel_; }
@@ -207,7 +217,8 @@ class Call : public IntrusiveList<Call>::Item {
   // Sends a payload with the specified type. The payload may either be in an
   // previously acquired buffer or in a standalone buffer.
   //
-  // Returns FAILED_PRECONDITION if the call is not active().
+  // Returns FAILED_PRECONDITION if the call is not active(), or
+  // RESOURCE_EXHAUSTED if the ChannelOutput did not provide a buffer.
   Status SendPacket(PacketType type,
                     ConstByteSpan payload,
                     Status status = OkStatus()) PW_UNLOCK_FUNCTION(rpc_lock());
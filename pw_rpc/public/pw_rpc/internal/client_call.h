@@ -25,15 +25,7 @@ namespace pw::rpc::internal {
 // A Call object, as used by an RPC client.
 class ClientCall : public Call {
  public:
-  ~ClientCall() PW_LOCKS_EXCLUDED(rpc_lock()) {
-    rpc_lock().lock();
-    if (client_stream_open()) {
-      EndClientStream();
-      rpc_lock().lock();  // Reacquire after sending the packet
-    }
-    Close();
-    rpc_lock().unlock();
-  }
+  ~ClientCall() PW_LOCKS_EXCLUDED(rpc_lock()) { CloseClientCall(); }
 
   void SendInitialRequest(ConstByteSpan payload) PW_LOCKS_EXCLUDED(rpc_lock()) {
     rpc_lock().lock();
@@ -53,13 +45,22 @@ class ClientCall : public Call {
              MethodType type)
       : Call(client, channel_id, service_id, method_id, type) {}
 
-  void MoveClientCallFrom(ClientCall& other)
-      PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock()) {
+  // Ends the client stream, if it is open, and closes the call. This is done
+  // before moving another call into this one. This call's lock is released
+  // before the other call's lock is acquired, so they are never held together.
+  void CloseClientCall() PW_LOCKS_EXCLUDED(rpc_lock()) {
+    rpc_lock().lock();
     if (client_stream_open()) {
       EndClientStream();
       rpc_lock().lock();  // Reacquire after sending the packet
     }
     Close();
+    rpc_lock().unlock();
+  }
+
+  // This call must be closed with CloseClientCall() first.
+  void MoveClientCallFrom(ClientCall& other)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(other.rpc_lock()) {
     MoveFrom(other);
   }
 };
@@ -112,14 +113,15 @@ class UnaryResponseClientCall : public ClientCall {
   }
 
   UnaryResponseClientCall& operator=(UnaryResponseClientCall&& other)
-      PW_LOCKS_EXCLUDED(rpc_lock()) {
-    std::lock_guard lock(rpc_lock());
+      PW_LOCKS_EXCLUDED(rpc_lock(), other.rpc_lock()) {
+    CloseClientCall();
+    std::lock_guard lock(other.rpc_lock());
     MoveUnaryResponseClientCallFrom(other);
     return *this;
   }
 
   void MoveUnaryResponseClientCallFrom(UnaryResponseClientCall& other)
-      PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock()) {
+      PW_EXCLUSIVE_LOCKS_REQUIRED(other.rpc_lock()) {
     MoveClientCallFrom(other);
     on_completed_ = std::move(other.on_completed_);
   }
@@ -183,14 +185,15 @@ class StreamResponseClientCall : public ClientCall {
   }
 
   StreamResponseClientCall& operator=(StreamResponseClientCall&& other)
-      PW_LOCKS_EXCLUDED(rpc_lock()) {
-    std::lock_guard lock(rpc_lock());
+      PW_LOCKS_EXCLUDED(rpc_lock(), other.rpc_lock()) {
+    CloseClientCall();
+    std::lock_guard lock(other.rpc_lock());
     MoveStreamResponseClientCallFrom(other);
     return *this;
   }
 
   void MoveStreamResponseClientCallFrom(StreamResponseClientCall& other)
-      PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock()) {
+      PW_EXCLUSIVE_LOCKS_REQUIRED(other.rpc_lock()) {
     MoveClientCallFrom(other);
     on_completed_ = std::move(other.on_completed_);
   }
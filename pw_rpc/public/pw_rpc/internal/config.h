@@ -43,12 +43,31 @@
 #define PW_RPC_NANOPB_STRUCT_MIN_BUFFER_SIZE 64
 #endif  // PW_RPC_NANOPB_STRUCT_MIN_BUFFER_SIZE
 
-// Enable global synchronization for RPC calls. If this is set, a backend must
-// be configured for pw_sync:mutex.
+// Enable synchronization for RPC calls. If this is set, a backend must be
+// configured for pw_sync:mutex. Calls are guarded by one mutex per bucket of
+// the call hash table (see PW_RPC_CALL_HASH_BUCKETS), so calls in different
+// buckets do not contend.
 #ifndef PW_RPC_USE_GLOBAL_MUTEX
 #define PW_RPC_USE_GLOBAL_MUTEX 0
 #endif  // PW_RPC_USE_GLOBAL_MUTEX
 
+// The number of buckets in the hash table a pw_rpc server uses to find a
+// service by ID. Each bucket is an IntrusiveList, which is the size of a
+// pointer. Service IDs are hashes, so services are spread evenly across the
+// buckets. With 1 bucket, finding a service scans every registered service.
+#ifndef PW_RPC_SERVICE_HASH_BUCKETS
+#define PW_RPC_SERVICE_HASH_BUCKETS 8
+#endif  // PW_RPC_SERVICE_HASH_BUCKETS
+
+// The number of buckets in the hash table pw_rpc servers and clients use to
+// find an ongoing call by channel, service, and method ID. Each bucket is an
+// IntrusiveList, which is the size of a pointer. With 1 bucket, finding a call
+// scans every ongoing call. If PW_RPC_USE_GLOBAL_MUTEX is enabled, each bucket
+// also has its own mutex.
+#ifndef PW_RPC_CALL_HASH_BUCKETS
+#define PW_RPC_CALL_HASH_BUCKETS 8
+#endif  // PW_RPC_CALL_HASH_BUCKETS
+
 // The log level to use for this module. Logs below this level are omitted.
 #ifndef PW_RPC_CONFIG_LOG_LEVEL
 #define PW_RPC_CONFIG_LOG_LEVEL PW_LOG_LEVEL_INFO
@@ -70,6 +89,20 @@ inline constexpr size_t kNanopbStructMinBufferSize =
 
 #undef PW_RPC_NANOPB_STRUCT_MIN_BUFFER_SIZE
 
+inline constexpr size_t kServiceHashBuckets = PW_RPC_SERVICE_HASH_BUCKETS;
+
+#undef PW_RPC_SERVICE_HASH_BUCKETS
+
+static_assert(kServiceHashBuckets > 0u,
+              "PW_RPC_SERVICE_HASH_BUCKETS must be at least 1");
+
+inline constexpr size_t kCallHashBuckets = PW_RPC_CALL_HASH_BUCKETS;
+
+#undef PW_RPC_CALL_HASH_BUCKETS
+
+static_assert(kCallHashBuckets > 0u,
+              "PW_RPC_CALL_HASH_BUCKETS must be at least 1");
+
 }  // namespace pw::rpc::cfg
 
 // This option determines whether to allocate the Nanopb structs on the stack or
@@ -13,6 +13,8 @@
 // the License.
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <mutex>
 #include <span>
 
@@ -20,6 +22,7 @@
 #include "pw_result/result.h"
 #include "pw_rpc/internal/call.h"
 #include "pw_rpc/internal/channel.h"
+#include "pw_rpc/internal/config.h"
 #include "pw_rpc/internal/lock.h"
 #include "pw_rpc/internal/packet.h"
 #include "pw_sync/lock_annotations.h"
@@ -34,13 +37,19 @@ namespace pw::rpc::internal {
 // calls add themselves to the Endpoint's list when they're started and
 // remove themselves when they complete. Calls do this through their associated
 // Server or Client object, which derive from Endpoint.
+//
+// Ongoing calls are stored in a hash table keyed by channel, service, and
+// method ID, so finding the call for a packet does not scan every call. Each
+// bucket is guarded by its own lock (see CallBucket() in lock.h). The channels
+// and the call ID counter are guarded by endpoint_lock().
 class Endpoint {
  public:
   ~Endpoint();
 
   // Finds an RPC Channel with this ID or nullptr if none matches.
-  rpc::Channel* GetChannel(uint32_t id) const PW_LOCKS_EXCLUDED(rpc_lock()) {
-    std::lock_guard lock(rpc_lock());
+  rpc::Channel* GetChannel(uint32_t id) const
+      PW_LOCKS_EXCLUDED(endpoint_lock()) {
+    std::lock_guard lock(endpoint_lock());
     return GetInternalChannel(id);
   }
 
@@ -53,61 +62,84 @@ class Endpoint {
   // Parses an RPC packet and sets ongoing_call to the matching call, if any.
   // Returns the parsed packet or an error.
   Result<Packet> ProcessPacket(std::span<const std::byte> data,
-                               Packet::Destination destination)
-      PW_LOCKS_EXCLUDED(rpc_lock());
+                               Packet::Destination destination);
+
+  // Returns the lock that guards calls with this packet's IDs.
+  static RpcLock& CallLock(const Packet& packet)
+      PW_LOCK_RETURNED(rpc_lock(packet.channel_id(),
+                                packet.service_id(),
+                                packet.method_id())) {
+    return rpc_lock(
+        packet.channel_id(), packet.service_id(), packet.method_id());
+  }
 
   // Finds a call object for an ongoing call associated with this packet, if
   // any. Returns nullptr if no matching call exists.
-  Call* FindCall(const Packet& packet) PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock()) {
+  Call* FindCall(const Packet& packet)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(CallLock(packet)) {
     return FindCallById(
         packet.channel_id(), packet.service_id(), packet.method_id());
   }
 
   // Finds an internal:::Channel with this ID or nullptr if none matches.
-  Channel* GetInternalChannel(uint32_t id) const;
+  Channel* GetInternalChannel(uint32_t id) const
+      PW_EXCLUSIVE_LOCKS_REQUIRED(endpoint_lock());
 
   // Creates a channel with the provided ID and ChannelOutput, if a channel slot
   // is available. Returns a pointer to the channel if one is created, nullptr
   // otherwise.
-  Channel* AssignChannel(uint32_t id, ChannelOutput& interface);
+  Channel* AssignChannel(uint32_t id, ChannelOutput& interface)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(endpoint_lock());
 
  private:
   // Give Call access to the register/unregister functions.
   friend class Call;
 
   // Returns an ID that can be assigned to a new call.
-  uint32_t NewCallId() {
+  uint32_t NewCallId() PW_LOCKS_EXCLUDED(endpoint_lock()) {
     // Call IDs are varint encoded. Limit the varint size to 2 bytes (14 usable
     // bits).
     constexpr uint32_t kMaxCallId = 1 << 14;
+    std::lock_guard lock(endpoint_lock());
     return (++next_call_id_) % kMaxCallId;
   }
 
   // Adds a call to the internal call registry. If a matching call already
   // exists, it is cancelled locally (on_error called, no packet sent).
-  void RegisterCall(Call& call) PW_LOCKS_EXCLUDED(rpc_lock());
+  void RegisterCall(Call& call) PW_LOCKS_EXCLUDED(call.rpc_lock());
 
   // Registers a call that is known to be unique. The calls list is NOT checked
   // for existing calls.
-  void RegisterUniqueCall(Call& call) PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock()) {
-    calls_.push_front(call);
+  void RegisterUniqueCall(Call& call)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(call.rpc_lock()) {
+    CallsFor(call.channel_id(), call.service_id(), call.method_id())
+        .push_front(call);
   }
 
   // Removes the provided call from the call registry.
   void UnregisterCall(const Call& call)
-      PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock()) {
-    calls_.remove(call);
+      PW_EXCLUSIVE_LOCKS_REQUIRED(call.rpc_lock()) {
+    CallsFor(call.channel_id(), call.service_id(), call.method_id())
+        .remove(call);
+  }
+
+  // Returns the hash table bucket for calls with these IDs. The bucket is
+  // guarded by rpc_lock(channel_id, service_id, method_id).
+  IntrusiveList<Call>& CallsFor(uint32_t channel_id,
+                                uint32_t service_id,
+                                uint32_t method_id) {
+    return calls_[CallBucket(channel_id, service_id, method_id)];
   }
 
   Call* FindCallById(uint32_t channel_id,
                      uint32_t service_id,
                      uint32_t method_id)
-      PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock());
+      PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock(channel_id, service_id, method_id));
 
-  std::span<Channel> channels_;
-  IntrusiveList<Call> calls_ PW_GUARDED_BY(rpc_lock());
+  std::span<Channel> channels_ PW_GUARDED_BY(endpoint_lock());
+  std::array<IntrusiveList<Call>, cfg::kCallHashBuckets> calls_;
 
-  uint32_t next_call_id_;
+  uint32_t next_call_id_ PW_GUARDED_BY(endpoint_lock());
 };
 
 }  // namespace pw::rpc::internal
@@ -14,6 +14,10 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
+#include "pw_preprocessor/compiler.h"
 #include "pw_rpc/internal/config.h"
 #include "pw_sync/lock_annotations.h"
 
@@ -46,6 +50,36 @@ class PW_LOCKABLE("pw::rpc::internal::RpcLock") RpcLock {
 
 #endif  // PW_RPC_USE_GLOBAL_MUTEX
 
-RpcLock& rpc_lock();
+// Ongoing calls are guarded by one of cfg::kCallHashBuckets locks. A call's
+// lock is selected by the same hash of its channel, service, and method IDs
+// that selects its bucket in the Endpoint's call table, so each lock guards one
+// bucket in every endpoint. Calls in different buckets do not contend with
+// each other, even when they share an endpoint.
+constexpr size_t CallBucket(uint32_t channel_id,
+                            uint32_t service_id,
+                            uint32_t method_id)
+    PW_NO_SANITIZE("unsigned-integer-overflow") {
+  // Service and method IDs are already hashes; channel IDs are usually small
+  // integers, so they are scaled to affect more bits.
+  constexpr uint32_t kChannelMultiplier = 0x9e3779b1;  // 2^32 / golden ratio
+  const uint32_t hash =
+      service_id ^ method_id ^ (channel_id * kChannelMultiplier);
+  return hash % cfg::kCallHashBuckets;
+}
+
+// Returns the lock for the calls in this bucket.
+RpcLock& rpc_lock(size_t bucket);
+
+// Returns the lock for calls with these IDs.
+inline RpcLock& rpc_lock(uint32_t channel_id,
+                         uint32_t service_id,
+                         uint32_t method_id) {
+  return rpc_lock(CallBucket(channel_id, service_id, method_id));
+}
+
+// Guards the channels and call ID counters of all endpoints. This is held
+// briefly when a packet is received or a call is created, but not when sending
+// on an ongoing call.
+RpcLock& endpoint_lock();
 
 }  // namespace pw::rpc::internal
@@ -46,14 +46,19 @@ class ServerCall : public Call {
   }
 
   // Version of operator= used by the raw call classes.
-  ServerCall& operator=(ServerCall&& other) PW_LOCKS_EXCLUDED(rpc_lock()) {
-    std::lock_guard lock(rpc_lock());
+  ServerCall& operator=(ServerCall&& other)
+      PW_LOCKS_EXCLUDED(rpc_lock(), other.rpc_lock()) {
+    // If this call is active, finish it first. Its lock is released before the
+    // other call's lock is acquired, so the two locks are never held at once.
+    CloseAndSendResponse(OkStatus()).IgnoreError();
+    std::lock_guard lock(other.rpc_lock());
     MoveServerCallFrom(other);
     return *this;
   }
 
+  // This call must be closed before another call is moved into it.
   void MoveServerCallFrom(ServerCall& other)
-      PW_EXCLUSIVE_LOCKS_REQUIRED(rpc_lock());
+      PW_EXCLUSIVE_LOCKS_REQUIRED(other.rpc_lock());
 
   ServerCall(const CallContext& context, MethodType type)
       : Call(context, type) {}
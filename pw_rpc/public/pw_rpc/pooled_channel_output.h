@@ -0,0 +1,189 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "pw_assert/assert.h"
+#include "pw_rpc/channel.h"
+#include "pw_status/status.h"
+#include "pw_sync/lock_annotations.h"
+#include "pw_sync/mutex.h"
+
+namespace pw::rpc {
+
+// A ChannelOutput with a pool of packet buffers. A ChannelOutput with a single
+// buffer has to hold it from AcquireBuffer() until SendAndReleaseBuffer(), so
+// only one thread at a time can encode a packet for it. With a pool, up to
+// kBufferCount threads can encode packets at the same time.
+//
+// Encoded packets are added to a queue and sent in the order they were passed
+// to SendAndReleaseBuffer(), so each call's packets are sent in the order they
+// were written. A thread that queues a packet while no other thread is sending
+// sends everything in the queue; otherwise, it returns immediately and the
+// sending thread sends its packet. Send() is only called from one thread at a
+// time.
+//
+// If every buffer is in use, AcquireBuffer() sends or waits for queued packets
+// to free a buffer. If all of the buffers are held by packets that are still
+// being encoded, it returns an empty buffer and the RPC write fails with
+// RESOURCE_EXHAUSTED.
+template <size_t kBufferCount, size_t kBufferSizeBytes>
+class PooledChannelOutput : public ChannelOutput {
+ public:
+  static_assert(kBufferCount > 0u, "The pool must have at least one buffer");
+
+  PooledChannelOutput(const char* name) : ChannelOutput(name) {
+    for (size_t i = 0; i < kBufferCount; ++i) {
+      free_[i] = i;
+    }
+  }
+
+  std::span<std::byte> AcquireBuffer() final
+      PW_LOCKS_EXCLUDED(mutex_, send_mutex_) {
+    mutex_.lock();
+    while (free_count_ == 0u) {
+      // Buffers held for encoding might only be released after the caller
+      // returns, so only wait if there are queued packets.
+      if (queued_count_ == 0u) {
+        mutex_.unlock();
+        return {};
+      }
+      mutex_.unlock();
+
+      send_mutex_.lock();
+      SendQueued();
+      send_mutex_.unlock();
+
+      mutex_.lock();
+    }
+
+    free_count_ -= 1;
+    const size_t index = free_[free_count_];
+    mutex_.unlock();
+    return buffers_[index];
+  }
+
+  // Queues the packet and sends the queue if no other thread is sending.
+  // Returns the status from Send() if this thread sent the packet. Returns OK
+  // if another thread sends the packet; errors from that are not reported.
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) final
+      PW_LOCKS_EXCLUDED(mutex_, send_mutex_) {
+    // Releasing the empty buffer returned when the pool was exhausted.
+    if (buffer.data() == nullptr) {
+      return OkStatus();
+    }
+
+    const size_t index = IndexOf(buffer);
+
+    mutex_.lock();
+    if (buffer.empty()) {
+      free_[free_count_++] = index;  // Discarded buffers are not sent.
+      mutex_.unlock();
+      return OkStatus();
+    }
+
+    sizes_[index] = buffer.size();
+    queue_[(queue_head_ + queued_count_) % kBufferCount] = index;
+    queued_count_ += 1;
+    mutex_.unlock();
+
+    Status result;
+
+    // If another thread is sending, it sends this packet after its current one.
+    // Check the queue again after sending, in case a packet was queued by a
+    // thread that found the send mutex held.
+    while (send_mutex_.try_lock()) {
+      SendQueued(index, result);
+      send_mutex_.unlock();
+
+      mutex_.lock();
+      const bool empty = queued_count_ == 0u;
+      mutex_.unlock();
+
+      if (empty) {
+        break;
+      }
+    }
+
+    return result;
+  }
+
+ protected:
+  // Sends an encoded packet. Packets are sent in order, and this function is
+  // only called by one thread at a time. The implementation must NOT return
+  // FAILED_PRECONDITION or INTERNAL, which are reserved by pw_rpc.
+  virtual Status Send(std::span<const std::byte> packet) = 0;
+
+ private:
+  size_t IndexOf(std::span<const std::byte> buffer) const {
+    const size_t offset = buffer.data() - buffers_.front().data();
+    PW_DASSERT(offset < sizeof(buffers_) && offset % kBufferSizeBytes == 0u);
+    return offset / kBufferSizeBytes;
+  }
+
+  // Sends queued packets for a thread that is waiting for a free buffer.
+  void SendQueued() PW_EXCLUSIVE_LOCKS_REQUIRED(send_mutex_)
+      PW_LOCKS_EXCLUDED(mutex_) {
+    Status unused;
+    SendQueued(kBufferCount, unused);
+  }
+
+  // Sends queued packets until the queue is empty. If the packet in the buffer
+  // at own_index is sent, its status is stored in own_status.
+  void SendQueued(size_t own_index, Status& own_status)
+      PW_EXCLUSIVE_LOCKS_REQUIRED(send_mutex_) PW_LOCKS_EXCLUDED(mutex_) {
+    mutex_.lock();
+    while (queued_count_ > 0u) {
+      const size_t index = queue_[queue_head_];
+      const size_t size = sizes_[index];
+      queue_head_ = (queue_head_ + 1) % kBufferCount;
+      queued_count_ -= 1;
+      mutex_.unlock();
+
+      const Status status = Send(std::span(buffers_[index]).first(size));
+      if (index == own_index) {
+        own_status = status;
+        own_index = kBufferCount;  // The buffer may be reused for another packet.
+      }
+
+      mutex_.lock();
+      free_[free_count_++] = index;
+    }
+    mutex_.unlock();
+  }
+
+  // Held by the thread that is sending packets. Lock before mutex_.
+  sync::Mutex send_mutex_;
+
+  // Guards the buffer bookkeeping, but not the buffers themselves.
+  sync::Mutex mutex_;
+
+  // Stack of buffers that are available to acquire.
+  std::array<size_t, kBufferCount> free_ PW_GUARDED_BY(mutex_);
+  size_t free_count_ PW_GUARDED_BY(mutex_) = kBufferCount;
+
+  // Ring of buffers with encoded packets, in the order to send them.
+  std::array<size_t, kBufferCount> queue_ PW_GUARDED_BY(mutex_) = {};
+  size_t queue_head_ PW_GUARDED_BY(mutex_) = 0;
+  size_t queued_count_ PW_GUARDED_BY(mutex_) = 0;
+
+  std::array<size_t, kBufferCount> sizes_ PW_GUARDED_BY(mutex_) = {};
+
+  std::array<std::array<std::byte, kBufferSizeBytes>, kBufferCount> buffers_;
+};
+
+}  // namespace pw::rpc
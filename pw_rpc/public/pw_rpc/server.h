@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include <span>
 #include <tuple>
@@ -20,6 +21,7 @@
 #include "pw_containers/intrusive_list.h"
 #include "pw_rpc/channel.h"
 #include "pw_rpc/internal/channel.h"
+#include "pw_rpc/internal/config.h"
 #include "pw_rpc/internal/endpoint.h"
 #include "pw_rpc/internal/method.h"
 #include "pw_rpc/internal/server_call.h"
@@ -34,7 +36,7 @@ class Server : public internal::Endpoint {
 
   // Registers a service with the server. This should not be called directly
   // with a Service; instead, use a generated class which inherits from it.
-  void RegisterService(Service& service) { services_.push_front(service); }
+  void RegisterService(Service& service);
 
   // Processes an RPC packet. The packet may contain an RPC request or a control
   // packet, the result of which is processed in this function. Returns whether
@@ -46,7 +48,7 @@ class Server : public internal::Endpoint {
   //
   Status ProcessPacket(std::span<const std::byte> packet_data,
                        ChannelOutput& interface)
-      PW_LOCKS_EXCLUDED(internal::rpc_lock());
+      PW_LOCKS_EXCLUDED(internal::endpoint_lock());
 
  private:
   friend class internal::Call;
@@ -57,9 +59,15 @@ class Server : public internal::Endpoint {
   void HandleClientStreamPacket(const internal::Packet& packet,
                                 internal::Channel& channel,
                                 internal::ServerCall* call) const
-      PW_UNLOCK_FUNCTION(internal::rpc_lock());
+      PW_UNLOCK_FUNCTION(CallLock(packet));
 
-  IntrusiveList<Service> services_;
+  // Returns the hash table bucket for services with this ID. Service IDs are
+  // hashes of the service names, so they are used directly.
+  IntrusiveList<Service>& ServicesFor(uint32_t service_id) {
+    return services_[service_id % services_.size()];
+  }
+
+  std::array<IntrusiveList<Service>, cfg::kServiceHashBuckets> services_;
 };
 
 }  // namespace pw::rpc
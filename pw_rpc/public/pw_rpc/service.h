@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <span>
@@ -29,7 +30,9 @@ namespace pw::rpc {
 //
 // Services store a span of concrete method implementation classes. To support
 // different Method implementations, Service stores a base MethodUnion* and the
-// size of the concrete MethodUnion object.
+// size of the concrete MethodUnion object. Generated services sort their
+// methods by ID so that they can be binary searched. Services with unsorted
+// methods are searched linearly.
 class Service : public IntrusiveList<Service>::Item {
  public:
   Service(const Service&) = delete;
@@ -66,10 +69,22 @@ class Service : public IntrusiveList<Service>::Item {
   // Finds the method with the provided method_id. Returns nullptr if no match.
   const internal::Method* FindMethod(uint32_t method_id) const;
 
+  // Checks whether the methods are sorted by ID. The server calls this when the
+  // service is registered to select how FindMethod searches.
+  bool MethodsSortedById() const;
+
+  const internal::Method& method(size_t index) const {
+    const auto raw = reinterpret_cast<const std::byte*>(methods_);
+    return reinterpret_cast<const internal::MethodUnion*>(
+               raw + index * method_size_)
+        ->method();
+  }
+
   const uint32_t id_;
   const internal::MethodUnion* const methods_;
   const uint16_t method_size_;
   const uint16_t method_count_;
+  bool sorted_by_id_ = false;
 };
 
 }  // namespace pw::rpc
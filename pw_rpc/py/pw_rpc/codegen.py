@@ -16,7 +16,7 @@
 import abc
 from datetime import datetime
 import os
-from typing import cast, Any, Iterable, Sequence, Union
+from typing import cast, Any, Iterable, List, Sequence, Union
 
 from pw_protobuf.output_file import OutputFile
 from pw_protobuf.proto_tree import ProtoNode, ProtoService, ProtoServiceMethod
@@ -48,6 +48,15 @@ def get_id(item: Union[ProtoService, ProtoServiceMethod]) -> str:
     return f'0x{pw_rpc.ids.calculate(name):08x}'
 
 
+def _methods_by_id(service: ProtoService) -> List[ProtoServiceMethod]:
+    """Returns the service's methods sorted by ID.
+
+    Service::FindMethod binary searches the method table, so it must be sorted.
+    """
+    return sorted(service.methods(),
+                  key=lambda method: pw_rpc.ids.calculate(method.name()))
+
+
 def client_call_type(method: ProtoServiceMethod, prefix: str) -> str:
     """Returns Client ReaderWriter/Reader/Writer/Recevier for the call."""
     if method.type() is ProtoServiceMethod.Type.UNARY:
@@ -349,13 +358,13 @@ def _generate_service(gen: CodeGenerator, service: ProtoService) -> None:
         gen.line('friend class ::pw::rpc::internal::MethodLookup;')
         gen.line()
 
-        # Generate the method table
+        # Generate the method table, sorted by method ID.
         gen.line('static constexpr std::array<'
                  f'{RPC_NAMESPACE}::internal::{gen.method_union_name()},'
                  f' {len(service.methods())}> kPwRpcMethods = {{')
 
         with gen.indent(4):
-            for method in service.methods():
+            for method in _methods_by_id(service):
                 gen.method_descriptor(method)
 
         gen.line('};\n')
@@ -372,7 +381,7 @@ def _method_lookup_table(gen: CodeGenerator, service: ProtoService) -> None:
              f'{len(service.methods())}> kPwRpcMethodIds = {{')
 
     with gen.indent(4):
-        for method in service.methods():
+        for method in _methods_by_id(service):
             gen.line(f'{get_id(method)},  // Hash of "{method.name()}"')
 
     gen.line('};')
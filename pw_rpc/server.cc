@@ -35,16 +35,20 @@ using internal::PacketType;
 
 }  // namespace
 
+void Server::RegisterService(Service& service) {
+  service.sorted_by_id_ = service.MethodsSortedById();
+  ServicesFor(service.id()).push_front(service);
+}
+
+// The call's lock is the lock for the packet's IDs, which the lock analysis
+// cannot determine.
 Status Server::ProcessPacket(std::span<const byte> packet_data,
-                             ChannelOutput& interface) {
+                             ChannelOutput& interface)
+    PW_NO_LOCK_SAFETY_ANALYSIS {
   PW_TRY_ASSIGN(Result<Packet> result,
                 Endpoint::ProcessPacket(packet_data, Packet::kServer));
   Packet& packet = *result;
 
-  internal::rpc_lock().lock();
-  internal::ServerCall* const call =
-      static_cast<internal::ServerCall*>(FindCall(packet));
-
   // Verbose log for debugging.
   // PW_LOG_DEBUG("RPC server received packet type %u for %u:%08x/%08x",
   //              static_cast<unsigned>(packet.type()),
@@ -52,13 +56,14 @@ Status Server::ProcessPacket(std::span<const byte> packet_data,
   //              static_cast<unsigned>(packet.service_id()),
   //              static_cast<unsigned>(packet.method_id()));
 
+  internal::endpoint_lock().lock();
   internal::Channel* channel = GetInternalChannel(packet.channel_id());
 
   if (channel == nullptr) {
     // If the requested channel doesn't exist, try to dynamically assign one.
     channel = AssignChannel(packet.channel_id(), interface);
     if (channel == nullptr) {
-      internal::rpc_lock().unlock();
+      internal::endpoint_lock().unlock();
       // If a channel can't be assigned, send a RESOURCE_EXHAUSTED error. Never
       // send responses to error messages, though, to avoid infinite cycles.
       if (packet.type() != PacketType::CLIENT_ERROR) {
@@ -70,11 +75,11 @@ Status Server::ProcessPacket(std::span<const byte> packet_data,
       return OkStatus();  // OK since the packet was handled
     }
   }
+  internal::endpoint_lock().unlock();
 
   const auto [service, method] = FindMethod(packet);
 
   if (method == nullptr) {
-    internal::rpc_lock().unlock();
     // Don't send responses to errors to avoid infinite error cycles.
     if (packet.type() != PacketType::CLIENT_ERROR) {
       channel->Send(Packet::ServerError(packet, Status::NotFound()))
@@ -83,13 +88,20 @@ Status Server::ProcessPacket(std::span<const byte> packet_data,
     return OkStatus();  // OK since the packet was handled.
   }
 
+  // Only the lock for this packet's call is held, so packets for calls in
+  // other buckets are processed in parallel.
+  internal::RpcLock& call_lock = CallLock(packet);
+  call_lock.lock();
+  internal::ServerCall* const call =
+      static_cast<internal::ServerCall*>(FindCall(packet));
+
   switch (packet.type()) {
     case PacketType::REQUEST: {
       // If the REQUEST is for an ongoing RPC, the existing call will be
       // cancelled when the new call object is created.
       const internal::CallContext context(
           *this, *channel, *service, *method, packet.call_id());
-      internal::rpc_lock().unlock();
+      call_lock.unlock();
       method->Invoke(context, packet);
       break;
     }
@@ -101,14 +113,14 @@ Status Server::ProcessPacket(std::span<const byte> packet_data,
       if (call != nullptr && call->id() == packet.call_id()) {
         call->HandleError(packet.status());
       } else {
-        internal::rpc_lock().unlock();
+        call_lock.unlock();
       }
       break;
     case PacketType::CLIENT_STREAM_END:
       HandleClientStreamPacket(packet, *channel, call);
       break;
     default:
-      internal::rpc_lock().unlock();
+      call_lock.unlock();
       PW_LOG_WARN("pw_rpc server unable to handle packet of type %u",
                   unsigned(packet.type()));
   }
@@ -119,22 +131,26 @@ Status Server::ProcessPacket(std::span<const byte> packet_data,
 std::tuple<Service*, const internal::Method*> Server::FindMethod(
     const internal::Packet& packet) {
   // Packets always include service and method IDs.
-  auto service = std::find_if(services_.begin(), services_.end(), [&](auto& s) {
+  IntrusiveList<Service>& services = ServicesFor(packet.service_id());
+  auto service = std::find_if(services.begin(), services.end(), [&](auto& s) {
     return s.id() == packet.service_id();
   });
 
-  if (service == services_.end()) {
+  if (service == services.end()) {
     return {};
   }
 
   return {&(*service), service->FindMethod(packet.method_id())};
 }
 
+// The call's lock is the lock for the packet's IDs, which the lock analysis
+// cannot determine.
 void Server::HandleClientStreamPacket(const internal::Packet& packet,
                                       internal::Channel& channel,
-                                      internal::ServerCall* call) const {
+                                      internal::ServerCall* call) const
+    PW_NO_LOCK_SAFETY_ANALYSIS {
   if (call == nullptr || call->id() != packet.call_id()) {
-    internal::rpc_lock().unlock();
+    CallLock(packet).unlock();
     PW_LOG_DEBUG(
         "Received client stream packet for %u:%08x/%08x, which is not pending",
         static_cast<unsigned>(packet.channel_id()),
@@ -146,14 +162,14 @@ void Server::HandleClientStreamPacket(const internal::Packet& packet,
   }
 
   if (!call->has_client_stream()) {
-    internal::rpc_lock().unlock();
+    CallLock(packet).unlock();
     channel.Send(Packet::ServerError(packet, Status::InvalidArgument()))
         .IgnoreError();  // Errors are logged in Channel::Send.
     return;
   }
 
   if (!call->client_stream_open()) {
-    internal::rpc_lock().unlock();
+    CallLock(packet).unlock();
     channel.Send(Packet::ServerError(packet, Status::FailedPrecondition()))
         .IgnoreError();  // Errors are logged in Channel::Send.
     return;
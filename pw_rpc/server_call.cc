@@ -17,15 +17,6 @@
 namespace pw::rpc::internal {
 
 void ServerCall::MoveServerCallFrom(ServerCall& other) {
-  // If this call is active, finish it first.
-  if (active()) {
-    Close();
-    SendPacket(PacketType::RESPONSE,
-               {},
-               OkStatus());  // Unlocks when it sends a packet
-    rpc_lock().lock();
-  }
-
   MoveFrom(other);
 
 #if PW_RPC_CLIENT_STREAM_END_CALLBACK
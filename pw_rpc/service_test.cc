@@ -16,6 +16,7 @@
 
 #include "gtest/gtest.h"
 #include "pw_rpc/internal/method.h"
+#include "pw_rpc/server.h"
 
 namespace pw::rpc {
 
@@ -80,6 +81,47 @@ TEST(Service, MultipleMethods_FindMethod_NotPresent) {
   EXPECT_EQ(ServiceTestHelper::FindMethod(service, 999), nullptr);
 }
 
+TEST(Service, MultipleMethods_Registered_FindMethod) {
+  TestService service;
+  Server server(std::span<Channel>{});
+  server.RegisterService(service);
+
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 123),
+            &TestService::kMethods[0].method());
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 456),
+            &TestService::kMethods[1].method());
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 789),
+            &TestService::kMethods[2].method());
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 0), nullptr);
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 457), nullptr);
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 999), nullptr);
+}
+
+class UnsortedTestService : public Service {
+ public:
+  constexpr UnsortedTestService() : Service(0xabcd, kMethods) {}
+
+  static constexpr std::array<ServiceTestMethodUnion, 3> kMethods = {
+      ServiceTestMethod(789, 'c'),
+      ServiceTestMethod(123, 'a'),
+      ServiceTestMethod(456, 'b'),
+  };
+};
+
+TEST(Service, UnsortedMethods_Registered_FindMethod) {
+  UnsortedTestService service;
+  Server server(std::span<Channel>{});
+  server.RegisterService(service);
+
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 789),
+            &UnsortedTestService::kMethods[0].method());
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 123),
+            &UnsortedTestService::kMethods[1].method());
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 456),
+            &UnsortedTestService::kMethods[2].method());
+  EXPECT_EQ(ServiceTestHelper::FindMethod(service, 457), nullptr);
+}
+
 class EmptyTestService : public Service {
  public:
   constexpr EmptyTestService() : Service(0xabcd, kMethods) {}
@@ -0,0 +1,209 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host stress test for calls on several threads at once. Each thread calls the
+// BenchmarkService on its own channel of a shared client. Packets are passed
+// directly between the client and server on the calling thread, so each
+// response arrives before the request returns. Multiple threads are only used
+// if PW_RPC_USE_GLOBAL_MUTEX is enabled. This test should only be built for the
+// host.
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "pw_rpc/benchmark.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/internal/config.h"
+#include "pw_rpc/server.h"
+
+namespace pw::rpc {
+namespace {
+
+using pw_rpc::raw::Benchmark;
+
+// The client and server can only be called from multiple threads with the
+// global mutex.
+constexpr size_t kThreads = PW_RPC_USE_GLOBAL_MUTEX ? 8 : 1;
+constexpr size_t kRequestsPerThread = 1000;
+
+constexpr size_t kBufferSizeBytes = 128;
+constexpr size_t kPayloadSizeBytes = 32;
+
+// Passes each packet to the client or server on the same thread. Each output
+// is only used by one thread.
+class LoopbackOutput final : public ChannelOutput {
+ public:
+  LoopbackOutput() : ChannelOutput("loopback") {}
+
+  void set_destination(Server& server) { server_ = &server; }
+  void set_destination(Client& client) { client_ = &client; }
+
+  std::span<std::byte> AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(std::span<const std::byte> buffer) override {
+    if (buffer.empty()) {
+      return OkStatus();
+    }
+    if (server_ != nullptr) {
+      return server_->ProcessPacket(buffer, *this);
+    }
+    return client_->ProcessPacket(buffer);
+  }
+
+ private:
+  Server* server_ = nullptr;
+  Client* client_ = nullptr;
+  std::array<std::byte, kBufferSizeBytes> buffer_;
+};
+
+// A channel's outputs in each direction.
+struct Connection {
+  LoopbackOutput to_server;
+  LoopbackOutput to_client;
+};
+
+// Sends a payload that identifies the thread and counts the responses that
+// echo it.
+class Echoer {
+ public:
+  void set_channel_id(uint32_t channel_id) {
+    channel_id_ = channel_id;
+    payload_.fill(static_cast<std::byte>(channel_id));
+  }
+
+  uint32_t channel_id() const { return channel_id_; }
+  ConstByteSpan payload() const { return payload_; }
+  size_t responses() const { return responses_; }
+
+  void HandleResponse(ConstByteSpan response) {
+    if (std::equal(response.begin(),
+                   response.end(),
+                   payload_.begin(),
+                   payload_.end())) {
+      responses_ += 1;
+    }
+  }
+
+ private:
+  uint32_t channel_id_ = 0;
+  std::array<std::byte, kPayloadSizeBytes> payload_;
+  size_t responses_ = 0;
+};
+
+class StressTest : public ::testing::Test {
+ protected:
+  StressTest() : client_(client_channels_) {
+    for (size_t i = 0; i < kThreads; ++i) {
+      const uint32_t channel_id = static_cast<uint32_t>(i + 1);
+      client_channels_[i].Configure(channel_id, connections_[i].to_server);
+      connections_[i].to_client.set_destination(client_);
+      echoers_[i].set_channel_id(channel_id);
+    }
+  }
+
+  // Runs the function on each echoer in its own thread.
+  template <typename Function>
+  void RunThreads(Function function) {
+    std::vector<std::thread> threads;
+    for (Echoer& echoer : echoers_) {
+      threads.emplace_back([&function, &echoer] { function(echoer); });
+    }
+    for (std::thread& thread : threads) {
+      thread.join();
+    }
+  }
+
+  std::array<Echoer, kThreads> echoers_;
+  std::array<Connection, kThreads> connections_;
+  std::array<Channel, kThreads> client_channels_;
+  Client client_;
+};
+
+// Each thread opens a BidirectionalEcho call on its own server, so the threads
+// share the client but not the servers.
+TEST_F(StressTest, BidirectionalEcho_SharedClient) {
+  std::array<BenchmarkService, kThreads> services;
+  std::array<Channel, kThreads> server_channels;
+  std::vector<std::unique_ptr<Server>> servers;
+
+  for (size_t i = 0; i < kThreads; ++i) {
+    const uint32_t channel_id = static_cast<uint32_t>(i + 1);
+    server_channels[i].Configure(channel_id, connections_[i].to_client);
+    servers.push_back(
+        std::make_unique<Server>(std::span(&server_channels[i], 1)));
+    servers.back()->RegisterService(services[i]);
+    connections_[i].to_server.set_destination(*servers.back());
+  }
+
+  RunThreads([this](Echoer& echoer) {
+    RawClientReaderWriter call = Benchmark::BidirectionalEcho(
+        client_, echoer.channel_id(), [&echoer](ConstByteSpan response) {
+          echoer.HandleResponse(response);
+        });
+
+    for (size_t count = 0; count < kRequestsPerThread; ++count) {
+      call.Write(echoer.payload()).IgnoreError();
+    }
+    call.Cancel().IgnoreError();
+  });
+
+  for (const Echoer& echoer : echoers_) {
+    EXPECT_EQ(echoer.responses(), kRequestsPerThread);
+  }
+}
+
+// Each thread sends UnaryEcho requests on its own channel of a shared server.
+TEST_F(StressTest, UnaryEcho_SharedClientAndServer) {
+  BenchmarkService service;
+  std::array<Channel, kThreads> server_channels;
+  for (size_t i = 0; i < kThreads; ++i) {
+    server_channels[i].Configure(static_cast<uint32_t>(i + 1),
+                                 connections_[i].to_client);
+  }
+
+  Server server(server_channels);
+  server.RegisterService(service);
+
+  for (Connection& connection : connections_) {
+    connection.to_server.set_destination(server);
+  }
+
+  RunThreads([this](Echoer& echoer) {
+    for (size_t count = 0; count < kRequestsPerThread; ++count) {
+      Benchmark::UnaryEcho(client_,
+                           echoer.channel_id(),
+                           echoer.payload(),
+                           [&echoer](ConstByteSpan response, Status status) {
+                             if (status.ok()) {
+                               echoer.HandleResponse(response);
+                             }
+                           });
+    }
+  });
+
+  for (const Echoer& echoer : echoers_) {
+    EXPECT_EQ(echoer.responses(), kRequestsPerThread);
+  }
+}
+
+}  // namespace
+}  // namespace pw::rpc
@@ -35,6 +35,11 @@ class SocketStream : public NonSeekableReaderWriter {
   // host is nullptr then the locahost address is used instead.
   Status Connect(const char* host, uint16_t port);
 
+  // Sets TCP_NODELAY on the connection, so small writes are sent immediately
+  // instead of being held until earlier data is acknowledged. Call after
+  // Serve() or Connect() succeeds.
+  Status DisableNagle();
+
   // Close the socket stream and release all resources
   void Close();
 
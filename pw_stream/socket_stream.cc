@@ -15,6 +15,7 @@
 #include "pw_stream/socket_stream.h"
 
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
 
 #include <cstring>
@@ -103,6 +104,20 @@ Status SocketStream::SocketStream::Connect(const char* host, uint16_t port) {
   return OkStatus();
 }
 
+Status SocketStream::DisableNagle() {
+  if (conn_fd_ == kInvalidFd) {
+    return Status::FailedPrecondition();
+  }
+
+  constexpr int value = 1;
+  if (setsockopt(conn_fd_, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(int)) <
+      0) {
+    PW_LOG_ERROR("Failed to set TCP_NODELAY: %s", std::strerror(errno));
+    return Status::Unknown();
+  }
+  return OkStatus();
+}
+
 void SocketStream::Close() {
   if (socket_fd_ != kInvalidFd) {
     close(socket_fd_);
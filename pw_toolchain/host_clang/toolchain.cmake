@@ -18,7 +18,10 @@ pw_set_backend(pw_assert pw_assert_log)
 pw_set_backend(pw_chrono.system_clock pw_chrono_stl.system_clock)
 pw_set_backend(pw_log pw_log_basic)
 pw_set_backend(pw_rpc.system_server targets.host.system_rpc_server)
+pw_set_backend(pw_sync.binary_semaphore pw_sync_stl.binary_semaphore_backend)
 pw_set_backend(pw_sync.mutex pw_sync_stl.mutex_backend)
+pw_set_backend(pw_sync.thread_notification
+               pw_sync.binary_semaphore_thread_notification_backend)
 pw_set_backend(pw_sys_io pw_sys_io_stdio)
 
 set(CMAKE_C_COMPILER clang)
@@ -72,6 +72,11 @@ Status DecodeChunk(ConstByteSpan message, Chunk& chunk) {
         PW_TRY(decoder.ReadUint32(&value));
         chunk.status = static_cast<Status::Code>(value);
         break;
+
+      case ProtoChunk::Fields::TYPE:
+        PW_TRY(decoder.ReadUint32(&value));
+        chunk.type = static_cast<Chunk::Type>(value);
+        break;
     }
   }
 
@@ -106,6 +111,10 @@ Result<ConstByteSpan> EncodeChunk(const Chunk& chunk, ByteSpan buffer) {
   if (chunk.status.has_value()) {
     encoder.WriteStatus(chunk.status.value().code()).IgnoreError();
   }
+  if (chunk.type.has_value()) {
+    encoder.WriteType(static_cast<ProtoChunk::Type>(chunk.type.value()))
+        .IgnoreError();
+  }
 
   PW_TRY(encoder.status());
   return ConstByteSpan(encoder);
@@ -21,11 +21,14 @@
 
 namespace pw::transfer::internal {
 
-void ChunkDataBuffer::Write(ConstByteSpan data, bool last_chunk) {
+void ChunkDataBuffer::Write(ConstByteSpan data,
+                            size_t offset,
+                            bool last_chunk) {
   PW_DASSERT(data.size() <= buffer_.size());
 
   std::copy(data.begin(), data.end(), buffer_.begin());
   size_ = data.size();
+  offset_ = offset;
 
   last_chunk_ = last_chunk;
 }
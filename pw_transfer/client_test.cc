@@ -381,7 +381,8 @@ TEST_F(ReadTransfer, ServerError) {
 }
 
 TEST_F(ReadTransfer, OnlySendsParametersOnceAfterDrop) {
-  stream::MemoryWriterBuffer<64> writer;
+  // The writer has room for the final chunk after the data.
+  stream::MemoryWriterBuffer<128> writer;
   Status transfer_status = Status::Unknown();
 
   client_.Read(10, writer, [&transfer_status](Status status) {
@@ -413,33 +414,41 @@ TEST_F(ReadTransfer, OnlySendsParametersOnceAfterDrop) {
                      .data = data.subspan(offset, 8)}));
   }
 
-  // Only one parameters update should be sent, with the offset of the initial
-  // dropped packet.
+  // Only one parameters update should be sent, requesting just the dropped
+  // packet.
   ASSERT_EQ(payloads.size(), 2u);
 
   Chunk c1 = DecodeChunk(payloads[1]);
   EXPECT_EQ(c1.transfer_id, 10u);
   EXPECT_EQ(c1.offset, 8u);
-  ASSERT_EQ(c1.pending_bytes.value(), 56u);
+  ASSERT_EQ(c1.pending_bytes.value(), 8u);
 
-  // Send the remaining data to complete the transfer.
-  context_.server().SendServerStream<Transfer::Read>(
-      EncodeChunk({.transfer_id = 10u,
-                   .offset = 8,
-                   .data = data.subspan(8, 56),
-                   .remaining_bytes = 0}));
+  // Once the dropped packet arrives, the rest of the transfer is requested.
+  context_.server().SendServerStream<Transfer::Read>(EncodeChunk(
+      {.transfer_id = 10u, .offset = 8, .data = data.subspan(8, 8)}));
   ASSERT_EQ(payloads.size(), 3u);
 
   Chunk c2 = DecodeChunk(payloads[2]);
   EXPECT_EQ(c2.transfer_id, 10u);
-  ASSERT_TRUE(c2.status.has_value());
-  EXPECT_EQ(c2.status.value(), OkStatus());
+  EXPECT_EQ(c2.offset, 64u);
+  ASSERT_EQ(c2.pending_bytes.value(), 64u);
+
+  context_.server().SendServerStream<Transfer::Read>(
+      EncodeChunk({.transfer_id = 10u, .offset = 64, .remaining_bytes = 0}));
+  ASSERT_EQ(payloads.size(), 4u);
+
+  Chunk c3 = DecodeChunk(payloads[3]);
+  EXPECT_EQ(c3.transfer_id, 10u);
+  ASSERT_TRUE(c3.status.has_value());
+  EXPECT_EQ(c3.status.value(), OkStatus());
 
   EXPECT_EQ(transfer_status, OkStatus());
+  EXPECT_EQ(std::memcmp(writer.data(), data.data(), data.size()), 0);
 }
 
 TEST_F(ReadTransfer, ResendsParametersIfSentRepeatedChunkDuringRecovery) {
-  stream::MemoryWriterBuffer<64> writer;
+  // The writer has room for the final chunk after the data.
+  stream::MemoryWriterBuffer<128> writer;
   Status transfer_status = Status::Unknown();
 
   client_.Read(11, writer, [&transfer_status](Status status) {
@@ -471,8 +480,8 @@ TEST_F(ReadTransfer, ResendsParametersIfSentRepeatedChunkDuringRecovery) {
                      .data = data.subspan(offset, 8)}));
   }
 
-  // Only one parameters update should be sent, with the offset of the initial
-  // dropped packet.
+  // Only one parameters update should be sent, requesting just the dropped
+  // packet.
   ASSERT_EQ(payloads.size(), 2u);
 
   const Chunk last_chunk = {
@@ -486,7 +495,7 @@ TEST_F(ReadTransfer, ResendsParametersIfSentRepeatedChunkDuringRecovery) {
   Chunk c2 = DecodeChunk(payloads[2]);
   EXPECT_EQ(c2.transfer_id, 11u);
   EXPECT_EQ(c2.offset, 8u);
-  ASSERT_EQ(c2.pending_bytes.value(), 56u);
+  ASSERT_EQ(c2.pending_bytes.value(), 8u);
 
   // Do it again.
   context_.server().SendServerStream<Transfer::Read>(EncodeChunk(last_chunk));
@@ -494,20 +503,24 @@ TEST_F(ReadTransfer, ResendsParametersIfSentRepeatedChunkDuringRecovery) {
   Chunk c3 = DecodeChunk(payloads[3]);
   EXPECT_EQ(c3.transfer_id, 11u);
   EXPECT_EQ(c3.offset, 8u);
-  ASSERT_EQ(c3.pending_bytes.value(), 56u);
+  ASSERT_EQ(c3.pending_bytes.value(), 8u);
 
   // Finish the transfer normally.
-  context_.server().SendServerStream<Transfer::Read>(
-      EncodeChunk({.transfer_id = 11u,
-                   .offset = 8,
-                   .data = data.subspan(8, 56),
-                   .remaining_bytes = 0}));
+  context_.server().SendServerStream<Transfer::Read>(EncodeChunk(
+      {.transfer_id = 11u, .offset = 8, .data = data.subspan(8, 8)}));
   ASSERT_EQ(payloads.size(), 5u);
-
   Chunk c4 = DecodeChunk(payloads[4]);
   EXPECT_EQ(c4.transfer_id, 11u);
-  ASSERT_TRUE(c4.status.has_value());
-  EXPECT_EQ(c4.status.value(), OkStatus());
+  EXPECT_EQ(c4.offset, 64u);
+
+  context_.server().SendServerStream<Transfer::Read>(
+      EncodeChunk({.transfer_id = 11u, .offset = 64, .remaining_bytes = 0}));
+  ASSERT_EQ(payloads.size(), 6u);
+
+  Chunk c5 = DecodeChunk(payloads[5]);
+  EXPECT_EQ(c5.transfer_id, 11u);
+  ASSERT_TRUE(c5.status.has_value());
+  EXPECT_EQ(c5.status.value(), OkStatus());
 
   EXPECT_EQ(transfer_status, OkStatus());
 }
@@ -16,6 +16,7 @@
 
 #include "pw_transfer/internal/context.h"
 
+#include <algorithm>
 #include <mutex>
 
 #include "pw_assert/check.h"
@@ -69,10 +70,22 @@ Status Context::SendInitialTransmitChunk() {
 
 void Context::UpdateParameters(const TransferParameters& max_parameters,
                                const Chunk& chunk) {
-  offset_ = chunk.offset;
+  if (IsWindowExtension(chunk)) {
+    // Keep sending from the current offset up to the new end of the window. If
+    // the final chunk was already sent, there is nothing left to send.
+    const size_t window_end_offset =
+        chunk.offset + chunk.pending_bytes.value_or(0);
+    pending_bytes_ = 0;
+    if ((flags_ & kFlagsFinalChunkSent) == 0 && window_end_offset > offset_) {
+      pending_bytes_ = window_end_offset - offset_;
+    }
+  } else {
+    offset_ = chunk.offset;
+    flags_ &= ~kFlagsFinalChunkSent;
 
-  if (chunk.pending_bytes.has_value()) {
-    pending_bytes_ = chunk.pending_bytes.value();
+    if (chunk.pending_bytes.has_value()) {
+      pending_bytes_ = chunk.pending_bytes.value();
+    }
   }
 
   if (chunk.max_chunk_size_bytes.has_value()) {
@@ -123,8 +136,10 @@ bool Context::ReadTransmitChunk(const TransferParameters& max_parameters,
   }
 
   // If the offsets don't match, attempt to seek on the reader. Not all readers
-  // support seeking; abort with UNIMPLEMENTED if this handler doesn't.
-  if (offset_ != chunk.offset) {
+  // support seeking; abort with UNIMPLEMENTED if this handler doesn't. A window
+  // extension never requires seeking, as the transmitter continues from its
+  // current offset.
+  if (offset_ != chunk.offset && !IsWindowExtension(chunk)) {
     if (Status seek_status = reader().Seek(chunk.offset); !seek_status.ok()) {
       PW_LOG_WARN("Transfer %u seek to %u failed with status %u",
                   static_cast<unsigned>(transfer_id_),
@@ -245,6 +260,11 @@ bool Context::ReadReceiveChunk(ChunkDataBuffer& buffer,
 
 void Context::ProcessReceiveChunk(ChunkDataBuffer& buffer,
                                   const TransferParameters& max_parameters) {
+  if (buffer.offset() != offset_) {
+    ProcessOutOfOrderChunk(buffer, max_parameters);
+    return;
+  }
+
   // Write staged data from the buffer to the stream.
   if (!buffer.empty()) {
     if (Status status = writer().Write(buffer); !status.ok()) {
@@ -272,10 +292,38 @@ void Context::ProcessReceiveChunk(ChunkDataBuffer& buffer,
 
   // TODO(frolv): Release the buffer.
 
-  if (pending_bytes_ == 0u) {
+  if (num_received_ranges_ != 0u) {
+    // Only the gap before the received data was requested. Once it is filled,
+    // skip over the data that is already in the stream.
+    if (offset_ >= received_ranges_[0].start) {
+      SkipReceivedRange(max_parameters);
+    }
+  } else if (pending_bytes_ == 0u) {
     // All pending data has been received. Send a new parameters chunk to start
     // the next batch.
     UpdateAndSendTransferParameters(max_parameters);
+  } else if (max_parameters.sliding_window()) {
+    UpdateSlidingWindow(max_parameters);
+  }
+}
+
+void Context::UpdateSlidingWindow(const TransferParameters& max_parameters) {
+  // Receiving a full window without loss takes at least one round trip. Grow
+  // the window by a chunk each time this happens, so that it opens up to fill
+  // the link, up to the configured maximum.
+  if (offset_ >= window_increase_offset_) {
+    window_size_ = std::min<size_t>(window_size_ + max_chunk_size_bytes_,
+                                    max_parameters.pending_bytes());
+    window_increase_offset_ = offset_ + window_size_;
+  }
+
+  // Extend the window each time a fraction of it has been received, rather than
+  // waiting for it to drain, so that the transmitter does not have to stop and
+  // wait for a parameters chunk.
+  if (pending_bytes_ <=
+      window_size_ - window_size_ / max_parameters.extend_window_divisor()) {
+    UpdateAndSendTransferParameters(max_parameters,
+                                    Chunk::Type::kParametersContinue);
   }
 }
 
@@ -308,6 +356,7 @@ Status Context::SendNextDataChunk() {
     // No more data to read.
     encoder.WriteRemainingBytes(0).IgnoreError();
     pending_bytes_ = 0;
+    flags_ |= kFlagsFinalChunkSent;
   } else if (data.ok()) {
     encoder.WriteData(data.value()).IgnoreError();
     last_chunk_offset_ = offset_;
@@ -342,6 +391,10 @@ Status Context::SendNextDataChunk() {
 bool Context::HandleDataChunk(ChunkDataBuffer& buffer,
                               const TransferParameters& max_parameters,
                               const Chunk& chunk) {
+  if (chunk.offset != offset_) {
+    return HandleOutOfOrderChunk(buffer, max_parameters, chunk);
+  }
+
   if (chunk.data.size() > pending_bytes_) {
     // End the transfer, as this indcates a bug with the client implementation
     // where it doesn't respect pending_bytes. Trying to recover from here
@@ -352,42 +405,233 @@ bool Context::HandleDataChunk(ChunkDataBuffer& buffer,
     return false;
   }
 
-  if (chunk.offset != offset_) {
-    // Bad offset; reset pending_bytes to send another parameters chunk.
+  // Write the chunk data to the buffer to be processed later. If the chunk has
+  // no data, this will clear the buffer.
+  buffer.Write(chunk.data, chunk.offset, chunk.IsFinalTransmitChunk());
+  return true;
+}
+
+bool Context::HandleOutOfOrderChunk(ChunkDataBuffer& buffer,
+                                    const TransferParameters& max_parameters,
+                                    const Chunk& chunk) {
+  if (CanStoreOutOfOrderChunk(chunk)) {
+    buffer.Write(chunk.data, chunk.offset, chunk.IsFinalTransmitChunk());
+    return true;
+  }
+
+  if (num_received_ranges_ == 0u) {
     PW_LOG_DEBUG(
         "Transfer %u expected offset %u, received %u; entering recovery state",
         static_cast<unsigned>(transfer_id_),
         static_cast<unsigned>(offset_),
         static_cast<unsigned>(chunk.offset));
-    UpdateAndSendTransferParameters(max_parameters);
-    set_transfer_state(TransferState::kRecovery);
+    EnterRecovery(max_parameters);
 
     // Return false as there is no immediate deferred work to complete. The
     // transfer must wait for the next data chunk to be sent by the transmitter.
     return false;
   }
 
-  // Write the chunk data to the buffer to be processed later. If the chunk has
-  // no data, this will clear the buffer.
-  buffer.Write(chunk.data, chunk.IsFinalTransmitChunk());
-  return true;
+  // The chunk was already received, or cannot be tracked. It is requested again
+  // once the gaps before it are filled. If the transmitter repeats a chunk, it
+  // may have missed the last parameters, so send them again.
+  if (last_chunk_offset_ == chunk.offset) {
+    PW_LOG_DEBUG(
+        "Transfer %u received repeated offset %u; retry detected, resending "
+        "transfer parameters",
+        static_cast<unsigned>(transfer_id_),
+        static_cast<unsigned>(chunk.offset));
+    SendTransferParameters().IgnoreError();
+  }
+
+  last_chunk_offset_ = chunk.offset;
+  return false;
+}
+
+bool Context::CanStoreOutOfOrderChunk(const Chunk& chunk) {
+  const size_t end = chunk.offset + chunk.data.size();
+  if (chunk.offset < offset_ || end > window_end_offset_ ||
+      !writer().seekable(stream::Stream::kCurrent)) {
+    return false;
+  }
+
+  bool adjacent = false;
+  for (size_t i = 0; i < num_received_ranges_; ++i) {
+    const ReceivedRange& range = received_ranges_[i];
+    if (chunk.offset < range.end && end > range.start) {
+      return false;  // The data was already received.
+    }
+    adjacent = adjacent || range.end == chunk.offset || range.start == end;
+  }
+
+  // Data next to a received range extends it; otherwise a new range is needed.
+  return adjacent || num_received_ranges_ < received_ranges_.size();
 }
 
-Status Context::SendTransferParameters() {
+void Context::ProcessOutOfOrderChunk(ChunkDataBuffer& buffer,
+                                     const TransferParameters& max_parameters) {
+  // Write the data in place, then return to the current offset so that the gap
+  // can be filled in.
+  const auto skip = static_cast<ssize_t>(buffer.offset() - offset_);
+
+  if (!writer().Seek(skip, stream::Stream::kCurrent).ok()) {
+    // The stream cannot hold the data past the gap; request it again later.
+    if (num_received_ranges_ == 0u) {
+      EnterRecovery(max_parameters);
+    }
+    return;
+  }
+
+  Status status;
+  if (!buffer.empty()) {
+    status = writer().Write(buffer);
+  }
+  if (status.ok()) {
+    status = writer().Seek(-skip - static_cast<ssize_t>(buffer.size()),
+                           stream::Stream::kCurrent);
+  }
+  if (!status.ok()) {
+    PW_LOG_ERROR(
+        "Transfer %u write of %u B chunk at offset %u failed with status %u; "
+        "aborting with DATA_LOSS",
+        static_cast<unsigned>(transfer_id_),
+        static_cast<unsigned>(buffer.size()),
+        static_cast<unsigned>(buffer.offset()),
+        status.code());
+    FinishAndSendStatus(Status::DataLoss());
+    return;
+  }
+
+  if (buffer.last_chunk()) {
+    flags_ |= kFlagsFinalChunkReceived;
+  }
+
+  const bool first_loss = num_received_ranges_ == 0u;
+  const size_t gap_end = first_loss ? 0 : received_ranges_[0].start;
+  AddReceivedRange(buffer.offset(), buffer.offset() + buffer.size());
+
+  if (!first_loss && received_ranges_[0].start == gap_end) {
+    return;  // The earliest gap was already requested.
+  }
+
+  // Shrink the window after the loss, as in EnterRecovery().
+  if (first_loss && max_parameters.sliding_window()) {
+    window_size_ = std::max(window_size_ / 2, max_chunk_size_bytes_);
+  }
+
+  // Request only the missing data. Data which is already in flight continues
+  // to arrive after the gap and extends the received range.
+  pending_bytes_ = received_ranges_[0].start - offset_;
+
+  PW_LOG_DEBUG(
+      "Transfer %u expected offset %u, received %u; requesting %u B gap",
+      static_cast<unsigned>(transfer_id_),
+      static_cast<unsigned>(offset_),
+      static_cast<unsigned>(buffer.offset()),
+      static_cast<unsigned>(pending_bytes_));
+  SendTransferParameters().IgnoreError();
+}
+
+void Context::AddReceivedRange(size_t start, size_t end) {
+  size_t i = 0;
+  while (i < num_received_ranges_ && received_ranges_[i].end < start) {
+    i += 1;
+  }
+
+  if (i < num_received_ranges_ && received_ranges_[i].end == start) {
+    received_ranges_[i].end = end;
+
+    // Merge with the next range if the data filled the gap between them.
+    if (i + 1 < num_received_ranges_ && received_ranges_[i + 1].start == end) {
+      received_ranges_[i].end = received_ranges_[i + 1].end;
+      std::copy(received_ranges_.begin() + i + 2,
+                received_ranges_.begin() + num_received_ranges_,
+                received_ranges_.begin() + i + 1);
+      num_received_ranges_ -= 1;
+    }
+    return;
+  }
+
+  if (i < num_received_ranges_ && received_ranges_[i].start == end) {
+    received_ranges_[i].start = start;
+    return;
+  }
+
+  PW_DASSERT(num_received_ranges_ < received_ranges_.size());
+  std::copy_backward(received_ranges_.begin() + i,
+                     received_ranges_.begin() + num_received_ranges_,
+                     received_ranges_.begin() + num_received_ranges_ + 1);
+  received_ranges_[i] = {.start = start, .end = end};
+  num_received_ranges_ += 1;
+}
+
+void Context::SkipReceivedRange(const TransferParameters& max_parameters) {
+  const ReceivedRange range = received_ranges_[0];
+  std::copy(received_ranges_.begin() + 1,
+            received_ranges_.begin() + num_received_ranges_,
+            received_ranges_.begin());
+  num_received_ranges_ -= 1;
+
+  if (range.end > offset_) {
+    const auto skip = static_cast<ssize_t>(range.end - offset_);
+    if (Status status = writer().Seek(skip, stream::Stream::kCurrent);
+        !status.ok()) {
+      PW_LOG_ERROR(
+          "Transfer %u seek past received data failed with status %u; "
+          "aborting with DATA_LOSS",
+          static_cast<unsigned>(transfer_id_),
+          status.code());
+      FinishAndSendStatus(Status::DataLoss());
+      return;
+    }
+    offset_ = range.end;
+  }
+
+  if (num_received_ranges_ != 0u) {
+    pending_bytes_ = received_ranges_[0].start - offset_;
+    SendTransferParameters().IgnoreError();
+    return;
+  }
+
+  // The final chunk is always in the last range.
+  if ((flags_ & kFlagsFinalChunkReceived) != 0) {
+    FinishAndSendStatus(OkStatus());
+    return;
+  }
+
+  // All gaps are filled; continue from the end of the received data.
+  UpdateAndSendTransferParameters(max_parameters);
+}
+
+void Context::EnterRecovery(const TransferParameters& max_parameters) {
+  // Data was lost, so the window is likely larger than the link can handle.
+  // Halve it, down to a single chunk.
+  if (max_parameters.sliding_window()) {
+    window_size_ = std::max(window_size_ / 2, max_chunk_size_bytes_);
+  }
+
+  // Reset pending_bytes to send another parameters chunk.
+  UpdateAndSendTransferParameters(max_parameters);
+  set_transfer_state(TransferState::kRecovery);
+}
+
+Status Context::SendTransferParameters(Chunk::Type type) {
   const internal::Chunk parameters = {
       .transfer_id = transfer_id_,
       .pending_bytes = pending_bytes_,
       .max_chunk_size_bytes = max_chunk_size_bytes_,
       .offset = static_cast<uint32_t>(offset_),
+      .type = type,
   };
 
   PW_LOG_DEBUG(
       "Transfer %u sending transfer parameters: "
-      "offset=%u, pending_bytes=%u, chunk_size=%u",
+      "offset=%u, pending_bytes=%u, chunk_size=%u, type=%u",
       static_cast<unsigned>(transfer_id_),
       static_cast<unsigned>(offset_),
       static_cast<unsigned>(pending_bytes_),
-      static_cast<unsigned>(max_chunk_size_bytes_));
+      static_cast<unsigned>(max_chunk_size_bytes_),
+      static_cast<unsigned>(type));
 
   // If the parameters can't be encoded or sent, it most likely indicates a
   // transport-layer issue, so there isn't much that can be done by the transfer
@@ -417,7 +661,7 @@ Status Context::SendTransferParameters() {
 }
 
 Status Context::UpdateAndSendTransferParameters(
-    const TransferParameters& max_parameters) {
+    const TransferParameters& max_parameters, Chunk::Type type) {
   const size_t write_limit = writer().ConservativeWriteLimit();
   if (write_limit == 0) {
     PW_LOG_WARN(
@@ -428,13 +672,30 @@ Status Context::UpdateAndSendTransferParameters(
     return Status::ResourceExhausted();
   }
 
-  pending_bytes_ = std::min(max_parameters.pending_bytes(),
-                            static_cast<uint32_t>(write_limit));
+  // Only the sliding window grows window_size_ back after it shrinks. Without
+  // it, take the current maximum, which may change between updates.
+  if (max_parameters.sliding_window()) {
+    window_size_ =
+        std::min<size_t>(window_size_, max_parameters.pending_bytes());
+  } else {
+    window_size_ = max_parameters.pending_bytes();
+  }
+  const size_t window = std::min(window_size_, write_limit);
+
+  if (type == Chunk::Type::kParametersContinue) {
+    // The transmitter may already have sent data up to the end of the current
+    // window, so never move it back.
+    pending_bytes_ = std::max(pending_bytes_, window);
+  } else {
+    pending_bytes_ = window;
+    window_increase_offset_ = offset_ + pending_bytes_;
+  }
+  window_end_offset_ = offset_ + pending_bytes_;
 
   max_chunk_size_bytes_ = MaxWriteChunkSize(
       max_parameters.max_chunk_size_bytes(), rpc_writer_->channel_id());
 
-  return SendTransferParameters();
+  return SendTransferParameters(type);
 }
 
 void Context::Initialize(Type type,
@@ -459,6 +720,10 @@ void Context::Initialize(Type type,
   offset_ = 0;
   pending_bytes_ = 0;
   max_chunk_size_bytes_ = std::numeric_limits<uint32_t>::max();
+  window_size_ = std::numeric_limits<uint32_t>::max();
+  window_increase_offset_ = 0;
+  window_end_offset_ = 0;
+  num_received_ranges_ = 0;
 
   last_chunk_offset_ = 0;
   chunk_timeout_ = chunk_timeout;
@@ -581,6 +846,7 @@ void Context::HandleTimeout() {
   size_t last_size_sent = offset_ - last_chunk_offset_;
   offset_ = last_chunk_offset_;
   pending_bytes_ += last_size_sent;
+  flags_ &= ~kFlagsFinalChunkSent;
 
   ProcessTransmitChunk();
 }
@@ -15,12 +15,14 @@
 
 #include <array>
 
+#include "pw_assert/assert.h"
 #include "pw_function/function.h"
 #include "pw_status/status.h"
 #include "pw_stream/stream.h"
 #include "pw_sync/lock_annotations.h"
 #include "pw_sync/mutex.h"
 #include "pw_transfer/internal/client_context.h"
+#include "pw_transfer/internal/config.h"
 #include "pw_transfer/transfer.raw_rpc.pb.h"
 #include "pw_work_queue/work_queue.h"
 
@@ -65,6 +67,19 @@ class Client {
                         transfer_data_buffer.size()),
         chunk_data_buffer_(transfer_data_buffer) {}
 
+  // Enables sliding window read transfers. Rather than waiting to receive the
+  // whole window before asking for more data, the client extends the window
+  // each time 1/extend_window_divisor of it is received, so the server can send
+  // continuously over high-latency links. The window shrinks when data is lost
+  // and grows back by a chunk for each window received without loss.
+  //
+  // This should be called before starting any transfers.
+  void EnableSlidingWindow(
+      uint32_t extend_window_divisor = cfg::kDefaultExtendWindowDivisor) {
+    PW_ASSERT(extend_window_divisor > 0u);
+    max_parameters_.set_extend_window_divisor(extend_window_divisor);
+  }
+
   // Begins a new read transfer for the given transfer ID. The data read from
   // the server is written to the provided writer. Returns OK if the transfer is
   // successfully started. When the transfer finishes (successfully or not), the
@@ -109,8 +124,7 @@ class Client {
   rpc::RawClientReaderWriter read_stream_;
   rpc::RawClientReaderWriter write_stream_;
 
-  // TODO(frolv): Make this size configurable.
-  std::array<ClientContext, 1> transfer_contexts_
+  std::array<ClientContext, cfg::kMaxConcurrentTransfers> transfer_contexts_
       PW_GUARDED_BY(transfer_context_mutex_);
   sync::Mutex transfer_context_mutex_;
 
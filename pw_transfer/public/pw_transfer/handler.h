@@ -34,6 +34,17 @@ class Handler : public IntrusiveList<Handler>::Item {
 
   constexpr uint32_t id() const { return transfer_id_; }
 
+  // The scheduling priority of this handler's write transfers. When several
+  // write transfers are active, the transfer service divides its
+  // max_pending_bytes window between them in proportion to their priorities.
+  // Handlers default to a priority of 1, which shares the window evenly.
+  constexpr uint8_t priority() const { return priority_; }
+
+  void set_priority(uint8_t priority) {
+    PW_ASSERT(priority > 0u);
+    priority_ = priority;
+  }
+
   // Called at the beginning of a read transfer. The stream::Reader must be
   // ready to read after a successful PrepareRead() call. Returning a non-OK
   // status aborts the read.
@@ -61,10 +72,10 @@ class Handler : public IntrusiveList<Handler>::Item {
 
  protected:
   constexpr Handler(uint32_t transfer_id, stream::Reader* reader)
-      : transfer_id_(transfer_id), reader_(reader) {}
+      : transfer_id_(transfer_id), priority_(1), reader_(reader) {}
 
   constexpr Handler(uint32_t transfer_id, stream::Writer* writer)
-      : transfer_id_(transfer_id), writer_(writer) {}
+      : transfer_id_(transfer_id), priority_(1), writer_(writer) {}
 
   void set_reader(stream::Reader& reader) { reader_ = &reader; }
   void set_writer(stream::Writer& writer) { writer_ = &writer; }
@@ -90,6 +101,7 @@ class Handler : public IntrusiveList<Handler>::Item {
   }
 
   uint32_t transfer_id_;
+  uint8_t priority_;
 
   // Use a union to support constexpr construction.
   union {
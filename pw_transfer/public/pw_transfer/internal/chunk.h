@@ -21,11 +21,20 @@
 namespace pw::transfer::internal {
 
 struct Chunk {
-  // The initial chunk always has an offset of 0 and no data or status.
+  // Mirrors the Chunk.Type enum in transfer.proto.
+  enum class Type {
+    kData = 0,
+    kParametersRetransmit = 1,
+    kParametersContinue = 2,
+  };
+
+  // The initial chunk always has an offset of 0 and no data or status. A window
+  // extension is never an initial chunk, even if nothing has been received.
   //
   // Pending bytes is required in all read chunks, so that is checked elsewhere.
   constexpr bool IsInitialChunk() const {
-    return offset == 0 && data.empty() && !status.has_value();
+    return offset == 0 && data.empty() && !status.has_value() &&
+           type != Type::kParametersContinue;
   }
 
   // The final chunk from the transmitter sets remaining_bytes to 0 in both Read
@@ -40,6 +49,7 @@ struct Chunk {
   ConstByteSpan data;
   std::optional<uint64_t> remaining_bytes;
   std::optional<Status> status;
+  std::optional<Type> type;
 };
 
 Status DecodeChunk(ConstByteSpan message, Chunk& chunk);
@@ -13,6 +13,8 @@
 // the License.
 #pragma once
 
+#include <cstddef>
+
 #include "pw_bytes/span.h"
 
 namespace pw::transfer::internal {
@@ -26,7 +28,7 @@ namespace pw::transfer::internal {
 class ChunkDataBuffer {
  public:
   constexpr ChunkDataBuffer(ByteSpan buffer)
-      : buffer_(buffer), size_(0), last_chunk_(false) {}
+      : buffer_(buffer), size_(0), offset_(0), last_chunk_(false) {}
 
   constexpr std::byte* data() const { return buffer_.data(); }
 
@@ -35,15 +37,19 @@ class ChunkDataBuffer {
 
   constexpr bool empty() const { return size() == 0u; }
 
+  // The offset of the buffered data within the transfer.
+  constexpr size_t offset() const { return offset_; }
+
   constexpr bool last_chunk() const { return last_chunk_; }
 
-  void Write(ConstByteSpan data, bool last_chunk);
+  void Write(ConstByteSpan data, size_t offset, bool last_chunk);
 
  private:
   // TODO(frolv): This should be locked for use between an RPC thread and work
   // queue.
   ByteSpan buffer_;
   size_t size_;
+  size_t offset_;
   bool last_chunk_;
 };
 
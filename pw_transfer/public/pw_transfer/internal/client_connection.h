@@ -48,6 +48,10 @@ class ClientConnection {
 
   const TransferParameters& max_parameters() const { return max_parameters_; }
 
+  void set_extend_window_divisor(uint32_t divisor) {
+    max_parameters_.set_extend_window_divisor(divisor);
+  }
+
   rpc::RawServerReaderWriter& read_stream() { return read_stream_; }
   rpc::RawServerReaderWriter& write_stream() { return write_stream_; }
 
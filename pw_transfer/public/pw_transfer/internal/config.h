@@ -16,6 +16,7 @@
 #pragma once
 
 #include <cinttypes>
+#include <cstddef>
 #include <limits>
 
 #include "pw_chrono/system_clock.h"
@@ -32,16 +33,55 @@
 #define PW_TRANSFER_DEFAULT_TIMEOUT_MS 2000
 #endif  // PW_TRANSFER_DEFAULT_TIMEOUT_MS
 
+// In a sliding window transfer, the receiver extends the window each time
+// 1/divisor of the window size has been received. Larger divisors keep more
+// data in flight on high-latency links at the cost of more parameters chunks.
+// A divisor of 1 waits for the whole window, as in a stop-and-wait transfer.
+#ifndef PW_TRANSFER_DEFAULT_EXTEND_WINDOW_DIVISOR
+#define PW_TRANSFER_DEFAULT_EXTEND_WINDOW_DIVISOR 8
+#endif  // PW_TRANSFER_DEFAULT_EXTEND_WINDOW_DIVISOR
+
+// The maximum number of transfers a transfer client can run at once. A
+// transfer service can run this many read transfers and this many write
+// transfers at once. Each transfer uses a transfer context, which includes a
+// timer.
+#ifndef PW_TRANSFER_MAX_CONCURRENT_TRANSFERS
+#define PW_TRANSFER_MAX_CONCURRENT_TRANSFERS 4
+#endif  // PW_TRANSFER_MAX_CONCURRENT_TRANSFERS
+
+// The maximum number of ranges of data received past a lost chunk that a
+// receive transfer keeps track of. Out-of-order data is written to the stream
+// in place, so that only the missing data is requested again. This requires a
+// writer which can seek from its current position; otherwise, or if this is 0,
+// the transfer restarts from the lost chunk and all data after it is resent.
+#ifndef PW_TRANSFER_MAX_OUT_OF_ORDER_RANGES
+#define PW_TRANSFER_MAX_OUT_OF_ORDER_RANGES 4
+#endif  // PW_TRANSFER_MAX_OUT_OF_ORDER_RANGES
+
 static_assert(PW_TRANSFER_DEFAULT_MAX_RETRIES > 0 &&
               PW_TRANSFER_DEFAULT_MAX_RETRIES <=
                   std::numeric_limits<uint8_t>::max());
 
 static_assert(PW_TRANSFER_DEFAULT_TIMEOUT_MS > 0);
 
+static_assert(PW_TRANSFER_DEFAULT_EXTEND_WINDOW_DIVISOR > 0);
+
+static_assert(PW_TRANSFER_MAX_CONCURRENT_TRANSFERS > 0);
+
+static_assert(PW_TRANSFER_MAX_OUT_OF_ORDER_RANGES >= 0 &&
+              PW_TRANSFER_MAX_OUT_OF_ORDER_RANGES <
+                  std::numeric_limits<uint8_t>::max());
+
 namespace pw::transfer::cfg {
 
 inline constexpr uint8_t kDefaultMaxRetries = PW_TRANSFER_DEFAULT_MAX_RETRIES;
 inline constexpr chrono::SystemClock::duration kDefaultChunkTimeout =
     std::chrono::milliseconds(PW_TRANSFER_DEFAULT_TIMEOUT_MS);
+inline constexpr uint32_t kDefaultExtendWindowDivisor =
+    PW_TRANSFER_DEFAULT_EXTEND_WINDOW_DIVISOR;
+inline constexpr size_t kMaxConcurrentTransfers =
+    PW_TRANSFER_MAX_CONCURRENT_TRANSFERS;
+inline constexpr size_t kMaxOutOfOrderRanges =
+    PW_TRANSFER_MAX_OUT_OF_ORDER_RANGES;
 
 }  // namespace pw::transfer::cfg
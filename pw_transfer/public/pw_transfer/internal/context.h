@@ -13,6 +13,7 @@
 // the License.
 #pragma once
 
+#include <array>
 #include <cinttypes>
 #include <cstddef>
 #include <limits>
@@ -34,9 +35,11 @@ namespace pw::transfer::internal {
 class TransferParameters {
  public:
   constexpr TransferParameters(uint32_t pending_bytes,
-                               uint32_t max_chunk_size_bytes)
+                               uint32_t max_chunk_size_bytes,
+                               uint32_t extend_window_divisor = 0)
       : pending_bytes_(pending_bytes),
-        max_chunk_size_bytes_(max_chunk_size_bytes) {
+        max_chunk_size_bytes_(max_chunk_size_bytes),
+        extend_window_divisor_(extend_window_divisor) {
     PW_ASSERT(pending_bytes > 0);
     PW_ASSERT(max_chunk_size_bytes > 0);
   }
@@ -44,9 +47,20 @@ class TransferParameters {
   uint32_t pending_bytes() const { return pending_bytes_; }
   uint32_t max_chunk_size_bytes() const { return max_chunk_size_bytes_; }
 
+  // If nonzero, receive transfers use a sliding window, which is extended
+  // each time 1/extend_window_divisor of it is received. If zero, the receiver
+  // waits for the whole window to arrive before requesting more data.
+  uint32_t extend_window_divisor() const { return extend_window_divisor_; }
+  bool sliding_window() const { return extend_window_divisor_ != 0u; }
+
+  void set_extend_window_divisor(uint32_t divisor) {
+    extend_window_divisor_ = divisor;
+  }
+
  private:
   uint32_t pending_bytes_;
   uint32_t max_chunk_size_bytes_;
+  uint32_t extend_window_divisor_;
 };
 
 // Information about a single transfer.
@@ -122,6 +136,11 @@ class Context {
         offset_(0),
         pending_bytes_(0),
         max_chunk_size_bytes_(std::numeric_limits<uint32_t>::max()),
+        window_size_(std::numeric_limits<uint32_t>::max()),
+        window_increase_offset_(0),
+        window_end_offset_(0),
+        received_ranges_{},
+        num_received_ranges_(0),
         last_chunk_offset_(0),
         timer_([this](chrono::SystemClock::time_point) { this->OnTimeout(); }),
         chunk_timeout_(chrono::SystemClock::duration::zero()),
@@ -228,6 +247,13 @@ class Context {
   void UpdateParameters(const TransferParameters& max_parameters,
                         const Chunk& chunk);
 
+  // In a transmit transfer, true if the chunk extends the window of a sliding
+  // window transfer without asking for data to be resent.
+  bool IsWindowExtension(const Chunk& chunk) const {
+    return chunk.type == Chunk::Type::kParametersContinue &&
+           chunk.offset <= offset_;
+  }
+
   // Functions which extract relevant data from a chunk into the context.
   bool ReadTransmitChunk(const TransferParameters& max_parameters,
                          const Chunk& chunk);
@@ -256,14 +282,47 @@ class Context {
                        const TransferParameters& max_parameters,
                        const Chunk& chunk);
 
+  // In a receive transfer, handles a data chunk which is not at the current
+  // offset. Data past a gap is staged to be written in place if possible;
+  // otherwise, the transfer enters the recovery state.
+  bool HandleOutOfOrderChunk(ChunkDataBuffer& buffer,
+                             const TransferParameters& max_parameters,
+                             const Chunk& chunk);
+
+  // True if data past a gap can be written in place and tracked.
+  bool CanStoreOutOfOrderChunk(const Chunk& chunk);
+
+  // Writes staged data past the current offset to the stream without moving
+  // the stream position, and requests the missing data before it.
+  void ProcessOutOfOrderChunk(ChunkDataBuffer& buffer,
+                              const TransferParameters& max_parameters);
+
+  // Adds the range [start, end), which must not overlap any received range,
+  // merging it with adjacent ranges.
+  void AddReceivedRange(size_t start, size_t end);
+
+  // Once the gap before the first received range is filled, moves the offset
+  // and stream position past the range and requests the next missing data.
+  void SkipReceivedRange(const TransferParameters& max_parameters);
+
+  // Requests all data from the current offset again and ignores chunks until
+  // it arrives.
+  void EnterRecovery(const TransferParameters& max_parameters);
+
   // In a receive transfer, sends a parameters chunk telling the transmitter how
   // much data they can send.
-  Status SendTransferParameters();
+  Status SendTransferParameters(
+      Chunk::Type type = Chunk::Type::kParametersRetransmit);
 
   // Updates the current receive transfer parameters from the provided object,
   // then sends them.
   Status UpdateAndSendTransferParameters(
-      const TransferParameters& max_parameters);
+      const TransferParameters& max_parameters,
+      Chunk::Type type = Chunk::Type::kParametersRetransmit);
+
+  // In a sliding window receive transfer, adjusts the window size and extends
+  // the window if enough of it has been received.
+  void UpdateSlidingWindow(const TransferParameters& max_parameters);
 
   void SendStatusChunk(Status status);
   void FinishAndSendStatus(Status status);
@@ -283,6 +342,14 @@ class Context {
 
   static constexpr uint8_t kFlagsType = 1 << 0;
   static constexpr uint8_t kFlagsDataSent = 1 << 1;
+  static constexpr uint8_t kFlagsFinalChunkSent = 1 << 2;
+  static constexpr uint8_t kFlagsFinalChunkReceived = 1 << 3;
+
+  // A range of data received past a gap in a receive transfer.
+  struct ReceivedRange {
+    size_t start;
+    size_t end;
+  };
 
   uint32_t transfer_id_;
   uint8_t flags_;
@@ -299,6 +366,20 @@ class Context {
   size_t pending_bytes_;
   size_t max_chunk_size_bytes_;
 
+  // In a sliding window receive transfer, the current window size, and the
+  // offset at which it next grows.
+  size_t window_size_;
+  size_t window_increase_offset_;
+
+  // In a receive transfer, the end of the furthest window requested from the
+  // transmitter.
+  size_t window_end_offset_;
+
+  // In a receive transfer, ranges of data past offset_ which were received
+  // out of order and already written to the stream, sorted by offset.
+  std::array<ReceivedRange, cfg::kMaxOutOfOrderRanges> received_ranges_;
+  uint8_t num_received_ranges_;
+
   union {
     Status status_;             // Used when state is kCompleted.
     size_t last_chunk_offset_;  // Used in states kData and kRecovery.
@@ -19,6 +19,7 @@
 #include "pw_rpc/raw/server_reader_writer.h"
 #include "pw_transfer/handler.h"
 #include "pw_transfer/internal/client_connection.h"
+#include "pw_transfer/internal/config.h"
 #include "pw_transfer/internal/context.h"
 
 namespace pw::transfer::internal {
@@ -48,6 +49,14 @@ class ServerContext : public Context {
   // Precondition: Transfer context is active.
   Status Finish(Status status);
 
+  // The scheduling priority of the transfer's handler.
+  //
+  // Precondition: Transfer context is active.
+  uint8_t priority() const {
+    PW_DASSERT(handler_ != nullptr);
+    return handler_->priority();
+  }
+
  private:
   static Status OnCompletion(Context& ctx, Status status) {
     return static_cast<ServerContext&>(ctx).Finish(status);
@@ -80,13 +89,18 @@ class ServerContextPool {
 
   Result<ServerContext*> GetPendingTransfer(uint32_t transfer_id);
 
- private:
-  // TODO(frolv): Initially, only one transfer at a time is supported. Once that
-  // is updated, this should be made configurable.
-  static constexpr int kMaxConcurrentTransfers = 1;
+  // Returns the parameters to use for a transfer in this pool. Write transfers
+  // share the max_parameters window: each active transfer may have a portion
+  // of the pending bytes in flight, in proportion to its handler's priority,
+  // but no less than one chunk. This keeps the total amount of data in flight
+  // on the shared stream bounded as transfers start and finish. Read transfers
+  // use the window requested by the client, so their parameters are unchanged.
+  TransferParameters ScheduledParameters(
+      ServerContext& transfer, const TransferParameters& max_parameters);
 
+ private:
   TransferType type_;
-  std::array<ServerContext, kMaxConcurrentTransfers> transfers_;
+  std::array<ServerContext, cfg::kMaxConcurrentTransfers> transfers_;
   IntrusiveList<internal::Handler>& handlers_;
 };
 
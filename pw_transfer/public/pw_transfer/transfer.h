@@ -17,6 +17,7 @@
 #include <cstdint>
 #include <limits>
 
+#include "pw_assert/assert.h"
 #include "pw_bytes/span.h"
 #include "pw_transfer/handler.h"
 #include "pw_transfer/internal/client_connection.h"
@@ -85,6 +86,21 @@ class TransferService : public generated::Transfer<TransferService> {
     });
   }
 
+  // Enables sliding window write transfers. Rather than waiting to receive the
+  // whole max_pending_bytes window before asking for more data, the service
+  // extends the window each time 1/extend_window_divisor of it is received,
+  // so the client can send continuously over high-latency links. The window
+  // shrinks when data is lost and grows back by a chunk for each window
+  // received without loss.
+  //
+  // This requires a client that does not rewind when the window is extended.
+  // It should be called before any transfers are started.
+  void EnableSlidingWindow(
+      uint32_t extend_window_divisor = cfg::kDefaultExtendWindowDivisor) {
+    PW_ASSERT(extend_window_divisor > 0u);
+    client_.set_extend_window_divisor(extend_window_divisor);
+  }
+
   void RegisterHandler(internal::Handler& handler) {
     handlers_.push_front(handler);
   }
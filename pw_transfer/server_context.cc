@@ -16,6 +16,8 @@
 
 #include "pw_transfer/internal/server_context.h"
 
+#include <algorithm>
+
 #include "pw_assert/check.h"
 #include "pw_log/log.h"
 #include "pw_status/try.h"
@@ -132,6 +134,34 @@ Result<ServerContext*> ServerContextPool::StartTransfer(
   return new_transfer;
 }
 
+TransferParameters ServerContextPool::ScheduledParameters(
+    ServerContext& transfer, const TransferParameters& max_parameters) {
+  if (type_ == kRead || !transfer.active()) {
+    return max_parameters;
+  }
+
+  uint32_t total_priority = 0;
+  for (ServerContext& active_transfer : transfers_) {
+    if (active_transfer.active()) {
+      total_priority += active_transfer.priority();
+    }
+  }
+
+  if (total_priority == transfer.priority()) {
+    return max_parameters;  // This is the only active transfer.
+  }
+
+  const uint32_t share = static_cast<uint32_t>(
+      uint64_t{max_parameters.pending_bytes()} * transfer.priority() /
+      total_priority);
+  const uint32_t min_share = std::min(max_parameters.pending_bytes(),
+                                      max_parameters.max_chunk_size_bytes());
+
+  return TransferParameters(std::max(share, min_share),
+                            max_parameters.max_chunk_size_bytes(),
+                            max_parameters.extend_window_divisor());
+}
+
 Result<ServerContext*> ServerContextPool::GetPendingTransfer(
     uint32_t transfer_id) {
   auto transfer =
@@ -80,11 +80,15 @@ void TransferService::HandleChunk(ConstByteSpan message,
     return;
   }
 
-  if (transfer.ReadChunkData(
-          chunk_data_buffer_, client_.max_parameters(), chunk)) {
+  // All transfers stage their data in the same chunk data buffer. This is safe
+  // because each chunk is processed before the next one is read.
+  const internal::TransferParameters parameters =
+      pool.ScheduledParameters(transfer, client_.max_parameters());
+
+  if (transfer.ReadChunkData(chunk_data_buffer_, parameters, chunk)) {
     // Call this synchronously for now. Later, this will be deferred within a
     // work queue.
-    transfer.ProcessChunk(chunk_data_buffer_, client_.max_parameters());
+    transfer.ProcessChunk(chunk_data_buffer_, parameters);
   }
 }
 
@@ -0,0 +1,425 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark comparing write transfer throughput with stop-and-wait and
+// sliding window flow control, with several transfers run one after another or
+// at the same time, and with go-back-N or selective retransmission on a lossy
+// link. A transfer client and service are connected by a simulated serial link
+// with a fixed bandwidth and one-way latency. Time is simulated and packets are
+// dropped pseudo-randomly with a fixed seed, so results are deterministic. This
+// target should only be built for the host.
+//
+// Build the pw_transfer.transfer_benchmark target and run the binary. Each line
+// reports the aggregate throughput of the transfers. Lossy link results also
+// report the number of bytes retransmitted per byte delivered.
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "pw_assert/check.h"
+#include "pw_bytes/array.h"
+#include "pw_rpc/channel.h"
+#include "pw_rpc/client.h"
+#include "pw_rpc/server.h"
+#include "pw_stream/memory_stream.h"
+#include "pw_transfer/client.h"
+#include "pw_transfer/transfer.h"
+
+namespace pw::transfer {
+namespace {
+
+constexpr uint32_t kChannelId = 1;
+constexpr uint32_t kTransferId = 1;
+constexpr size_t kTransferSizeBytes = 32 * 1024;
+constexpr size_t kChunkBufferSizeBytes = 256;
+constexpr size_t kPacketSizeBytes = 2 * kChunkBufferSizeBytes;
+constexpr size_t kConcurrentTransfers = 4;
+
+static_assert(kConcurrentTransfers <= cfg::kMaxConcurrentTransfers);
+
+// A 115200 baud UART with 8N1 framing and a few bytes of overhead per packet.
+constexpr int64_t kLinkBytesPerSecond = 11520;
+constexpr size_t kFramingOverheadBytes = 8;
+
+// RPC control packets and transfer chunks without data are smaller than this,
+// so a lossy link only drops larger packets.
+constexpr size_t kMinDataPacketSizeBytes = 32;
+
+// Link parameters for comparing retransmission schemes.
+constexpr int64_t kLossyLinkLatencyMs = 50;
+constexpr uint32_t kLossyLinkWindowBytes = 4096;
+
+// Transfers should complete long before any chunk times out.
+constexpr auto kChunkTimeout = std::chrono::seconds(10);
+
+constexpr auto kData =
+    bytes::Initialized<kTransferSizeBytes>([](size_t i) { return i * 7; });
+
+// One direction of the simulated link. Packets sent through the channel output
+// are serialized one at a time at the link bandwidth, then arrive after the
+// link latency.
+class Link : public rpc::ChannelOutput {
+ public:
+  Link(const char* name, const int64_t& now_us, int64_t latency_us)
+      : ChannelOutput(name), now_us_(now_us), latency_us_(latency_us) {}
+
+  ByteSpan AcquireBuffer() override { return buffer_; }
+
+  Status SendAndReleaseBuffer(ConstByteSpan packet) override {
+    if (packet.empty()) {
+      return OkStatus();
+    }
+    const size_t size = packet.size() + kFramingOverheadBytes;
+    free_us_ = std::max(now_us_, free_us_) +
+               static_cast<int64_t>(size) * 1000000 / kLinkBytesPerSecond;
+    packets_.push_back({free_us_ + latency_us_,
+                        std::vector<std::byte>(packet.begin(), packet.end())});
+    return OkStatus();
+  }
+
+  bool empty() const { return packets_.empty(); }
+  int64_t next_arrival_us() const { return packets_.front().arrival_us; }
+
+  // Drops data chunks at random with the given probability. Transfers cannot
+  // time out in simulated time, so only chunks followed by another packet in
+  // flight are dropped; the receiver notices the loss when it arrives.
+  void set_loss_rate(double loss_rate) { loss_rate_ = loss_rate; }
+
+  // Returns the next packet, or an empty packet if it was dropped.
+  std::vector<std::byte> Receive() {
+    std::vector<std::byte> packet = std::move(packets_.front().packet);
+    packets_.pop_front();
+    if (!packets_.empty() && packet.size() >= kMinDataPacketSizeBytes &&
+        loss_(random_) < loss_rate_) {
+      return {};
+    }
+    return packet;
+  }
+
+ private:
+  struct InFlightPacket {
+    int64_t arrival_us;
+    std::vector<std::byte> packet;
+  };
+
+  const int64_t& now_us_;
+  const int64_t latency_us_;
+  int64_t free_us_ = 0;
+  std::array<std::byte, kPacketSizeBytes> buffer_;
+  std::deque<InFlightPacket> packets_;
+
+  double loss_rate_ = 0;
+  std::minstd_rand random_;
+  std::uniform_real_distribution<double> loss_;
+};
+
+// Reads from memory and counts every byte read, including bytes read again
+// after seeking back to resend them.
+class CountingReader final : public stream::SeekableReader {
+ public:
+  CountingReader(ConstByteSpan data) : reader_(data) {}
+
+  size_t total_bytes_read() const { return total_bytes_read_; }
+
+ private:
+  Status DoSeek(ssize_t offset, Whence origin) override {
+    return reader_.Seek(offset, origin);
+  }
+
+  StatusWithSize DoRead(ByteSpan dest) override {
+    Result<ByteSpan> result = reader_.Read(dest);
+    if (!result.ok()) {
+      return StatusWithSize(result.status(), 0);
+    }
+    total_bytes_read_ += result->size();
+    return StatusWithSize(result->size());
+  }
+
+  stream::MemoryReader reader_;
+  size_t total_bytes_read_ = 0;
+};
+
+// Writes to memory without supporting seeking, so a receiver has to restart
+// from a lost chunk and cannot keep data received after it.
+class AppendOnlyWriter final : public stream::NonSeekableWriter {
+ public:
+  AppendOnlyWriter(stream::MemoryWriter& writer) : writer_(writer) {}
+
+ private:
+  Status DoWrite(ConstByteSpan data) override { return writer_.Write(data); }
+
+  size_t ConservativeLimit(LimitType type) const override {
+    return type == LimitType::kWrite ? writer_.ConservativeWriteLimit() : 0;
+  }
+
+  stream::MemoryWriter& writer_;
+};
+
+// One of the write transfers in a benchmark run. Each transfer sends a slice
+// of the data to its own receive buffer.
+struct WriteTransfer {
+  WriteTransfer(uint32_t id,
+                ConstByteSpan data,
+                ByteSpan receive_buffer,
+                bool seekable_writer)
+      : data(data),
+        reader(data),
+        writer(receive_buffer),
+        append_only_writer(writer),
+        handler(id,
+                seekable_writer ? static_cast<stream::Writer&>(writer)
+                                : append_only_writer) {}
+
+  ConstByteSpan data;
+  CountingReader reader;
+  stream::MemoryWriter writer;
+  AppendOnlyWriter append_only_writer;
+  WriteOnlyHandler handler;
+  bool started = false;
+  Status status = Status::Unknown();
+};
+
+struct BenchmarkOptions {
+  int64_t latency_us;
+  uint32_t max_pending_bytes;
+  bool sliding_window = false;
+
+  // The transfers run either one after another or all at once.
+  size_t num_transfers = 1;
+  bool concurrent = false;
+
+  // Data chunks sent to the service are dropped with this probability. The
+  // service writes to a seekable writer only if seekable_writer is true.
+  double loss_rate = 0;
+  bool seekable_writer = true;
+};
+
+struct BenchmarkResult {
+  // The simulated time the transfers took, or a negative value if a transfer
+  // failed.
+  int64_t us;
+
+  // The number of data bytes the client sent, including retransmissions.
+  size_t bytes_sent;
+};
+
+// Runs client to service write transfers of kTransferSizeBytes in total, split
+// evenly between the transfers.
+BenchmarkResult RunWriteTransfers(const BenchmarkOptions& options) {
+  int64_t now_us = 0;
+  Link to_service("to_service", now_us, options.latency_us);
+  Link to_client("to_client", now_us, options.latency_us);
+  to_service.set_loss_rate(options.loss_rate);
+
+  work_queue::WorkQueueWithBuffer<1> work_queue;
+
+  rpc::Channel server_channel = rpc::Channel::Create<kChannelId>(&to_client);
+  rpc::Server server(std::span(&server_channel, 1));
+  std::array<std::byte, kChunkBufferSizeBytes> service_buffer;
+  TransferService service(
+      work_queue, service_buffer, options.max_pending_bytes, kChunkTimeout);
+  if (options.sliding_window) {
+    service.EnableSlidingWindow();
+  }
+  server.RegisterService(service);
+
+  rpc::Channel client_channel = rpc::Channel::Create<kChannelId>(&to_service);
+  rpc::Client rpc_client(std::span(&client_channel, 1));
+  std::array<std::byte, kChunkBufferSizeBytes> client_buffer;
+  Client client(rpc_client, kChannelId, work_queue, client_buffer);
+
+  // Each writer needs room beyond its data so the receiver can request the
+  // final chunk.
+  static std::array<std::byte,
+                    kTransferSizeBytes +
+                        cfg::kMaxConcurrentTransfers * kChunkBufferSizeBytes>
+      received;
+  std::memset(received.data(), 0, received.size());
+
+  const size_t slice_size = kTransferSizeBytes / options.num_transfers;
+  std::deque<WriteTransfer> transfers;
+  for (size_t i = 0; i < options.num_transfers; ++i) {
+    WriteTransfer& transfer = transfers.emplace_back(
+        kTransferId + i,
+        std::span(kData).subspan(i * slice_size, slice_size),
+        std::span(received).subspan(i * (slice_size + kChunkBufferSizeBytes),
+                                    slice_size + kChunkBufferSizeBytes),
+        options.seekable_writer);
+    service.RegisterHandler(transfer.handler);
+  }
+
+  auto start = [&client](WriteTransfer& transfer) {
+    transfer.started = true;
+    return client.Write(
+        transfer.handler.id(),
+        transfer.reader,
+        [&transfer](Status result) { transfer.status = result; },
+        kChunkTimeout);
+  };
+
+  // Starts transfers which are ready to run. Returns false if all transfers are
+  // done.
+  auto start_transfers = [&]() {
+    for (WriteTransfer& transfer : transfers) {
+      if (!transfer.started) {
+        PW_CHECK_OK(start(transfer));
+        if (!options.concurrent) {
+          return true;
+        }
+      } else if (transfer.status.IsUnknown()) {
+        if (!options.concurrent) {
+          return true;  // Wait for this transfer to finish.
+        }
+      }
+    }
+    return std::any_of(transfers.begin(), transfers.end(), [](auto& t) {
+      return t.status.IsUnknown();
+    });
+  };
+
+  while (start_transfers()) {
+    if (to_service.empty() && to_client.empty()) {
+      return {-1, 0};  // Stalled; nothing is in flight.
+    }
+
+    const bool deliver_to_service =
+        to_client.empty() ||
+        (!to_service.empty() &&
+         to_service.next_arrival_us() <= to_client.next_arrival_us());
+
+    if (deliver_to_service) {
+      now_us = to_service.next_arrival_us();
+      if (std::vector<std::byte> packet = to_service.Receive();
+          !packet.empty()) {
+        PW_CHECK_OK(server.ProcessPacket(packet, to_client));
+      }
+    } else {
+      now_us = to_client.next_arrival_us();
+      PW_CHECK_OK(rpc_client.ProcessPacket(to_client.Receive()));
+    }
+  }
+
+  bool ok = true;
+  size_t bytes_sent = 0;
+  for (WriteTransfer& transfer : transfers) {
+    service.UnregisterHandler(transfer.handler);
+    bytes_sent += transfer.reader.total_bytes_read();
+    ok = ok && transfer.status.ok() &&
+         transfer.writer.bytes_written() == transfer.data.size() &&
+         std::memcmp(transfer.writer.data(),
+                     transfer.data.data(),
+                     transfer.data.size()) == 0;
+  }
+  return {ok ? now_us : -1, bytes_sent};
+}
+
+void PrintThroughput(int64_t us) {
+  if (us < 0) {
+    std::printf("  %14s", "failed");
+  } else {
+    std::printf("  %10" PRId64 " B/s",
+                int64_t(kTransferSizeBytes) * 1000000 / us);
+  }
+}
+
+void RunWriteBenchmark(int64_t latency_ms, uint32_t max_pending_bytes) {
+  std::printf("%4" PRId64 " ms  %5u B", latency_ms, max_pending_bytes);
+  for (bool sliding_window : {false, true}) {
+    PrintThroughput(RunWriteTransfers({.latency_us = latency_ms * 1000,
+                                       .max_pending_bytes = max_pending_bytes,
+                                       .sliding_window = sliding_window})
+                        .us);
+  }
+  std::printf("\n");
+}
+
+void RunConcurrentWriteBenchmark(int64_t latency_ms,
+                                 uint32_t max_pending_bytes) {
+  std::printf("%4" PRId64 " ms  %5u B", latency_ms, max_pending_bytes);
+  for (bool concurrent : {false, true}) {
+    PrintThroughput(RunWriteTransfers({.latency_us = latency_ms * 1000,
+                                       .max_pending_bytes = max_pending_bytes,
+                                       .num_transfers = kConcurrentTransfers,
+                                       .concurrent = concurrent})
+                        .us);
+  }
+  std::printf("\n");
+}
+
+void RunLossyWriteBenchmark(double loss_rate) {
+  std::printf("%5.1f %%", loss_rate * 100);
+  for (bool seekable_writer : {false, true}) {
+    const BenchmarkResult result =
+        RunWriteTransfers({.latency_us = kLossyLinkLatencyMs * 1000,
+                           .max_pending_bytes = kLossyLinkWindowBytes,
+                           .sliding_window = true,
+                           .loss_rate = loss_rate,
+                           .seekable_writer = seekable_writer});
+    PrintThroughput(result.us);
+    if (result.us < 0) {
+      std::printf(" %9s", "");
+    } else {
+      std::printf(" %9.3f",
+                  double(result.bytes_sent - kTransferSizeBytes) /
+                      kTransferSizeBytes);
+    }
+  }
+  std::printf("\n");
+}
+
+int Main() {
+  std::printf("%u B write transfers over a %" PRId64 " B/s link\n",
+              static_cast<unsigned>(kTransferSizeBytes),
+              kLinkBytesPerSecond);
+  std::printf("latency   window   stop-and-wait  sliding window\n");
+  for (int64_t latency_ms : {0, 10, 50, 200}) {
+    for (uint32_t max_pending_bytes : {1024u, 4096u}) {
+      RunWriteBenchmark(latency_ms, max_pending_bytes);
+    }
+  }
+
+  std::printf("\n%u x %u B stop-and-wait write transfers\n",
+              static_cast<unsigned>(kConcurrentTransfers),
+              static_cast<unsigned>(kTransferSizeBytes / kConcurrentTransfers));
+  std::printf("latency   window      sequential      concurrent\n");
+  for (int64_t latency_ms : {0, 10, 50, 200}) {
+    for (uint32_t max_pending_bytes : {1024u, 4096u}) {
+      RunConcurrentWriteBenchmark(latency_ms, max_pending_bytes);
+    }
+  }
+
+  std::printf("\n%u B sliding window write transfers over a lossy link with "
+              "%" PRId64 " ms latency and a %u B window\n",
+              static_cast<unsigned>(kTransferSizeBytes),
+              kLossyLinkLatencyMs,
+              static_cast<unsigned>(kLossyLinkWindowBytes));
+  std::printf("   loss       go-back-N  resent/B       selective  resent/B\n");
+  for (double loss_rate : {0.0, 0.01, 0.02, 0.05}) {
+    RunLossyWriteBenchmark(loss_rate);
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::transfer
+
+int main() { return pw::transfer::Main(); }
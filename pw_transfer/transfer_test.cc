@@ -213,6 +213,85 @@ TEST_F(ReadTransfer, OutOfOrder_SeekingNotSupported_EndsWithUnimplemented) {
   EXPECT_EQ(chunk.status, Status::Unimplemented());
 }
 
+TEST_F(ReadTransfer, WindowExtension_ContinuesFromCurrentOffset) {
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = 3,
+                                     .pending_bytes = 16,
+                                     .max_chunk_size_bytes = 8,
+                                     .offset = 0}));
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+
+  // The receiver has only seen the first chunk. Extending the window must not
+  // rewind the transmitter to resend the second.
+  ctx_.SendClientStream(
+      EncodeChunk({.transfer_id = 3,
+                   .pending_bytes = 16,
+                   .max_chunk_size_bytes = 8,
+                   .offset = 8,
+                   .type = Chunk::Type::kParametersContinue}));
+  ASSERT_EQ(ctx_.total_responses(), 3u);
+  Chunk chunk = DecodeChunk(ctx_.responses()[2]);
+  EXPECT_EQ(chunk.offset, 16u);
+  ASSERT_EQ(chunk.data.size(), 8u);
+  EXPECT_EQ(std::memcmp(chunk.data.data(), kData.data() + 16, 8), 0);
+
+  ctx_.SendClientStream(
+      EncodeChunk({.transfer_id = 3,
+                   .pending_bytes = 16,
+                   .max_chunk_size_bytes = 8,
+                   .offset = 16,
+                   .type = Chunk::Type::kParametersContinue}));
+  ASSERT_EQ(ctx_.total_responses(), 4u);
+  chunk = DecodeChunk(ctx_.responses()[3]);
+  EXPECT_EQ(chunk.offset, 24u);
+  ASSERT_EQ(chunk.data.size(), 8u);
+  EXPECT_EQ(std::memcmp(chunk.data.data(), kData.data() + 24, 8), 0);
+
+  ctx_.SendClientStream(
+      EncodeChunk({.transfer_id = 3,
+                   .pending_bytes = 16,
+                   .max_chunk_size_bytes = 8,
+                   .offset = 24,
+                   .type = Chunk::Type::kParametersContinue}));
+  ASSERT_EQ(ctx_.total_responses(), 5u);
+  chunk = DecodeChunk(ctx_.responses()[4]);
+  EXPECT_EQ(chunk.data.size(), 0u);
+  ASSERT_TRUE(chunk.remaining_bytes.has_value());
+  EXPECT_EQ(chunk.remaining_bytes.value(), 0u);
+
+  // Further window extensions do not resend the final chunk.
+  ctx_.SendClientStream(
+      EncodeChunk({.transfer_id = 3,
+                   .pending_bytes = 16,
+                   .max_chunk_size_bytes = 8,
+                   .offset = 32,
+                   .type = Chunk::Type::kParametersContinue}));
+  EXPECT_EQ(ctx_.total_responses(), 5u);
+
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = 3, .status = OkStatus()}));
+  EXPECT_TRUE(handler_.finalize_read_called);
+  EXPECT_EQ(handler_.finalize_read_status, OkStatus());
+}
+
+TEST_F(ReadTransfer, WindowExtension_AheadOfTransmitter_Seeks) {
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = 3,
+                                     .pending_bytes = 8,
+                                     .max_chunk_size_bytes = 8,
+                                     .offset = 0}));
+  ASSERT_EQ(ctx_.total_responses(), 1u);
+
+  ctx_.SendClientStream(
+      EncodeChunk({.transfer_id = 3,
+                   .pending_bytes = 8,
+                   .max_chunk_size_bytes = 8,
+                   .offset = 16,
+                   .type = Chunk::Type::kParametersContinue}));
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  Chunk chunk = DecodeChunk(ctx_.responses()[1]);
+  EXPECT_EQ(chunk.offset, 16u);
+  ASSERT_EQ(chunk.data.size(), 8u);
+  EXPECT_EQ(std::memcmp(chunk.data.data(), kData.data() + 16, 8), 0);
+}
+
 TEST_F(ReadTransfer, MaxChunkSize_Client) {
   ctx_.SendClientStream(EncodeChunk({.transfer_id = 3,
                                      .pending_bytes = 64,
@@ -443,6 +522,32 @@ TEST_F(ReadTransfer, SendsErrorIfChunkIsReceivedInCompletedState) {
   EXPECT_FALSE(handler_.finalize_read_called);
 }
 
+class TestMemoryWriter : public stream::SeekableWriter {
+ public:
+  constexpr TestMemoryWriter(ByteSpan dest) : memory_writer_(dest) {}
+
+  Status DoSeek(ssize_t offset, Whence origin) override {
+    if (seek_status.ok()) {
+      return memory_writer_.Seek(offset, origin);
+    }
+    return seek_status;
+  }
+
+  Status DoWrite(ConstByteSpan data) final {
+    return memory_writer_.Write(data);
+  }
+
+  size_t ConservativeLimit(LimitType type) const final {
+    return type == LimitType::kWrite ? memory_writer_.ConservativeWriteLimit()
+                                     : 0;
+  }
+
+  Status seek_status;
+
+ private:
+  stream::MemoryWriter memory_writer_;
+};
+
 class SimpleWriteTransfer final : public WriteOnlyHandler {
  public:
   SimpleWriteTransfer(uint32_t transfer_id, ByteSpan data)
@@ -469,13 +574,15 @@ class SimpleWriteTransfer final : public WriteOnlyHandler {
     finalize_write_return_status_ = status;
   }
 
+  void set_seek_status(Status status) { writer_.seek_status = status; }
+
   bool prepare_write_called;
   bool finalize_write_called;
   Status finalize_write_status;
 
  private:
   Status finalize_write_return_status_;
-  stream::MemoryWriter writer_;
+  TestMemoryWriter writer_;
 };
 
 class WriteTransfer : public ::testing::Test {
@@ -832,6 +939,115 @@ TEST_F(WriteTransfer, ResendParametersIfSentRepeatedChunkDuringRecovery) {
   EXPECT_EQ(handler_.finalize_write_status, OkStatus());
 }
 
+TEST_F(WriteTransfer, OutOfOrder_RequestsOnlyMissingData) {
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = 7}));
+  ASSERT_EQ(ctx_.total_responses(), 1u);
+
+  constexpr std::span data(kData);
+  ctx_.SendClientStream<64>(
+      EncodeChunk({.transfer_id = 7, .offset = 0, .data = data.first(8)}));
+
+  // Drop offset 8. The data after it is kept, and only the gap is requested.
+  ctx_.SendClientStream<64>(EncodeChunk(
+      {.transfer_id = 7, .offset = 16, .data = data.subspan(16, 8)}));
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  Chunk chunk = DecodeChunk(ctx_.responses().back());
+  EXPECT_EQ(chunk.offset, 8u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 8u);
+
+  // Chunks still in flight continue the received data.
+  ctx_.SendClientStream<64>(EncodeChunk({.transfer_id = 7,
+                                         .offset = 24,
+                                         .data = data.subspan(24),
+                                         .remaining_bytes = 0}));
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  EXPECT_FALSE(handler_.finalize_write_called);
+
+  // Filling the gap completes the transfer.
+  ctx_.SendClientStream<64>(EncodeChunk(
+      {.transfer_id = 7, .offset = 8, .data = data.subspan(8, 8)}));
+  ASSERT_EQ(ctx_.total_responses(), 3u);
+  chunk = DecodeChunk(ctx_.responses().back());
+  ASSERT_TRUE(chunk.status.has_value());
+  EXPECT_EQ(chunk.status.value(), OkStatus());
+
+  EXPECT_TRUE(handler_.finalize_write_called);
+  EXPECT_EQ(handler_.finalize_write_status, OkStatus());
+  EXPECT_EQ(std::memcmp(buffer.data(), kData.data(), kData.size()), 0);
+}
+
+TEST_F(WriteTransfer, OutOfOrder_RequestsEachGapInTurn) {
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = 7}));
+  ASSERT_EQ(ctx_.total_responses(), 1u);
+
+  // Drop offsets 4, 12 and 20.
+  constexpr std::span data(kData);
+  for (uint32_t offset : {0u, 8u, 16u, 24u}) {
+    ctx_.SendClientStream<64>(
+        EncodeChunk({.transfer_id = 7,
+                     .offset = offset,
+                     .data = data.subspan(offset, offset == 24u ? 8 : 4),
+                     .remaining_bytes = offset == 24u
+                                            ? std::optional<uint64_t>(0)
+                                            : std::nullopt}));
+  }
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  Chunk chunk = DecodeChunk(ctx_.responses().back());
+  EXPECT_EQ(chunk.offset, 4u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 4u);
+
+  ctx_.SendClientStream<64>(EncodeChunk(
+      {.transfer_id = 7, .offset = 4, .data = data.subspan(4, 4)}));
+  ASSERT_EQ(ctx_.total_responses(), 3u);
+  chunk = DecodeChunk(ctx_.responses().back());
+  EXPECT_EQ(chunk.offset, 12u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 4u);
+
+  ctx_.SendClientStream<64>(EncodeChunk(
+      {.transfer_id = 7, .offset = 12, .data = data.subspan(12, 4)}));
+  ASSERT_EQ(ctx_.total_responses(), 4u);
+  chunk = DecodeChunk(ctx_.responses().back());
+  EXPECT_EQ(chunk.offset, 20u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 4u);
+
+  ctx_.SendClientStream<64>(EncodeChunk(
+      {.transfer_id = 7, .offset = 20, .data = data.subspan(20, 4)}));
+  ASSERT_EQ(ctx_.total_responses(), 5u);
+  chunk = DecodeChunk(ctx_.responses().back());
+  ASSERT_TRUE(chunk.status.has_value());
+  EXPECT_EQ(chunk.status.value(), OkStatus());
+  EXPECT_EQ(std::memcmp(buffer.data(), kData.data(), kData.size()), 0);
+}
+
+TEST_F(WriteTransfer, OutOfOrder_SeekingNotSupported_ResendsAllData) {
+  handler_.set_seek_status(Status::Unimplemented());
+
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = 7}));
+  ASSERT_EQ(ctx_.total_responses(), 1u);
+
+  constexpr std::span data(kData);
+  ctx_.SendClientStream<64>(
+      EncodeChunk({.transfer_id = 7, .offset = 0, .data = data.first(8)}));
+  ctx_.SendClientStream<64>(EncodeChunk(
+      {.transfer_id = 7, .offset = 16, .data = data.subspan(16, 8)}));
+
+  // Data past the gap cannot be kept, so everything after it is requested.
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  Chunk chunk = DecodeChunk(ctx_.responses().back());
+  EXPECT_EQ(chunk.offset, 8u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 24u);
+
+  ctx_.SendClientStream<64>(EncodeChunk({.transfer_id = 7,
+                                         .offset = 8,
+                                         .data = data.subspan(8),
+                                         .remaining_bytes = 0}));
+  ASSERT_EQ(ctx_.total_responses(), 3u);
+  chunk = DecodeChunk(ctx_.responses().back());
+  ASSERT_TRUE(chunk.status.has_value());
+  EXPECT_EQ(chunk.status.value(), OkStatus());
+  EXPECT_EQ(std::memcmp(buffer.data(), kData.data(), kData.size()), 0);
+}
+
 TEST_F(WriteTransfer, ResendsStatusIfClientRetriesAfterStatusChunk) {
   ctx_.SendClientStream(EncodeChunk({.transfer_id = 7}));
 
@@ -929,6 +1145,316 @@ TEST_F(WriteTransfer, AbortAndRestartIfInitialPacketIsReceived) {
   EXPECT_EQ(std::memcmp(buffer.data(), kData.data(), kData.size()), 0);
 }
 
+constexpr auto kData128 = bytes::Initialized<128>([](size_t i) { return i; });
+
+class WriteTransferSlidingWindow : public WriteTransfer {
+ protected:
+  WriteTransferSlidingWindow()
+      : WriteTransfer(/*max_bytes_to_receive=*/64),
+        large_buffer_{},
+        large_handler_(8, large_buffer_) {
+    ctx_.service().EnableSlidingWindow(/*extend_window_divisor=*/2);
+    ctx_.service().RegisterHandler(large_handler_);
+  }
+
+  Chunk LastResponse() { return DecodeChunk(ctx_.responses().back()); }
+
+  std::array<std::byte, kData128.size()> large_buffer_;
+  SimpleWriteTransfer large_handler_;
+};
+
+TEST_F(WriteTransferSlidingWindow, ExtendsWindowBeforeItDrains) {
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = 8}));
+
+  ASSERT_EQ(ctx_.total_responses(), 1u);
+  Chunk chunk = LastResponse();
+  EXPECT_EQ(chunk.offset, 0u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 64u);
+  EXPECT_EQ(chunk.type, Chunk::Type::kParametersRetransmit);
+
+  ctx_.SendClientStream<64>(EncodeChunk(
+      {.transfer_id = 8, .offset = 0, .data = std::span(kData128).first(16)}));
+  EXPECT_EQ(ctx_.total_responses(), 1u);
+
+  // Once half of the window remains, it is extended to a full window again.
+  ctx_.SendClientStream<64>(
+      EncodeChunk({.transfer_id = 8,
+                   .offset = 16,
+                   .data = std::span(kData128).subspan(16, 16)}));
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  chunk = LastResponse();
+  EXPECT_EQ(chunk.offset, 32u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 64u);
+  EXPECT_EQ(chunk.type, Chunk::Type::kParametersContinue);
+
+  for (uint32_t offset = 32; offset < 112; offset += 16) {
+    ctx_.SendClientStream<64>(
+        EncodeChunk({.transfer_id = 8,
+                     .offset = offset,
+                     .data = std::span(kData128).subspan(offset, 16)}));
+  }
+  ctx_.SendClientStream<64>(
+      EncodeChunk({.transfer_id = 8,
+                   .offset = 112,
+                   .data = std::span(kData128).subspan(112),
+                   .remaining_bytes = 0}));
+
+  chunk = LastResponse();
+  ASSERT_TRUE(chunk.status.has_value());
+  EXPECT_EQ(chunk.status.value(), OkStatus());
+
+  EXPECT_TRUE(large_handler_.finalize_write_called);
+  EXPECT_EQ(large_handler_.finalize_write_status, OkStatus());
+  EXPECT_EQ(std::memcmp(large_buffer_.data(), kData128.data(), kData128.size()),
+            0);
+}
+
+TEST_F(WriteTransferSlidingWindow, ShrinksWindowOnLossAndRegrows) {
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = 8}));
+  ASSERT_EQ(ctx_.total_responses(), 1u);
+  Chunk chunk = LastResponse();
+  EXPECT_EQ(chunk.pending_bytes.value(), 64u);
+  const uint32_t chunk_size = chunk.max_chunk_size_bytes.value();
+  ASSERT_GT(chunk_size, 32u);
+
+  ctx_.SendClientStream<64>(EncodeChunk(
+      {.transfer_id = 8, .offset = 0, .data = std::span(kData128).first(16)}));
+
+  // Drop the chunk at offset 16. Only the missing chunk is requested.
+  ctx_.SendClientStream<64>(
+      EncodeChunk({.transfer_id = 8,
+                   .offset = 32,
+                   .data = std::span(kData128).subspan(32, 16)}));
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  chunk = LastResponse();
+  EXPECT_EQ(chunk.offset, 16u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 16u);
+  EXPECT_EQ(chunk.type, Chunk::Type::kParametersRetransmit);
+
+  // Once the gap is filled, the transfer continues after the received data. The
+  // window is halved, down to one chunk.
+  ctx_.SendClientStream<64>(
+      EncodeChunk({.transfer_id = 8,
+                   .offset = 16,
+                   .data = std::span(kData128).subspan(16, 16)}));
+  ASSERT_EQ(ctx_.total_responses(), 3u);
+  chunk = LastResponse();
+  EXPECT_EQ(chunk.offset, 48u);
+  EXPECT_EQ(chunk.pending_bytes.value(), chunk_size);
+  EXPECT_EQ(chunk.type, Chunk::Type::kParametersRetransmit);
+
+  for (uint32_t offset = 48; offset < 80; offset += 16) {
+    ctx_.SendClientStream<64>(
+        EncodeChunk({.transfer_id = 8,
+                     .offset = offset,
+                     .data = std::span(kData128).subspan(offset, 16)}));
+  }
+  ASSERT_EQ(ctx_.total_responses(), 4u);
+  chunk = LastResponse();
+  EXPECT_EQ(chunk.offset, 80u);
+  EXPECT_EQ(chunk.pending_bytes.value(), chunk_size);
+  EXPECT_EQ(chunk.type, Chunk::Type::kParametersContinue);
+
+  // After a full window is received without loss, the window grows again, up
+  // to the space left in the writer.
+  ctx_.SendClientStream<64>(
+      EncodeChunk({.transfer_id = 8,
+                   .offset = 80,
+                   .data = std::span(kData128).subspan(80, 16)}));
+  ASSERT_EQ(ctx_.total_responses(), 5u);
+  chunk = LastResponse();
+  EXPECT_EQ(chunk.offset, 96u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 32u);
+  EXPECT_EQ(chunk.type, Chunk::Type::kParametersContinue);
+}
+
+class ConcurrentWriteTransfers : public ::testing::Test {
+ protected:
+  static constexpr uint32_t kFirstId = 20;
+  static constexpr size_t kTransfers = 4;
+  static_assert(kTransfers <= cfg::kMaxConcurrentTransfers);
+
+  ConcurrentWriteTransfers()
+      : buffers_{},
+        handlers_{{{kFirstId, buffers_[0]},
+                   {kFirstId + 1, buffers_[1]},
+                   {kFirstId + 2, buffers_[2]},
+                   {kFirstId + 3, buffers_[3]}}},
+        ctx_(work_queue_, data_buffer_, /*max_pending_bytes=*/256) {
+    for (SimpleWriteTransfer& handler : handlers_) {
+      ctx_.service().RegisterHandler(handler);
+    }
+    ctx_.call();  // Open the write stream
+  }
+
+  Chunk LastResponse() { return DecodeChunk(ctx_.responses().back()); }
+
+  std::array<std::array<std::byte, kData128.size()>, kTransfers> buffers_;
+  std::array<SimpleWriteTransfer, kTransfers> handlers_;
+
+  PW_RAW_TEST_METHOD_CONTEXT(TransferService, Write, 24) ctx_;
+  std::array<std::byte, 64> data_buffer_;
+
+  // Not currently used in the tests, so left uninitialized.
+  work_queue::WorkQueueWithBuffer<1> work_queue_;
+};
+
+TEST_F(ConcurrentWriteTransfers, WindowSharedBetweenTransfers) {
+  // The first transfer gets the whole window, limited by its writer. Later
+  // transfers get an even share of the window, but no less than one chunk.
+  constexpr uint32_t kExpectedWindows[kTransfers] = {128, 128, 85, 64};
+
+  for (uint32_t i = 0; i < kTransfers; ++i) {
+    ctx_.SendClientStream(EncodeChunk({.transfer_id = kFirstId + i}));
+    ASSERT_EQ(ctx_.total_responses(), i + 1);
+    Chunk chunk = LastResponse();
+    EXPECT_EQ(chunk.transfer_id, kFirstId + i);
+    EXPECT_EQ(chunk.pending_bytes.value(), kExpectedWindows[i]);
+  }
+}
+
+TEST_F(ConcurrentWriteTransfers, WindowSharedByPriority) {
+  handlers_[0].set_priority(3);
+
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = kFirstId + 1}));
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = kFirstId}));
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  Chunk chunk = LastResponse();
+  EXPECT_EQ(chunk.transfer_id, kFirstId);
+  EXPECT_EQ(chunk.pending_bytes.value(), 128u);  // 3/4 of 256, up to 128.
+
+  // Drop a chunk so that the lower priority transfer asks for the missing data,
+  // then for a new window. It now shares the window.
+  ctx_.SendClientStream<64>(
+      EncodeChunk({.transfer_id = kFirstId + 1,
+                   .offset = 16,
+                   .data = std::span(kData128).subspan(16, 16)}));
+  ASSERT_EQ(ctx_.total_responses(), 3u);
+  chunk = LastResponse();
+  EXPECT_EQ(chunk.transfer_id, kFirstId + 1);
+  EXPECT_EQ(chunk.offset, 0u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 16u);
+
+  ctx_.SendClientStream<64>(
+      EncodeChunk({.transfer_id = kFirstId + 1,
+                   .offset = 0,
+                   .data = std::span(kData128).first(16)}));
+  ASSERT_EQ(ctx_.total_responses(), 4u);
+  chunk = LastResponse();
+  EXPECT_EQ(chunk.transfer_id, kFirstId + 1);
+  EXPECT_EQ(chunk.offset, 32u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 64u);  // 1/4 of 256.
+}
+
+TEST_F(ConcurrentWriteTransfers, WindowRestoredWhenOtherTransfersFinish) {
+  constexpr uint32_t kLargeId = kFirstId + kTransfers;
+  std::array<std::byte, 512> large_buffer = {};
+  SimpleWriteTransfer large_handler(kLargeId, large_buffer);
+  ctx_.service().RegisterHandler(large_handler);
+  handlers_[0].set_priority(3);
+
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = kFirstId}));
+  ctx_.SendClientStream(EncodeChunk({.transfer_id = kLargeId}));
+  ASSERT_EQ(ctx_.total_responses(), 2u);
+  Chunk chunk = LastResponse();
+  EXPECT_EQ(chunk.transfer_id, kLargeId);
+  EXPECT_EQ(chunk.pending_bytes.value(), 64u);  // 1/4 of 256.
+
+  // Finish the higher priority transfer.
+  for (uint32_t offset = 0; offset < kData128.size(); offset += 16) {
+    Chunk data = {.transfer_id = kFirstId,
+                  .offset = offset,
+                  .data = std::span(kData128).subspan(offset, 16)};
+    if (offset + 16 == kData128.size()) {
+      data.remaining_bytes = 0;
+    }
+    ctx_.SendClientStream<64>(EncodeChunk(data));
+  }
+  ASSERT_EQ(ctx_.total_responses(), 3u);
+  chunk = LastResponse();
+  EXPECT_EQ(chunk.transfer_id, kFirstId);
+  ASSERT_TRUE(chunk.status.has_value());
+  EXPECT_EQ(chunk.status.value(), OkStatus());
+
+  // Once its window is received, the remaining transfer asks for the whole
+  // window again.
+  for (uint32_t offset = 0; offset < 64; offset += 16) {
+    ctx_.SendClientStream<64>(
+        EncodeChunk({.transfer_id = kLargeId,
+                     .offset = offset,
+                     .data = std::span(kData128).subspan(offset, 16)}));
+  }
+  ASSERT_EQ(ctx_.total_responses(), 4u);
+  chunk = LastResponse();
+  EXPECT_EQ(chunk.transfer_id, kLargeId);
+  EXPECT_EQ(chunk.offset, 64u);
+  EXPECT_EQ(chunk.pending_bytes.value(), 256u);
+}
+
+TEST_F(ConcurrentWriteTransfers, InterleavedTransfersComplete) {
+  struct Progress {
+    uint32_t offset;
+    uint32_t window_end;
+    bool done;
+  };
+  std::array<Progress, kTransfers> progress{};
+  size_t responses_read = 0;
+
+  auto read_responses = [&]() {
+    for (; responses_read < ctx_.total_responses(); ++responses_read) {
+      Chunk chunk = DecodeChunk(ctx_.responses()[responses_read]);
+      Progress& transfer = progress[chunk.transfer_id - kFirstId];
+      if (chunk.status.has_value()) {
+        EXPECT_EQ(chunk.status.value(), OkStatus());
+        transfer.done = true;
+      } else {
+        transfer.window_end = chunk.offset + chunk.pending_bytes.value();
+      }
+    }
+  };
+
+  for (uint32_t i = 0; i < kTransfers; ++i) {
+    ctx_.SendClientStream(EncodeChunk({.transfer_id = kFirstId + i}));
+  }
+  read_responses();
+
+  // Send one chunk from each transfer in turn, as a client would when running
+  // the transfers at the same time.
+  bool sent = true;
+  while (sent) {
+    sent = false;
+    for (uint32_t i = 0; i < kTransfers; ++i) {
+      Progress& transfer = progress[i];
+      if (transfer.done || transfer.offset >= transfer.window_end) {
+        continue;
+      }
+
+      const uint32_t size = std::min<uint32_t>(
+          16, std::min<uint32_t>(transfer.window_end, kData128.size()) -
+                  transfer.offset);
+      Chunk chunk = {
+          .transfer_id = kFirstId + i,
+          .offset = transfer.offset,
+          .data = std::span(kData128).subspan(transfer.offset, size)};
+      if (transfer.offset + size == kData128.size()) {
+        chunk.remaining_bytes = 0;
+      }
+      ctx_.SendClientStream<64>(EncodeChunk(chunk));
+      transfer.offset += size;
+      sent = true;
+      read_responses();
+    }
+  }
+
+  for (size_t i = 0; i < kTransfers; ++i) {
+    EXPECT_TRUE(progress[i].done);
+    EXPECT_TRUE(handlers_[i].finalize_write_called);
+    EXPECT_EQ(handlers_[i].finalize_write_status, OkStatus());
+    EXPECT_EQ(
+        std::memcmp(buffers_[i].data(), kData128.data(), kData128.size()), 0);
+  }
+}
+
 class SometimesUnavailableReadHandler final : public ReadOnlyHandler {
  public:
   SometimesUnavailableReadHandler(uint32_t transfer_id, ConstByteSpan data)
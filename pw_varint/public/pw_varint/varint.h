@@ -70,6 +70,8 @@ size_t pw_varint_ZigZagEncodedSize(int64_t integer);
 
 }  // extern "C"
 
+#include <cstddef>
+#include <limits>
 #include <span>
 #include <type_traits>
 
@@ -188,6 +190,47 @@ inline size_t Decode(std::span<const std::byte> input,
       input.data(), input.size(), value, static_cast<pw_varint_Format>(format));
 }
 
+// Encodes values as consecutive varints, as in a protobuf packed repeated
+// field. Signed integers are ZigZag encoded. Encoding stops when all values
+// are encoded or the next value does not fit in the output.
+//
+// Returns the number of bytes written and sets values_encoded to the number of
+// values encoded. Bytes in the output after the written varints may be
+// overwritten.
+size_t EncodeArray(std::span<const uint32_t> values,
+                   std::span<std::byte> output,
+                   size_t* values_encoded);
+size_t EncodeArray(std::span<const uint64_t> values,
+                   std::span<std::byte> output,
+                   size_t* values_encoded);
+size_t EncodeArray(std::span<const int32_t> values,
+                   std::span<std::byte> output,
+                   size_t* values_encoded);
+size_t EncodeArray(std::span<const int64_t> values,
+                   std::span<std::byte> output,
+                   size_t* values_encoded);
+
+// Decodes consecutive varints, as in a protobuf packed repeated field. Signed
+// integers are ZigZag decoded. Decoding stops when the output is full, the
+// input is exhausted, or at a varint that is truncated, longer than 10 bytes,
+// or too large for the output type.
+//
+// Returns the number of bytes read and sets values_decoded to the number of
+// values decoded. All varints in the input were decoded if the number of bytes
+// read equals the input size.
+size_t DecodeArray(std::span<const std::byte> input,
+                   std::span<uint32_t> values,
+                   size_t* values_decoded);
+size_t DecodeArray(std::span<const std::byte> input,
+                   std::span<uint64_t> values,
+                   size_t* values_decoded);
+size_t DecodeArray(std::span<const std::byte> input,
+                   std::span<int32_t> values,
+                   size_t* values_decoded);
+size_t DecodeArray(std::span<const std::byte> input,
+                   std::span<int64_t> values,
+                   size_t* values_decoded);
+
 // Returns a size of an integer when encoded as a varint.
 constexpr size_t EncodedSize(uint64_t integer) {
   return integer == 0 ? 1 : (64 - __builtin_clzll(integer) + 6) / 7;
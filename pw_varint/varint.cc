@@ -15,6 +15,12 @@
 #include "pw_varint/varint.h"
 
 #include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif  // defined(__BMI2__)
 
 namespace pw {
 namespace varint {
@@ -28,8 +34,246 @@ inline bool LeastSignificant(pw_varint_Format format) {
   return (static_cast<unsigned>(format) & 0b01) == 0;
 }
 
+// The array functions process varints of up to 8 bytes in a 64-bit word
+// instead of byte by byte. Longer varints and the last bytes of the input or
+// output use pw_varint_Encode and pw_varint_Decode.
+constexpr uint64_t kContinuationBits = 0x8080808080808080u;
+constexpr uint64_t kPayloadBits = 0x7f7f7f7f7f7f7f7fu;
+constexpr uint64_t kMaxWordValue = (uint64_t(1) << 56) - 1;
+
+inline uint64_t LoadWord(const std::byte* bytes) {
+  uint64_t word;
+  std::memcpy(&word, bytes, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif  // __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  return word;
+}
+
+inline void StoreWord(uint64_t word, std::byte* bytes) {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif  // __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  std::memcpy(bytes, &word, sizeof(word));
+}
+
+// Gathers the low 7 bits of each byte into the low 56 bits.
+inline uint64_t CompactPayload(uint64_t word) {
+#if defined(__BMI2__)
+  return _pext_u64(word, kPayloadBits);
+#else
+  word &= kPayloadBits;
+  word = (word & 0x007f007f007f007fu) | ((word & 0x7f007f007f007f00u) >> 1);
+  word = (word & 0x00003fff00003fffu) | ((word & 0x3fff00003fff0000u) >> 2);
+  return (word & 0x000000000fffffffu) | ((word & 0x0fffffff00000000u) >> 4);
+#endif  // defined(__BMI2__)
+}
+
+// Spreads the low 56 bits into the low 7 bits of each byte.
+inline uint64_t SpreadPayload(uint64_t value) {
+#if defined(__BMI2__)
+  return _pdep_u64(value, kPayloadBits);
+#else
+  value = (value & 0x000000000fffffffu) | ((value & 0x00fffffff0000000u) << 4);
+  value = (value & 0x00003fff00003fffu) | ((value & 0x0fffc0000fffc000u) << 2);
+  return (value & 0x007f007f007f007fu) | ((value & 0x3f803f803f803f80u) << 1);
+#endif  // defined(__BMI2__)
+}
+
+// Encodes a value of at most kMaxWordValue to 8 writable bytes. Returns the
+// size of the varint; the remaining bytes are overwritten with zeros.
+inline size_t EncodeWord(uint64_t value, std::byte* output) {
+  const uint64_t payload = SpreadPayload(value);
+  const int leading_zeros = __builtin_clzll(payload | 1u);
+
+  // Set the continuation bit in each byte below the most significant nonzero
+  // byte.
+  const uint64_t below_last = (~uint64_t(0) >> leading_zeros) >> 8;
+  const uint64_t continuation_bits = (below_last & 0x0101010101010101u) << 7;
+
+  StoreWord(payload | continuation_bits, output);
+  return static_cast<size_t>(71 - leading_zeros) / 8;
+}
+
+// Conversions between array elements and varint values. FromVarint() returns
+// false if the value is out of range for the element type.
+inline uint64_t ToVarint(uint32_t value) { return value; }
+inline uint64_t ToVarint(uint64_t value) { return value; }
+inline uint64_t ToVarint(int32_t value) { return ZigZagEncode(value); }
+inline uint64_t ToVarint(int64_t value) { return ZigZagEncode(value); }
+
+inline bool FromVarint(uint64_t value, uint32_t* element) {
+  *element = static_cast<uint32_t>(value);
+  return value <= std::numeric_limits<uint32_t>::max();
+}
+
+inline bool FromVarint(uint64_t value, uint64_t* element) {
+  *element = value;
+  return true;
+}
+
+inline bool FromVarint(uint64_t value, int32_t* element) {
+  *element = ZigZagDecode(static_cast<uint32_t>(value));
+  return value <= std::numeric_limits<uint32_t>::max();
+}
+
+inline bool FromVarint(uint64_t value, int64_t* element) {
+  *element = ZigZagDecode(value);
+  return true;
+}
+
+template <typename T>
+size_t EncodeArrayImpl(std::span<const T> values,
+                       std::span<std::byte> output,
+                       size_t* values_encoded) {
+  size_t written = 0;
+  size_t count = 0;
+
+  for (; count < values.size(); ++count) {
+    const uint64_t value = ToVarint(values[count]);
+    std::byte* const position = output.data() + written;
+    const size_t available = output.size() - written;
+
+    size_t size;
+    if (value < 0x80u && available >= 1u) {
+      position[0] = static_cast<std::byte>(value);
+      size = 1;
+    } else if (value < 0x4000u && available >= 2u) {
+      position[0] = static_cast<std::byte>(value | 0x80u);
+      position[1] = static_cast<std::byte>(value >> 7);
+      size = 2;
+    } else if (available >= sizeof(uint64_t) && value <= kMaxWordValue) {
+      size = EncodeWord(value, position);
+    } else {
+      size = pw_varint_Encode(value, position, available);
+      if (size == 0u) {
+        break;
+      }
+    }
+    written += size;
+  }
+
+  *values_encoded = count;
+  return written;
+}
+
+template <typename T>
+size_t DecodeArrayImpl(std::span<const std::byte> input,
+                       std::span<T> values,
+                       size_t* values_decoded) {
+  size_t read = 0;
+  size_t count = 0;
+
+  while (count < values.size() && read < input.size()) {
+    const std::byte* const position = input.data() + read;
+    const size_t available = input.size() - read;
+
+    if (available >= sizeof(uint64_t)) {
+      const uint64_t word = LoadWord(position);
+
+      // Small values, such as sensor sample deltas, are often a run of
+      // single-byte varints. Decode 8 of them at once.
+      if ((word & kContinuationBits) == 0u && values.size() - count >= 8u) {
+        for (size_t i = 0; i < 8u; ++i) {
+          FromVarint((word >> (8 * i)) & 0x7f, &values[count + i]);
+        }
+        count += 8;
+        read += 8;
+        continue;
+      }
+
+      // Decode each varint that ends within the word. The last byte of a
+      // varint is the one without a continuation bit. Only clearing the
+      // lowest bit of last_bytes depends on the previous varint, so the
+      // varints are decoded in parallel.
+      uint64_t last_bytes = ~word & kContinuationBits;
+      if (last_bytes != 0u) {
+        unsigned start_bit = 0;
+        do {
+          const unsigned end_bit = __builtin_ctzll(last_bytes) + 1;
+          const uint64_t varint = word & (~uint64_t(0) >> (64 - end_bit));
+          T value;
+          if (!FromVarint(CompactPayload(varint >> start_bit), &value)) {
+            *values_decoded = count;
+            return read + start_bit / 8;
+          }
+          values[count] = value;
+          count += 1;
+          start_bit = end_bit;
+          last_bytes &= last_bytes - 1;
+        } while (last_bytes != 0u && count < values.size());
+
+        read += start_bit / 8;
+        continue;
+      }
+    }
+
+    // Varints longer than 8 bytes or at the end of the input.
+    uint64_t varint;
+    T value;
+    const size_t size = pw_varint_Decode(position, available, &varint);
+    if (size == 0u || !FromVarint(varint, &value)) {
+      break;
+    }
+    values[count] = value;
+    read += size;
+    count += 1;
+  }
+
+  *values_decoded = count;
+  return read;
+}
+
 }  // namespace
 
+size_t EncodeArray(std::span<const uint32_t> values,
+                   std::span<std::byte> output,
+                   size_t* values_encoded) {
+  return EncodeArrayImpl(values, output, values_encoded);
+}
+
+size_t EncodeArray(std::span<const uint64_t> values,
+                   std::span<std::byte> output,
+                   size_t* values_encoded) {
+  return EncodeArrayImpl(values, output, values_encoded);
+}
+
+size_t EncodeArray(std::span<const int32_t> values,
+                   std::span<std::byte> output,
+                   size_t* values_encoded) {
+  return EncodeArrayImpl(values, output, values_encoded);
+}
+
+size_t EncodeArray(std::span<const int64_t> values,
+                   std::span<std::byte> output,
+                   size_t* values_encoded) {
+  return EncodeArrayImpl(values, output, values_encoded);
+}
+
+size_t DecodeArray(std::span<const std::byte> input,
+                   std::span<uint32_t> values,
+                   size_t* values_decoded) {
+  return DecodeArrayImpl(input, values, values_decoded);
+}
+
+size_t DecodeArray(std::span<const std::byte> input,
+                   std::span<uint64_t> values,
+                   size_t* values_decoded) {
+  return DecodeArrayImpl(input, values, values_decoded);
+}
+
+size_t DecodeArray(std::span<const std::byte> input,
+                   std::span<int32_t> values,
+                   size_t* values_decoded) {
+  return DecodeArrayImpl(input, values, values_decoded);
+}
+
+size_t DecodeArray(std::span<const std::byte> input,
+                   std::span<int64_t> values,
+                   size_t* values_decoded) {
+  return DecodeArrayImpl(input, values, values_decoded);
+}
+
 extern "C" size_t pw_varint_EncodeCustom(uint64_t integer,
                                          void* output,
                                          size_t output_size,
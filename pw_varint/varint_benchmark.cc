@@ -0,0 +1,163 @@
+// Copyright 2021 The Pigweed Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License"); you may not
+// use this file except in compliance with the License. You may obtain a copy of
+// the License at
+//
+//     https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+// WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+// License for the specific language governing permissions and limitations under
+// the License.
+
+// Host benchmark comparing EncodeArray and DecodeArray with encoding and
+// decoding one varint at a time. The payloads model packed repeated fields of
+// sensor samples: 7-bit deltas, 12-bit ADC readings, signed deltas, and 32-bit
+// timestamps. This target should only be built for the host.
+//
+// Build the pw_varint.varint_benchmark target and run the binary. Each line
+// reports the encoding and decoding throughput for one payload in MB/s of
+// encoded varints.
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+
+#include "pw_varint/varint.h"
+
+namespace pw::varint {
+namespace {
+
+constexpr size_t kBytesPerRun = 64 * 1024 * 1024;
+constexpr size_t kSamples = 256;
+
+struct Payload {
+  const char* name;
+  uint32_t mask;
+  bool zig_zag;
+};
+
+constexpr Payload kPayloads[] = {
+    {"7-bit deltas", 0x7f, false},
+    {"12-bit ADC", 0xfff, false},
+    {"signed deltas", 0x7ff, true},
+    {"timestamps", 0xffffffff, false},
+};
+
+std::array<uint32_t, kSamples> samples;
+std::array<int32_t, kSamples> signed_samples;
+std::array<uint32_t, kSamples> decoded;
+std::array<int32_t, kSamples> signed_decoded;
+std::array<std::byte, kSamples * kMaxVarint32SizeBytes> encoded;
+
+// Keeps the compiler from optimizing away unused results.
+volatile size_t result;
+
+double Throughput(std::chrono::steady_clock::time_point start) {
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return double(kBytesPerRun) / 1e6 / elapsed.count();
+}
+
+size_t EncodeSamples(const Payload& payload, bool bulk) {
+  size_t count;
+  if (bulk) {
+    return payload.zig_zag ? EncodeArray(std::span<const int32_t>(
+                                             signed_samples),
+                                         encoded,
+                                         &count)
+                           : EncodeArray(std::span<const uint32_t>(samples),
+                                         encoded,
+                                         &count);
+  }
+
+  size_t written = 0;
+  for (size_t i = 0; i < kSamples; ++i) {
+    written += payload.zig_zag
+                   ? Encode(signed_samples[i], std::span(encoded).subspan(
+                                                   written))
+                   : Encode(samples[i], std::span(encoded).subspan(written));
+  }
+  return written;
+}
+
+size_t DecodeSamples(const Payload& payload, size_t size, bool bulk) {
+  const std::span<const std::byte> input(encoded.data(), size);
+  size_t count;
+  if (bulk) {
+    return payload.zig_zag ? DecodeArray(input, signed_decoded, &count)
+                           : DecodeArray(input, decoded, &count);
+  }
+
+  size_t read = 0;
+  for (size_t i = 0; i < kSamples; ++i) {
+    if (payload.zig_zag) {
+      int64_t value;
+      read += Decode(input.subspan(read), &value);
+      signed_decoded[i] = int32_t(value);
+    } else {
+      uint64_t value;
+      read += Decode(input.subspan(read), &value);
+      decoded[i] = uint32_t(value);
+    }
+  }
+  return read;
+}
+
+void RunBenchmark(const Payload& payload, bool bulk) {
+  uint32_t value = 1;
+  for (size_t i = 0; i < kSamples; ++i) {
+    value = value * 1103515245u + 12345u;
+    const uint32_t sample = (value ^ (value >> 15)) & payload.mask;
+    samples[i] = sample;
+    signed_samples[i] = int32_t(sample) - int32_t(payload.mask / 2);
+  }
+
+  const size_t size = EncodeSamples(payload, bulk);
+  const size_t iterations = kBytesPerRun / size;
+  size_t total = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    total += EncodeSamples(payload, bulk);
+  }
+  const double encode = Throughput(start);
+
+  start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    total += DecodeSamples(payload, size, bulk);
+  }
+  const double decode = Throughput(start);
+
+  result = total;
+  std::printf("%-14s %-10s  %5.2f B  %9.1f  %9.1f\n",
+              payload.name,
+              bulk ? "array" : "per value",
+              double(size) / kSamples,
+              encode,
+              decode);
+}
+
+int Main() {
+  std::printf("%-14s %-10s  %7s  %9s  %9s\n",
+              "MB/s",
+              "",
+              "size",
+              "encode",
+              "decode");
+  for (const Payload& payload : kPayloads) {
+    RunBenchmark(payload, false);
+    RunBenchmark(payload, true);
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace pw::varint
+
+int main() { return pw::varint::Main(); }
@@ -14,9 +14,11 @@
 
 #include "pw_varint/varint.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstdint>
 #include <cstring>
+#include <iterator>
 #include <limits>
 
 #include "gtest/gtest.h"
@@ -1078,5 +1080,229 @@ TEST(Varint, MaxValueInBytes) {
   static_assert(MaxValueInBytes(100) == std::numeric_limits<uint64_t>::max());
 }
 
+// Values of every encoded size, for the array tests.
+constexpr uint64_t kArrayValues[] = {
+    0,
+    1,
+    0x7f,
+    0x80,
+    0x3fff,
+    0x4000,
+    0x1fffff,
+    0x200000,
+    0xfffffff,
+    0x10000000,
+    0xffffffff,
+    0x100000000,
+    0xffffffffffffff,
+    0x100000000000000,
+    0x7fffffffffffffff,
+    0x8000000000000000,
+    std::numeric_limits<uint64_t>::max(),
+    5,
+    3,
+    0,
+    127,
+    1,
+    2,
+    6,
+    9,
+};
+
+constexpr size_t kArrayValueCount = std::size(kArrayValues);
+
+// Encodes values one at a time with Encode.
+size_t EncodeEach(std::span<const uint64_t> values, std::span<std::byte> out) {
+  size_t written = 0;
+  for (uint64_t value : values) {
+    written += Encode(value, out.subspan(written));
+  }
+  return written;
+}
+
+TEST(VarintArray, EncodeArray_MatchesEncodeAtEachOffset) {
+  std::byte expected[kArrayValueCount * kMaxVarint64SizeBytes];
+  std::byte encoded[sizeof(expected) + 8];
+
+  for (size_t first = 0; first < kArrayValueCount; ++first) {
+    const std::span<const uint64_t> values =
+        std::span(kArrayValues).subspan(first);
+    const size_t expected_size = EncodeEach(values, expected);
+
+    for (size_t offset = 0; offset < 8u; ++offset) {
+      std::memset(encoded, 0xa5, sizeof(encoded));
+      size_t count = 0;
+      const size_t written =
+          EncodeArray(values,
+                      std::span(encoded).subspan(offset, expected_size),
+                      &count);
+      ASSERT_EQ(written, expected_size);
+      EXPECT_EQ(count, values.size());
+      EXPECT_EQ(std::memcmp(encoded + offset, expected, expected_size), 0);
+      EXPECT_EQ(encoded[offset + expected_size], std::byte{0xa5});
+    }
+  }
+}
+
+TEST(VarintArray, EncodeArray_StopsWhenValueDoesNotFit) {
+  std::byte expected[kArrayValueCount * kMaxVarint64SizeBytes];
+  const size_t expected_size = EncodeEach(kArrayValues, expected);
+  std::byte encoded[sizeof(expected)];
+
+  for (size_t size = 0; size < expected_size; ++size) {
+    size_t count = 0;
+    const size_t written =
+        EncodeArray(std::span<const uint64_t>(kArrayValues),
+                    std::span(encoded, size),
+                    &count);
+    ASSERT_LT(count, kArrayValueCount);
+    EXPECT_EQ(written, EncodeEach(std::span(kArrayValues, count), expected));
+    EXPECT_LE(written, size);
+    EXPECT_GT(written + EncodedSize(kArrayValues[count]), size);
+    EXPECT_EQ(std::memcmp(encoded, expected, written), 0);
+  }
+}
+
+TEST(VarintArray, EncodeArray_Signed) {
+  constexpr int64_t kValues[] = {0, -1, 1, -64, 64, -5000, 1 << 30};
+  std::byte expected[std::size(kValues) * kMaxVarint64SizeBytes];
+  std::byte encoded[sizeof(expected)];
+
+  size_t expected_size = 0;
+  for (int64_t value : kValues) {
+    expected_size += Encode(value, std::span(expected).subspan(expected_size));
+  }
+
+  size_t count = 0;
+  EXPECT_EQ(EncodeArray(std::span(kValues), encoded, &count), expected_size);
+  EXPECT_EQ(count, std::size(kValues));
+  EXPECT_EQ(std::memcmp(encoded, expected, expected_size), 0);
+
+  int32_t values32[std::size(kValues)];
+  std::copy(std::begin(kValues), std::end(kValues), values32);
+  EXPECT_EQ(EncodeArray(std::span<const int32_t>(values32), encoded, &count),
+            expected_size);
+  EXPECT_EQ(count, std::size(kValues));
+  EXPECT_EQ(std::memcmp(encoded, expected, expected_size), 0);
+}
+
+TEST(VarintArray, DecodeArray_MatchesValuesAtEachOffset) {
+  std::byte encoded[kArrayValueCount * kMaxVarint64SizeBytes + 8];
+  uint64_t decoded[kArrayValueCount + 1];
+
+  for (size_t first = 0; first < kArrayValueCount; ++first) {
+    const std::span<const uint64_t> values =
+        std::span(kArrayValues).subspan(first);
+
+    for (size_t offset = 0; offset < 8u; ++offset) {
+      const size_t size =
+          EncodeEach(values, std::span(encoded).subspan(offset));
+      std::fill(std::begin(decoded), std::end(decoded), 0xa5a5);
+
+      size_t count = 0;
+      const size_t read = DecodeArray(
+          std::span(encoded).subspan(offset, size), decoded, &count);
+      ASSERT_EQ(read, size);
+      ASSERT_EQ(count, values.size());
+      EXPECT_TRUE(std::equal(values.begin(), values.end(), decoded));
+      EXPECT_EQ(decoded[count], 0xa5a5u);
+    }
+  }
+}
+
+TEST(VarintArray, DecodeArray_SingleByteRuns) {
+  std::byte encoded[64];
+  for (size_t i = 0; i < sizeof(encoded); ++i) {
+    encoded[i] = std::byte(i * 37 % 128);
+  }
+
+  for (size_t capacity = 0; capacity <= sizeof(encoded); ++capacity) {
+    uint32_t decoded[sizeof(encoded) + 1] = {};
+    size_t count = 0;
+    EXPECT_EQ(DecodeArray(encoded, std::span(decoded, capacity), &count),
+              capacity);
+    ASSERT_EQ(count, capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+      EXPECT_EQ(decoded[i], i * 37 % 128);
+    }
+    EXPECT_EQ(decoded[capacity], 0u);
+  }
+}
+
+TEST(VarintArray, DecodeArray_StopsAtTruncatedVarint) {
+  std::byte encoded[kArrayValueCount * kMaxVarint64SizeBytes];
+  const size_t size = EncodeEach(kArrayValues, encoded);
+  uint64_t decoded[kArrayValueCount];
+
+  size_t expected_read = 0;
+  size_t expected_count = 0;
+  for (size_t truncated = 0; truncated < size; ++truncated) {
+    if (expected_read + EncodedSize(kArrayValues[expected_count]) <=
+        truncated) {
+      expected_read += EncodedSize(kArrayValues[expected_count]);
+      expected_count += 1;
+    }
+    size_t count = 0;
+    EXPECT_EQ(DecodeArray(std::span(encoded, truncated), decoded, &count),
+              expected_read);
+    EXPECT_EQ(count, expected_count);
+  }
+}
+
+TEST(VarintArray, DecodeArray_StopsAtTooLongVarint) {
+  std::byte encoded[16];
+  std::memset(encoded, 0x80, sizeof(encoded));
+  encoded[0] = std::byte{0x01};
+
+  uint64_t decoded[4];
+  size_t count = 0;
+  EXPECT_EQ(DecodeArray(encoded, decoded, &count), 1u);
+  EXPECT_EQ(count, 1u);
+  EXPECT_EQ(decoded[0], 1u);
+}
+
+TEST(VarintArray, DecodeArray_StopsAtValueTooLargeFor32Bits) {
+  constexpr uint64_t kValues[] = {1, 0xffffffff, 0x100000000, 2};
+  std::byte encoded[std::size(kValues) * kMaxVarint64SizeBytes];
+  const size_t size = EncodeEach(kValues, encoded);
+
+  uint32_t decoded[std::size(kValues)] = {0, 0, 123, 0};
+  size_t count = 0;
+  EXPECT_EQ(DecodeArray(std::span(encoded, size), decoded, &count), 6u);
+  EXPECT_EQ(count, 2u);
+  EXPECT_EQ(decoded[1], 0xffffffffu);
+  EXPECT_EQ(decoded[2], 123u);
+
+  // A value at the end of the input is decoded without reading a whole word.
+  EXPECT_EQ(DecodeArray(std::span(encoded, size).subspan(6, 5),
+                        std::span(decoded).subspan(2),
+                        &count),
+            0u);
+  EXPECT_EQ(count, 0u);
+  EXPECT_EQ(decoded[2], 123u);
+
+  uint64_t decoded64[std::size(kValues)];
+  EXPECT_EQ(DecodeArray(std::span(encoded, size), decoded64, &count), size);
+  EXPECT_EQ(count, std::size(kValues));
+}
+
+TEST(VarintArray, DecodeArray_Signed) {
+  constexpr int32_t kValues[] = {0, -1, 1, -64, 64, -5000, -2147483647 - 1};
+  std::byte encoded[std::size(kValues) * kMaxVarint64SizeBytes];
+  size_t count = 0;
+  const size_t size = EncodeArray(std::span(kValues), encoded, &count);
+  ASSERT_EQ(count, std::size(kValues));
+
+  int32_t decoded[std::size(kValues)];
+  EXPECT_EQ(DecodeArray(std::span(encoded, size), decoded, &count), size);
+  EXPECT_EQ(count, std::size(kValues));
+  EXPECT_TRUE(std::equal(std::begin(kValues), std::end(kValues), decoded));
+
+  int64_t decoded64[std::size(kValues)];
+  EXPECT_EQ(DecodeArray(std::span(encoded, size), decoded64, &count), size);
+  EXPECT_EQ(count, std::size(kValues));
+  EXPECT_TRUE(std::equal(std::begin(kValues), std::end(kValues), decoded64));
+}
+
 }  // namespace
 }  // namespace pw::varint